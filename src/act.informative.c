@@ -1105,7 +1105,7 @@ ACMD(do_who)
 /* BIG OL' FIXME: Rewrite it all. Similar to do_who(). */
 ACMD(do_users)
 {
-  char line[200], line2[220], idletime[10], classname[20];
+  char line[200], line2[220], idletime[10], classname[20], saved[20];
   char state[30], *timeptr, mode;
   char name_search[MAX_INPUT_LENGTH], host_search[MAX_INPUT_LENGTH];
   struct char_data *tch;
@@ -1167,8 +1167,8 @@ ACMD(do_users)
     }
   }				/* end while (parser) */
   send_to_char(ch,
-	 "Num Class   Name         State          Idl Login@   Site\r\n"
-	 "--- ------- ------------ -------------- --- -------- ------------------------\r\n");
+	 "Num Class   Name         State          Idl Login@   MCCP  Site\r\n"
+	 "--- ------- ------------ -------------- --- -------- ----- ------------------------\r\n");
 
   one_argument(argument, arg);
 
@@ -1221,11 +1221,17 @@ ACMD(do_users)
     else
       strcpy(idletime, "");
 
-    sprintf(line, "%3d %-7s %-12s %-14s %-3s %-8s ", d->desc_num, classname,
+    /* Bytes compression has saved this connection so far, in K. */
+    if (d->mccp_in)
+      sprintf(saved, "%4ldk", ((long) d->mccp_in - (long) d->mccp_out) / 1024);
+    else
+      strcpy(saved, "  -  ");
+
+    sprintf(line, "%3d %-7s %-12s %-14s %-3s %-8s %-5s ", d->desc_num, classname,
 	d->original && d->original->player.name ? d->original->player.name :
 	d->character && d->character->player.name ? d->character->player.name :
 	"UNDEFINED",
-	state, idletime, timeptr);
+	state, idletime, timeptr, saved);
 
     if (*d->host)
       sprintf(line + strlen(line), "[%s]\r\n", d->host);
@@ -77,6 +77,7 @@ void perform_put(struct char_data *ch, struct obj_data *obj,
     /* Yes, I realize this is strange until we have auto-equip on rent. -gg */
     if (OBJ_FLAGGED(obj, ITEM_NODROP) && !OBJ_FLAGGED(cont, ITEM_NODROP)) {
       SET_BIT(GET_OBJ_EXTRA(cont), ITEM_NODROP);
+      obj_dirty(cont);
       act("You get a strange feeling as you put $p in $P.", FALSE,
                 ch, obj, cont, TO_CHAR);
     } else
@@ -664,6 +665,7 @@ void perform_give_gold(struct char_data *ch, struct char_data *vict,
   if (IS_NPC(ch) || (GET_LEVEL(ch) < LVL_GOD))
     GET_GOLD(ch) -= amount;
   GET_GOLD(vict) += amount;
+  SET_DIRTY(vict, DIRTY_RECORD);
 }
 
 
@@ -738,6 +740,7 @@ void weight_change_object(struct obj_data *obj, int weight)
 
   if (IN_ROOM(obj) != NOWHERE) {
     GET_OBJ_WEIGHT(obj) += weight;
+    obj_dirty(obj);
   } else if ((tmp_ch = obj->carried_by)) {
     obj_from_char(obj);
     GET_OBJ_WEIGHT(obj) += weight;
@@ -933,6 +936,7 @@ ACMD(do_drink)
     GET_OBJ_VAL(temp, 2) = 0;
     GET_OBJ_VAL(temp, 3) = 0;
   }
+  obj_dirty(temp);
   return;
 }
 
@@ -1004,7 +1008,8 @@ ACMD(do_eat)
     if (!(--GET_OBJ_VAL(food, 0))) {
       send_to_char(ch, "There's nothing left now.\r\n");
       extract_obj(food);
-    }
+    } else
+      obj_dirty(food);
   }
 }
 
@@ -1076,6 +1081,7 @@ ACMD(do_pour)
       GET_OBJ_VAL(from_obj, 1) = 0;
       GET_OBJ_VAL(from_obj, 2) = 0;
       GET_OBJ_VAL(from_obj, 3) = 0;
+      obj_dirty(from_obj);
 
       return;
     }
@@ -1137,6 +1143,9 @@ ACMD(do_pour)
   /* And the weight boogie */
   weight_change_object(from_obj, -amount);
   weight_change_object(to_obj, amount);	/* Add weight */
+
+  obj_dirty(from_obj);
+  obj_dirty(to_obj);
 }
 
 
@@ -295,6 +295,7 @@ ACMD(do_steal)
       if (gold > 0) {
 	GET_GOLD(ch) += gold;
 	GET_GOLD(vict) -= gold;
+	SET_DIRTY(vict, DIRTY_RECORD);
         if (gold > 1)
 	  send_to_char(ch, "Bingo!  You got %d gold coins.\r\n", gold);
 	else
@@ -602,6 +603,7 @@ ACMD(do_split)
     if (AFF_FLAGGED(k, AFF_GROUP) && IN_ROOM(k) == IN_ROOM(ch) &&
 		!IS_NPC(k) && k != ch) {
       GET_GOLD(k) += share;
+      SET_DIRTY(k, DIRTY_RECORD);
       send_to_char(k, "%s", buf);
     }
 
@@ -21,16 +21,17 @@
 #include "house.h"
 #include "screen.h"
 #include "constants.h"
+#include "events.h"
+#include "intern.h"
 
 /*   external vars  */
-extern FILE *player_fl;
 extern struct attack_hit_type attack_hit_text[];
 extern char *class_abbrevs[];
 extern time_t boot_time;
 extern int circle_shutdown, circle_reboot;
 extern int circle_restrict;
 extern int load_into_inventory;
-extern int buf_switches, buf_largecount, buf_overflows;
+extern int buf_switches, buf_largecount, buf_poolcount, buf_overflows;
 extern int top_of_p_table;
 
 /* for chars */
@@ -1296,6 +1297,7 @@ ACMD(do_restore)
     GET_HIT(vict) = GET_MAX_HIT(vict);
     GET_MANA(vict) = GET_MAX_MANA(vict);
     GET_MOVE(vict) = GET_MAX_MOVE(vict);
+    SET_DIRTY(vict, DIRTY_RECORD);
 
     if (!IS_NPC(vict) && GET_LEVEL(ch) >= LVL_GRGOD) {
       if (GET_LEVEL(vict) >= LVL_IMMORT)
@@ -1862,7 +1864,7 @@ size_t print_zone_to_buf(char *bufptr, size_t left, zone_rnum zone)
   return snprintf(bufptr, left,
 	"%3d %-30.30s Age: %3d; Reset: %3d (%1d); Range: %5d-%5d\r\n",
 	zone_table[zone].number, zone_table[zone].name,
-	zone_table[zone].age, zone_table[zone].lifespan,
+	zone_age(zone), zone_table[zone].lifespan,
 	zone_table[zone].reset_mode,
 	zone_table[zone].bot, zone_table[zone].top);
 }
@@ -1872,7 +1874,8 @@ ACMD(do_show)
 {
   struct char_file_u vbuf;
   int i, j, k, l, con, nlen;		/* i, j, k to specifics? */
-  size_t len;
+  int strings, refs;
+  size_t len, bytes, saved;
   zone_rnum zrn;
   zone_vnum zvn;
   byte self = FALSE;
@@ -1897,6 +1900,7 @@ ACMD(do_show)
     { "shops",		LVL_IMMORT },
     { "houses",		LVL_GOD },
     { "snoop",		LVL_GRGOD },			/* 10 */
+    { "events",		LVL_IMMORT },
     { "\n", 0 }
   };
 
@@ -1997,22 +2001,34 @@ ACMD(do_show)
     }
     for (obj = object_list; obj; obj = obj->next)
       k++;
+    for (l = 0, zrn = 0; zrn <= top_of_zone_table; zrn++)
+      if (zone_table[zrn].resident)
+	l++;
+    str_intern_stats(&strings, &refs, &bytes, &saved);
     send_to_char(ch,
 	"Current stats:\r\n"
 	"  %5d players in game  %5d connected\r\n"
 	"  %5d registered\r\n"
 	"  %5d mobiles          %5d prototypes\r\n"
 	"  %5d objects          %5d prototypes\r\n"
-	"  %5d rooms            %5d zones\r\n"
-	"  %5d large bufs\r\n"
-	"  %5d buf switches     %5d overflows\r\n",
+	"  %5d rooms            %5d zones, %d loaded\r\n"
+	"  %5d output chunks    %5d in pool\r\n"
+	"  %5d chunks handed out %4d overflows\r\n"
+	"  %5d shared strings   %5d uses, %luk held, %luk saved\r\n"
+	"  Saved: %lu records (%lu unchanged), %lu rent files (%lu unchanged)\r\n"
+	"         %lu houses (%lu unchanged), %lu journal compares (%lu unchanged)\r\n",
 	i, con,
 	top_of_p_table + 1,
 	j, top_of_mobt + 1,
 	k, top_of_objt + 1,
-	top_of_world + 1, top_of_zone_table + 1,
-	buf_largecount,
-	buf_switches, buf_overflows
+	top_of_world + 1, top_of_zone_table + 1, l,
+	buf_largecount, buf_poolcount,
+	buf_switches, buf_overflows,
+	strings, refs, (unsigned long) bytes / 1024, (unsigned long) saved / 1024,
+	saves_done[SAVES_RECORD], saves_skipped[SAVES_RECORD],
+	saves_done[SAVES_OBJS], saves_skipped[SAVES_OBJS],
+	saves_done[SAVES_HOUSE], saves_skipped[SAVES_HOUSE],
+	saves_done[SAVES_JOURNAL], saves_skipped[SAVES_JOURNAL]
 	);
     break;
 
@@ -2084,6 +2100,16 @@ ACMD(do_show)
       send_to_char(ch, "No one is currently snooping.\r\n");
     break;
 
+  /* show events */
+  case 11:
+    send_to_char(ch, "Event wheel at pulse %lu:\r\n", event_pulse);
+    for (i = 0; i < EVENT_LEVELS; i++) {
+      event_level_stats(i, &j, &k);
+      send_to_char(ch, "  Level %d: %8lu pulses/slot  %5d events  %5d in busiest slot\r\n",
+	i, 1UL << (EVENT_BITS * i), j, k);
+    }
+    break;
+
   /* show what? */
   default:
     send_to_char(ch, "Sorry, I don't understand that.\r\n");
@@ -2575,8 +2601,7 @@ ACMD(do_set)
       save_char(vict);
     if (is_file) {
       char_to_store(vict, &tmp_store);
-      fseek(player_fl, (player_i) * sizeof(struct char_file_u), SEEK_SET);
-      fwrite(&tmp_store, sizeof(struct char_file_u), 1, player_fl);
+      save_char_record(player_i, &tmp_store);
       send_to_char(ch, "Saved in file.\r\n");
     }
   }
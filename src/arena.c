@@ -0,0 +1,147 @@
+/* ************************************************************************
+*   File: arena.c                                       Part of CircleMUD *
+*  Usage: memory for world data that lives until the world goes           *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * The exits, extra descriptions and text read from the world files are
+ * small, many, and never freed until the whole world is.  Taken from a
+ * few large chunks instead of one malloc() apiece, each room's lie next
+ * to each other, and freeing them is a matter of freeing the chunks.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "arena.h"
+
+#define ARENA_FIRST	(2 * 1024)	/* bytes in the first chunk	*/
+#define ARENA_CHUNK	(64 * 1024)	/* ... doubling up to this	*/
+
+/* Anything handed out is aligned for whatever might be stored in it. */
+union arena_align {
+  void *p;
+  long l;
+  double d;
+};
+
+#define ARENA_ALIGN(n)	(((n) + sizeof(union arena_align) - 1) & ~(sizeof(union arena_align) - 1))
+
+struct arena_chunk {
+  struct arena_chunk *next;
+  union arena_align data[1];	/* really as long as it needs	*/
+};
+
+#define CHUNK_HEADER	(sizeof(struct arena_chunk) - sizeof(union arena_align))
+
+/* local functions */
+struct arena_chunk *arena_chunk(size_t size);
+
+
+struct arena_chunk *arena_chunk(size_t size)
+{
+  struct arena_chunk *chunk;
+
+  if (!(chunk = (struct arena_chunk *) calloc(1, CHUNK_HEADER + size))) {
+    perror("SYSERR: malloc failure");
+    abort();
+  }
+
+  return (chunk);
+}
+
+
+void *arena_alloc(struct arena *a, size_t size)
+{
+  struct arena_chunk *chunk;
+  void *ptr;
+
+  size = ARENA_ALIGN(size ? size : 1);
+
+  /*
+   * Something large gets a chunk of its own, kept behind the current one
+   * so what's left of that isn't wasted.
+   */
+  if (size > ARENA_CHUNK / 4) {
+    chunk = arena_chunk(size);
+    if (a->chunks) {
+      chunk->next = a->chunks->next;
+      a->chunks->next = chunk;
+    } else
+      a->chunks = chunk;
+    a->bytes += size;
+    return (chunk->data);
+  }
+
+  /* Start small, since a good many arenas won't need much. */
+  if (size > a->left) {
+    a->chunk_size = (a->chunk_size ? a->chunk_size * 2 : ARENA_FIRST);
+    if (a->chunk_size > ARENA_CHUNK)
+      a->chunk_size = ARENA_CHUNK;
+    while (a->chunk_size < size)
+      a->chunk_size *= 2;
+    chunk = arena_chunk(a->chunk_size);
+    chunk->next = a->chunks;
+    a->chunks = chunk;
+    a->next = (char *) chunk->data;
+    a->left = a->chunk_size;
+  }
+
+  ptr = a->next;
+  a->next += size;
+  a->left -= size;
+  a->bytes += size;
+
+  return (ptr);
+}
+
+
+char *arena_strdup(struct arena *a, const char *str)
+{
+  size_t len = strlen(str) + 1;
+
+  return ((char *) memcpy(arena_alloc(a, len), str, len));
+}
+
+
+/*
+ * Hand everything in 'from' over to 'into', to be freed with it.  The
+ * space left in 'from's newest chunk is given up.
+ */
+void arena_merge(struct arena *into, struct arena *from)
+{
+  struct arena_chunk *last;
+
+  if (from->chunks) {
+    for (last = from->chunks; last->next; last = last->next);
+    last->next = into->chunks;
+    into->chunks = from->chunks;
+    into->next = from->next;
+    into->left = from->left;
+    if (from->chunk_size > into->chunk_size)
+      into->chunk_size = from->chunk_size;
+    into->bytes += from->bytes;
+  }
+
+  memset(from, 0, sizeof(struct arena));
+}
+
+
+void arena_free(struct arena *a)
+{
+  struct arena_chunk *chunk, *next;
+
+  for (chunk = a->chunks; chunk; chunk = next) {
+    next = chunk->next;
+    free(chunk);
+  }
+
+  memset(a, 0, sizeof(struct arena));
+}
@@ -0,0 +1,35 @@
+/* ************************************************************************
+*   File: arena.h                                       Part of CircleMUD *
+*  Usage: header file for the boot-time memory arenas                     *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * An arena hands out memory that is never given back piece by piece:
+ * it all goes at once, with arena_free().  Nothing taken from one may be
+ * free()'d or realloc'd.  An arena is empty when zeroed, so a global or
+ * CREATE()'d one is ready to use.  One arena must not be used by two
+ * threads at once.
+ */
+struct arena_chunk;
+
+struct arena {
+  struct arena_chunk *chunks;	/* newest first			*/
+  char *next;			/* free space in the newest	*/
+  size_t left;
+  size_t chunk_size;		/* of the newest		*/
+  size_t bytes;			/* allocated, for the stats	*/
+};
+
+void *arena_alloc(struct arena *a, size_t size);
+char *arena_strdup(struct arena *a, const char *str);
+void arena_merge(struct arena *into, struct arena *from);
+void arena_free(struct arena *a);
+
+/* CREATE() for memory from an arena: zeroed, like calloc()'s. */
+#define ARENA_CREATE(result, arena, type, number) \
+	((result) = (type *) arena_alloc((arena), sizeof(type) * (number)))
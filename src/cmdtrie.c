@@ -0,0 +1,190 @@
+/* ************************************************************************
+*   File: cmdtrie.c                                     Part of CircleMUD *
+*  Usage: finding commands by name or abbreviation                        *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * The command a player means is the first in cmd_info[] that starts with
+ * what they typed and that their level allows, which used to mean a
+ * strncmp() down the table, three hundred entries for a typo, every line
+ * anyone typed.  Now the names are in a trie, a node for each prefix of
+ * one, so what's typed is followed a letter at a time to the node for
+ * all of it.
+ *
+ * Each node keeps the commands starting with its prefix that could be
+ * the answer for somebody: in table order, each with a lower minimum
+ * level than any before it.  The one the table would have found is the
+ * first of those the player's level allows, because any command ahead of
+ * it needs more, so only a few are looked at -- one for mortals, nearly
+ * always.  Nothing here knows about cmd_info[], so the utilities can
+ * build one, too.
+ */
+
+#define __CMDTRIE_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "cmdtrie.h"
+
+struct cmdtrie_node {
+  char letter;			/* the last of its prefix		*/
+  int child;			/* the first node under it, or -1	*/
+  int sibling;			/* the next under its parent, or -1	*/
+  int exact;			/* the first command it spells, or -1	*/
+  int *cmds;			/* the commands it could abbreviate	*/
+  int num_cmds;
+};
+
+/* local globals */
+struct cmdtrie_node *ct_node = NULL;	/* the root is the first	*/
+int ct_top = 0, ct_size = 0;
+int *ct_level = NULL;		/* each command's minimum level	*/
+int ct_num = 0, ct_num_size = 0;
+
+/* local functions */
+int ct_new_node(char letter);
+int ct_step(int node, char letter);
+void ct_note(int node, int cmd);
+
+
+int ct_new_node(char letter)
+{
+  struct cmdtrie_node *n;
+
+  if (ct_top == ct_size) {
+    ct_size = (ct_size ? ct_size * 2 : 256);
+    RECREATE(ct_node, struct cmdtrie_node, ct_size);
+  }
+  n = &ct_node[ct_top];
+  n->letter = letter;
+  n->child = n->sibling = n->exact = -1;
+  n->cmds = NULL;
+  n->num_cmds = 0;
+
+  return (ct_top++);
+}
+
+
+/* The node under 'node' for 'letter', or -1. */
+int ct_step(int node, char letter)
+{
+  int n;
+
+  for (n = ct_node[node].child; n >= 0; n = ct_node[n].sibling)
+    if (ct_node[n].letter == letter)
+      return (n);
+
+  return (-1);
+}
+
+
+/* 'cmd' starts with what 'node' spells; keep it if it needs less. */
+void ct_note(int node, int cmd)
+{
+  struct cmdtrie_node *n = &ct_node[node];
+
+  if (n->num_cmds && ct_level[cmd] >= ct_level[n->cmds[n->num_cmds - 1]])
+    return;
+  RECREATE(n->cmds, int, n->num_cmds + 1);
+  n->cmds[n->num_cmds++] = cmd;
+}
+
+
+/*
+ * Add the next command in the table; commands are numbered in the order
+ * they're added, from 0.  Returns its number.
+ */
+int cmdtrie_add(const char *command, int level)
+{
+  int node = 0, next, cmd = ct_num;
+
+  if (ct_num == ct_num_size) {
+    ct_num_size = (ct_num_size ? ct_num_size * 2 : 64);
+    RECREATE(ct_level, int, ct_num_size);
+  }
+  ct_level[ct_num++] = level;
+
+  if (!ct_top)
+    ct_new_node('\0');
+  ct_note(node, cmd);
+
+  for (; *command; command++) {
+    if ((next = ct_step(node, *command)) < 0) {
+      next = ct_new_node(*command);
+      ct_node[next].sibling = ct_node[node].child;
+      ct_node[node].child = next;
+    }
+    node = next;
+    ct_note(node, cmd);
+  }
+
+  if (ct_node[node].exact < 0)
+    ct_node[node].exact = cmd;
+
+  return (cmd);
+}
+
+
+/*
+ * The first command starting with 'arg' that 'level' may use, as a
+ * strncmp() down the table would find it, or -1.
+ */
+int cmdtrie_find(const char *arg, int level)
+{
+  int node = 0, i;
+
+  if (!ct_top)
+    return (-1);
+
+  for (; *arg; arg++)
+    if ((node = ct_step(node, *arg)) < 0)
+      return (-1);
+
+  for (i = 0; i < ct_node[node].num_cmds; i++)
+    if (level >= ct_level[ct_node[node].cmds[i]])
+      return (ct_node[node].cmds[i]);
+
+  return (-1);
+}
+
+
+/* The first command named exactly 'command', or -1. */
+int cmdtrie_exact(const char *command)
+{
+  int node = 0;
+
+  if (!ct_top)
+    return (-1);
+
+  for (; *command; command++)
+    if ((node = ct_step(node, *command)) < 0)
+      return (-1);
+
+  return (ct_node[node].exact);
+}
+
+
+void cmdtrie_free(void)
+{
+  int i;
+
+  for (i = 0; i < ct_top; i++)
+    if (ct_node[i].cmds)
+      free(ct_node[i].cmds);
+  if (ct_node)
+    free(ct_node);
+  if (ct_level)
+    free(ct_level);
+
+  ct_node = NULL;
+  ct_level = NULL;
+  ct_top = ct_size = ct_num = ct_num_size = 0;
+}
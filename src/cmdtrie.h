@@ -0,0 +1,14 @@
+/* ************************************************************************
+*   File: cmdtrie.h                                     Part of CircleMUD *
+*  Usage: header file for the index of command names                      *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+int cmdtrie_add(const char *command, int level);
+int cmdtrie_find(const char *arg, int level);
+int cmdtrie_exact(const char *command);
+void cmdtrie_free(void);
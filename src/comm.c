@@ -59,6 +59,12 @@
 #include "handler.h"
 #include "db.h"
 #include "house.h"
+#include "events.h"
+#include "perf.h"
+#include "worldimg.h"
+#include "saver.h"
+#include "journal.h"
+#include "cmdtrie.h"
 
 #ifdef HAVE_ARPA_TELNET_H
 #include <arpa/telnet.h>
@@ -66,10 +72,81 @@
 #include "telnet.h"
 #endif
 
+#ifndef TELOPT_COMPRESS2
+#define TELOPT_COMPRESS2	86	/* MCCP v2; newer than most <arpa/telnet.h> */
+#endif
+
 #ifndef INVALID_SOCKET
 #define INVALID_SOCKET (-1)
 #endif
 
+/* Socket readiness: used by io_link.io_ready */
+#define IO_READY_WRITE	(1 << 0)   /* Kernel send buffer has room	*/
+
+#define DNS_CACHE_BUCKETS	64	/* hostname cache; power of 2 */
+#define DNS_HASH(a)	(((a).s_addr ^ ((a).s_addr >> 16)) & (DNS_CACHE_BUCKETS - 1))
+
+#define LINK_INPUT_SIZE		4096	/* Raw input a link can hold; power of 2 */
+#define LINK_INPUT_LINES	16	/* Framed lines a link can hold; power of 2 */
+#define LINK_OUTBUF_SIZE	16384	/* Output ring, power of 2 >= MAX_SOCK_BUF */
+#define ACCEPT_QUEUE_SIZE	64	/* New links waiting for the game; power of 2 */
+/* Output chunks offered per process_output(); a full ring's worth and then some */
+#define OUTPUT_IOVECS		(LINK_OUTBUF_SIZE / OUTBUF_CHUNK_SIZE + 1)
+#define OUTBUF_DIRECT_MIN	512	/* Room needed to format straight into a chunk */
+
+/*
+ * Ring positions only ever grow; a slot is 'pos & (SIZE - 1)'.  Each
+ * position has exactly one writer, who publishes it with RING_SET after
+ * filling the slots, and readers pick it up with RING_GET.
+ */
+#ifdef CIRCLE_IO_THREAD
+typedef atomic_size_t ring_pos_t;
+typedef atomic_int link_flag_t;
+#define RING_GET(pos)		atomic_load_explicit(&(pos), memory_order_acquire)
+#define RING_SET(pos, val)	atomic_store_explicit(&(pos), (val), memory_order_release)
+#else
+typedef size_t ring_pos_t;
+typedef int link_flag_t;
+#define RING_GET(pos)		(pos)
+#define RING_SET(pos, val)	((pos) = (val))
+#endif
+
+/* Where a line sits in the input ring: it runs from the end of the last. */
+struct link_line {
+  size_t end;			/* position of its newline		*/
+  size_t next;			/* first position past the newline(s)	*/
+};
+
+/* The socket half of a descriptor; see the comments above init_poller(). */
+struct io_link {
+  socket_t descriptor;		/* file descriptor for socket		*/
+  struct sockaddr_in peer;	/* who connected, for the game side	*/
+  int io_ready;			/* IO_READY_x bits from the poller	*/
+  int stalled;			/* input ring full; more input waiting	*/
+  int telnet_state;		/* partway through a telnet command?	*/
+
+  char inbuf[LINK_INPUT_SIZE];	/* raw input, telnet commands removed	*/
+  size_t in_head;		/* network side: end of what's been read */
+  size_t in_scan;		/* network side: newline search from here */
+  size_t in_line;		/* network side: start of unfinished line */
+  ring_pos_t in_tail;		/* written by the game side		*/
+
+  struct link_line lines[LINK_INPUT_LINES];  /* complete lines in inbuf */
+  ring_pos_t line_head;		/* written by the network side		*/
+  ring_pos_t line_tail;		/* written by the game side		*/
+
+  char outbuf[LINK_OUTBUF_SIZE];	/* output waiting for the kernel	*/
+  ring_pos_t out_head;		/* written by the game side		*/
+  ring_pos_t out_tail;		/* written by the network side		*/
+
+  link_flag_t gone;		/* network side: the socket has failed	*/
+  link_flag_t released;		/* game side: descriptor is finished	*/
+  link_flag_t mccp_wanted;	/* network side: last DO/DONT COMPRESS2	*/
+
+  struct io_link *prev;		/* network side's list of links		*/
+  struct io_link *next;
+};
+
 /* externs */
 extern struct ban_list_element *ban_list;
 extern int num_invalid;
@@ -94,21 +171,55 @@ extern char *help;
 
 /* local globals */
 struct descriptor_data *descriptor_list = NULL;		/* master desc list */
-struct txt_block *bufpool = 0;	/* pool of large output buffers */
-int buf_largecount = 0;		/* # of large buffers which exist */
-int buf_overflows = 0;		/* # of overflows of output */
-int buf_switches = 0;		/* # of switches from small to large buf */
+struct out_chunk *bufpool = NULL;	/* free list of output chunks */
+struct txt_block *txt_pool = NULL;	/* free list of input queue slots */
+int buf_largecount = 0;		/* # of output chunks which exist */
+int buf_poolcount = 0;		/* # of those sitting in bufpool */
+int buf_overflows = 0;		/* # of times output hit MAX_OUTBUF_SIZE */
+int buf_switches = 0;		/* # of chunks handed out from the pool */
 int circle_shutdown = 0;	/* clean shutdown */
 int circle_reboot = 0;		/* reboot the game after a shutdown */
 int no_specials = 0;		/* Suppress ass. of special routines */
 int max_players = 0;		/* max descriptors available */
 int tics = 0;			/* for extern checkpointing */
 int scheck = 0;			/* for syntax checking mode */
+int write_image = 0;		/* boot, write the world image, and exit */
 struct timeval null_time;	/* zero-valued time structure */
 byte reread_wizlist;		/* signal: SIGUSR1 */
 byte emergency_unban;		/* signal: SIGUSR2 */
 FILE *logfile = NULL;		/* Where to send the log messages. */
 const char *text_overflow = "**OVERFLOW**\r\n";
+#ifdef CIRCLE_EPOLL
+int epoll_fd = -1;		/* kernel event queue for all sockets */
+struct epoll_event *epoll_events = NULL;	/* results of epoll_wait() */
+#endif
+
+/* network side (the I/O thread, if there is one) */
+struct io_link *link_list = NULL;	/* every open socket */
+int num_links = 0;		/* # of links in link_list */
+int sweep_needed = FALSE;	/* io_sweep() has catching up to do */
+int accept_paused = FALSE;	/* accept queue was full; mother unwatched */
+
+/* shared between the game and network sides */
+struct io_link *accept_queue[ACCEPT_QUEUE_SIZE];
+ring_pos_t accept_head = 0;	/* written by the network side */
+ring_pos_t accept_tail = 0;	/* written by the game side */
+#ifdef CIRCLE_IO_THREAD
+pthread_t io_thread;
+int io_wake_pipe[2];		/* game -> network: output to flush */
+int game_wake_pipe[2];		/* network -> game: a connection came in */
+link_flag_t io_shutdown = FALSE;	/* game -> network: finish up */
+link_flag_t io_failed = FALSE;	/* network -> game: poll failed */
+#endif
+
+/* hostname lookups */
+struct dns_entry *dns_cache[DNS_CACHE_BUCKETS];	/* game side only */
+#ifdef CIRCLE_DNS_THREADS
+pthread_mutex_t dns_lock = PTHREAD_MUTEX_INITIALIZER;	/* guards the next 3 */
+pthread_cond_t dns_wake = PTHREAD_COND_INITIALIZER;
+struct dns_job *dns_todo = NULL, *dns_todo_tail = NULL;	/* for the helpers */
+struct dns_job *dns_done = NULL;	/* answered, for the game */
+#endif
 
 /* functions in this file */
 RETSIGTYPE reread_wizlists(int sig);
@@ -118,6 +229,7 @@ RETSIGTYPE checkpointing(int sig);
 RETSIGTYPE hupsig(int sig);
 ssize_t perform_socket_read(socket_t desc, char *read_point,size_t space_left);
 ssize_t perform_socket_write(socket_t desc, const char *txt,size_t length);
+ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int iovcnt);
 void echo_off(struct descriptor_data *d);
 void echo_on(struct descriptor_data *d);
 void circle_sleep(struct timeval *timeout);
@@ -126,19 +238,77 @@ void init_game(ush_int port);
 void signal_setup(void);
 void game_loop(socket_t mother_desc);
 socket_t init_socket(ush_int port);
-int new_descriptor(socket_t s);
+int new_descriptor(struct io_link *link);
+void init_poller(socket_t mother_desc);
+void close_poller(void);
+int poller_add(struct io_link *l);
+void poller_remove(struct io_link *l);
+void poller_mother(socket_t mother_desc, int watch);
+int io_poll(socket_t mother_desc, struct timeval *timeout);
+void io_sweep(socket_t mother_desc);
+void link_accept(socket_t mother_desc);
+void link_lost(struct io_link *l);
+void link_close(struct io_link *l);
+int link_flush(struct io_link *l);
+int link_read(struct io_link *l);
+int link_frame(struct io_link *l);
+size_t link_telnet(struct io_link *l, char *buf, size_t len);
+const char *link_scan(const char *p, const char *end, int a, int b);
+void drain_pipe(int fd);
+struct io_link *link_accepted(void);
+int link_get_line(struct io_link *l, char *dest);
+ssize_t link_writev(struct io_link *l, const struct iovec *iov, int iovcnt);
+ssize_t link_write(struct io_link *l, const char *txt, size_t length);
+int link_writable(struct io_link *l);
+size_t link_space(struct io_link *l);
+void link_release(struct io_link *l);
+int io_service(socket_t mother_desc);
+void io_wake(void);
+int io_sleep(socket_t mother_desc);
+void start_io_thread(socket_t *mother_desc);
+void stop_io_thread(socket_t mother_desc);
+#ifdef CIRCLE_IO_THREAD
+void *io_thread_loop(void *arg);
+#endif
+void start_dns_threads(void);
+void dns_lookup(struct descriptor_data *d, struct in_addr addr);
+void dns_collect(void);
+struct dns_entry *dns_cache_find(struct in_addr addr);
+void dns_resolve(struct in_addr addr, char *name);
+#ifdef CIRCLE_DNS_THREADS
+void *dns_thread_loop(void *arg);
+#endif
 int get_max_players(void);
 int process_output(struct descriptor_data *t);
 int process_input(struct descriptor_data *t);
 void timediff(struct timeval *diff, struct timeval *a, struct timeval *b);
 void timeadd(struct timeval *sum, struct timeval *a, struct timeval *b);
 void flush_queues(struct descriptor_data *d);
+struct out_chunk *new_chunk(struct out_chunk **head, struct out_chunk **tail);
+void free_chunk(struct out_chunk **head, struct out_chunk **tail);
+ssize_t desc_writev(struct descriptor_data *t, const struct iovec *iov, int iovcnt);
+#ifdef CIRCLE_MCCP
+voidpf mccp_alloc(voidpf opaque, uInt items, uInt size);
+void mccp_free(voidpf opaque, voidpf address);
+void mccp_check(struct descriptor_data *t);
+void mccp_start(struct descriptor_data *t);
+void mccp_end(struct descriptor_data *t);
+ssize_t mccp_writev(struct descriptor_data *t, const struct iovec *iov, int iovcnt);
+int mccp_drain(struct descriptor_data *t);
+void mccp_release(struct descriptor_data *t);
+#endif
+void queue_output(struct descriptor_data *t, const char *txt, size_t len);
 void nonblock(socket_t s);
 int perform_subst(struct descriptor_data *t, char *orig, char *subst);
 void record_usage(void);
 char *make_prompt(struct descriptor_data *point);
 void check_idle_passwords(void);
-void heartbeat(int pulse);
+void heartbeat(void);
+EVENTFUNC(periodic_event);
+void start_periodic_jobs(void);
+void mud_hour_update(void);
+void autosave_update(void);
+void timesave_update(void);
 struct in_addr *get_bind_addr(void);
 int parse_ip(const char *addr, struct in_addr *inaddr);
 int set_sendbuf(socket_t s);
@@ -152,7 +322,6 @@ sigfunc *my_signal(int signo, sigfunc *func);
 void reboot_wizlists(void);
 void boot_world(void);
 void affect_update(void);	/* In magic.c */
-void mobile_activity(void);
 void perform_violence(void);
 void show_string(struct descriptor_data *d, char *input);
 int isbanned(char *hostname);
@@ -257,6 +426,10 @@ int main(int argc, char **argv)
       scheck = 1;
       puts("Syntax check mode enabled.");
       break;
+    case 'w':
+      write_image = 1;
+      puts("Writing the world image.");
+      break;
     case 'q':
       no_rent_check = 1;
       puts("Quick boot mode -- rent check supressed.");
@@ -271,7 +444,7 @@ int main(int argc, char **argv)
       break;
     case 'h':
       /* From: Anil Mahajan <amahajan@proxicom.com> */
-      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-d pathname] [port #]\n"
+      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-w] [-d pathname] [port #]\n"
               "  -c             Enable syntax check mode.\n"
               "  -d <directory> Specify library directory (defaults to 'lib').\n"
               "  -h             Print this command line argument help.\n"
@@ -279,7 +452,8 @@ int main(int argc, char **argv)
 	      "  -o <file>      Write log to <file> instead of stderr.\n"
               "  -q             Quick boot (doesn't scan rent for object limits)\n"
               "  -r             Restrict MUD -- no new players allowed.\n"
-              "  -s             Suppress special procedure assignments.\n",
+              "  -s             Suppress special procedure assignments.\n"
+              "  -w             Write the world image and exit.\n",
 		 argv[0]
       );
       exit(0);
@@ -292,7 +466,7 @@ int main(int argc, char **argv)
 
   if (pos < argc) {
     if (!isdigit(*argv[pos])) {
-      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-d pathname] [port #]\n", argv[0]);
+      printf("Usage: %s [-c] [-m] [-q] [-r] [-s] [-w] [-d pathname] [port #]\n", argv[0]);
       exit(1);
     } else if ((port = atoi(argv[pos])) <= 1024) {
       printf("SYSERR: Illegal port number %d.\n", port);
@@ -315,17 +489,20 @@ int main(int argc, char **argv)
   }
   log("Using %s as data directory.", dir);
 
-  if (scheck)
+  if (scheck || write_image) {
     boot_world();
-  else {
+    if (write_image && world_image_write(WORLD_IMAGE_FILE) < 0)
+      exit(1);
+  } else {
     log("Running game on port %d.", port);
     init_game(port);
   }
 
   log("Clearing game world.");
   destroy_db();
+  event_free_all();
 
-  if (!scheck) {
+  if (!scheck && !write_image) {
     log("Clearing other memory.");
     free_player_index();	/* db.c */
     free_messages();		/* fight.c */
@@ -333,7 +510,9 @@ int main(int argc, char **argv)
     free_text_files();		/* db.c */
     Board_clear_all();		/* boards.c */
     free(cmd_sort_info);	/* act.informative.c */
+    cmdtrie_free();		/* cmdtrie.c */
     free_social_messages();	/* act.social.c */
+    perf_free();		/* perf.c */
     free_help();		/* db.c */
     Free_Invalid_List();	/* ban.c */
   }
@@ -359,6 +538,7 @@ void init_game(ush_int port)
 
   log("Opening mother connection.");
   mother_desc = init_socket(port);
+  init_poller(mother_desc);
 
   boot_db();
 
@@ -370,17 +550,28 @@ void init_game(ush_int port)
   /* If we made it this far, we will be able to restart without problem. */
   remove(KILLSCRIPT_FILE);
 
+  start_io_thread(&mother_desc);
+  start_dns_threads();
+  start_save_thread();
+  start_periodic_jobs();
+  perf_init();
+
   log("Entering game loop.");
 
   game_loop(mother_desc);
 
   Crash_save_all();
+  journal_compact();
 
   log("Closing all sockets.");
   while (descriptor_list)
     close_socket(descriptor_list);
 
+  stop_io_thread(mother_desc);
+  close_poller();
   CLOSE_SOCKET(mother_desc);
+  saver_wait(NULL);		/* everything's on disk before it's indexed */
+  save_player_index();
   fclose(player_fl);
 
   log("Saving current MUD time.");
@@ -564,6 +755,11 @@ int get_max_players(void)
   max_descs = max_playing + NUM_RESERVED_DESCS;
 #endif
 
+#ifndef CIRCLE_EPOLL
+  /* select() can't watch descriptors numbered FD_SETSIZE or higher. */
+  max_descs = MIN(max_descs, FD_SETSIZE);
+#endif
+
   /* now calculate max _players_ based on max descs */
   max_descs = MIN(max_playing, max_descs - NUM_RESERVED_DESCS);
 
@@ -583,24 +779,24 @@ int get_max_players(void)
  * game_loop contains the main loop which drives the entire MUD.  It
  * cycles once every 0.10 seconds and is responsible for accepting new
  * new connections, polling existing connections for input, dequeueing
- * output and sending it out to players, and calling "heartbeat" functions
- * such as mobile_activity().
+ * output and sending it out to players, and calling "heartbeat" to run
+ * whatever events are due, such as mobile_activity().
  */
 void game_loop(socket_t mother_desc)
 {
-  fd_set input_set, output_set, exc_set, null_set;
   struct timeval last_time, opt_time, process_time, temp_time;
   struct timeval before_sleep, now, timeout;
   char comm[MAX_INPUT_LENGTH];
   struct descriptor_data *d, *next_d;
-  int pulse = 0, missed_pulses, maxdesc, aliased;
+  struct io_link *link;
+  int missed_pulses, aliased;
+  unsigned long pass_start, perf_t;
 
   /* initialize various time values */
   null_time.tv_sec = 0;
   null_time.tv_usec = 0;
   opt_time.tv_usec = OPT_USEC;
   opt_time.tv_sec = 0;
-  FD_ZERO(&null_set);
 
   gettimeofday(&last_time, (struct timezone *) 0);
 
@@ -610,9 +806,7 @@ void game_loop(socket_t mother_desc)
     /* Sleep if we don't have any connections */
     if (descriptor_list == NULL) {
       log("No connections.  Going to sleep.");
-      FD_ZERO(&input_set);
-      FD_SET(mother_desc, &input_set);
-      if (select(mother_desc + 1, &input_set, (fd_set *) 0, (fd_set *) 0, NULL) < 0) {
+      if (io_sleep(mother_desc) < 0) {
 	if (errno == EINTR)
 	  log("Waking up to process signal.");
 	else
@@ -621,22 +815,6 @@ void game_loop(socket_t mother_desc)
 	log("New connection.  Waking up.");
       gettimeofday(&last_time, (struct timezone *) 0);
     }
-    /* Set up the input, output, and exception sets for select(). */
-    FD_ZERO(&input_set);
-    FD_ZERO(&output_set);
-    FD_ZERO(&exc_set);
-    FD_SET(mother_desc, &input_set);
-
-    maxdesc = mother_desc;
-    for (d = descriptor_list; d; d = d->next) {
-#ifndef CIRCLE_WINDOWS
-      if (d->descriptor > maxdesc)
-	maxdesc = d->descriptor;
-#endif
-      FD_SET(d->descriptor, &input_set);
-      FD_SET(d->descriptor, &output_set);
-      FD_SET(d->descriptor, &exc_set);
-    }
 
     /*
      * At this point, we have completed all input, output and heartbeat
@@ -676,32 +854,32 @@ void game_loop(socket_t mother_desc)
       timediff(&timeout, &last_time, &now);
     } while (timeout.tv_usec || timeout.tv_sec);
 
+    /* Time each phase of the pass, for 'perf'. */
+    pass_start = perf_t = PERF_START();
+
     /* Poll (without blocking) for new input, output, and exceptions */
-    if (select(maxdesc + 1, &input_set, &output_set, &exc_set, &null_time) < 0) {
-      perror("SYSERR: Select poll");
+    if (io_service(mother_desc) < 0)
       return;
-    }
+    perf_t = perf_mark(PERF_NETWORK, perf_t);
+
     /* If there are new connections waiting, accept them. */
-    if (FD_ISSET(mother_desc, &input_set))
-      new_descriptor(mother_desc);
+    while ((link = link_accepted()) != NULL)
+      new_descriptor(link);
 
-    /* Kick out the freaky folks in the exception set and marked for close */
-    for (d = descriptor_list; d; d = next_d) {
-      next_d = d->next;
-      if (FD_ISSET(d->descriptor, &exc_set)) {
-	FD_CLR(d->descriptor, &input_set);
-	FD_CLR(d->descriptor, &output_set);
-	close_socket(d);
-      }
-    }
+    /* Hostnames that have been looked up since last time. */
+    dns_collect();
 
-    /* Process descriptors with input pending */
+    /* Saves the writer thread couldn't make, to be logged. */
+    saver_collect();
+    perf_t = perf_mark(PERF_ACCEPT, perf_t);
+
+    /* Collect the lines framed for each descriptor; drop the dead ones. */
     for (d = descriptor_list; d; d = next_d) {
       next_d = d->next;
-      if (FD_ISSET(d->descriptor, &input_set))
-	if (process_input(d) < 0)
-	  close_socket(d);
+      if (process_input(d) < 0)
+	close_socket(d);
     }
+    perf_t = perf_mark(PERF_INPUT, perf_t);
 
     /* Process commands we just read from process_input */
     for (d = descriptor_list; d; d = next_d) {
@@ -751,26 +929,46 @@ void game_loop(socket_t mother_desc)
 	command_interpreter(d->character, comm); /* Send it to interpreter */
       }
     }
+    perf_t = perf_mark(PERF_COMMANDS, perf_t);
 
     /* Send queued output out to the operating system (ultimately to user). */
     for (d = descriptor_list; d; d = next_d) {
       next_d = d->next;
-      if (*(d->output) && FD_ISSET(d->descriptor, &output_set)) {
+#ifdef CIRCLE_MCCP
+      /* Compressed output left over from last time goes ahead of anything new. */
+      if (d->mccp && mccp_drain(d) < 0) {
+	close_socket(d);
+	continue;
+      }
+#endif
+      if (d->bufptr && link_writable(d->link)) {
 	/* Output for this player is ready. */
 
-        process_output(d);
+        if (process_output(d) < 0)
+          continue;		/* Descriptor was closed. */
         if (d->bufptr == 0)	/* All output sent. */
           d->has_prompt = TRUE;
       }
     }
+    perf_t = perf_mark(PERF_OUTPUT, perf_t);
 
-    /* Print prompts for other descriptors who had no other output */
+    /*
+     * Print prompts for other descriptors who had no other output.  One
+     * that can't go out whole now (the link is backed up, or the
+     * compressor is) is tried again next pass.
+     */
     for (d = descriptor_list; d; d = d->next) {
       if (!d->has_prompt && d->bufptr == 0) {
-	write_to_descriptor(d->descriptor, make_prompt(d));
-	d->has_prompt = TRUE;
+	struct iovec iov;
+
+	iov.iov_base = make_prompt(d);
+	iov.iov_len = strlen((char *) iov.iov_base);
+	if (link_space(d->link) >= iov.iov_len &&
+	    desc_writev(d, &iov, 1) == (ssize_t) iov.iov_len)
+	  d->has_prompt = TRUE;
       }
     }
+    perf_t = perf_mark(PERF_PROMPTS, perf_t);
 
     /* Kick out folks in the CON_CLOSE or CON_DISCONNECT state */
     for (d = descriptor_list; d; d = next_d) {
@@ -779,6 +977,10 @@ void game_loop(socket_t mother_desc)
 	close_socket(d);
     }
 
+    /* Everything for this pulse is queued; let the network side at it. */
+    io_wake();
+    perf_mark(PERF_CLOSE, perf_t);
+
     /*
      * Now, we execute as many pulses as necessary--just one if we haven't
      * missed any pulses, or make up for lost time if we missed a few
@@ -799,7 +1001,7 @@ void game_loop(socket_t mother_desc)
 
     /* Now execute the heartbeat functions */
     while (missed_pulses--)
-      heartbeat(++pulse);
+      heartbeat();
 
     /* Check for any signals we may have received. */
     if (reread_wizlist) {
@@ -815,9 +1017,7 @@ void game_loop(socket_t mother_desc)
       num_invalid = 0;
     }
 
-    /* Roll pulse over after 10 hours */
-    if (pulse >= (10 * 60 * 60 * PASSES_PER_SEC))
-      pulse = 0;
+    perf_mark(PERF_PULSE, pass_start);
 
 #ifdef CIRCLE_UNIX
     /* Update tics for deadlock protection (UNIX only) */
@@ -827,45 +1027,95 @@ void game_loop(socket_t mother_desc)
 }
 
 
-void heartbeat(int pulse)
+/*
+ * The jobs that run every so many pulses.  Each is a repeating event; the
+ * stagger starts each that many pulses early, so that with the stock
+ * pulse lengths no two of them ever run on the same pulse.
+ */
+struct periodic_job {
+  void (*func)(void);
+  int period;			/* in pulses */
+  int stagger;
+  int perf_phase;		/* what 'perf' counts it under */
+} periodic_jobs[] = {
+  { perform_violence,		PULSE_VIOLENCE,	1,	PERF_VIOLENCE },
+  { check_idle_passwords,	PULSE_IDLEPWD,	7,	PERF_IDLEPWD },
+  { mud_hour_update,		SECS_PER_MUD_HOUR * PASSES_PER_SEC, 13, PERF_MUDHOUR },
+  { autosave_update,		PULSE_AUTOSAVE,	16,	PERF_AUTOSAVE },
+  { record_usage,		PULSE_USAGE,	25,	PERF_USAGE },
+  { timesave_update,		PULSE_TIMESAVE,	28,	PERF_TIMESAVE },
+  { NULL, 0, 0, 0 }
+};
+
+
+EVENTFUNC(periodic_event)
 {
-  static int mins_since_crashsave = 0;
+  struct periodic_job *job = (struct periodic_job *) event_obj;
+  unsigned long start = PERF_START();
 
-  if (!(pulse % PULSE_ZONE))
-    zone_update();
+  (job->func)();
+  perf_mark(job->perf_phase, start);
+  return (job->period);
+}
 
-  if (!(pulse % PULSE_IDLEPWD))		/* 15 seconds */
-    check_idle_passwords();
 
-  if (!(pulse % PULSE_MOBILE))
-    mobile_activity();
+void start_periodic_jobs(void)
+{
+  struct periodic_job *job;
 
-  if (!(pulse % PULSE_VIOLENCE))
-    perform_violence();
+  for (job = periodic_jobs; job->func; job++)
+    event_create(periodic_event, job, job->period - job->stagger);
+}
 
-  if (!(pulse % (SECS_PER_MUD_HOUR * PASSES_PER_SEC))) {
-    weather_and_time(1);
-    affect_update();
-    point_update();
-    fflush(player_fl);
-  }
 
-  if (auto_save && !(pulse % PULSE_AUTOSAVE)) {	/* 1 minute */
-    if (++mins_since_crashsave >= autosave_time) {
-      mins_since_crashsave = 0;
-      Crash_save_all();
-      House_save_all();
-    }
+void mud_hour_update(void)
+{
+  weather_and_time(1);
+  affect_update();
+  point_update();
+  fflush(player_fl);
+}
+
+
+void autosave_update(void)
+{
+  static int mins_since_crashsave = 0;
+
+  if (auto_save && ++mins_since_crashsave >= autosave_time) {
+    mins_since_crashsave = 0;
+    Crash_save_all();
+    House_save_all();
+    journal_compact();
   }
+}
+
+
+void timesave_update(void)
+{
+  save_mud_time(&time_info);
+}
+
+
+void heartbeat(void)
+{
+  unsigned long start, perf_t;
+
+  start = PERF_START();
+  event_process();
+  perf_t = perf_mark(PERF_EVENTS, start);
 
-  if (!(pulse % PULSE_USAGE))
-    record_usage();
+  /* Zone resets are spread over as many pulses as they take. */
+  zone_update();
+  perf_t = perf_mark(PERF_ZONES, perf_t);
 
-  if (!(pulse % PULSE_TIMESAVE))
-    save_mud_time(&time_info);
+  /* Players are compared for the journal a slice at a time, too. */
+  journal_update();
+  perf_t = perf_mark(PERF_JOURNAL, perf_t);
 
   /* Every pulse! Don't want them to stink the place up... */
   extract_pending_chars();
+  perf_mark(PERF_EXTRACT, perf_t);
+  perf_mark(PERF_HEARTBEAT, start);
 }
 
 
@@ -1043,8 +1293,11 @@ void write_to_q(const char *txt, struct txt_q *queue, int aliased)
 {
   struct txt_block *newt;
 
-  CREATE(newt, struct txt_block, 1);
-  newt->text = strdup(txt);
+  if ((newt = txt_pool) != NULL)
+    txt_pool = newt->next;
+  else
+    CREATE(newt, struct txt_block, 1);
+  strcpy(newt->text, txt);	/* strcpy: OK (mutual MAX_INPUT_LENGTH) */
   newt->aliased = aliased;
 
   /* queue empty? */
@@ -1075,8 +1328,8 @@ int get_from_q(struct txt_q *queue, char *dest, int *aliased)
 
   tmp = queue->head;
   queue->head = queue->head->next;
-  free(tmp->text);
-  free(tmp);
+  tmp->next = txt_pool;
+  txt_pool = tmp;
 
   return (1);
 }
@@ -1085,15 +1338,18 @@ int get_from_q(struct txt_q *queue, char *dest, int *aliased)
 /* Empty the queues before closing connection */
 void flush_queues(struct descriptor_data *d)
 {
-  if (d->large_outbuf) {
-    d->large_outbuf->next = bufpool;
-    bufpool = d->large_outbuf;
-  }
+  while (d->output)
+    free_chunk(&d->output, &d->output_tail);
+  d->bufptr = 0;
+#ifdef CIRCLE_MCCP
+  if (d->mccp)
+    mccp_release(d);
+#endif
   while (d->input.head) {
     struct txt_block *tmp = d->input.head;
     d->input.head = d->input.head->next;
-    free(tmp->text);
-    free(tmp);
+    tmp->next = txt_pool;
+    txt_pool = tmp;
   }
 }
 
@@ -1112,69 +1368,144 @@ size_t write_to_output(struct descriptor_data *t, const char *txt, ...)
 }
 
 
-/* Add a new string to a player's output queue. */
+/* Take a chunk from the pool and hang it on the end of a chunk queue. */
+struct out_chunk *new_chunk(struct out_chunk **head, struct out_chunk **tail)
+{
+  struct out_chunk *c;
+
+  if (bufpool != NULL) {
+    c = bufpool;
+    bufpool = c->next;
+    buf_poolcount--;
+  } else {
+    CREATE(c, struct out_chunk, 1);
+    buf_largecount++;
+  }
+  buf_switches++;
+
+  c->head = c->tail = 0;
+  c->next = NULL;
+  if (*tail)
+    (*tail)->next = c;
+  else
+    *head = c;
+  *tail = c;
+
+  return (c);
+}
+
+
+/* Return the first chunk of a chunk queue to the pool. */
+void free_chunk(struct out_chunk **head, struct out_chunk **tail)
+{
+  struct out_chunk *c = *head;
+
+  if (!(*head = c->next))
+    *tail = NULL;
+
+  c->next = bufpool;
+  bufpool = c;
+  buf_poolcount++;
+}
+
+
+/* Append raw bytes to the output queue, adding chunks as they fill. */
+void queue_output(struct descriptor_data *t, const char *txt, size_t len)
+{
+  struct out_chunk *c = t->output_tail;
+  size_t n;
+
+  /* The usual case: it fits in the chunk we were writing into. */
+  if (c && len <= OUTBUF_CHUNK_SIZE - c->tail) {
+    memcpy(c->text + c->tail, txt, len);
+    c->tail += len;
+    t->bufptr += len;
+    return;
+  }
+
+  while (len > 0) {
+    if (!c || c->tail == OUTBUF_CHUNK_SIZE)
+      c = new_chunk(&t->output, &t->output_tail);
+    n = MIN(len, OUTBUF_CHUNK_SIZE - c->tail);
+    memcpy(c->text + c->tail, txt, n);
+    c->tail += n;
+    t->bufptr += n;
+    txt += n;
+    len -= n;
+  }
+}
+
+
+/*
+ * Add a new string to a player's output queue.
+ *
+ * When the last chunk has room for a line or two, the text is formatted
+ * straight into it.  Otherwise, or when it turns out not to fit, it is
+ * formatted into a scratch buffer (grown if need be, so nothing is cut
+ * off at MAX_STRING_LENGTH) and spread over as many chunks as it needs.
+ * Output beyond MAX_OUTBUF_SIZE is dropped, and so is everything after
+ * it until the queue has drained.
+ */
 size_t vwrite_to_output(struct descriptor_data *t, const char *format, va_list args)
 {
-  static char txt[MAX_STRING_LENGTH];
-  size_t wantsize;
+  static char *txt = NULL;
+  static size_t txt_size = 0;
+  struct out_chunk *c;
+  va_list again;
+  size_t space = 0, keep;
   int size;
 
   /* if we're in the overflow state already, ignore this new output */
-  if (t->bufspace == 0)
+  if (t->overflow)
     return (0);
 
-  wantsize = size = vsnprintf(txt, sizeof(txt), format, args);
-  /* If exceeding the size of the buffer, truncate it for the overflow message */
-  if (size < 0 || wantsize >= sizeof(txt)) {
-    size = sizeof(txt) - 1;
-    strcpy(txt + size - strlen(text_overflow), text_overflow);	/* strcpy: OK */
-  }
-
-  /*
-   * If the text is too big to fit into even a large buffer, truncate
-   * the new text to make it fit.  (This will switch to the overflow
-   * state automatically because t->bufspace will end up 0.)
-   */
-  if (size + t->bufptr + 1 > LARGE_BUFSIZE) {
-    size = LARGE_BUFSIZE - t->bufptr - 1;
-    txt[size] = '\0';
-    buf_overflows++;
+  if (!txt) {
+    txt_size = MAX_STRING_LENGTH;
+    CREATE(txt, char, txt_size);
   }
 
-  /*
-   * If we have enough space, just write to buffer and that's it! If the
-   * text just barely fits, then it's switched to a large buffer instead.
-   */
-  if (t->bufspace > size) {
-    strcpy(t->output + t->bufptr, txt);	/* strcpy: OK (size checked above) */
-    t->bufspace -= size;
-    t->bufptr += size;
-    return (t->bufspace);
-  }
+  if (!(c = t->output_tail))
+    c = new_chunk(&t->output, &t->output_tail);
+  if (OUTBUF_CHUNK_SIZE - c->tail >= OUTBUF_DIRECT_MIN)
+    space = OUTBUF_CHUNK_SIZE - c->tail;
 
-  buf_switches++;
+  va_copy(again, args);
+  if (space)
+    size = vsnprintf(c->text + c->tail, space, format, args);
+  else
+    size = vsnprintf(txt, txt_size, format, args);
 
-  /* if the pool has a buffer in it, grab it */
-  if (bufpool != NULL) {
-    t->large_outbuf = bufpool;
-    bufpool = bufpool->next;
-  } else {			/* else create a new one */
-    CREATE(t->large_outbuf, struct txt_block, 1);
-    CREATE(t->large_outbuf->text, char, LARGE_BUFSIZE);
-    buf_largecount++;
+  /* Didn't fit where it went; (re)format it into a big enough 'txt'. */
+  if (size >= 0 && (size_t) size >= (space ? space : txt_size)) {
+    if ((size_t) size >= txt_size) {
+      txt_size = size + 1;
+      RECREATE(txt, char, txt_size);
+    }
+    vsnprintf(txt, txt_size, format, again);
+    space = 0;
   }
+  va_end(again);
 
-  strcpy(t->large_outbuf->text, t->output);	/* strcpy: OK (size checked previously) */
-  t->output = t->large_outbuf->text;	/* make big buffer primary */
-  strcat(t->output, txt);	/* strcat: OK (size checked) */
+  if (size < 0) {
+    log("SYSERR: vwrite_to_output: bad format string '%s'", format);
+    return (MAX_OUTBUF_SIZE - t->bufptr);
+  }
 
-  /* set the pointer for the next write */
-  t->bufptr = strlen(t->output);
+  /* Anything past the cap is lost; note it for the '**OVERFLOW**' notice. */
+  keep = size;
+  if (t->bufptr + keep > MAX_OUTBUF_SIZE) {
+    keep = MAX_OUTBUF_SIZE - t->bufptr;
+    t->overflow = TRUE;
+    buf_overflows++;
+  }
 
-  /* calculate how much space is left in the buffer */
-  t->bufspace = LARGE_BUFSIZE - 1 - t->bufptr;
+  if (space) {		/* already in place */
+    c->tail += keep;
+    t->bufptr += keep;
+  } else
+    queue_output(t, txt, keep);
 
-  return (t->bufspace);
+  return (MAX_OUTBUF_SIZE - t->bufptr);
 }
 
 
@@ -1282,206 +1613,1441 @@ int set_sendbuf(socket_t s)
   return (0);
 }
 
-int new_descriptor(socket_t s)
-{
-  socket_t desc;
-  int sockets_connected = 0;
-  socklen_t i;
-  static int last_desc = 0;	/* last descriptor number */
-  struct descriptor_data *newd;
-  struct sockaddr_in peer;
-  struct hostent *from;
 
-  /* accept the new connection */
-  i = sizeof(peer);
-  if ((desc = accept(s, (struct sockaddr *) &peer, &i)) == INVALID_SOCKET) {
-    perror("SYSERR: accept");
-    return (-1);
-  }
-  /* keep it from blocking */
-  nonblock(desc);
+/*
+ * Each descriptor's socket lives in an io_link, which belongs to the
+ * network side of the server: it accepts connections, reads and frames
+ * input into lines, and writes output to the kernel.  The game side only
+ * ever touches a link through the calls below, which pass lines and
+ * output bytes through single-producer/single-consumer rings:
+ *
+ *   line ring:   network side -> game side, one complete line per slot
+ *   output ring: game side -> network side, raw bytes
+ *   accept queue: network side -> game side, freshly accepted links
+ *
+ * With CIRCLE_IO_THREAD the network side is a thread of its own and the
+ * game thread never makes a socket call; otherwise game_loop() runs the
+ * very same code inline once per pulse.  Either way a link is freed only
+ * by the network side, after the game side has let go of it with
+ * link_release().
+ */
 
-  /* set the send buffer size */
-  if (set_sendbuf(desc) < 0) {
-    CLOSE_SOCKET(desc);
-    return (0);
+/*
+ * The poller keeps track of which sockets are ready for I/O.  With epoll
+ * every socket is registered once (edge-triggered) and the kernel hands
+ * back only the ones that changed state; otherwise we fall back to building
+ * select() sets over the whole link list on every call.
+ */
+void init_poller(socket_t mother_desc)
+{
+#ifdef CIRCLE_IO_THREAD
+  if (pipe(io_wake_pipe) < 0 || pipe(game_wake_pipe) < 0) {
+    perror("SYSERR: pipe");
+    exit(1);
   }
+  nonblock(io_wake_pipe[0]);
+  nonblock(io_wake_pipe[1]);
+  nonblock(game_wake_pipe[0]);
+  nonblock(game_wake_pipe[1]);
+#endif
 
-  /* make sure we have room for it */
-  for (newd = descriptor_list; newd; newd = newd->next)
-    sockets_connected++;
+#ifdef CIRCLE_EPOLL
+  {
+    struct epoll_event ev;
 
-  if (sockets_connected >= max_players) {
-    write_to_descriptor(desc, "Sorry, CircleMUD is full right now... please try again later!\r\n");
-    CLOSE_SOCKET(desc);
-    return (0);
+    if ((epoll_fd = epoll_create1(0)) < 0) {
+      perror("SYSERR: epoll_create1");
+      exit(1);
+    }
+    CREATE(epoll_events, struct epoll_event, max_players + 2);
+
+    /* The mother stays level-triggered: one accept per event, as always. */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, mother_desc, &ev) < 0) {
+      perror("SYSERR: epoll_ctl (mother)");
+      exit(1);
+    }
+#ifdef CIRCLE_IO_THREAD
+    ev.data.ptr = (void *) io_wake_pipe;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, io_wake_pipe[0], &ev) < 0) {
+      perror("SYSERR: epoll_ctl (wake pipe)");
+      exit(1);
+    }
+#endif
   }
-  /* create a new descriptor */
-  CREATE(newd, struct descriptor_data, 1);
+#else
+  (void)mother_desc;
+#endif
+}
 
-  /* find the sitename */
-  if (nameserver_is_slow || !(from = gethostbyaddr((char *) &peer.sin_addr,
-				      sizeof(peer.sin_addr), AF_INET))) {
 
-    /* resolution failed */
-    if (!nameserver_is_slow)
-      perror("SYSERR: gethostbyaddr");
+void close_poller(void)
+{
+#ifdef CIRCLE_EPOLL
+  close(epoll_fd);
+  epoll_fd = -1;
+  free(epoll_events);
+  epoll_events = NULL;
+#endif
+#ifdef CIRCLE_IO_THREAD
+  close(io_wake_pipe[0]);
+  close(io_wake_pipe[1]);
+  close(game_wake_pipe[0]);
+  close(game_wake_pipe[1]);
+#endif
+}
 
-    /* find the numeric site address */
-    strncpy(newd->host, (char *)inet_ntoa(peer.sin_addr), HOST_LENGTH);	/* strncpy: OK (n->host:HOST_LENGTH+1) */
-    *(newd->host + HOST_LENGTH) = '\0';
-  } else {
-    strncpy(newd->host, from->h_name, HOST_LENGTH);	/* strncpy: OK (n->host:HOST_LENGTH+1) */
-    *(newd->host + HOST_LENGTH) = '\0';
-  }
 
-  /* determine if the site is banned */
-  if (isbanned(newd->host) == BAN_ALL) {
-    CLOSE_SOCKET(desc);
-    mudlog(CMP, LVL_GOD, TRUE, "Connection attempt denied from [%s]", newd->host);
-    free(newd);
-    return (0);
+/* Start watching a new link.  Returns -1 if the kernel refused. */
+int poller_add(struct io_link *l)
+{
+#ifdef CIRCLE_EPOLL
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+  ev.data.ptr = l;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, l->descriptor, &ev) < 0) {
+    perror("SYSERR: epoll_ctl (add)");
+    return (-1);
   }
-#if 0
-  /*
-   * Log new connections - probably unnecessary, but you may want it.
-   * Note that your immortals may wonder if they see a connection from
-   * your site, but you are wizinvis upon login.
-   */
-  mudlog(CMP, LVL_GOD, FALSE, "New connection from [%s]", newd->host);
 #endif
 
-  /* initialize descriptor data */
-  newd->descriptor = desc;
-  newd->idle_tics = 0;
-  newd->output = newd->small_outbuf;
-  newd->bufspace = SMALL_BUFSIZE - 1;
-  newd->login_time = time(0);
-  *newd->output = '\0';
-  newd->bufptr = 0;
-  newd->has_prompt = 1;  /* prompt is part of greetings */
-  STATE(newd) = CON_GET_NAME;
-
-  /*
-   * This isn't exactly optimal but allows us to make a design choice.
-   * Do we embed the history in descriptor_data or keep it dynamically
-   * allocated and allow a user defined history size?
-   */
-  CREATE(newd->history, char *, HISTORY_SIZE);
-
-  if (++last_desc == 1000)
-    last_desc = 1;
-  newd->desc_num = last_desc;
+  /* A fresh socket has an empty send buffer. */
+  l->io_ready = IO_READY_WRITE;
+  return (0);
+}
 
-  /* prepend to list */
-  newd->next = descriptor_list;
-  descriptor_list = newd;
 
-  write_to_output(newd, "%s", GREETINGS);
+void poller_remove(struct io_link *l)
+{
+#ifdef CIRCLE_EPOLL
+  struct epoll_event ev;	/* Pre-2.6.9 kernels insist on a non-NULL event. */
 
-  return (0);
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, l->descriptor, &ev) < 0)
+    perror("SYSERR: epoll_ctl (del)");
+#else
+  (void)l;
+#endif
 }
 
 
 /*
- * Send all of the output that we've accumulated for a player out to
- * the player's descriptor.
- *
- * 32 byte GARBAGE_SPACE in MAX_SOCK_BUF used for:
- *	 2 bytes: prepended \r\n
- *	14 bytes: overflow message
- *	 2 bytes: extra \r\n for non-comapct
- *      14 bytes: unused
+ * Stop or resume watching the mother.  While the game side is behind on
+ * picking up new links, connections wait in the listen backlog.
  */
-int process_output(struct descriptor_data *t)
+void poller_mother(socket_t mother_desc, int watch)
 {
-  char i[MAX_SOCK_BUF], *osb = i + 2;
-  int result;
-
-  /* we may need this \r\n for later -- see below */
-  strcpy(i, "\r\n");	/* strcpy: OK (for 'MAX_SOCK_BUF >= 3') */
+#ifdef CIRCLE_EPOLL
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if (epoll_ctl(epoll_fd, watch ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, mother_desc, &ev) < 0)
+    perror("SYSERR: epoll_ctl (mother)");
+#else
+  (void)mother_desc;
+#endif
 
-  /* now, append the 'real' output */
-  strcpy(osb, t->output);	/* strcpy: OK (t->output:LARGE_BUFSIZE < osb:MAX_SOCK_BUF-2) */
+  accept_paused = !watch;
+}
 
-  /* if we're in the overflow state, notify the user */
-  if (t->bufspace == 0)
-    strcat(osb, "**OVERFLOW**\r\n");	/* strcpy: OK (osb:MAX_SOCK_BUF-2 reserves space) */
 
-  /* add the extra CRLF if the person isn't in compact mode */
-  if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) && !PRF_FLAGGED(t->character, PRF_COMPACT))
-    strcat(osb, "\r\n");	/* strcpy: OK (osb:MAX_SOCK_BUF-2 reserves space) */
+#ifdef CIRCLE_EPOLL
 
-  /* add a prompt */
-  strcat(i, make_prompt(t));	/* strcpy: OK (i:MAX_SOCK_BUF reserves space) */
+/*
+ * Wait up to 'timeout' (forever if NULL) for socket activity and deal
+ * with all of it: accept, read and frame input, flush pending output.
+ * Network side only.  Returns -1 if the wait itself failed.
+ */
+int io_poll(socket_t mother_desc, struct timeval *timeout)
+{
+  struct io_link *l;
+  int i, num_events, msec = -1, sweep = sweep_needed;
 
-  /*
-   * now, send the output.  If this is an 'interruption', use the prepended
-   * CRLF, otherwise send the straight output sans CRLF.
-   */
-  if (t->has_prompt) {
-    t->has_prompt = FALSE;
-    result = write_to_descriptor(t->descriptor, i);
-    if (result >= 2)
-      result -= 2;
-  } else
-    result = write_to_descriptor(t->descriptor, osb);
+  if (timeout)
+    msec = timeout->tv_sec * 1000 + timeout->tv_usec / 1000;
 
-  if (result < 0) {	/* Oops, fatal error. Bye! */
-    close_socket(t);
+  if ((num_events = epoll_wait(epoll_fd, epoll_events, max_players + 2, msec)) < 0)
     return (-1);
-  } else if (result == 0)	/* Socket buffer full. Try later. */
-    return (0);
-
-  /* Handle snooping: prepend "% " and send to snooper. */
-  if (t->snoop_by)
-    write_to_output(t->snoop_by, "%% %*s%%%%", result, t->output);
 
-  /* The common case: all saved output was handed off to the kernel buffer. */
-  if (result >= t->bufptr) {
-    /*
-     * if we were using a large buffer, put the large buffer on the buffer pool
-     * and switch back to the small one
-     */
-    if (t->large_outbuf) {
-      t->large_outbuf->next = bufpool;
-      bufpool = t->large_outbuf;
-      t->large_outbuf = NULL;
-      t->output = t->small_outbuf;
+  for (i = 0; i < num_events; i++) {
+    if ((l = (struct io_link *) epoll_events[i].data.ptr) == NULL) {
+      link_accept(mother_desc);
+      continue;
     }
-    /* reset total bufspace back to that of a small buffer */
-    t->bufspace = SMALL_BUFSIZE - 1;
-    t->bufptr = 0;
-    *(t->output) = '\0';
-
-    /*
-     * If the overflow message or prompt were partially written, try to save
-     * them. There will be enough space for them if this is true.  'result'
-     * is effectively unsigned here anyway.
-     */
-    if ((unsigned int)result < strlen(osb)) {
-      size_t savetextlen = strlen(osb + result);
-
-      strcat(t->output, osb + result);
-      t->bufptr   -= savetextlen;
-      t->bufspace += savetextlen;
+#ifdef CIRCLE_IO_THREAD
+    if (l == (struct io_link *) io_wake_pipe) {
+      drain_pipe(io_wake_pipe[0]);
+      sweep = TRUE;
+      continue;
     }
-
-  } else {
-    /* Not all data in buffer sent.  result < output buffersize. */
-
-    strcpy(t->output, t->output + result);	/* strcpy: OK (overlap) */
-    t->bufptr   -= result;
-    t->bufspace += result;
+#endif
+    if (epoll_events[i].events & EPOLLERR) {
+      link_lost(l);
+      continue;
+    }
+    if (epoll_events[i].events & EPOLLOUT)
+      l->io_ready |= IO_READY_WRITE;
+
+    /* A hangup reads as EOF, which link_read() already deals with. */
+    if ((epoll_events[i].events & (EPOLLIN | EPOLLHUP)) && link_read(l) < 0)
+      link_lost(l);
+    else if (link_flush(l) < 0)
+      link_lost(l);
   }
 
-  return (result);
+  if (sweep)
+    io_sweep(mother_desc);
+
+  return (num_events);
 }
 
+#else
 
-/*
- * perform_socket_write: takes a descriptor, a pointer to text, and a
- * text length, and tries once to send that text to the OS.  This is
+int io_poll(socket_t mother_desc, struct timeval *timeout)
+{
+  fd_set input_set, output_set, exc_set;
+  struct io_link *l, *next_l;
+  socket_t maxdesc;
+  int num_ready, sweep = sweep_needed;
+
+  /* Set up the input, output, and exception sets for select(). */
+  FD_ZERO(&input_set);
+  FD_ZERO(&output_set);
+  FD_ZERO(&exc_set);
+  if (!accept_paused)
+    FD_SET(mother_desc, &input_set);
+
+  maxdesc = mother_desc;
+#ifdef CIRCLE_IO_THREAD
+  FD_SET(io_wake_pipe[0], &input_set);
+  maxdesc = MAX(maxdesc, io_wake_pipe[0]);
+#endif
+  for (l = link_list; l; l = l->next) {
+    if (RING_GET(l->gone))
+      continue;
+#ifndef CIRCLE_WINDOWS
+    if (l->descriptor > maxdesc)
+      maxdesc = l->descriptor;
+#endif
+    FD_SET(l->descriptor, &input_set);
+    FD_SET(l->descriptor, &exc_set);
+    /* Only ask about room to write if the last write came up short. */
+    if (!(l->io_ready & IO_READY_WRITE))
+      FD_SET(l->descriptor, &output_set);
+  }
+
+  if ((num_ready = select(maxdesc + 1, &input_set, &output_set, &exc_set, timeout)) < 0)
+    return (-1);
+
+  for (l = link_list; l; l = next_l) {
+    next_l = l->next;
+    if (RING_GET(l->gone))
+      continue;
+
+    if (FD_ISSET(l->descriptor, &output_set))
+      l->io_ready |= IO_READY_WRITE;
+
+    if (FD_ISSET(l->descriptor, &exc_set))
+      link_lost(l);
+    else if (FD_ISSET(l->descriptor, &input_set) && link_read(l) < 0)
+      link_lost(l);
+    else if (link_flush(l) < 0)
+      link_lost(l);
+  }
+
+#ifdef CIRCLE_IO_THREAD
+  if (FD_ISSET(io_wake_pipe[0], &input_set)) {
+    drain_pipe(io_wake_pipe[0]);
+    sweep = TRUE;
+  }
+#endif
+
+  if (FD_ISSET(mother_desc, &input_set))
+    link_accept(mother_desc);
+
+  if (sweep)
+    io_sweep(mother_desc);
+
+  return (num_ready);
+}
+
+#endif /* CIRCLE_EPOLL */
+
+
+/*
+ * Visit every link: close the ones the game has released, resume reading
+ * on the ones whose line ring filled up, and push out any output the game
+ * queued since the last time.  Also start accepting again if we stopped.
+ * Network side only.
+ */
+void io_sweep(socket_t mother_desc)
+{
+  struct io_link *l, *next_l;
+
+  sweep_needed = FALSE;
+
+  if (accept_paused && RING_GET(accept_head) - RING_GET(accept_tail) < ACCEPT_QUEUE_SIZE)
+    poller_mother(mother_desc, TRUE);
+
+  for (l = link_list; l; l = next_l) {
+    next_l = l->next;
+
+    if (RING_GET(l->released))
+      link_close(l);
+    else if (RING_GET(l->gone))
+      continue;
+    else if (l->stalled && link_read(l) < 0)
+      link_lost(l);
+    else if (link_flush(l) < 0)
+      link_lost(l);
+  }
+}
+
+
+/* Accept a connection on the mother and queue it up for the game side. */
+void link_accept(socket_t mother_desc)
+{
+  socket_t desc;
+  socklen_t i;
+  struct io_link *l;
+  struct sockaddr_in peer;
+  size_t head = RING_GET(accept_head);
+
+  /* The game side hasn't caught up; leave the rest in the listen backlog. */
+  if (head - RING_GET(accept_tail) >= ACCEPT_QUEUE_SIZE) {
+    poller_mother(mother_desc, FALSE);
+    sweep_needed = TRUE;	/* so io_sweep() turns it back on */
+    return;
+  }
+
+  /* accept the new connection */
+  i = sizeof(peer);
+  if ((desc = accept(mother_desc, (struct sockaddr *) &peer, &i)) == INVALID_SOCKET) {
+    perror("SYSERR: accept");
+    return;
+  }
+  /* keep it from blocking */
+  nonblock(desc);
+
+  /* set the send buffer size */
+  if (set_sendbuf(desc) < 0) {
+    CLOSE_SOCKET(desc);
+    return;
+  }
+
+  /* make sure we have room for it */
+  if (num_links >= max_players) {
+    write_to_descriptor(desc, "Sorry, CircleMUD is full right now... please try again later!\r\n");
+    CLOSE_SOCKET(desc);
+    return;
+  }
+
+  CREATE(l, struct io_link, 1);
+  l->descriptor = desc;
+  l->peer = peer;
+  if (poller_add(l) < 0) {
+    CLOSE_SOCKET(desc);
+    free(l);
+    return;
+  }
+
+  l->prev = NULL;
+  l->next = link_list;
+  if (link_list)
+    link_list->prev = l;
+  link_list = l;
+  num_links++;
+
+  accept_queue[head & (ACCEPT_QUEUE_SIZE - 1)] = l;
+  RING_SET(accept_head, head + 1);
+
+#ifdef CIRCLE_IO_THREAD
+  /* In case the game thread is asleep for lack of players. */
+  if (write(game_wake_pipe[1], "", 1) < 0 && errno != EAGAIN)
+    perror("SYSERR: write (game wake pipe)");
+#endif
+}
+
+
+/*
+ * The socket is dead: stop watching it and tell the game side, which will
+ * close the descriptor and release the link.  Network side only.
+ */
+void link_lost(struct io_link *l)
+{
+  poller_remove(l);
+  RING_SET(l->gone, TRUE);
+}
+
+
+/* Close the socket and free a link the game side has released. */
+void link_close(struct io_link *l)
+{
+  /* Give any goodbye message one last chance to get out. */
+  if (!RING_GET(l->gone)) {
+    link_flush(l);
+    poller_remove(l);
+  }
+  CLOSE_SOCKET(l->descriptor);
+
+  if (l->prev)
+    l->prev->next = l->next;
+  else
+    link_list = l->next;
+  if (l->next)
+    l->next->prev = l->prev;
+  num_links--;
+
+  free(l);
+}
+
+
+/*
+ * Hand as much of the output ring to the kernel as it will take.  A short
+ * write means the send buffer is full; the poller says when it drains.
+ * Network side only.  Returns -1 if the socket has failed.
+ */
+int link_flush(struct io_link *l)
+{
+  size_t head = RING_GET(l->out_head), tail = RING_GET(l->out_tail), off, len;
+  struct iovec iov[2];
+  ssize_t result;
+
+  while (tail != head && (l->io_ready & IO_READY_WRITE)) {
+    /* At most two pieces: up to the end of the ring, then from the start. */
+    off = tail & (LINK_OUTBUF_SIZE - 1);
+    len = MIN(head - tail, LINK_OUTBUF_SIZE - off);
+    iov[0].iov_base = l->outbuf + off;
+    iov[0].iov_len = len;
+    iov[1].iov_base = l->outbuf;
+    iov[1].iov_len = head - tail - len;
+
+    if ((result = perform_socket_writev(l->descriptor, iov, iov[1].iov_len ? 2 : 1)) < 0) {
+      perror("SYSERR: Write to socket");
+      return (-1);
+    }
+    if ((size_t)result < head - tail)
+      l->io_ready &= ~IO_READY_WRITE;
+
+    tail += result;
+    RING_SET(l->out_tail, tail);
+  }
+
+  return (0);
+}
+
+
+/* Network side only: the game thread can't be woken like this. */
+void drain_pipe(int fd)
+{
+  char junk[64];
+
+  while (read(fd, junk, sizeof(junk)) > 0)
+    ;
+}
+
+
+/* ----- Called from the game side. ----- */
+
+/* Pick up the next link accepted by the network side, if any. */
+struct io_link *link_accepted(void)
+{
+  size_t tail = RING_GET(accept_tail);
+  struct io_link *l;
+
+  if (tail == RING_GET(accept_head))
+    return (NULL);
+
+  l = accept_queue[tail & (ACCEPT_QUEUE_SIZE - 1)];
+  RING_SET(accept_tail, tail + 1);
+  return (l);
+}
+
+
+/*
+ * Ever wonder why 'tmp' had '+8' on it?  The crusty old code could write
+ * MAX_INPUT_LENGTH+1 bytes to 'tmp' if there was a '$' as the final
+ * character in the input buffer.  This would also cause 'space_left' to
+ * drop to -1, which wasn't very happy in an unsigned variable.  Argh.
+ * So to fix the above, 'tmp' lost the '+8' since it doesn't need it
+ * and the code has been changed to reserve space by accepting one less
+ * character. (Do you really need 256 characters on a line?)
+ * -gg 1/21/2000
+ *
+ * The 'tmp' in question is now 'dest': the next complete line is copied
+ * out of the link's input ring, cleaned up on the way, and its space in
+ * the ring handed back to the network side.  Returns 0 if there is no
+ * line, 2 if it had to be truncated, 1 otherwise.
+ */
+int link_get_line(struct io_link *l, char *dest)
+{
+  size_t tail = RING_GET(l->line_tail), pos, space_left;
+  struct link_line *line;
+  char *write_point, ch;
+
+  if (tail == RING_GET(l->line_head))
+    return (0);
+
+  line = &l->lines[tail & (LINK_INPUT_LINES - 1)];
+  write_point = dest;
+  space_left = MAX_INPUT_LENGTH - 1;
+
+  /* The '> 1' reserves room for a '$ => $$' expansion. */
+  for (pos = RING_GET(l->in_tail); (space_left > 1) && (pos != line->end); pos++) {
+    ch = l->inbuf[pos & (LINK_INPUT_SIZE - 1)];
+    if (ch == '\b' || ch == 127) { /* handle backspacing or delete key */
+      if (write_point > dest) {
+	if (*(--write_point) == '$') {
+	  write_point--;
+	  space_left += 2;
+	} else
+	  space_left++;
+      }
+    } else if (isascii(ch) && isprint(ch)) {
+      if ((*(write_point++) = ch) == '$') {		/* copy one character */
+	*(write_point++) = '$';	/* if it's a $, double it */
+	space_left -= 2;
+      } else
+	space_left--;
+    }
+  }
+
+  *write_point = '\0';
+
+  RING_SET(l->in_tail, line->next);
+  RING_SET(l->line_tail, tail + 1);
+
+  return ((space_left <= 0) && (pos != line->end) ? 2 : 1);
+}
+
+
+/*
+ * Queue the pieces in 'iov' for the network side, in order.  Returns how
+ * many bytes were taken (possibly fewer than offered, or 0), or -1 if the
+ * connection is gone.
+ *
+ * Without a network thread, and with nothing already queued ahead of us,
+ * the pieces go to the kernel in a single gathered write straight from
+ * the caller's buffers; only what the kernel doesn't take is copied into
+ * the ring.
+ */
+ssize_t link_writev(struct io_link *l, const struct iovec *iov, int iovcnt)
+{
+  size_t head = RING_GET(l->out_head), total = 0, sent = 0, queued = 0;
+  size_t space, skip, len, off, chunk, done;
+  const char *txt;
+  int i;
+
+  if (RING_GET(l->gone))
+    return (-1);
+
+  for (i = 0; i < iovcnt; i++)
+    total += iov[i].iov_len;
+  if (total == 0)
+    return (0);
+
+#ifndef CIRCLE_IO_THREAD
+  if (head == RING_GET(l->out_tail) && (l->io_ready & IO_READY_WRITE)) {
+    ssize_t result;
+
+    if ((result = perform_socket_writev(l->descriptor, iov, iovcnt)) < 0) {
+      perror("SYSERR: Write to socket");
+      link_lost(l);
+      return (-1);
+    }
+    if ((sent = result) < total)
+      l->io_ready &= ~IO_READY_WRITE;
+  }
+#endif
+
+  /* Whatever didn't go out directly waits in the ring. */
+  space = LINK_OUTBUF_SIZE - (head - RING_GET(l->out_tail));
+  skip = sent;
+
+  for (i = 0; i < iovcnt && space > 0; i++) {
+    if (skip >= iov[i].iov_len) {
+      skip -= iov[i].iov_len;
+      continue;
+    }
+    txt = (const char *) iov[i].iov_base + skip;
+    len = MIN(iov[i].iov_len - skip, space);
+    skip = 0;
+
+    for (done = 0; done < len; done += chunk) {
+      off = (head + done) & (LINK_OUTBUF_SIZE - 1);
+      chunk = MIN(len - done, LINK_OUTBUF_SIZE - off);
+      memcpy(l->outbuf + off, txt + done, chunk);
+    }
+    head += len;
+    space -= len;
+    queued += len;
+  }
+  RING_SET(l->out_head, head);
+
+#ifndef CIRCLE_IO_THREAD
+  if (queued && link_flush(l) < 0) {
+    link_lost(l);
+    return (-1);
+  }
+#endif
+
+  return (sent + queued);
+}
+
+
+/* Queue a single string; see link_writev(). */
+ssize_t link_write(struct io_link *l, const char *txt, size_t length)
+{
+  struct iovec iov;
+
+  iov.iov_base = (void *) txt;
+  iov.iov_len = length;
+  return (link_writev(l, &iov, 1));
+}
+
+
+/* Is there room to queue more output? */
+int link_writable(struct io_link *l)
+{
+  if (RING_GET(l->gone))
+    return (FALSE);
+
+  return (RING_GET(l->out_head) - RING_GET(l->out_tail) < LINK_OUTBUF_SIZE);
+}
+
+
+/* How much more output can be queued; link_writev() takes this much whole. */
+size_t link_space(struct io_link *l)
+{
+  if (RING_GET(l->gone))
+    return (0);
+
+  return (LINK_OUTBUF_SIZE - (RING_GET(l->out_head) - RING_GET(l->out_tail)));
+}
+
+
+/* The descriptor is done with this link; it must not be touched again. */
+void link_release(struct io_link *l)
+{
+#ifdef CIRCLE_IO_THREAD
+  RING_SET(l->released, TRUE);
+#else
+  link_close(l);
+#endif
+}
+
+
+/*
+ * Do the network side's share of a pulse.  Without a network thread that
+ * means polling the sockets right here, without blocking; with one, it
+ * only means checking that the thread is still alive.
+ */
+int io_service(socket_t mother_desc)
+{
+#ifdef CIRCLE_IO_THREAD
+  (void)mother_desc;
+  return (RING_GET(io_failed) ? -1 : 0);
+#else
+  if (io_poll(mother_desc, &null_time) < 0) {
+    perror("SYSERR: Select poll");
+    return (-1);
+  }
+  return (0);
+#endif
+}
+
+
+/* Let the network thread know there's new output and released links. */
+void io_wake(void)
+{
+#ifdef CIRCLE_IO_THREAD
+  if (write(io_wake_pipe[1], "", 1) < 0 && errno != EAGAIN)
+    perror("SYSERR: write (I/O wake pipe)");
+#endif
+}
+
+
+/* Block until someone connects (or a signal arrives). */
+int io_sleep(socket_t mother_desc)
+{
+#ifdef CIRCLE_IO_THREAD
+  fd_set wake_set;
+
+  (void)mother_desc;
+  drain_pipe(game_wake_pipe[0]);
+  if (RING_GET(accept_head) != RING_GET(accept_tail) || RING_GET(io_failed))
+    return (0);
+
+  FD_ZERO(&wake_set);
+  FD_SET(game_wake_pipe[0], &wake_set);
+  return (select(game_wake_pipe[0] + 1, &wake_set, NULL, NULL, NULL));
+#else
+  return (io_poll(mother_desc, NULL));
+#endif
+}
+
+
+#ifdef CIRCLE_IO_THREAD
+
+void *io_thread_loop(void *arg)
+{
+  socket_t mother_desc = *(socket_t *) arg;
+
+  while (!RING_GET(io_shutdown))
+    if (io_poll(mother_desc, NULL) < 0 && errno != EINTR) {
+      perror("SYSERR: I/O thread poll");
+      RING_SET(io_failed, TRUE);
+      if (write(game_wake_pipe[1], "", 1) < 0)
+	perror("SYSERR: write (game wake pipe)");
+      break;
+    }
+
+  return (NULL);
+}
+
+#endif
+
+
+/*
+ * Start the network thread.  It's started with every signal blocked so
+ * that SIGHUP and friends keep going to the game thread.
+ */
+void start_io_thread(socket_t *mother_desc)
+{
+#ifdef CIRCLE_IO_THREAD
+  sigset_t all, old;
+  int err;
+
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  if ((err = pthread_create(&io_thread, NULL, io_thread_loop, mother_desc)) != 0) {
+    log("SYSERR: pthread_create: %s", strerror(err));
+    exit(1);
+  }
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+  log("Network I/O thread started.");
+#else
+  (void)mother_desc;
+#endif
+}
+
+
+/*
+ * Stop the network thread once the game has released every descriptor,
+ * then close whatever links are left over.
+ */
+void stop_io_thread(socket_t mother_desc)
+{
+#ifdef CIRCLE_IO_THREAD
+  RING_SET(io_shutdown, TRUE);
+  io_wake();
+  pthread_join(io_thread, NULL);
+#endif
+
+  /* Now there's only one of us; the last goodbyes get one try to go out. */
+  io_sweep(mother_desc);
+  while (link_list)
+    link_close(link_list);
+}
+
+
+/*
+ * Hostname lookups.  A new connection is named by its numeric address
+ * until the nameserver says otherwise.  With threads, the asking is done
+ * by DNS_THREADS helpers: the game hands them dns_jobs through dns_todo
+ * and picks the answers up from dns_done once a pulse, so however long
+ * the nameserver takes, nobody else waits for it.  Answers (and failures)
+ * are cached by address on the game side, and a lookup that's already
+ * out isn't asked again for the next connection from the same place.
+ */
+struct dns_entry {
+  struct in_addr addr;
+  char name[HOST_LENGTH + 1];	/* "" if the address has no name	*/
+  time_t expires;		/* 0 while the lookup is out		*/
+  struct dns_entry *next;
+};
+
+struct dns_job {
+  struct in_addr addr;
+  char name[HOST_LENGTH + 1];	/* filled in by a helper		*/
+  struct dns_job *next;
+};
+
+
+#ifdef CIRCLE_DNS_THREADS
+
+void *dns_thread_loop(void *arg __attribute__((unused)))
+{
+  struct dns_job *job;
+
+  pthread_mutex_lock(&dns_lock);
+  for (;;) {
+    while (!dns_todo)
+      pthread_cond_wait(&dns_wake, &dns_lock);
+    job = dns_todo;
+    if (!(dns_todo = job->next))
+      dns_todo_tail = NULL;
+    pthread_mutex_unlock(&dns_lock);
+
+    dns_resolve(job->addr, job->name);
+
+    pthread_mutex_lock(&dns_lock);
+    job->next = dns_done;
+    dns_done = job;
+  }
+
+  return (NULL);
+}
+
+#endif
+
+
+/*
+ * Start the lookup helpers, with signals blocked like the network thread.
+ * They're never stopped; one may be stuck on the nameserver at shutdown,
+ * and there's nothing they hold that needs cleaning up.
+ */
+void start_dns_threads(void)
+{
+#ifdef CIRCLE_DNS_THREADS
+  pthread_t thread;
+  sigset_t all, old;
+  int i, err, count = DNS_THREADS;
+
+#if !defined(HAVE_GETNAMEINFO) && !defined(DNS_STUB_DELAY)
+  count = 1;			/* gethostbyaddr() isn't reentrant */
+#endif
+
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  for (i = 0; i < count; i++) {
+    if ((err = pthread_create(&thread, NULL, dns_thread_loop, NULL)) != 0) {
+      log("SYSERR: pthread_create: %s", strerror(err));
+      exit(1);
+    }
+    pthread_detach(thread);
+  }
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+  log("Started %d hostname lookup thread%s.", count, count == 1 ? "" : "s");
+#endif
+}
+
+
+/*
+ * Look 'addr' up and leave its name in 'name' (HOST_LENGTH + 1 big), or
+ * an empty string if it hasn't got one.  This can take a long time.
+ */
+void dns_resolve(struct in_addr addr, char *name)
+{
+#if defined(DNS_STUB_DELAY)
+  unsigned char *b = (unsigned char *) &addr;
+
+  sleep(DNS_STUB_DELAY);
+  snprintf(name, HOST_LENGTH + 1, "%d-%d-%d-%d.stub.invalid", b[0], b[1], b[2], b[3]);
+#elif defined(HAVE_GETNAMEINFO)
+  struct sockaddr_in sa;
+  char host[NI_MAXHOST];
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr = addr;
+  if (getnameinfo((struct sockaddr *) &sa, sizeof(sa), host, sizeof(host), NULL, 0, NI_NAMEREQD) != 0)
+    *host = '\0';
+  strncpy(name, host, HOST_LENGTH);	/* strncpy: OK (name:HOST_LENGTH+1) */
+  *(name + HOST_LENGTH) = '\0';
+#else
+  struct hostent *from;
+
+  if ((from = gethostbyaddr((char *) &addr, sizeof(addr), AF_INET)) == NULL)
+    *name = '\0';
+  else {
+    strncpy(name, from->h_name, HOST_LENGTH);	/* strncpy: OK (name:HOST_LENGTH+1) */
+    *(name + HOST_LENGTH) = '\0';
+  }
+#endif
+}
+
+
+/* Find 'addr' in the cache, throwing out stale entries on the way. */
+struct dns_entry *dns_cache_find(struct in_addr addr)
+{
+  struct dns_entry **ep, *e;
+  time_t now = time(0);
+
+  for (ep = &dns_cache[DNS_HASH(addr)]; (e = *ep) != NULL; ) {
+    if (e->expires && e->expires <= now) {
+      *ep = e->next;
+      free(e);
+    } else if (e->addr.s_addr == addr.s_addr)
+      return (e);
+    else
+      ep = &e->next;
+  }
+
+  return (NULL);
+}
+
+
+/*
+ * Name a new descriptor after the address it's connecting from: the
+ * cached hostname if we have one, otherwise the numeric address, and
+ * start a lookup if nobody has yet.
+ */
+void dns_lookup(struct descriptor_data *d, struct in_addr addr)
+{
+  struct dns_entry *e;
+
+  strncpy(d->host, (char *)inet_ntoa(addr), HOST_LENGTH);	/* strncpy: OK (d->host:HOST_LENGTH+1) */
+  *(d->host + HOST_LENGTH) = '\0';
+
+  if (nameserver_is_slow)
+    return;
+
+  if ((e = dns_cache_find(addr)) == NULL) {
+    CREATE(e, struct dns_entry, 1);
+    e->addr = addr;
+    e->next = dns_cache[DNS_HASH(addr)];
+    dns_cache[DNS_HASH(addr)] = e;
+
+#ifdef CIRCLE_DNS_THREADS
+    {
+      struct dns_job *job;
+
+      CREATE(job, struct dns_job, 1);
+      job->addr = addr;
+
+      pthread_mutex_lock(&dns_lock);
+      if (dns_todo_tail)
+	dns_todo_tail->next = job;
+      else
+	dns_todo = job;
+      dns_todo_tail = job;
+      pthread_cond_signal(&dns_wake);
+      pthread_mutex_unlock(&dns_lock);
+    }
+#else
+    dns_resolve(addr, e->name);
+    e->expires = time(0) + (*e->name ? DNS_CACHE_TTL : DNS_FAILED_TTL);
+#endif
+  }
+
+  if (!e->expires)
+    d->dns_pending = TRUE;
+  else if (*e->name)
+    strcpy(d->host, e->name);	/* strcpy: OK (mutual HOST_LENGTH+1) */
+}
+
+
+/*
+ * Take the answers the helpers have come up with: cache them, and rename
+ * each descriptor that was waiting on one.  The new name gets checked
+ * against the ban list just as it would have been at connect time.
+ */
+void dns_collect(void)
+{
+#ifdef CIRCLE_DNS_THREADS
+  struct dns_job *job, *done;
+  struct dns_entry *e;
+  struct descriptor_data *d;
+
+  pthread_mutex_lock(&dns_lock);
+  done = dns_done;
+  dns_done = NULL;
+  pthread_mutex_unlock(&dns_lock);
+
+  while ((job = done) != NULL) {
+    done = job->next;
+
+    if ((e = dns_cache_find(job->addr)) != NULL) {
+      strcpy(e->name, job->name);	/* strcpy: OK (mutual HOST_LENGTH+1) */
+      e->expires = time(0) + (*e->name ? DNS_CACHE_TTL : DNS_FAILED_TTL);
+    }
+
+    for (d = descriptor_list; d; d = d->next) {
+      if (!d->dns_pending || d->link->peer.sin_addr.s_addr != job->addr.s_addr)
+	continue;
+      d->dns_pending = FALSE;
+      if (!*job->name)
+	continue;
+
+      strcpy(d->host, job->name);	/* strcpy: OK (mutual HOST_LENGTH+1) */
+      if (isbanned(d->host) != BAN_ALL)
+	continue;
+
+      /*
+       * Whoever's already past their password may be in the game, and
+       * closing them as if they weren't would free a character still in
+       * the world, so they're only reported.
+       */
+      if (STATE(d) == CON_GET_NAME || STATE(d) == CON_NAME_CNFRM ||
+	  STATE(d) == CON_PASSWORD) {
+	mudlog(CMP, LVL_GOD, TRUE, "Connection attempt denied from [%s]", d->host);
+	STATE(d) = CON_CLOSE;
+      } else
+	mudlog(NRM, LVL_GOD, TRUE, "%s is connected from banned site [%s]",
+		d->character ? GET_NAME(d->character) : "Someone", d->host);
+    }
+
+    free(job);
+  }
+#endif
+}
+
+
+int new_descriptor(struct io_link *link)
+{
+  static int last_desc = 0;	/* last descriptor number */
+  struct descriptor_data *newd;
+
+  /* create a new descriptor */
+  CREATE(newd, struct descriptor_data, 1);
+
+  /* find the sitename */
+  dns_lookup(newd, link->peer.sin_addr);
+
+  /* determine if the site is banned */
+  if (isbanned(newd->host) == BAN_ALL) {
+    link_release(link);
+    mudlog(CMP, LVL_GOD, TRUE, "Connection attempt denied from [%s]", newd->host);
+    free(newd);
+    return (0);
+  }
+#if 0
+  /*
+   * Log new connections - probably unnecessary, but you may want it.
+   * Note that your immortals may wonder if they see a connection from
+   * your site, but you are wizinvis upon login.
+   */
+  mudlog(CMP, LVL_GOD, FALSE, "New connection from [%s]", newd->host);
+#endif
+
+  /* initialize descriptor data */
+  newd->link = link;
+  newd->descriptor = link->descriptor;
+  newd->idle_tics = 0;
+  newd->login_time = time(0);
+  newd->has_prompt = 1;  /* prompt is part of greetings */
+  STATE(newd) = CON_GET_NAME;
+
+  /*
+   * This isn't exactly optimal but allows us to make a design choice.
+   * Do we embed the history in descriptor_data or keep it dynamically
+   * allocated and allow a user defined history size?
+   */
+  CREATE(newd->history, char *, HISTORY_SIZE);
+
+  if (++last_desc == 1000)
+    last_desc = 1;
+  newd->desc_num = last_desc;
+
+  /* prepend to list */
+  newd->next = descriptor_list;
+  descriptor_list = newd;
+
+#ifdef CIRCLE_MCCP
+  {
+    char mccp_offer[] =
+    {
+      (char) IAC,
+      (char) WILL,
+      (char) TELOPT_COMPRESS2,
+      (char) 0,
+    };
+
+    write_to_output(newd, "%s", mccp_offer);
+  }
+#endif
+
+  write_to_output(newd, "%s", GREETINGS);
+
+  return (0);
+}
+
+
+#ifdef CIRCLE_MCCP
+/*
+ * MCCP v2, the MUD Client Compression Protocol.  We offer COMPRESS2 on
+ * connect; once the client answers DO, everything we send after an
+ * IAC SB COMPRESS2 IAC SE marker is one long zlib stream, sync-flushed
+ * after every write so each prompt shows up as soon as it arrives.  A
+ * DONT finishes the stream and we go back to plain text.
+ *
+ * Compressed bytes the link can't take yet wait in their own queue of
+ * output chunks.  New text isn't compressed until that queue is empty,
+ * so a slow client backs up into the ordinary output queue (and its
+ * overflow limit) just as it would without compression.
+ */
+struct mccp_data {
+  z_stream stream;
+  struct out_chunk *head, *tail;	/* compressed, not yet on the link */
+  int ending;			/* stream finished; free once drained */
+};
+
+/*
+ * zlib's allocations for a stream come in the same handful of sizes for
+ * every connection, so freed blocks are kept on a free list per size
+ * rather than going back to malloc() each time a client connects.
+ */
+#define MCCP_POOL_SIZES	8
+
+union mccp_block {
+  union mccp_block *next;	/* while on a free list */
+  int pool;			/* while in use: which list to go back to */
+  double align;
+};
+
+struct mccp_pool {
+  size_t size;
+  union mccp_block *free;
+} mccp_pool[MCCP_POOL_SIZES];
+
+
+voidpf mccp_alloc(voidpf opaque __attribute__((unused)), uInt items, uInt size)
+{
+  size_t bytes = (size_t) items * size;
+  union mccp_block *b;
+  int i;
+
+  for (i = 0; i < MCCP_POOL_SIZES; i++)
+    if (mccp_pool[i].size == bytes || mccp_pool[i].size == 0)
+      break;
+
+  if (i == MCCP_POOL_SIZES)
+    i = -1;		/* too many sizes; this one isn't pooled */
+  else if (mccp_pool[i].size == 0)
+    mccp_pool[i].size = bytes;
+
+  if (i >= 0 && (b = mccp_pool[i].free) != NULL)
+    mccp_pool[i].free = b->next;
+  else if ((b = (union mccp_block *) malloc(sizeof(union mccp_block) + bytes)) == NULL)
+    return (Z_NULL);
+
+  b->pool = i;
+  return ((voidpf) (b + 1));
+}
+
+
+void mccp_free(voidpf opaque __attribute__((unused)), voidpf address)
+{
+  union mccp_block *b = (union mccp_block *) address - 1;
+  int i = b->pool;
+
+  if (i < 0)
+    free(b);
+  else {
+    b->next = mccp_pool[i].free;
+    mccp_pool[i].free = b;
+  }
+}
+
+
+/* Act on the client's latest DO or DONT COMPRESS2, if we haven't yet. */
+void mccp_check(struct descriptor_data *t)
+{
+  int wanted = RING_GET(t->link->mccp_wanted);
+
+  if (wanted && !t->mccp)
+    mccp_start(t);
+  else if (!wanted && t->mccp && !t->mccp->ending)
+    mccp_end(t);
+}
+
+
+void mccp_start(struct descriptor_data *t)
+{
+  char marker[] =
+  {
+    (char) IAC,
+    (char) SB,
+    (char) TELOPT_COMPRESS2,
+    (char) IAC,
+    (char) SE,
+  };
+  struct mccp_data *m;
+  struct out_chunk *c;
+
+  CREATE(m, struct mccp_data, 1);
+  m->stream.zalloc = mccp_alloc;
+  m->stream.zfree = mccp_free;
+  m->stream.opaque = Z_NULL;
+
+  if (deflateInit2(&m->stream, MCCP_LEVEL, Z_DEFLATED, MCCP_WINDOW_BITS,
+		MCCP_MEMLEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+    log("SYSERR: mccp_start: deflateInit2: %s", m->stream.msg ? m->stream.msg : "failed");
+    free(m);
+    return;
+  }
+
+  /* The marker itself goes out uncompressed, ahead of the stream. */
+  c = new_chunk(&m->head, &m->tail);
+  memcpy(c->text, marker, sizeof(marker));
+  c->tail = sizeof(marker);
+
+  t->mccp = m;
+}
+
+
+/* Finish the stream; it is freed once the last of it reaches the link. */
+void mccp_end(struct descriptor_data *t)
+{
+  struct mccp_data *m = t->mccp;
+  struct out_chunk *c;
+  uLong before = m->stream.total_out;
+  int err;
+
+  m->stream.next_in = Z_NULL;
+  m->stream.avail_in = 0;
+  do {
+    if (!(c = m->tail) || c->tail == OUTBUF_CHUNK_SIZE)
+      c = new_chunk(&m->head, &m->tail);
+    m->stream.next_out = (Bytef *) c->text + c->tail;
+    m->stream.avail_out = OUTBUF_CHUNK_SIZE - c->tail;
+    err = deflate(&m->stream, Z_FINISH);
+    c->tail = OUTBUF_CHUNK_SIZE - m->stream.avail_out;
+  } while (err == Z_OK);
+
+  t->mccp_out += m->stream.total_out - before;
+  deflateEnd(&m->stream);
+  m->ending = TRUE;
+}
+
+
+/*
+ * Compress the pieces in 'iov' onto the end of the compressed queue and
+ * push what we can of it to the link.  Returns how many bytes of 'iov'
+ * were taken -- all or nothing -- or -1 if the connection is gone.
+ */
+ssize_t mccp_writev(struct descriptor_data *t, const struct iovec *iov, int iovcnt)
+{
+  struct mccp_data *m = t->mccp;
+  struct out_chunk *c;
+  size_t total = 0;
+  uLong before;
+  int i;
+
+  /* Don't pile more up behind output the link hasn't taken yet. */
+  if (mccp_drain(t) < 0)
+    return (-1);
+  if (!t->mccp || m->ending || m->head)
+    return (t->mccp ? 0 : desc_writev(t, iov, iovcnt));
+
+  before = m->stream.total_out;
+  for (i = 0; i < iovcnt; i++) {
+    m->stream.next_in = (Bytef *) iov[i].iov_base;
+    m->stream.avail_in = iov[i].iov_len;
+    total += iov[i].iov_len;
+
+    do {
+      if (!(c = m->tail) || c->tail == OUTBUF_CHUNK_SIZE)
+	c = new_chunk(&m->head, &m->tail);
+      m->stream.next_out = (Bytef *) c->text + c->tail;
+      m->stream.avail_out = OUTBUF_CHUNK_SIZE - c->tail;
+      if (deflate(&m->stream, i == iovcnt - 1 ? Z_SYNC_FLUSH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+	log("SYSERR: mccp_writev: deflate: stream error");
+	return (-1);
+      }
+      c->tail = OUTBUF_CHUNK_SIZE - m->stream.avail_out;
+    } while (m->stream.avail_in || m->stream.avail_out == 0);
+  }
+
+  t->mccp_in += total;
+  t->mccp_out += m->stream.total_out - before;
+
+  if (mccp_drain(t) < 0)
+    return (-1);
+  return (total);
+}
+
+
+/*
+ * Hand as much of the compressed queue to the link as it will take.
+ * Returns -1 if the connection is gone, 0 otherwise.
+ */
+int mccp_drain(struct descriptor_data *t)
+{
+  struct mccp_data *m = t->mccp;
+  struct iovec iov[OUTPUT_IOVECS];
+  struct out_chunk *c;
+  ssize_t result = 0;
+  size_t len;
+  int iovcnt = 0;
+
+  for (c = m->head; c && iovcnt < OUTPUT_IOVECS; c = c->next) {
+    iov[iovcnt].iov_base = c->text + c->head;
+    iov[iovcnt++].iov_len = c->tail - c->head;
+  }
+
+  if (iovcnt && (result = link_writev(t->link, iov, iovcnt)) < 0)
+    return (-1);
+
+  for (; m->head && result > 0; result -= len) {
+    c = m->head;
+    len = MIN((size_t) result, c->tail - c->head);
+    c->head += len;
+    if (c->head < c->tail)
+      break;
+    free_chunk(&m->head, &m->tail);
+  }
+
+  /* Once a finished stream is all out, the client is back to plain text. */
+  if (m->ending && !m->head) {
+    free(m);
+    t->mccp = NULL;
+  }
+
+  return (0);
+}
+
+
+/* Throw away the compressor and whatever it still had queued. */
+void mccp_release(struct descriptor_data *t)
+{
+  struct mccp_data *m = t->mccp;
+
+  while (m->head)
+    free_chunk(&m->head, &m->tail);
+  if (!m->ending)
+    deflateEnd(&m->stream);
+  free(m);
+  t->mccp = NULL;
+}
+#endif /* CIRCLE_MCCP */
+
+
+/*
+ * Send output to the descriptor's link, through the compressor if the
+ * client asked for one.  Same return values as link_writev().
+ */
+ssize_t desc_writev(struct descriptor_data *t, const struct iovec *iov, int iovcnt)
+{
+#ifdef CIRCLE_MCCP
+  if (t->mccp)
+    return (mccp_writev(t, iov, iovcnt));
+#endif
+  return (link_writev(t->link, iov, iovcnt));
+}
+
+
+/*
+ * Send all of the output that we've accumulated for a player out to
+ * the player's descriptor.
+ *
+ * The pieces -- a CRLF if this interrupts the player at a prompt, each
+ * chunk of queued text, the overflow notice, an extra CRLF for
+ * non-compact players, and the prompt -- are handed over together in
+ * one iovec list straight from where they lie; nothing is pasted
+ * together first.  If there are more chunks than iovecs, the tail end
+ * of the queue (and the prompt) waits for the next pass.
+ */
+int process_output(struct descriptor_data *t)
+{
+  struct iovec iov[OUTPUT_IOVECS + 4];
+  struct out_chunk *c;
+  int iovcnt = 0, text_iov, trail_iov, i;
+  ssize_t result;
+  size_t skip, len;
+  char *prompt;
+
+  /* If this is an 'interruption', prepend a CRLF. */
+  if (t->has_prompt) {
+    t->has_prompt = FALSE;
+    iov[iovcnt].iov_base = (void *) "\r\n";
+    iov[iovcnt++].iov_len = 2;
+  }
+
+  /* now, the 'real' output */
+  text_iov = iovcnt;
+  for (c = t->output; c && iovcnt - text_iov < OUTPUT_IOVECS; c = c->next) {
+    iov[iovcnt].iov_base = c->text + c->head;
+    iov[iovcnt++].iov_len = c->tail - c->head;
+  }
+  trail_iov = iovcnt;
+
+  /* The rest only goes out behind the last of the text. */
+  if (!c) {
+    /* if we're in the overflow state, notify the user */
+    if (t->overflow) {
+      iov[iovcnt].iov_base = (void *) text_overflow;
+      iov[iovcnt++].iov_len = strlen(text_overflow);
+    }
+
+    /* add the extra CRLF if the person isn't in compact mode */
+    if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) && !PRF_FLAGGED(t->character, PRF_COMPACT)) {
+      iov[iovcnt].iov_base = (void *) "\r\n";
+      iov[iovcnt++].iov_len = 2;
+    }
+
+    /* add a prompt */
+    prompt = make_prompt(t);
+    iov[iovcnt].iov_base = prompt;
+    iov[iovcnt++].iov_len = strlen(prompt);
+  }
+
+  if ((result = desc_writev(t, iov, iovcnt)) < 0) {
+    close_socket(t);	/* Oops, fatal error. Bye! */
+    return (-1);
+  }
+
+  /* From here on, 'result' counts bytes of the buffered text and beyond. */
+  if (text_iov)
+    result = (result > 2 ? result - 2 : 0);
+
+  if (result == 0)	/* Output ring full. Try later. */
+    return (0);
+
+  /* Handle snooping: prepend "% " and send to snooper. */
+  if (t->snoop_by) {
+    write_to_output(t->snoop_by, "%% ");
+    for (skip = result, i = text_iov; i < trail_iov && skip; i++) {
+      len = MIN(skip, iov[i].iov_len);
+      write_to_output(t->snoop_by, "%.*s", (int) len, (char *) iov[i].iov_base);
+      skip -= len;
+    }
+    write_to_output(t->snoop_by, "%%%%");
+  }
+
+  /* Retire every chunk that went out whole; trim the one that didn't. */
+  for (skip = result; t->output && skip; ) {
+    c = t->output;
+    len = MIN(skip, c->tail - c->head);
+    c->head += len;
+    t->bufptr -= len;
+    skip -= len;
+    if (c->head < c->tail)
+      break;
+    free_chunk(&t->output, &t->output_tail);
+  }
+
+  /*
+   * All saved output was handed off.  If the overflow message or prompt
+   * were partially written, save the rest of them.
+   */
+  if (t->bufptr == 0) {
+    while (t->output)
+      free_chunk(&t->output, &t->output_tail);
+    t->overflow = FALSE;
+    for (i = trail_iov; i < iovcnt; i++) {
+      if (skip >= iov[i].iov_len) {
+	skip -= iov[i].iov_len;
+	continue;
+      }
+      queue_output(t, (char *) iov[i].iov_base + skip, iov[i].iov_len - skip);
+      skip = 0;
+    }
+  }
+
+  return (result);
+}
+
+
+/*
+ * perform_socket_write: takes a descriptor, a pointer to text, and a
+ * text length, and tries once to send that text to the OS.  This is
  * where we stuff all the platform-dependent stuff that used to be
  * ugly #ifdef's in write_to_descriptor().
  *
@@ -1576,6 +3142,57 @@ ssize_t perform_socket_write(socket_t desc, const char *txt, size_t length)
 
 #endif /* CIRCLE_WINDOWS */
 
+
+/*
+ * perform_socket_writev: the same, for a list of pieces to be sent in
+ * order.  'iovcnt' is small and the pieces must not all be empty.  Where
+ * there's no writev(), only the first piece is tried, which callers see
+ * as an ordinary short write.
+ */
+#if defined(HAVE_WRITEV) && !defined(CIRCLE_WINDOWS)
+
+ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int iovcnt)
+{
+  ssize_t result;
+
+  result = writev(desc, iov, iovcnt);
+
+  if (result > 0)
+    return (result);
+
+  if (result == 0) {
+    log("SYSERR: Huh??  writev() returned 0???  Please report this!");
+    return (-1);
+  }
+
+#ifdef EAGAIN		/* POSIX */
+  if (errno == EAGAIN)
+    return (0);
+#endif
+
+#ifdef EWOULDBLOCK	/* BSD */
+  if (errno == EWOULDBLOCK)
+    return (0);
+#endif
+
+  return (-1);
+}
+
+#else
+
+ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int iovcnt)
+{
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+    if (iov[i].iov_len > 0)
+      return (perform_socket_write(desc, iov[i].iov_base, iov[i].iov_len));
+
+  return (0);
+}
+
+#endif /* HAVE_WRITEV && !CIRCLE_WINDOWS */
+
     
 /*
  * write_to_descriptor takes a descriptor, and text to write to the
@@ -1684,38 +3301,42 @@ ssize_t perform_socket_read(socket_t desc, char *read_point, size_t space_left)
 }
 
 /*
- * ASSUMPTION: There will be no newlines in the raw input buffer when this
- * function is called.  We must maintain that before returning.
- *
- * Ever wonder why 'tmp' had '+8' on it?  The crusty old code could write
- * MAX_INPUT_LENGTH+1 bytes to 'tmp' if there was a '$' as the final
- * character in the input buffer.  This would also cause 'space_left' to
- * drop to -1, which wasn't very happy in an unsigned variable.  Argh.
- * So to fix the above, 'tmp' lost the '+8' since it doesn't need it
- * and the code has been changed to reserve space by accepting one less
- * character. (Do you really need 256 characters on a line?)
- * -gg 1/21/2000
+ * link_read: pull whatever the socket has into the link's input ring and
+ * mark off the complete lines for the game side.  Network side only.
+ * Returns -1 if the link should be dropped, 0 otherwise.
  */
-int process_input(struct descriptor_data *t)
+int link_read(struct io_link *l)
 {
-  int buf_length, failed_subst;
+  size_t space, pos;
   ssize_t bytes_read;
-  size_t space_left;
-  char *ptr, *read_point, *write_point, *nl_pos = NULL;
-  char tmp[MAX_INPUT_LENGTH];
 
-  /* first, find the point where we left off reading data */
-  buf_length = strlen(t->inbuf);
-  read_point = t->inbuf + buf_length;
-  space_left = MAX_RAW_INPUT_LENGTH - buf_length - 1;
+  l->stalled = FALSE;
 
-  do {
-    if (space_left <= 0) {
-      log("WARNING: process_input: about to close connection: input overflow");
+  for (;;) {
+    /* Frame what we have first; a full line index means wait for the game. */
+    if (link_frame(l) < 0)
       return (-1);
+    if (l->stalled)
+      return (0);
+
+    /* As ever, an unfinished line may not grow to MAX_RAW_INPUT_LENGTH. */
+    if ((space = MAX_RAW_INPUT_LENGTH - 1 - (l->in_head - l->in_line)) <= 0) {
+      log("WARNING: link_read: about to close connection: input overflow");
+      return (-1);
+    }
+
+    /* Read into the free space, up to where the ring wraps. */
+    pos = l->in_head & (LINK_INPUT_SIZE - 1);
+    space = MIN(space, LINK_INPUT_SIZE - (l->in_head - RING_GET(l->in_tail)));
+    space = MIN(space, LINK_INPUT_SIZE - pos);
+
+    if (space == 0) {		/* waiting on the game to take lines */
+      l->stalled = TRUE;
+      sweep_needed = TRUE;
+      return (0);
     }
 
-    bytes_read = perform_socket_read(t->descriptor, read_point, space_left);
+    bytes_read = perform_socket_read(l->descriptor, l->inbuf + pos, space);
 
     if (bytes_read < 0)	/* Error, disconnect them. */
       return (-1);
@@ -1724,15 +3345,8 @@ int process_input(struct descriptor_data *t)
 
     /* at this point, we know we got some data from the read */
 
-    *(read_point + bytes_read) = '\0';	/* terminate the string */
-
-    /* search for a newline in the data we just read */
-    for (ptr = read_point; *ptr && !nl_pos; ptr++)
-      if (ISNEWL(*ptr))
-	nl_pos = ptr;
-
-    read_point += bytes_read;
-    space_left -= bytes_read;
+    /* Telnet commands come out here; they may hold NULs and option bytes. */
+    l->in_head += link_telnet(l, l->inbuf + pos, bytes_read);
 
 /*
  * on some systems such as AIX, POSIX-standard nonblocking I/O is broken,
@@ -1744,54 +3358,172 @@ int process_input(struct descriptor_data *t)
  * that data is ready (process_input is only called if select indicates that
  * this descriptor is in the read set).  JE 2/23/95.
  */
-#if !defined(POSIX_NONBLOCK_BROKEN)
-  } while (nl_pos == NULL);
-#else
-  } while (0);
+#if defined(POSIX_NONBLOCK_BROKEN)
+    return (link_frame(l));
+#endif
+  }
+}
 
-  if (nl_pos == NULL)
-    return (0);
-#endif /* POSIX_NONBLOCK_BROKEN */
 
-  /*
-   * okay, at this point we have at least one newline in the string; now we
-   * can copy the formatted data to a new array for further processing.
-   */
+/*
+ * Find the first byte in [p, end) that is 'a' or 'b', or NULL if there
+ * isn't one.  Input is searched a machine word at a time: XORing a word
+ * with the wanted byte repeated zeroes exactly the matching bytes, and
+ * HAS_ZERO_BYTE() spots a zero byte in a word without looking at them
+ * one by one.
+ */
+#define BYTES_ONES		((unsigned long) -1 / 0xFF)
+#define HAS_ZERO_BYTE(w)	(((w) - BYTES_ONES) & ~(w) & (BYTES_ONES << 7))
 
-  read_point = t->inbuf;
-
-  while (nl_pos != NULL) {
-    write_point = tmp;
-    space_left = MAX_INPUT_LENGTH - 1;
-
-    /* The '> 1' reserves room for a '$ => $$' expansion. */
-    for (ptr = read_point; (space_left > 1) && (ptr < nl_pos); ptr++) {
-      if (*ptr == '\b' || *ptr == 127) { /* handle backspacing or delete key */
-	if (write_point > tmp) {
-	  if (*(--write_point) == '$') {
-	    write_point--;
-	    space_left += 2;
-	  } else
-	    space_left++;
-	}
-      } else if (isascii(*ptr) && isprint(*ptr)) {
-	if ((*(write_point++) = *ptr) == '$') {		/* copy one character */
-	  *(write_point++) = '$';	/* if it's a $, double it */
-	  space_left -= 2;
-	} else
-	  space_left--;
-      }
+const char *link_scan(const char *p, const char *end, int a, int b)
+{
+  unsigned long wa = BYTES_ONES * (unsigned char) a, wb = BYTES_ONES * (unsigned char) b, w;
+
+  for (; end - p >= (ptrdiff_t) sizeof(w); p += sizeof(w)) {
+    memcpy(&w, p, sizeof(w));
+    if (HAS_ZERO_BYTE(w ^ wa) || HAS_ZERO_BYTE(w ^ wb))
+      break;
+  }
+
+  for (; p < end; p++)
+    if (*p == (char) a || *p == (char) b)
+      return (p);
+
+  return (NULL);
+}
+
+
+/*
+ * Strip telnet commands out of 'len' freshly read bytes at 'buf', in
+ * place, and return how many bytes of plain text are left.  A command
+ * split across two reads is picked up again through l->telnet_state.
+ * The only option we act on is COMPRESS2: the client's DO or DONT is
+ * left in l->mccp_wanted for the game side to notice.
+ */
+#define TS_DATA		0
+#define TS_IAC		1
+#define TS_SB		2
+#define TS_SB_IAC	3
+
+size_t link_telnet(struct io_link *l, char *buf, size_t len)
+{
+  unsigned char *in = (unsigned char *)buf, *out = in, *end = in + len;
+  int state = l->telnet_state;
+
+  /* Usually there's nothing to take out. */
+  if (state == TS_DATA) {
+    if ((in = (unsigned char *) link_scan(buf, buf + len, IAC, '\0')) == NULL)
+      return (len);
+    out = in;
+  }
+
+  for (; in < end; in++) {
+    switch (state) {
+    case TS_DATA:
+      if (*in == IAC)
+	state = TS_IAC;
+      else if (*in)
+	*(out++) = *in;
+      break;
+    case TS_IAC:
+      if (*in == IAC) {		/* escaped 255; not printable anyway */
+	*(out++) = *in;
+	state = TS_DATA;
+      } else if (*in == SB)
+	state = TS_SB;
+      else if (*in == WILL || *in == WONT || *in == DO || *in == DONT)
+	state = *in;		/* option byte comes next */
+      else
+	state = TS_DATA;
+      break;
+    case TS_SB:
+      if (*in == IAC)
+	state = TS_SB_IAC;
+      break;
+    case TS_SB_IAC:
+      state = (*in == SE ? TS_DATA : TS_SB);
+      break;
+    default:			/* WILL, WONT, DO or DONT */
+      if (*in == TELOPT_COMPRESS2 && (state == DO || state == DONT))
+	RING_SET(l->mccp_wanted, state == DO);
+      state = TS_DATA;
+      break;
     }
+  }
 
-    *write_point = '\0';
+  l->telnet_state = state;
+  return (out - (unsigned char *)buf);
+}
 
-    if ((space_left <= 0) && (ptr < nl_pos)) {
-      char buffer[MAX_INPUT_LENGTH + 64];
 
-      snprintf(buffer, sizeof(buffer), "Line too long.  Truncated to:\r\n%s\r\n", tmp);
-      if (write_to_descriptor(t->descriptor, buffer) < 0)
-	return (-1);
+/*
+ * Mark off the complete lines in the input ring for the game side, until
+ * there are none left or the line index is full, in which case the link
+ * is marked stalled and the rest waits.  Cleaning each line up is left to
+ * link_get_line(), on the game side.
+ */
+int link_frame(struct io_link *l)
+{
+  const char *nl;
+  size_t pos, len, end, head;
+
+  while (l->in_scan != l->in_head) {
+    /* search for a newline in the raw input, up to where the ring wraps */
+    pos = l->in_scan & (LINK_INPUT_SIZE - 1);
+    len = MIN(l->in_head - l->in_scan, LINK_INPUT_SIZE - pos);
+    if ((nl = link_scan(l->inbuf + pos, l->inbuf + pos + len, '\n', '\r')) == NULL) {
+      l->in_scan += len;
+      continue;
     }
+    end = l->in_scan + (nl - (l->inbuf + pos));
+
+    head = RING_GET(l->line_head);
+    if (head - RING_GET(l->line_tail) >= LINK_INPUT_LINES) {
+      l->in_scan = end;
+      l->stalled = TRUE;
+      sweep_needed = TRUE;
+      break;
+    }
+
+    /* find the end of this line */
+    l->lines[head & (LINK_INPUT_LINES - 1)].end = end;
+    while (end != l->in_head && ISNEWL(l->inbuf[end & (LINK_INPUT_SIZE - 1)]))
+      end++;
+    l->lines[head & (LINK_INPUT_LINES - 1)].next = end;
+
+    /* Hand the line over to the game side. */
+    RING_SET(l->line_head, head + 1);
+    l->in_scan = l->in_line = end;
+  }
+
+  return (0);
+}
+
+
+/*
+ * process_input: take the lines the network side has framed for this
+ * descriptor and run them through snooping, history and '^' substitution
+ * into the descriptor's input queue.  Returns the number of lines taken,
+ * or -1 once the connection is gone and there's nothing left to run.
+ */
+int process_input(struct descriptor_data *t)
+{
+  int failed_subst, gone, got, lines = 0;
+  char tmp[MAX_INPUT_LENGTH];
+
+  /* Look first: lines queued before the link died are still worth running. */
+  gone = RING_GET(t->link->gone);
+
+#ifdef CIRCLE_MCCP
+  mccp_check(t);
+#endif
+
+  while ((got = link_get_line(t->link, tmp)) != 0) {
+    lines++;
+
+    if (got == 2)
+      write_to_output(t, "Line too long.  Truncated to:\r\n%s\r\n", tmp);
+
     if (t->snoop_by)
       write_to_output(t->snoop_by, "%% %s\r\n", tmp);
     failed_subst = 0;
@@ -1828,25 +3560,12 @@ int process_input(struct descriptor_data *t)
 
     if (!failed_subst)
       write_to_q(tmp, &t->input, 0);
-
-    /* find the end of this line */
-    while (ISNEWL(*nl_pos))
-      nl_pos++;
-
-    /* see if there's another newline in the input buffer */
-    read_point = ptr = nl_pos;
-    for (nl_pos = NULL; *ptr && !nl_pos; ptr++)
-      if (ISNEWL(*ptr))
-	nl_pos = ptr;
   }
 
-  /* now move the rest of the buffer up to the beginning for the next pass */
-  write_point = t->inbuf;
-  while (*read_point)
-    *(write_point++) = *(read_point++);
-  *write_point = '\0';
+  if (gone && !lines && !t->input.head)
+    return (-1);
 
-  return (1);
+  return (lines);
 }
 
 
@@ -1909,7 +3628,7 @@ void close_socket(struct descriptor_data *d)
   struct descriptor_data *temp;
 
   REMOVE_FROM_LIST(d, descriptor_list, next);
-  CLOSE_SOCKET(d->descriptor);
+  link_release(d->link);
   flush_queues(d);
 
   /* Forget snooping */
@@ -24,6 +24,14 @@
 #include "interpreter.h"
 #include "house.h"
 #include "constants.h"
+#include "events.h"
+#include "worldimg.h"
+#include "intern.h"
+#include "arena.h"
+#include "perf.h"
+#include "plrindex.h"
+#include "saver.h"
+#include "journal.h"
 
 /**************************************************************************
 *  declarations of most of the 'global' variables                         *
@@ -51,6 +59,8 @@ struct player_index_element *player_table = NULL;	/* index to plr file	 */
 FILE *player_fl = NULL;		/* file desc of player file	 */
 int top_of_p_table = 0;		/* ref to top of table		 */
 long top_idnum = 0;		/* highest idnum in use		 */
+unsigned long saves_done[NUM_SAVES];	/* SAVES_x, for 'show stats'	 */
+unsigned long saves_skipped[NUM_SAVES];
 
 int no_mail = 0;		/* mail disabled?		 */
 int mini_mud = 0;		/* mini-mud mode?		 */
@@ -80,20 +90,124 @@ int top_of_helpt = 0;		/* top of help index table	 */
 struct time_info_data time_info;/* the infomation about the time    */
 struct weather_data weather_info;	/* the infomation about the weather */
 struct player_special_data dummy_mob;	/* dummy spec area for mobs	*/
-struct reset_q_type reset_q;	/* queue of zones to be reset	 */
+struct arena world_arena;	/* the rooms' exits, extra descs */
+
+/*
+ * The exits and extra descriptions of a zone's last reload, by file, so
+ * the next one of that file can give them back.  What the boot read stays
+ * in world_arena, so a zone reloaded any number of times keeps at most
+ * one copy besides that.
+ */
+struct reload_arenas {
+  struct arena file[3];		/* by DB_BOOT_WLD .. DB_BOOT_OBJ */
+} *reload_arena;
+
+/*
+ * Straight from a vnum to its rnum, or NOWHERE.  There's one entry for
+ * every vnum up to the highest in use; with 16-bit vnums that's never
+ * much.  Until a table is finished the look-ups search it instead.
+ * util/vnumbench.c times these against the search, with copies of both.
+ */
+struct vnum_index {
+  IDXTYPE *rnum;
+  int top;			/* highest vnum it has room for	*/
+};
+
+struct vnum_index room_vnums, mob_vnums, obj_vnums, zone_vnums;
+
+#define ZONE_SAVE_DEPTH	16	/* containers in containers, when unloaded */
+#define RESET_BUDGET_USEC 10000	/* of each pulse, at most, for zone resets */
+
+/*
+ * Every zone that resets is in the reset heap, the one due soonest at the
+ * top.  Those that are due are reset one at a time, as much of each on a
+ * pulse as fits in RESET_BUDGET_USEC; the rest waits for the next pulse.
+ */
+struct reset_entry {
+  unsigned long due;		/* event_pulse it's due on	*/
+  zone_rnum zone;
+};
+
+/* A reset under way, a slice at a time. */
+struct reset_state {
+  zone_rnum zone;		/* NOWHERE if there isn't one	*/
+  int cmd_no;			/* the next command to run	*/
+  int last_cmd;
+  struct char_data *mob;	/* the last loaded, for 'G', 'E' */
+  mob_rnum mob_nr;
+  int mob_gone;			/* ... went between two slices	*/
+};
+
+struct reset_entry *reset_heap = NULL;
+int reset_heap_size = 0;
+struct reset_state resetting = { NOWHERE, 0, 0, NULL, NOBODY, FALSE };
+
+/*
+ * A room, mobile or object file named in an index.  Its records are
+ * read into their own stretch of the table, from 'base' on, so that the
+ * files can be read at the same time; anything logged meanwhile is kept
+ * with the number of the record it was about, to come out in order.
+ */
+struct boot_message {
+  int record;
+  char *text;
+};
+
+struct boot_file {
+  char *filename;
+  int mode;
+  int base;			/* where its records start in the table */
+  int records;			/* how many it has room for	*/
+  int parsed;			/* records read so far		*/
+  int started;			/* ... counting a partly read one */
+  int failed;			/* the format was bad: don't boot */
+  unsigned long usec;		/* time taken to read it	*/
+  jmp_buf error;		/* for boot_exit()		*/
+  char line[READ_SIZE];		/* for parse_object()		*/
+  struct boot_message *messages;
+  int num_messages, max_messages;
+  struct arena arena;		/* exits and extra descriptions	*/
+};
+
+/*
+ * A zone being reloaded: its files, read into tables of their own, and
+ * where in the real tables what they hold goes.
+ */
+struct zone_reload {
+  zone_rnum zone;
+  struct boot_file file[4];	/* by DB_BOOT_WLD .. DB_BOOT_ZON */
+  IDXTYPE first[3];		/* rnum of the zone's first of each */
+  struct room_data *rooms;
+  struct char_data *mobs;
+  struct index_data *mob_index;
+  struct obj_data *objs;
+  struct index_data *obj_index;
+  struct zone_data table;
+};
+
+#ifdef CIRCLE_BOOT_THREADS
+pthread_key_t boot_self;		/* the boot_file a thread is reading */
+int boot_self_made = FALSE;
+pthread_mutex_t boot_lock = PTHREAD_MUTEX_INITIALIZER;
+struct boot_file *boot_queue;		/* files for the threads to read */
+int boot_queued, boot_next;
+#else
+struct boot_file *boot_self;
+#endif
 
 /* local functions */
 int check_bitvector_names(bitvector_t bits, size_t namecount, const char *whatami, const char *whatbits);
 int check_object_spell_number(struct obj_data *obj, int val);
 int check_object_level(struct obj_data *obj, int val);
-void setup_dir(FILE *fl, int room, int dir);
+void setup_dir(struct boot_file *bf, FILE *fl, int room, int dir);
 void index_boot(int mode);
-void discrete_load(FILE *fl, int mode, char *filename);
+void discrete_load(struct boot_file *bf, FILE *fl);
 int check_object(struct obj_data *);
-void parse_room(FILE *fl, int virtual_nr);
-void parse_mobile(FILE *mob_f, int nr);
-char *parse_object(FILE *obj_f, int nr);
+void parse_room(struct boot_file *bf, FILE *fl, int virtual_nr);
+void parse_mobile(struct boot_file *bf, FILE *mob_f, int nr);
+char *parse_object(struct boot_file *bf, FILE *obj_f, int nr);
 void load_zones(FILE *fl, char *zonename);
+void parse_zone(FILE *fl, char *zonename, struct zone_data *zone);
 void load_help(FILE *fl);
 void assign_mobiles(void);
 void assign_objects(void);
@@ -119,9 +233,50 @@ void save_etext(struct char_data *ch);
 void check_start_rooms(void);
 void renum_world(void);
 void renum_zone_table(void);
+void renum_zone(zone_rnum zone);
 void log_zone_error(zone_rnum zone, int cmd_no, const char *message);
 void reset_time(void);
 long get_ptable_by_name(const char *name);
+void boot_log(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
+void boot_exit(void) __attribute__ ((noreturn));
+struct boot_file *boot_file_self(void);
+void boot_set_self(struct boot_file *bf);
+void boot_read_file(struct boot_file *bf);
+int boot_read_files(struct boot_file *files, int num);
+void boot_merge_files(struct boot_file *files, int num, int mode);
+void boot_room_zone(room_rnum room, zone_rnum *zone);
+int starts_with_article(const char *str);
+void vnum_index_size(struct vnum_index *vi, int top);
+void reload_zone(struct char_data *ch, zone_vnum vnum);
+int reload_read(struct char_data *ch, struct zone_reload *zr, int mode);
+int reload_read_table(struct char_data *ch, struct zone_reload *zr);
+int reload_match(struct char_data *ch, struct zone_reload *zr, int mode);
+void reload_messages(struct char_data *ch, struct boot_file *bf);
+void reload_rooms(struct zone_reload *zr);
+void reload_mobiles(struct zone_reload *zr);
+void reload_objects(struct zone_reload *zr);
+void reload_discard(struct zone_reload *zr);
+void release_room_text(struct room_data *room);
+void release_mob_text(struct char_data *mob);
+void release_obj_text(struct obj_data *obj);
+int zone_unload(zone_rnum zone);
+void zone_restore(zone_rnum zone);
+int zone_storable(struct obj_data *obj);
+int zone_unloads_mob(struct char_data *ch);
+int zone_mob_keeps(zone_rnum zone, struct char_data *ch);
+int zone_gives(zone_rnum zone, struct obj_data *obj);
+int zone_save_objs(struct obj_data *obj, FILE *fl, room_vnum room, int depth);
+void reset_heap_set(int pos, struct reset_entry e);
+void reset_heap_up(int pos);
+void reset_heap_down(int pos);
+void zone_schedule(zone_rnum zone, unsigned long due);
+void zone_unschedule(zone_rnum zone);
+void zone_reschedule(zone_rnum zone);
+void reset_start(struct reset_state *rs, zone_rnum zone);
+int reset_zone_cmds(struct reset_state *rs, unsigned long deadline);
+#ifdef CIRCLE_BOOT_THREADS
+void *boot_thread_loop(void *arg);
+#endif
 
 /* external functions */
 void paginate_string(char *str, struct descriptor_data *d);
@@ -140,10 +295,15 @@ void boot_the_shops(FILE *shop_f, char *filename, int rec_count);
 int hsort(const void *a, const void *b);
 void prune_crlf(char *txt);
 void destroy_shops(void);
+EVENTFUNC(mobile_activity);
+SPECIAL(shop_keeper);
+struct obj_data *Obj_from_store(struct obj_file_elem object, int *location);
+int Obj_to_store(struct obj_data *obj, FILE *fl, int location);
 
 /* external vars */
 extern int no_specials;
 extern int scheck;
+extern int write_image;
 extern room_vnum mortal_start_room;
 extern room_vnum immort_start_room;
 extern room_vnum frozen_start_room;
@@ -187,9 +347,9 @@ void free_text_files(void)
  */
 ACMD(do_reboot)
 {
-  char arg[MAX_INPUT_LENGTH];
+  char arg[MAX_INPUT_LENGTH], zone[MAX_INPUT_LENGTH];
 
-  one_argument(argument, arg);
+  two_arguments(argument, arg, zone);
 
   if (!str_cmp(arg, "all") || *arg == '*') {
     if (file_to_string_alloc(GREETINGS_FILE, &GREETINGS) == 0)
@@ -234,6 +394,14 @@ ACMD(do_reboot)
     if (help_table)
       free_help();
     index_boot(DB_BOOT_HLP);
+  } else if (!str_cmp(arg, "zone")) {
+    if (!*zone || !isdigit(*zone))
+      send_to_char(ch, "Usage: reload zone <zone number>\r\n"
+		"The zone's own files are read again.  Adding or removing any of its\r\n"
+		"rooms, mobiles or objects needs a reboot instead.\r\n");
+    else
+      reload_zone(ch, atoi(zone));
+    return;
   } else {
     send_to_char(ch, "Unknown reload option.\r\n");
     return;
@@ -245,6 +413,23 @@ ACMD(do_reboot)
 
 void boot_world(void)
 {
+  /*
+   * The image has the whole world; mini-mud and syntax checking want
+   * it read from the files.
+   */
+  if (!scheck && !write_image && !mini_mud) {
+    log("Loading the world image.");
+    if (world_image_load(WORLD_IMAGE_FILE)) {
+      vnum_index_build(DB_BOOT_ZON);
+      vnum_index_build(DB_BOOT_WLD);
+      vnum_index_build(DB_BOOT_MOB);
+      vnum_index_build(DB_BOOT_OBJ);
+      log("Checking start rooms.");
+      check_start_rooms();
+      return;
+    }
+  }
+
   log("Loading zone table.");
   index_boot(DB_BOOT_ZON);
 
@@ -266,13 +451,409 @@ void boot_world(void)
   log("Renumbering zone table.");
   renum_zone_table();
 
-  if (!no_specials) {
+  if (!no_specials || write_image) {
     log("Loading shops.");
     index_boot(DB_BOOT_SHP);
   }
 }
 
 
+/*
+ * Reloading one zone while the game runs.  Its files are read into
+ * tables of their own, and nothing is changed unless every one of them
+ * reads cleanly and holds just the rooms, mobiles and objects the zone
+ * has now.  Those keep their rnums, so nothing outside the zone has to
+ * be renumbered and the time taken goes with the size of the zone; one
+ * that gains or loses any still needs a reboot.
+ *
+ * A zone's files are those named for it, 30.wld and so on.  Any it
+ * doesn't have leave that part of it as it was.
+ */
+void reload_zone(struct char_data *ch, zone_vnum vnum)
+{
+  struct zone_reload zr;
+  unsigned long start = perf_now();
+  int mode, found = 0, ok = TRUE, result;
+
+  memset(&zr, 0, sizeof(zr));
+  if ((zr.zone = real_zone(vnum)) == NOWHERE) {
+    send_to_char(ch, "There is no zone %d.\r\n", vnum);
+    return;
+  }
+
+  for (mode = DB_BOOT_WLD; ok && mode <= DB_BOOT_OBJ; mode++)
+    if ((result = reload_read(ch, &zr, mode)) < 0 || (result && !reload_match(ch, &zr, mode)))
+      ok = FALSE;
+    else
+      found += result;
+  if (ok) {
+    if ((result = reload_read_table(ch, &zr)) < 0)
+      ok = FALSE;
+    else
+      found += result;
+  }
+
+  if (!ok || !found) {
+    if (ok)
+      send_to_char(ch, "Zone %d has no files of its own to reload.\r\n", vnum);
+    else
+      send_to_char(ch, "Zone %d was left as it was.\r\n", vnum);
+    reload_discard(&zr);
+    return;
+  }
+
+  /* Everything's been checked: there's no going back from here. */
+  if (zr.rooms)
+    reload_rooms(&zr);
+  if (zr.mobs)
+    reload_mobiles(&zr);
+  if (zr.objs)
+    reload_objects(&zr);
+  if (zr.table.cmd) {
+    /* A reset of it that's under way was going by the old commands. */
+    if (resetting.zone == zr.zone)
+      resetting.zone = NOWHERE;
+    WORLD_FREE(zone_table[zr.zone].name);
+    WORLD_FREE(zone_table[zr.zone].cmd);
+    zone_table[zr.zone].name = zr.table.name;
+    zone_table[zr.zone].cmd = zr.table.cmd;
+    zone_table[zr.zone].lifespan = zr.table.lifespan;
+    zone_table[zr.zone].reset_mode = zr.table.reset_mode;
+    zr.table.name = NULL;
+    zr.table.cmd = NULL;
+    renum_zone(zr.zone);
+    if (zone_table[zr.zone].resident)
+      zone_reschedule(zr.zone);
+  }
+
+  /* Nothing is left pointing at what the last reload of a file read. */
+  if (!reload_arena)
+    CREATE(reload_arena, struct reload_arenas, top_of_zone_table + 1);
+  for (mode = DB_BOOT_WLD; mode <= DB_BOOT_OBJ; mode++)
+    if (zr.file[mode].parsed) {
+      arena_free(&reload_arena[zr.zone].file[mode]);
+      arena_merge(&reload_arena[zr.zone].file[mode], &zr.file[mode].arena);
+    }
+
+  send_to_char(ch, "Zone %d reloaded: %d rooms, %d mobiles, %d objects%s, in %lu ms.\r\n",
+	vnum, zr.file[DB_BOOT_WLD].parsed, zr.file[DB_BOOT_MOB].parsed,
+	zr.file[DB_BOOT_OBJ].parsed, zr.file[DB_BOOT_ZON].filename ? " and its resets" : "",
+	(perf_now() - start) / 1000);
+  mudlog(NRM, MAX(LVL_GOD, GET_INVIS_LEV(ch)), TRUE, "(GC) %s reloaded zone %d.", GET_NAME(ch), vnum);
+
+  /* What's left is only the tables they were read into. */
+  for (mode = DB_BOOT_WLD; mode <= DB_BOOT_OBJ; mode++)
+    zr.file[mode].records = 0;
+  reload_discard(&zr);
+}
+
+
+/*
+ * Read the zone's room, mobile or object file, if it has one, into a table
+ * of its own.  Returns 1 if it was read, 0 if there isn't one, and -1 if it
+ * couldn't be.
+ */
+int reload_read(struct char_data *ch, struct zone_reload *zr, int mode)
+{
+  const char *prefix[] = {WLD_PREFIX, MOB_PREFIX, OBJ_PREFIX};
+  const char *suffix[] = {"wld", "mob", "obj"};
+  struct boot_file *bf = zr->file + mode;
+  struct room_data *live_world = world;
+  struct char_data *live_mob_proto = mob_proto;
+  struct index_data *live_mob_index = mob_index;
+  struct obj_data *live_obj_proto = obj_proto;
+  struct index_data *live_obj_index = obj_index;
+  room_rnum live_top_of_world = top_of_world;
+  mob_rnum live_top_of_mobt = top_of_mobt;
+  obj_rnum live_top_of_objt = top_of_objt;
+  char filename[128];
+  FILE *fl;
+
+  snprintf(filename, sizeof(filename), "%s%d.%s", prefix[mode], zone_table[zr->zone].number, suffix[mode]);
+  if (!(fl = fopen(filename, "r")))
+    return (0);
+  bf->records = count_hash_records(fl);
+  fclose(fl);
+
+  bf->filename = strdup(filename);
+  bf->mode = mode;
+
+  /* The parsers fill in the tables they know; for now, these are them. */
+  switch (mode) {
+  case DB_BOOT_WLD:
+    CREATE(zr->rooms, struct room_data, bf->records + 1);
+    world = zr->rooms;
+    top_of_world = bf->records - 1;
+    break;
+  case DB_BOOT_MOB:
+    CREATE(zr->mobs, struct char_data, bf->records + 1);
+    CREATE(zr->mob_index, struct index_data, bf->records + 1);
+    mob_proto = zr->mobs;
+    mob_index = zr->mob_index;
+    top_of_mobt = bf->records - 1;
+    break;
+  case DB_BOOT_OBJ:
+    CREATE(zr->objs, struct obj_data, bf->records + 1);
+    CREATE(zr->obj_index, struct index_data, bf->records + 1);
+    obj_proto = zr->objs;
+    obj_index = zr->obj_index;
+    top_of_objt = bf->records - 1;
+    break;
+  }
+
+  boot_read_file(bf);
+
+  world = live_world;
+  top_of_world = live_top_of_world;
+  mob_proto = live_mob_proto;
+  mob_index = live_mob_index;
+  top_of_mobt = live_top_of_mobt;
+  obj_proto = live_obj_proto;
+  obj_index = live_obj_index;
+  top_of_objt = live_top_of_objt;
+
+  reload_messages(ch, bf);
+
+  return (bf->failed ? -1 : 1);
+}
+
+
+/* The same for the zone file, which has its own parser. */
+int reload_read_table(struct char_data *ch, struct zone_reload *zr)
+{
+  struct boot_file *bf = zr->file + DB_BOOT_ZON;
+  struct zone_data *zone = zone_table + zr->zone;
+  char filename[128];
+  FILE *fl;
+
+  snprintf(filename, sizeof(filename), "%s%d.zon", ZON_PREFIX, zone->number);
+  if (!(fl = fopen(filename, "r")))
+    return (0);
+
+  bf->filename = strdup(filename);
+  bf->mode = DB_BOOT_ZON;
+
+  boot_set_self(bf);
+  if (!setjmp(bf->error))
+    parse_zone(fl, bf->filename, &zr->table);
+  boot_set_self(NULL);
+  fclose(fl);
+
+  reload_messages(ch, bf);
+  if (bf->failed)
+    return (-1);
+
+  if (zr->table.number != zone->number || zr->table.bot != zone->bot || zr->table.top != zone->top) {
+    send_to_char(ch, "%s is for zone %d, %d to %d; changing that needs a reboot.\r\n",
+	filename, zr->table.number, zr->table.bot, zr->table.top);
+    return (-1);
+  }
+
+  return (1);
+}
+
+
+/*
+ * Check that what was read is just what the zone has now, in the same
+ * order, and find where in the real table it goes.
+ */
+int reload_match(struct char_data *ch, struct zone_reload *zr, int mode)
+{
+  const char *what[] = {"Room", "Mobile", "Object"};
+  struct zone_data *zone = zone_table + zr->zone;
+  struct boot_file *bf = zr->file + mode;
+  int vnum, k, live = 0, rnum, first = NOWHERE;
+
+  for (vnum = zone->bot; vnum <= zone->top; vnum++) {
+    rnum = (mode == DB_BOOT_WLD ? real_room(vnum) : mode == DB_BOOT_MOB ? real_mobile(vnum) : real_object(vnum));
+    if (rnum != NOWHERE && !live++)
+      first = rnum;
+  }
+
+  if (bf->parsed < live) {
+    send_to_char(ch, "%s has only %d of the zone's %d; removing any needs a reboot.\r\n",
+	bf->filename, bf->parsed, live);
+    return (FALSE);
+  }
+
+  for (k = 0; k < bf->parsed; k++) {
+    vnum = (mode == DB_BOOT_WLD ? zr->rooms[k].number : mode == DB_BOOT_MOB ? zr->mob_index[k].vnum : zr->obj_index[k].vnum);
+    rnum = (mode == DB_BOOT_WLD ? real_room(vnum) : mode == DB_BOOT_MOB ? real_mobile(vnum) : real_object(vnum));
+
+    if (vnum < zone->bot || vnum > zone->top)
+      send_to_char(ch, "%s #%d isn't in zone %d, %d to %d.\r\n", what[mode], vnum, zone->number, zone->bot, zone->top);
+    else if (rnum == NOWHERE)
+      send_to_char(ch, "%s #%d is new; adding it needs a reboot.\r\n", what[mode], vnum);
+    else if (rnum != first + k)
+      send_to_char(ch, "%s #%d is out of order, or there twice.\r\n", what[mode], vnum);
+    else
+      continue;
+    return (FALSE);
+  }
+
+  zr->first[mode] = first;
+  return (TRUE);
+}
+
+
+/* Pass on what was logged while reading a file, to the log and to 'ch'. */
+void reload_messages(struct char_data *ch, struct boot_file *bf)
+{
+  int m;
+
+  for (m = 0; m < bf->num_messages; m++) {
+    log("%s", bf->messages[m].text);
+    send_to_char(ch, "%s\r\n", bf->messages[m].text);
+    free(bf->messages[m].text);
+  }
+  if (bf->messages)
+    free(bf->messages);
+  bf->messages = NULL;
+  bf->num_messages = bf->max_messages = 0;
+}
+
+
+/*
+ * The rooms keep what the game has done with them: who and what is in
+ * them, their light and special procedure, and the house flags.  Exits
+ * into the zone need nothing, since its rooms keep their rnums.
+ */
+void reload_rooms(struct zone_reload *zr)
+{
+  struct room_data *room, *new;
+  bitvector_t keep;
+  int k, door;
+
+  for (k = 0; k < zr->file[DB_BOOT_WLD].parsed; k++) {
+    room = world + zr->first[DB_BOOT_WLD] + k;
+    new = zr->rooms + k;
+
+    keep = room->room_flags & (ROOM_HOUSE | ROOM_HOUSE_CRASH | ROOM_ATRIUM);
+    if (keep & ROOM_HOUSE)
+      keep |= ROOM_PRIVATE;
+
+    release_room_text(room);
+    room->name = new->name;
+    room->description = new->description;
+    room->ex_description = new->ex_description;
+    room->room_flags = new->room_flags | keep;
+    room->sector_type = new->sector_type;
+
+    for (door = 0; door < NUM_OF_DIRS; door++) {
+      room->dir_option[door] = new->dir_option[door];
+      if (room->dir_option[door] && room->dir_option[door]->to_room != NOWHERE)
+	room->dir_option[door]->to_room = real_room(room->dir_option[door]->to_room);
+    }
+  }
+}
+
+
+/*
+ * The mobiles in the game keep their state, but what text they shared
+ * with the old prototype they now share with the new one.
+ */
+void reload_mobiles(struct zone_reload *zr)
+{
+  struct char_data *mob, *proto, *new;
+  int k, n = zr->file[DB_BOOT_MOB].parsed, first = zr->first[DB_BOOT_MOB];
+
+  for (k = 0; k < n; k++) {
+    proto = mob_proto + first + k;
+    new = zr->mobs + k;
+
+    for (mob = mob_index[first + k].mobs; mob; mob = mob->next_instance) {
+      if (mob->player.name == proto->player.name)
+	mob->player.name = new->player.name;
+      if (mob->player.title == proto->player.title)
+	mob->player.title = new->player.title;
+      if (mob->player.short_descr == proto->player.short_descr)
+	mob->player.short_descr = new->player.short_descr;
+      if (mob->player.long_descr == proto->player.long_descr)
+	mob->player.long_descr = new->player.long_descr;
+      if (mob->player.description == proto->player.description)
+	mob->player.description = new->player.description;
+    }
+
+    release_mob_text(proto);
+    *proto = *new;
+    proto->nr = first + k;
+  }
+}
+
+
+/* The same for objects, which share their extra descriptions, too. */
+void reload_objects(struct zone_reload *zr)
+{
+  struct obj_data *obj, *proto, *new;
+  int k, n = zr->file[DB_BOOT_OBJ].parsed, first = zr->first[DB_BOOT_OBJ];
+
+  for (k = 0; k < n; k++) {
+    proto = obj_proto + first + k;
+    new = zr->objs + k;
+
+    for (obj = obj_index[first + k].objs; obj; obj = obj->next_instance) {
+      if (obj->name == proto->name)
+	obj->name = new->name;
+      if (obj->description == proto->description)
+	obj->description = new->description;
+      if (obj->short_description == proto->short_description)
+	obj->short_description = new->short_description;
+      if (obj->action_description == proto->action_description)
+	obj->action_description = new->action_description;
+      if (obj->ex_description == proto->ex_description)
+	obj->ex_description = new->ex_description;
+    }
+
+    release_obj_text(proto);
+    *proto = *new;
+    proto->item_number = first + k;
+  }
+}
+
+
+/* Throw away whatever is left of a reload. */
+void reload_discard(struct zone_reload *zr)
+{
+  int mode, k;
+
+  for (mode = DB_BOOT_WLD; mode <= DB_BOOT_ZON; mode++) {
+    for (k = 0; k < zr->file[mode].records; k++)
+      switch (mode) {
+      case DB_BOOT_WLD:
+	if (zr->rooms)
+	  release_room_text(zr->rooms + k);
+	break;
+      case DB_BOOT_MOB:
+	if (zr->mobs)
+	  release_mob_text(zr->mobs + k);
+	break;
+      case DB_BOOT_OBJ:
+	if (zr->objs)
+	  release_obj_text(zr->objs + k);
+	break;
+      }
+    arena_free(&zr->file[mode].arena);
+    if (zr->file[mode].filename)
+      free(zr->file[mode].filename);
+  }
+
+  if (zr->rooms)
+    free(zr->rooms);
+  if (zr->mobs)
+    free(zr->mobs);
+  if (zr->mob_index)
+    free(zr->mob_index);
+  if (zr->objs)
+    free(zr->objs);
+  if (zr->obj_index)
+    free(zr->obj_index);
+  if (zr->table.name)
+    free(zr->table.name);
+  if (zr->table.cmd)
+    free(zr->table.cmd);
+}
+
+
 void free_extra_descriptions(struct extra_descr_data *edesc)
 {
   struct extra_descr_data *enext;
@@ -280,17 +861,66 @@ void free_extra_descriptions(struct extra_descr_data *edesc)
   for (; edesc; edesc = enext) {
     enext = edesc->next;
 
-    free(edesc->keyword);
-    free(edesc->description);
+    str_release(edesc->keyword);
+    str_release(edesc->description);
     free(edesc);
   }
 }
 
 
+/*
+ * Let go of the text of a room, mobile or object read from the world
+ * files.  What holds the text is in world_arena, or the image.
+ */
+void release_room_text(struct room_data *room)
+{
+  struct extra_descr_data *ed;
+  int door;
+
+  WORLD_FREE_STR(room->name);
+  WORLD_FREE_STR(room->description);
+  for (ed = room->ex_description; ed; ed = ed->next) {
+    WORLD_FREE_STR(ed->keyword);
+    WORLD_FREE_STR(ed->description);
+  }
+  for (door = 0; door < NUM_OF_DIRS; door++)
+    if (room->dir_option[door]) {
+      WORLD_FREE_STR(room->dir_option[door]->general_description);
+      WORLD_FREE_STR(room->dir_option[door]->keyword);
+    }
+}
+
+
+void release_mob_text(struct char_data *mob)
+{
+  WORLD_FREE_STR(mob->player.name);
+  WORLD_FREE_STR(mob->player.title);
+  WORLD_FREE_STR(mob->player.short_descr);
+  WORLD_FREE_STR(mob->player.long_descr);
+  WORLD_FREE_STR(mob->player.description);
+}
+
+
+void release_obj_text(struct obj_data *obj)
+{
+  struct extra_descr_data *ed;
+
+  WORLD_FREE_STR(obj->name);
+  WORLD_FREE_STR(obj->description);
+  WORLD_FREE_STR(obj->short_description);
+  WORLD_FREE_STR(obj->action_description);
+  for (ed = obj->ex_description; ed; ed = ed->next) {
+    WORLD_FREE_STR(ed->keyword);
+    WORLD_FREE_STR(ed->description);
+  }
+}
+
+
 /* Free the world, in a memory allocation sense. */
 void destroy_db(void)
 {
-  ssize_t cnt, itr;
+  ssize_t cnt;
+  int mode;
   struct char_data *chtmp;
   struct obj_data *objtmp;
 
@@ -308,78 +938,58 @@ void destroy_db(void)
     free_obj(objtmp);
   }
 
-  /* Rooms */
-  for (cnt = 0; cnt <= top_of_world; cnt++) {
-    if (world[cnt].name)
-      free(world[cnt].name);
-    if (world[cnt].description)
-      free(world[cnt].description);
-    free_extra_descriptions(world[cnt].ex_description);
-
-    for (itr = 0; itr < NUM_OF_DIRS; itr++) {
-      if (!world[cnt].dir_option[itr])
-        continue;
-
-      if (world[cnt].dir_option[itr]->general_description)
-        free(world[cnt].dir_option[itr]->general_description);
-      if (world[cnt].dir_option[itr]->keyword)
-        free(world[cnt].dir_option[itr]->keyword);
-      free(world[cnt].dir_option[itr]);
-    }
-  }
-  free(world);
-
-  /* Objects */
-  for (cnt = 0; cnt <= top_of_objt; cnt++) {
-    if (obj_proto[cnt].name)
-      free(obj_proto[cnt].name);
-    if (obj_proto[cnt].description)
-      free(obj_proto[cnt].description);
-    if (obj_proto[cnt].short_description)
-      free(obj_proto[cnt].short_description);
-    if (obj_proto[cnt].action_description)
-      free(obj_proto[cnt].action_description);
-    free_extra_descriptions(obj_proto[cnt].ex_description);
-  }
-  free(obj_proto);
-  free(obj_index);
-
-  /* Mobiles */
-  for (cnt = 0; cnt <= top_of_mobt; cnt++) {
-    if (mob_proto[cnt].player.name)
-      free(mob_proto[cnt].player.name);
-    if (mob_proto[cnt].player.title)
-      free(mob_proto[cnt].player.title);
-    if (mob_proto[cnt].player.short_descr)
-      free(mob_proto[cnt].player.short_descr);
-    if (mob_proto[cnt].player.long_descr)
-      free(mob_proto[cnt].player.long_descr);
-    if (mob_proto[cnt].player.description)
-      free(mob_proto[cnt].player.description);
+  /*
+   * Exits and extra descriptions are in world_arena, and all the text is
+   * in the shared string table, unless the whole world is in the image.
+   */
+  WORLD_FREE(world);
+  WORLD_FREE(obj_proto);
+  WORLD_FREE(obj_index);
 
+  for (cnt = 0; cnt <= top_of_mobt; cnt++)
     while (mob_proto[cnt].affected)
       affect_remove(&mob_proto[cnt], mob_proto[cnt].affected);
-  }
-  free(mob_proto);
-  free(mob_index);
+  WORLD_FREE(mob_proto);
+  WORLD_FREE(mob_index);
 
   /* Shops */
   destroy_shops();
 
   /* Zones */
   for (cnt = 0; cnt <= top_of_zone_table; cnt++) {
-    if (zone_table[cnt].name)
-      free(zone_table[cnt].name);
-    if (zone_table[cnt].cmd)
-      free(zone_table[cnt].cmd);
+    WORLD_FREE(zone_table[cnt].name);
+    WORLD_FREE(zone_table[cnt].cmd);
+  }
+  WORLD_FREE(zone_table);
+  if (reset_heap)
+    free(reset_heap);
+  reset_heap = NULL;
+  reset_heap_size = 0;
+  resetting.zone = NOWHERE;
+
+  arena_free(&world_arena);
+  if (reload_arena) {
+    for (cnt = 0; cnt <= top_of_zone_table; cnt++)
+      for (mode = DB_BOOT_WLD; mode <= DB_BOOT_OBJ; mode++)
+	arena_free(&reload_arena[cnt].file[mode]);
+    free(reload_arena);
+    reload_arena = NULL;
   }
-  free(zone_table);
+  str_intern_clear();
+
+  vnum_index_size(&room_vnums, -1);
+  vnum_index_size(&mob_vnums, -1);
+  vnum_index_size(&obj_vnums, -1);
+  vnum_index_size(&zone_vnums, -1);
+
+  world_image_unload();
 }
 
 
 /* body of the booting system */
 void boot_db(void)
 {
+  char filename[PATH_MAX];
   zone_rnum i;
 
   log("Boot db -- BEGIN.");
@@ -405,6 +1015,9 @@ void boot_db(void)
   log("Loading spell definitions.");
   mag_assign_spells();
 
+  log("Indexing the command list.");
+  build_command_trie();
+
   boot_world();
 
   log("Loading help entries.");
@@ -461,12 +1074,23 @@ void boot_db(void)
   }
 
   for (i = 0; i <= top_of_zone_table; i++) {
+    zone_table[i].players = zone_table[i].mortals = zone_table[i].idle = 0;
+    zone_table[i].resident = FALSE;
+    zone_table[i].reset_pos = -1;
+
+    if (ZONE_IDLE_MINUTES > 0) {
+      /* What was saved of it went with the rest of the last game. */
+      snprintf(filename, sizeof(filename), ZONE_SAVE_FILE, zone_table[i].number);
+      remove(filename);
+      continue;
+    }
+
     log("Resetting #%d: %s (rooms %d-%d).", zone_table[i].number,
 	zone_table[i].name, zone_table[i].bot, zone_table[i].top);
     reset_zone(i);
   }
-
-  reset_q.head = reset_q.tail = NULL;
+  if (ZONE_IDLE_MINUTES > 0)
+    log("Zones will be reset as players come into them.");
 
   boot_time = time(0);
 
@@ -555,15 +1179,18 @@ void free_player_index(void)
   free(player_table);
   player_table = NULL;
   top_of_p_table = 0;
+  plrindex_free();
 }
 
 
-/* generate index table for the player file */
+/*
+ * generate index table for the player file, from its index if that's up
+ * to date, or else from the file itself
+ */
 void build_player_index(void)
 {
-  int nr = -1, i;
-  long size, recs;
-  struct char_file_u dummy;
+  long size;
+  int i;
 
   if (!(player_fl = fopen(PLAYER_FILE, "r+b"))) {
     if (errno != ENOENT) {
@@ -579,39 +1206,36 @@ void build_player_index(void)
     }
   }
 
-  fseek(player_fl, 0L, SEEK_END);
-  size = ftell(player_fl);
-  rewind(player_fl);
-  if (size % sizeof(struct char_file_u))
-    log("\aWARNING:  PLAYERFILE IS PROBABLY CORRUPT!");
-  recs = size / sizeof(struct char_file_u);
-  if (recs) {
-    log("   %ld players in database.", recs);
-    CREATE(player_table, struct player_index_element, recs);
-  } else {
-    player_table = NULL;
-    top_of_p_table = -1;
-    return;
+  if (!plrindex_load(PLAYER_INDEX_FILE, player_fl, &player_table, &top_of_p_table)) {
+    fseek(player_fl, 0L, SEEK_END);
+    size = ftell(player_fl);
+    if (size % sizeof(struct char_file_u))
+      log("\aWARNING:  PLAYERFILE IS PROBABLY CORRUPT!");
+    if (size)
+      log("   Player index is out of date; reading the player file.");
+    if (!plrindex_scan(player_fl, &player_table, &top_of_p_table))
+      log("SYSERR: Error reading playerfile.");
+    else
+      plrindex_save(PLAYER_INDEX_FILE, player_fl, player_table, top_of_p_table);
   }
 
-  for (;;) {
-    if (fread(&dummy, sizeof(struct char_file_u), 1, player_fl) != 1) {
-      if (feof(player_fl))
-	break;
-      log("SYSERR: Error reading playerfile.");
-      break;
-    }
+  if (top_of_p_table >= 0)
+    log("   %d players in database.", top_of_p_table + 1);
 
-    /* new record */
-    nr++;
-    CREATE(player_table[nr].name, char, strlen(dummy.name) + 1);
-    for (i = 0; (*(player_table[nr].name + i) = LOWER(*(dummy.name + i))); i++)
-      ;
-    player_table[nr].id = dummy.char_specials_saved.idnum;
-    top_idnum = MAX(top_idnum, dummy.char_specials_saved.idnum);
-  }
+  for (i = 0; i <= top_of_p_table; i++)
+    top_idnum = MAX(top_idnum, player_table[i].id);
+
+  plrindex_attach(&player_table, &top_of_p_table);
 
-  top_of_p_table = nr;
+  if (journal_boot())
+    save_player_index();	/* the player file's changed under it */
+}
+
+
+/* Bring the player file's index up to date, as the game shuts down. */
+void save_player_index(void)
+{
+  plrindex_save(PLAYER_INDEX_FILE, player_fl, player_table, top_of_p_table);
 }
 
 /*
@@ -678,8 +1302,10 @@ void index_boot(int mode)
 {
   const char *index_filename, *prefix = NULL;	/* NULL or egcs 1.1 complains */
   FILE *db_index, *db_file;
-  int rec_count = 0, size[2];
+  int rec_count = 0, size[2], num_files = 0, i, threads = 0;
   char buf2[PATH_MAX], buf1[MAX_STRING_LENGTH];
+  struct boot_file *files = NULL;
+  unsigned long start = perf_now();
 
   switch (mode) {
   case DB_BOOT_WLD:
@@ -733,9 +1359,18 @@ void index_boot(int mode)
     }
     strcpy(buf2, prefix);
     strcat(buf2, buf1);
+
+    /* Remember it; one that won't open now is an error when it's read. */
+    RECREATE(files, struct boot_file, num_files + 1);
+    memset(files + num_files, 0, sizeof(struct boot_file));
+    files[num_files].filename = strdup(buf2);
+    files[num_files].mode = mode;
+    files[num_files].base = rec_count;
+
     if (!(db_file = fopen(buf2, "r"))) {
       log("SYSERR: File '%s' listed in '%s/%s': %s", buf2, prefix,
 	  index_filename, strerror(errno));
+      num_files++;
       if (fscanf(db_index, "%s\n", buf1) != 1) {
 	log("SYSERR: format error in index file '%s'.", index_filename);
 	exit(1);
@@ -743,11 +1378,12 @@ void index_boot(int mode)
       continue;
     } else {
       if (mode == DB_BOOT_ZON)
-	rec_count++;
+	files[num_files].records = 1;
       else if (mode == DB_BOOT_HLP)
-	rec_count += count_alias_records(db_file);
+	files[num_files].records = count_alias_records(db_file);
       else
-	rec_count += count_hash_records(db_file);
+	files[num_files].records = count_hash_records(db_file);
+      rec_count += files[num_files++].records;
     }
 
     fclose(db_file);
@@ -759,8 +1395,14 @@ void index_boot(int mode)
 
   /* Exit if 0 records, unless this is shops */
   if (!rec_count) {
-    if (mode == DB_BOOT_SHP)
+    if (mode == DB_BOOT_SHP) {
+      for (i = 0; i < num_files; i++)
+	free(files[i].filename);
+      if (files)
+	free(files);
+      fclose(db_index);
       return;
+    }
     log("SYSERR: boot error - 0 records counted in %s/%s.", prefix,
 	index_filename);
     exit(1);
@@ -801,63 +1443,76 @@ void index_boot(int mode)
     break;
   }
 
-  rewind(db_index);
-  if (fscanf(db_index, "%s\n", buf1) != 1) {
-    log("SYSERR: format error in index file '%s'.", index_filename);
-    exit(1);
-  }
-  while (*buf1 != '$') {
-    if (strlen(prefix) + strlen(buf1) >= sizeof(buf2)) {
-      log("SYSERR: Index filename too long.");
-      exit(1);
-    }
-    strcpy(buf2, prefix);
-    strcat(buf2, buf1);
-    if (!(db_file = fopen(buf2, "r"))) {
-      log("SYSERR: %s: %s", buf2, strerror(errno));
-      exit(1);
-    }
-    switch (mode) {
-    case DB_BOOT_WLD:
-    case DB_BOOT_OBJ:
-    case DB_BOOT_MOB:
-      discrete_load(db_file, mode, buf2);
-      break;
-    case DB_BOOT_ZON:
-      load_zones(db_file, buf2);
-      break;
-    case DB_BOOT_HLP:
-      /*
-       * If you think about it, we have a race here.  Although, this is the
-       * "point-the-gun-at-your-own-foot" type of race.
-       */
-      load_help(db_file);
-      break;
-    case DB_BOOT_SHP:
-      boot_the_shops(db_file, buf2, rec_count);
-      break;
-    }
+  fclose(db_index);
 
-    fclose(db_file);
-    if (fscanf(db_index, "%s\n", buf1) != 1) {
-      log("SYSERR: format error in index file '%s'.", index_filename);
-      exit(1);
+  switch (mode) {
+  case DB_BOOT_WLD:
+  case DB_BOOT_OBJ:
+  case DB_BOOT_MOB:
+    /*
+     * These don't depend on each other until they're renumbered.  While
+     * they're read the whole table counts as in use, so that the vnums
+     * of the records so far can be looked up to log them.
+     */
+    if (mode == DB_BOOT_WLD)
+      top_of_world = rec_count - 1;
+    else if (mode == DB_BOOT_MOB)
+      top_of_mobt = rec_count - 1;
+    else
+      top_of_objt = rec_count - 1;
+    threads = boot_read_files(files, num_files);
+    boot_merge_files(files, num_files, mode);
+    break;
+  default:
+    for (i = 0; i < num_files; i++) {
+      if (!(db_file = fopen(files[i].filename, "r"))) {
+	log("SYSERR: %s: %s", files[i].filename, strerror(errno));
+	exit(1);
+      }
+      switch (mode) {
+      case DB_BOOT_ZON:
+	load_zones(db_file, files[i].filename);
+	break;
+      case DB_BOOT_HLP:
+	/*
+	 * If you think about it, we have a race here.  Although, this is the
+	 * "point-the-gun-at-your-own-foot" type of race.
+	 */
+	load_help(db_file);
+	break;
+      case DB_BOOT_SHP:
+	boot_the_shops(db_file, files[i].filename, rec_count);
+	break;
+      }
+      fclose(db_file);
     }
+    break;
   }
-  fclose(db_index);
+
+  for (i = 0; i < num_files; i++)
+    free(files[i].filename);
+  free(files);
 
   /* sort the help index */
   if (mode == DB_BOOT_HLP) {
     qsort(help_table, top_of_helpt, sizeof(struct help_index_element), hsort);
     top_of_helpt--;
   }
+
+  if (mode != DB_BOOT_SHP && mode != DB_BOOT_HLP)
+    vnum_index_build(mode);
+
+  if (threads > 1)
+    log("   Read in %lu ms, %d files on %d threads.", (perf_now() - start) / 1000, num_files, threads);
+  else
+    log("   Read in %lu ms.", (perf_now() - start) / 1000);
 }
 
 
-void discrete_load(FILE *fl, int mode, char *filename)
+void discrete_load(struct boot_file *bf, FILE *fl)
 {
-  int nr = -1, last;
-  char line[READ_SIZE];
+  int nr = -1, last, mode = bf->mode;
+  char line[READ_SIZE], *filename = bf->filename;
 
   const char *modes[] = {"world", "mob", "obj"};
 
@@ -869,14 +1524,14 @@ void discrete_load(FILE *fl, int mode, char *filename)
     if (mode != DB_BOOT_OBJ || nr < 0)
       if (!get_line(fl, line)) {
 	if (nr == -1) {
-	  log("SYSERR: %s file %s is empty!", modes[mode], filename);
+	  boot_log("SYSERR: %s file %s is empty!", modes[mode], filename);
 	} else {
-	  log("SYSERR: Format error in %s after %s #%d\n"
+	  boot_log("SYSERR: Format error in %s after %s #%d\n"
 	      "...expecting a new %s, but file ended!\n"
 	      "(maybe the file is not terminated with '$'?)", filename,
 	      modes[mode], nr, modes[mode]);
 	}
-	exit(1);
+	boot_exit();
       }
     if (*line == '$')
       return;
@@ -884,32 +1539,291 @@ void discrete_load(FILE *fl, int mode, char *filename)
     if (*line == '#') {
       last = nr;
       if (sscanf(line, "#%d", &nr) != 1) {
-	log("SYSERR: Format error after %s #%d", modes[mode], last);
-	exit(1);
+	boot_log("SYSERR: Format error after %s #%d", modes[mode], last);
+	boot_exit();
       }
       if (nr >= 99999)
 	return;
       else
 	switch (mode) {
 	case DB_BOOT_WLD:
-	  parse_room(fl, nr);
+	  parse_room(bf, fl, nr);
 	  break;
 	case DB_BOOT_MOB:
-	  parse_mobile(fl, nr);
+	  parse_mobile(bf, fl, nr);
 	  break;
 	case DB_BOOT_OBJ:
-	  strlcpy(line, parse_object(fl, nr), sizeof(line));
+	  strlcpy(line, parse_object(bf, fl, nr), sizeof(line));
 	  break;
 	}
     } else {
-      log("SYSERR: Format error in %s file %s near %s #%d", modes[mode],
+      boot_log("SYSERR: Format error in %s file %s near %s #%d", modes[mode],
 	  filename, modes[mode], nr);
-      log("SYSERR: ... offending line: '%s'", line);
+      boot_log("SYSERR: ... offending line: '%s'", line);
+      boot_exit();
+    }
+  }
+}
+
+
+/*
+ * log() for the world files: what's logged while a file is being read
+ * is kept with it, to be logged by boot_merge_files() in the order it
+ * would have been had the files been read one after another.
+ */
+void boot_log(const char *format, ...)
+{
+  struct boot_file *bf = boot_file_self();
+  char text[MAX_STRING_LENGTH];
+  va_list args;
+
+  va_start(args, format);
+  if (!bf)
+    basic_mud_vlog(format, args);
+  else {
+    vsnprintf(text, sizeof(text), format, args);
+    if (bf->num_messages == bf->max_messages) {
+      bf->max_messages = (bf->max_messages ? bf->max_messages * 2 : 8);
+      RECREATE(bf->messages, struct boot_message, bf->max_messages);
+    }
+    bf->messages[bf->num_messages].record = bf->parsed;
+    bf->messages[bf->num_messages++].text = strdup(text);
+  }
+  va_end(args);
+}
+
+
+/* exit(1) for the world files: give up on this one, and later the boot. */
+void boot_exit(void)
+{
+  struct boot_file *bf = boot_file_self();
+
+  if (!bf)
+    exit(1);
+
+  bf->failed = TRUE;
+  longjmp(bf->error, 1);
+}
+
+
+/* The file this thread is reading, if any. */
+struct boot_file *boot_file_self(void)
+{
+#ifdef CIRCLE_BOOT_THREADS
+  return (boot_self_made ? (struct boot_file *) pthread_getspecific(boot_self) : NULL);
+#else
+  return (boot_self);
+#endif
+}
+
+
+void boot_set_self(struct boot_file *bf)
+{
+#ifdef CIRCLE_BOOT_THREADS
+  /* The first call is always on the main thread, before any others. */
+  if (!boot_self_made) {
+    pthread_key_create(&boot_self, NULL);
+    boot_self_made = TRUE;
+  }
+  pthread_setspecific(boot_self, bf);
+#else
+  boot_self = bf;
+#endif
+}
+
+
+void boot_read_file(struct boot_file *bf)
+{
+  unsigned long start = perf_now();
+  FILE *fl;
+
+  boot_set_self(bf);
+  if (!setjmp(bf->error)) {
+    if (!(fl = fopen(bf->filename, "r"))) {
+      boot_log("SYSERR: %s: %s", bf->filename, strerror(errno));
+      boot_exit();
+    }
+    discrete_load(bf, fl);
+    fclose(fl);
+  }
+  boot_set_self(NULL);
+  bf->usec = perf_now() - start;
+}
+
+
+#ifdef CIRCLE_BOOT_THREADS
+void *boot_thread_loop(void *arg __attribute__((unused)))
+{
+  int i;
+
+  for (;;) {
+    pthread_mutex_lock(&boot_lock);
+    i = boot_next++;
+    pthread_mutex_unlock(&boot_lock);
+
+    if (i >= boot_queued)
+      break;
+    boot_read_file(boot_queue + i);
+  }
+
+  return (NULL);
+}
+#endif
+
+
+/*
+ * Read every file, on as many threads as will help, and return how many
+ * that was.  Every one is read even if an earlier one is bad, so that
+ * what's logged doesn't depend on which thread got there first.
+ */
+int boot_read_files(struct boot_file *files, int num)
+{
+  int i, threads = 1;
+
+#ifdef CIRCLE_BOOT_THREADS
+  pthread_t *thread;
+  int err;
+
+  boot_set_self(NULL);
+
+  if ((threads = BOOT_THREADS) <= 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    threads = 1;
+#endif
+  }
+  threads = MAX(1, MIN(threads, num));
+
+  if (threads > 1) {
+    boot_queue = files;
+    boot_queued = num;
+    boot_next = 0;
+
+    /* This thread is one of them. */
+    CREATE(thread, pthread_t, threads - 1);
+    for (i = 0; i < threads - 1; i++)
+      if ((err = pthread_create(thread + i, NULL, boot_thread_loop, NULL)) != 0) {
+	log("SYSERR: pthread_create: %s", strerror(err));
+	break;
+      }
+    boot_thread_loop(NULL);
+    threads = i + 1;
+    while (i--)
+      pthread_join(thread[i], NULL);
+    free(thread);
+
+    return (threads);
+  }
+#endif
+
+  for (i = 0; i < num; i++)
+    boot_read_file(files + i);
+
+  return (threads);
+}
+
+
+/*
+ * Rooms are put in zones in the order they come, as they used to be while
+ * reading them; the zones have to cover the vnums in order, too.
+ */
+void boot_room_zone(room_rnum room, zone_rnum *zone)
+{
+  room_vnum virtual_nr = world[room].number;
+
+  if (virtual_nr < zone_table[*zone].bot) {
+    log("SYSERR: Room #%d is below zone %d.", virtual_nr, *zone);
+    exit(1);
+  }
+  while (virtual_nr > zone_table[*zone].top)
+    if (++*zone > top_of_zone_table) {
+      log("SYSERR: Room %d is outside of any zone.", virtual_nr);
       exit(1);
     }
+  world[room].zone = *zone;
+}
+
+
+/*
+ * Log what each file logged and stop at the first bad one, just as if
+ * they had been read in order, and close up the gaps files left at the
+ * end of their stretches of the table.
+ */
+void boot_merge_files(struct boot_file *files, int num, int mode)
+{
+  struct boot_file *bf;
+  zone_rnum zone = 0;
+  int i, j, m, top = 0;
+
+  for (bf = files; bf < files + num; bf++) {
+    for (m = j = 0; j <= bf->parsed; j++) {
+      if (mode == DB_BOOT_WLD && j < bf->started)
+	boot_room_zone(bf->base + j, &zone);
+      for (; m < bf->num_messages && bf->messages[m].record == j; m++)
+	log("%s", bf->messages[m].text);
+    }
+    for (m = 0; m < bf->num_messages; m++)
+      free(bf->messages[m].text);
+    if (bf->messages)
+      free(bf->messages);
+
+    if (bf->failed)
+      exit(1);
+
+    arena_merge(&world_arena, &bf->arena);
+
+    if (bf->base != top)
+      switch (mode) {
+      case DB_BOOT_WLD:
+	memmove(world + top, world + bf->base, sizeof(struct room_data) * bf->parsed);
+	break;
+      case DB_BOOT_MOB:
+	memmove(mob_index + top, mob_index + bf->base, sizeof(struct index_data) * bf->parsed);
+	memmove(mob_proto + top, mob_proto + bf->base, sizeof(struct char_data) * bf->parsed);
+	for (i = top; i < top + bf->parsed; i++)
+	  mob_proto[i].nr = i;
+	break;
+      case DB_BOOT_OBJ:
+	memmove(obj_index + top, obj_index + bf->base, sizeof(struct index_data) * bf->parsed);
+	memmove(obj_proto + top, obj_proto + bf->base, sizeof(struct obj_data) * bf->parsed);
+	for (i = top; i < top + bf->parsed; i++)
+	  obj_proto[i].item_number = i;
+	break;
+      }
+    top += bf->parsed;
+  }
+
+  switch (mode) {
+  case DB_BOOT_WLD:
+    top_of_world = top - 1;
+    break;
+  case DB_BOOT_MOB:
+    top_of_mobt = top - 1;
+    break;
+  case DB_BOOT_OBJ:
+    top_of_objt = top - 1;
+    break;
   }
 }
 
+
+/* fname() has the one buffer, for all the threads reading world files. */
+int starts_with_article(const char *str)
+{
+  char word[4];
+  int i;
+
+  for (i = 0; i < 3 && isalpha(str[i]); i++)
+    word[i] = str[i];
+  if (isalpha(str[i]))
+    return (FALSE);
+  word[i] = '\0';
+
+  return (!str_cmp(word, "a") || !str_cmp(word, "an") || !str_cmp(word, "the"));
+}
+
+
 bitvector_t asciiflag_conv(char *flag)
 {
   bitvector_t flags = 0;
@@ -934,9 +1848,9 @@ bitvector_t asciiflag_conv(char *flag)
 
 
 /* load the rooms */
-void parse_room(FILE *fl, int virtual_nr)
+void parse_room(struct boot_file *bf, FILE *fl, int virtual_nr)
 {
-  static int room_nr = 0, zone = 0;
+  room_rnum room_nr = bf->base + bf->parsed;
   int t[10], i;
   char line[READ_SIZE], flags[128], buf2[MAX_STRING_LENGTH], buf[128];
   struct extra_descr_data *new_descr;
@@ -944,30 +1858,22 @@ void parse_room(FILE *fl, int virtual_nr)
   /* This really had better fit or there are other problems. */
   snprintf(buf2, sizeof(buf2), "room #%d", virtual_nr);
 
-  if (virtual_nr < zone_table[zone].bot) {
-    log("SYSERR: Room #%d is below zone %d.", virtual_nr, zone);
-    exit(1);
-  }
-  while (virtual_nr > zone_table[zone].top)
-    if (++zone > top_of_zone_table) {
-      log("SYSERR: Room %d is outside of any zone.", virtual_nr);
-      exit(1);
-    }
-  world[room_nr].zone = zone;
+  /* Its zone is found by boot_room_zone(), once all the files are in. */
   world[room_nr].number = virtual_nr;
-  world[room_nr].name = fread_string(fl, buf2);
-  world[room_nr].description = fread_string(fl, buf2);
+  bf->started++;
+  world[room_nr].name = str_intern(fread_string(fl, buf2));
+  world[room_nr].description = str_intern(fread_string(fl, buf2));
 
   if (!get_line(fl, line)) {
-    log("SYSERR: Expecting roomflags/sector type of room #%d but file ended!",
+    boot_log("SYSERR: Expecting roomflags/sector type of room #%d but file ended!",
 	virtual_nr);
-    exit(1);
+    boot_exit();
   }
 
   if (sscanf(line, " %d %s %d ", t, flags, t + 2) != 3) {
-    log("SYSERR: Format error in roomflags/sector type of room #%d",
+    boot_log("SYSERR: Format error in roomflags/sector type of room #%d",
 	virtual_nr);
-    exit(1);
+    boot_exit();
   }
   /* t[0] is the zone number; ignored with the zone-file system */
 
@@ -991,26 +1897,26 @@ void parse_room(FILE *fl, int virtual_nr)
 
   for (;;) {
     if (!get_line(fl, line)) {
-      log("%s", buf);
-      exit(1);
+      boot_log("%s", buf);
+      boot_exit();
     }
     switch (*line) {
     case 'D':
-      setup_dir(fl, room_nr, atoi(line + 1));
+      setup_dir(bf, fl, room_nr, atoi(line + 1));
       break;
     case 'E':
-      CREATE(new_descr, struct extra_descr_data, 1);
-      new_descr->keyword = fread_string(fl, buf2);
-      new_descr->description = fread_string(fl, buf2);
+      ARENA_CREATE(new_descr, &bf->arena, struct extra_descr_data, 1);
+      new_descr->keyword = str_intern(fread_string(fl, buf2));
+      new_descr->description = str_intern(fread_string(fl, buf2));
       new_descr->next = world[room_nr].ex_description;
       world[room_nr].ex_description = new_descr;
       break;
     case 'S':			/* end of room */
-      top_of_world = room_nr++;
+      bf->parsed++;
       return;
     default:
-      log("%s", buf);
-      exit(1);
+      boot_log("%s", buf);
+      boot_exit();
     }
   }
 }
@@ -1018,24 +1924,24 @@ void parse_room(FILE *fl, int virtual_nr)
 
 
 /* read direction data */
-void setup_dir(FILE *fl, int room, int dir)
+void setup_dir(struct boot_file *bf, FILE *fl, int room, int dir)
 {
   int t[5];
   char line[READ_SIZE], buf2[128];
 
   snprintf(buf2, sizeof(buf2), "room #%d, direction D%d", GET_ROOM_VNUM(room), dir);
 
-  CREATE(world[room].dir_option[dir], struct room_direction_data, 1);
-  world[room].dir_option[dir]->general_description = fread_string(fl, buf2);
-  world[room].dir_option[dir]->keyword = fread_string(fl, buf2);
+  ARENA_CREATE(world[room].dir_option[dir], &bf->arena, struct room_direction_data, 1);
+  world[room].dir_option[dir]->general_description = str_intern(fread_string(fl, buf2));
+  world[room].dir_option[dir]->keyword = str_intern(fread_string(fl, buf2));
 
   if (!get_line(fl, line)) {
-    log("SYSERR: Format error, %s", buf2);
-    exit(1);
+    boot_log("SYSERR: Format error, %s", buf2);
+    boot_exit();
   }
   if (sscanf(line, " %d %d %d ", t, t + 1, t + 2) != 3) {
-    log("SYSERR: Format error, %s", buf2);
-    exit(1);
+    boot_log("SYSERR: Format error, %s", buf2);
+    boot_exit();
   }
   if (t[0] == 1)
     world[room].dir_option[dir]->exit_info = EX_ISDOOR;
@@ -1097,55 +2003,63 @@ void renum_world(void)
  * NOTE 2: Assumes sizeof(room_rnum) >= (sizeof(mob_rnum) and sizeof(obj_rnum))
  */
 void renum_zone_table(void)
+{
+  zone_rnum zone;
+
+  for (zone = 0; zone <= top_of_zone_table; zone++)
+    renum_zone(zone);
+}
+
+
+/* The same for one zone, which might have just been reloaded. */
+void renum_zone(zone_rnum zone)
 {
   int cmd_no;
   room_rnum a, b, c, olda, oldb, oldc;
-  zone_rnum zone;
   char buf[128];
 
-  for (zone = 0; zone <= top_of_zone_table; zone++)
-    for (cmd_no = 0; ZCMD.command != 'S'; cmd_no++) {
-      a = b = c = 0;
-      olda = ZCMD.arg1;
-      oldb = ZCMD.arg2;
-      oldc = ZCMD.arg3;
-      switch (ZCMD.command) {
-      case 'M':
-	a = ZCMD.arg1 = real_mobile(ZCMD.arg1);
+  for (cmd_no = 0; ZCMD.command != 'S'; cmd_no++) {
+    a = b = c = 0;
+    olda = ZCMD.arg1;
+    oldb = ZCMD.arg2;
+    oldc = ZCMD.arg3;
+    switch (ZCMD.command) {
+    case 'M':
+      a = ZCMD.arg1 = real_mobile(ZCMD.arg1);
+      c = ZCMD.arg3 = real_room(ZCMD.arg3);
+      break;
+    case 'O':
+      a = ZCMD.arg1 = real_object(ZCMD.arg1);
+      if (ZCMD.arg3 != NOWHERE)
 	c = ZCMD.arg3 = real_room(ZCMD.arg3);
-	break;
-      case 'O':
-	a = ZCMD.arg1 = real_object(ZCMD.arg1);
-	if (ZCMD.arg3 != NOWHERE)
-	  c = ZCMD.arg3 = real_room(ZCMD.arg3);
-	break;
-      case 'G':
-	a = ZCMD.arg1 = real_object(ZCMD.arg1);
-	break;
-      case 'E':
-	a = ZCMD.arg1 = real_object(ZCMD.arg1);
-	break;
-      case 'P':
-	a = ZCMD.arg1 = real_object(ZCMD.arg1);
-	c = ZCMD.arg3 = real_object(ZCMD.arg3);
-	break;
-      case 'D':
-	a = ZCMD.arg1 = real_room(ZCMD.arg1);
-	break;
-      case 'R': /* rem obj from room */
-        a = ZCMD.arg1 = real_room(ZCMD.arg1);
-	b = ZCMD.arg2 = real_object(ZCMD.arg2);
-        break;
-      }
-      if (a == NOWHERE || b == NOWHERE || c == NOWHERE) {
-	if (!mini_mud) {
-	  snprintf(buf, sizeof(buf), "Invalid vnum %d, cmd disabled",
-			 a == NOWHERE ? olda : b == NOWHERE ? oldb : oldc);
-	  log_zone_error(zone, cmd_no, buf);
-	}
-	ZCMD.command = '*';
+      break;
+    case 'G':
+      a = ZCMD.arg1 = real_object(ZCMD.arg1);
+      break;
+    case 'E':
+      a = ZCMD.arg1 = real_object(ZCMD.arg1);
+      break;
+    case 'P':
+      a = ZCMD.arg1 = real_object(ZCMD.arg1);
+      c = ZCMD.arg3 = real_object(ZCMD.arg3);
+      break;
+    case 'D':
+      a = ZCMD.arg1 = real_room(ZCMD.arg1);
+      break;
+    case 'R': /* rem obj from room */
+      a = ZCMD.arg1 = real_room(ZCMD.arg1);
+      b = ZCMD.arg2 = real_object(ZCMD.arg2);
+      break;
+    }
+    if (a == NOWHERE || b == NOWHERE || c == NOWHERE) {
+      if (!mini_mud) {
+	snprintf(buf, sizeof(buf), "Invalid vnum %d, cmd disabled",
+		       a == NOWHERE ? olda : b == NOWHERE ? oldb : oldc);
+	log_zone_error(zone, cmd_no, buf);
       }
+      ZCMD.command = '*';
     }
+  }
 }
 
 
@@ -1163,15 +2077,15 @@ void parse_simple_mob(FILE *mob_f, int i, int nr)
   mob_proto[i].real_abils.cha = 11;
 
   if (!get_line(mob_f, line)) {
-    log("SYSERR: Format error in mob #%d, file ended after S flag!", nr);
-    exit(1);
+    boot_log("SYSERR: Format error in mob #%d, file ended after S flag!", nr);
+    boot_exit();
   }
 
   if (sscanf(line, " %d %d %d %dd%d+%d %dd%d+%d ",
 	  t, t + 1, t + 2, t + 3, t + 4, t + 5, t + 6, t + 7, t + 8) != 9) {
-    log("SYSERR: Format error in mob #%d, first line after S flag\n"
+    boot_log("SYSERR: Format error in mob #%d, first line after S flag\n"
 	"...expecting line of form '# # # #d#+# #d#+#'", nr);
-    exit(1);
+    boot_exit();
   }
 
   GET_LEVEL(mob_proto + i) = t[0];
@@ -1192,30 +2106,30 @@ void parse_simple_mob(FILE *mob_f, int i, int nr)
   GET_DAMROLL(mob_proto + i) = t[8];
 
   if (!get_line(mob_f, line)) {
-      log("SYSERR: Format error in mob #%d, second line after S flag\n"
+      boot_log("SYSERR: Format error in mob #%d, second line after S flag\n"
 	  "...expecting line of form '# #', but file ended!", nr);
-      exit(1);
+      boot_exit();
     }
 
   if (sscanf(line, " %d %d ", t, t + 1) != 2) {
-    log("SYSERR: Format error in mob #%d, second line after S flag\n"
+    boot_log("SYSERR: Format error in mob #%d, second line after S flag\n"
 	"...expecting line of form '# #'", nr);
-    exit(1);
+    boot_exit();
   }
 
   GET_GOLD(mob_proto + i) = t[0];
   GET_EXP(mob_proto + i) = t[1];
 
   if (!get_line(mob_f, line)) {
-    log("SYSERR: Format error in last line of mob #%d\n"
+    boot_log("SYSERR: Format error in last line of mob #%d\n"
 	"...expecting line of form '# # #', but file ended!", nr);
-    exit(1);
+    boot_exit();
   }
 
   if (sscanf(line, " %d %d %d ", t, t + 1, t + 2) != 3) {
-    log("SYSERR: Format error in last line of mob #%d\n"
+    boot_log("SYSERR: Format error in last line of mob #%d\n"
 	"...expecting line of form '# # #'", nr);
-    exit(1);
+    boot_exit();
   }
 
   GET_POS(mob_proto + i) = t[0];
@@ -1306,7 +2220,7 @@ void interpret_espec(const char *keyword, const char *value, int i, int nr)
   }
 
   if (!matched) {
-    log("SYSERR: Warning: unrecognized espec keyword %s in mob #%d",
+    boot_log("SYSERR: Warning: unrecognized espec keyword %s in mob #%d",
 	    keyword, nr);
   }    
 }
@@ -1338,27 +2252,27 @@ void parse_enhanced_mob(FILE *mob_f, int i, int nr)
     if (!strcmp(line, "E"))	/* end of the enhanced section */
       return;
     else if (*line == '#') {	/* we've hit the next mob, maybe? */
-      log("SYSERR: Unterminated E section in mob #%d", nr);
-      exit(1);
+      boot_log("SYSERR: Unterminated E section in mob #%d", nr);
+      boot_exit();
     } else
       parse_espec(line, i, nr);
   }
 
-  log("SYSERR: Unexpected end of file reached after mob #%d", nr);
-  exit(1);
+  boot_log("SYSERR: Unexpected end of file reached after mob #%d", nr);
+  boot_exit();
 }
 
 
-void parse_mobile(FILE *mob_f, int nr)
+void parse_mobile(struct boot_file *bf, FILE *mob_f, int nr)
 {
-  static int i = 0;
-  int j, t[10];
+  int i = bf->base + bf->parsed, j, t[10];
   char line[READ_SIZE], *tmpptr, letter;
   char f1[128], f2[128], buf2[128];
 
   mob_index[i].vnum = nr;
   mob_index[i].number = 0;
   mob_index[i].func = NULL;
+  bf->started++;
 
   clear_char(mob_proto + i);
 
@@ -1371,21 +2285,20 @@ void parse_mobile(FILE *mob_f, int nr)
   sprintf(buf2, "mob vnum %d", nr);	/* sprintf: OK (for 'buf2 >= 19') */
 
   /***** String data *****/
-  mob_proto[i].player.name = fread_string(mob_f, buf2);
-  tmpptr = mob_proto[i].player.short_descr = fread_string(mob_f, buf2);
-  if (tmpptr && *tmpptr)
-    if (!str_cmp(fname(tmpptr), "a") || !str_cmp(fname(tmpptr), "an") ||
-	!str_cmp(fname(tmpptr), "the"))
-      *tmpptr = LOWER(*tmpptr);
-  mob_proto[i].player.long_descr = fread_string(mob_f, buf2);
-  mob_proto[i].player.description = fread_string(mob_f, buf2);
+  mob_proto[i].player.name = str_intern(fread_string(mob_f, buf2));
+  tmpptr = fread_string(mob_f, buf2);
+  if (tmpptr && *tmpptr && starts_with_article(tmpptr))
+    *tmpptr = LOWER(*tmpptr);
+  mob_proto[i].player.short_descr = str_intern(tmpptr);
+  mob_proto[i].player.long_descr = str_intern(fread_string(mob_f, buf2));
+  mob_proto[i].player.description = str_intern(fread_string(mob_f, buf2));
   GET_TITLE(mob_proto + i) = NULL;
 
   /* *** Numeric data *** */
   if (!get_line(mob_f, line)) {
-    log("SYSERR: Format error after string section of mob #%d\n"
+    boot_log("SYSERR: Format error after string section of mob #%d\n"
 	"...expecting line of form '# # # {S | E}', but file ended!", nr);
-    exit(1);
+    boot_exit();
   }
 
 #ifdef CIRCLE_ACORN	/* Ugh. */
@@ -1393,16 +2306,16 @@ void parse_mobile(FILE *mob_f, int nr)
 #else
   if (sscanf(line, "%s %s %d %c", f1, f2, t + 2, &letter) != 4) {
 #endif
-    log("SYSERR: Format error after string section of mob #%d\n"
+    boot_log("SYSERR: Format error after string section of mob #%d\n"
 	"...expecting line of form '# # # {S | E}'", nr);
-    exit(1);
+    boot_exit();
   }
 
   MOB_FLAGS(mob_proto + i) = asciiflag_conv(f1);
   SET_BIT(MOB_FLAGS(mob_proto + i), MOB_ISNPC);
   if (MOB_FLAGGED(mob_proto + i, MOB_NOTDEADYET)) {
     /* Rather bad to load mobiles with this bit already set. */
-    log("SYSERR: Mob #%d has reserved bit MOB_NOTDEADYET set.", nr);
+    boot_log("SYSERR: Mob #%d has reserved bit MOB_NOTDEADYET set.", nr);
     REMOVE_BIT(MOB_FLAGS(mob_proto + i), MOB_NOTDEADYET);
   }
   check_bitvector_names(MOB_FLAGS(mob_proto + i), action_bits_count, buf2, "mobile");
@@ -1414,7 +2327,7 @@ void parse_mobile(FILE *mob_f, int nr)
 
   /* AGGR_TO_ALIGN is ignored if the mob is AGGRESSIVE. */
   if (MOB_FLAGGED(mob_proto + i, MOB_AGGRESSIVE) && MOB_FLAGGED(mob_proto + i, MOB_AGGR_GOOD | MOB_AGGR_EVIL | MOB_AGGR_NEUTRAL))
-    log("SYSERR: Mob #%d both Aggressive and Aggressive_to_Alignment.", nr);
+    boot_log("SYSERR: Mob #%d both Aggressive and Aggressive_to_Alignment.", nr);
 
   switch (UPPER(letter)) {
   case 'S':	/* Simple monsters */
@@ -1425,8 +2338,8 @@ void parse_mobile(FILE *mob_f, int nr)
     break;
   /* add new mob types here.. */
   default:
-    log("SYSERR: Unsupported mob type '%c' in mob #%d", letter, nr);
-    exit(1);
+    boot_log("SYSERR: Unsupported mob type '%c' in mob #%d", letter, nr);
+    boot_exit();
   }
 
   mob_proto[i].aff_abils = mob_proto[i].real_abils;
@@ -1437,18 +2350,17 @@ void parse_mobile(FILE *mob_f, int nr)
   mob_proto[i].nr = i;
   mob_proto[i].desc = NULL;
 
-  top_of_mobt = i++;
+  bf->parsed++;
 }
 
 
 
 
 /* read all objects from obj file; generate index and prototypes */
-char *parse_object(FILE *obj_f, int nr)
+char *parse_object(struct boot_file *bf, FILE *obj_f, int nr)
 {
-  static int i = 0;
-  static char line[READ_SIZE];
-  int t[10], j, retval;
+  int i = bf->base + bf->parsed, t[10], j, retval;
+  char *line = bf->line;
   char *tmpptr;
   char f1[READ_SIZE], f2[READ_SIZE], buf2[128];
   struct extra_descr_data *new_descr;
@@ -1456,6 +2368,7 @@ char *parse_object(FILE *obj_f, int nr)
   obj_index[i].vnum = nr;
   obj_index[i].number = 0;
   obj_index[i].func = NULL;
+  bf->started++;
 
   clear_object(obj_proto + i);
   obj_proto[i].item_number = i;
@@ -1463,29 +2376,29 @@ char *parse_object(FILE *obj_f, int nr)
   sprintf(buf2, "object #%d", nr);	/* sprintf: OK (for 'buf2 >= 19') */
 
   /* *** string data *** */
-  if ((obj_proto[i].name = fread_string(obj_f, buf2)) == NULL) {
-    log("SYSERR: Null obj name or format error at or near %s", buf2);
-    exit(1);
+  if ((obj_proto[i].name = str_intern(fread_string(obj_f, buf2))) == NULL) {
+    boot_log("SYSERR: Null obj name or format error at or near %s", buf2);
+    boot_exit();
   }
-  tmpptr = obj_proto[i].short_description = fread_string(obj_f, buf2);
-  if (tmpptr && *tmpptr)
-    if (!str_cmp(fname(tmpptr), "a") || !str_cmp(fname(tmpptr), "an") ||
-	!str_cmp(fname(tmpptr), "the"))
-      *tmpptr = LOWER(*tmpptr);
+  tmpptr = fread_string(obj_f, buf2);
+  if (tmpptr && *tmpptr && starts_with_article(tmpptr))
+    *tmpptr = LOWER(*tmpptr);
+  obj_proto[i].short_description = str_intern(tmpptr);
 
-  tmpptr = obj_proto[i].description = fread_string(obj_f, buf2);
+  tmpptr = fread_string(obj_f, buf2);
   if (tmpptr && *tmpptr)
     CAP(tmpptr);
-  obj_proto[i].action_description = fread_string(obj_f, buf2);
+  obj_proto[i].description = str_intern(tmpptr);
+  obj_proto[i].action_description = str_intern(fread_string(obj_f, buf2));
 
   /* *** numeric data *** */
   if (!get_line(obj_f, line)) {
-    log("SYSERR: Expecting first numeric line of %s, but file ended!", buf2);
-    exit(1);
+    boot_log("SYSERR: Expecting first numeric line of %s, but file ended!", buf2);
+    boot_exit();
   }
   if ((retval = sscanf(line, " %d %s %s", t, f1, f2)) != 3) {
-    log("SYSERR: Format error in first numeric line (expecting 3 args, got %d), %s", retval, buf2);
-    exit(1);
+    boot_log("SYSERR: Format error in first numeric line (expecting 3 args, got %d), %s", retval, buf2);
+    boot_exit();
   }
 
   /* Object flags checked in check_object(). */
@@ -1494,12 +2407,12 @@ char *parse_object(FILE *obj_f, int nr)
   GET_OBJ_WEAR(obj_proto + i) = asciiflag_conv(f2);
 
   if (!get_line(obj_f, line)) {
-    log("SYSERR: Expecting second numeric line of %s, but file ended!", buf2);
-    exit(1);
+    boot_log("SYSERR: Expecting second numeric line of %s, but file ended!", buf2);
+    boot_exit();
   }
   if ((retval = sscanf(line, "%d %d %d %d", t, t + 1, t + 2, t + 3)) != 4) {
-    log("SYSERR: Format error in second numeric line (expecting 4 args, got %d), %s", retval, buf2);
-    exit(1);
+    boot_log("SYSERR: Format error in second numeric line (expecting 4 args, got %d), %s", retval, buf2);
+    boot_exit();
   }
   GET_OBJ_VAL(obj_proto + i, 0) = t[0];
   GET_OBJ_VAL(obj_proto + i, 1) = t[1];
@@ -1507,12 +2420,12 @@ char *parse_object(FILE *obj_f, int nr)
   GET_OBJ_VAL(obj_proto + i, 3) = t[3];
 
   if (!get_line(obj_f, line)) {
-    log("SYSERR: Expecting third numeric line of %s, but file ended!", buf2);
-    exit(1);
+    boot_log("SYSERR: Expecting third numeric line of %s, but file ended!", buf2);
+    boot_exit();
   }
   if ((retval = sscanf(line, "%d %d %d", t, t + 1, t + 2)) != 3) {
-    log("SYSERR: Format error in third numeric line (expecting 3 args, got %d), %s", retval, buf2);
-    exit(1);
+    boot_log("SYSERR: Format error in third numeric line (expecting 3 args, got %d), %s", retval, buf2);
+    boot_exit();
   }
   GET_OBJ_WEIGHT(obj_proto + i) = t[0];
   GET_OBJ_COST(obj_proto + i) = t[1];
@@ -1537,33 +2450,33 @@ char *parse_object(FILE *obj_f, int nr)
 
   for (;;) {
     if (!get_line(obj_f, line)) {
-      log("SYSERR: Format error in %s", buf2);
-      exit(1);
+      boot_log("SYSERR: Format error in %s", buf2);
+      boot_exit();
     }
     switch (*line) {
     case 'E':
-      CREATE(new_descr, struct extra_descr_data, 1);
-      new_descr->keyword = fread_string(obj_f, buf2);
-      new_descr->description = fread_string(obj_f, buf2);
+      ARENA_CREATE(new_descr, &bf->arena, struct extra_descr_data, 1);
+      new_descr->keyword = str_intern(fread_string(obj_f, buf2));
+      new_descr->description = str_intern(fread_string(obj_f, buf2));
       new_descr->next = obj_proto[i].ex_description;
       obj_proto[i].ex_description = new_descr;
       break;
     case 'A':
       if (j >= MAX_OBJ_AFFECT) {
-	log("SYSERR: Too many A fields (%d max), %s", MAX_OBJ_AFFECT, buf2);
-	exit(1);
+	boot_log("SYSERR: Too many A fields (%d max), %s", MAX_OBJ_AFFECT, buf2);
+	boot_exit();
       }
       if (!get_line(obj_f, line)) {
-	log("SYSERR: Format error in 'A' field, %s\n"
+	boot_log("SYSERR: Format error in 'A' field, %s\n"
 	    "...expecting 2 numeric constants but file ended!", buf2);
-	exit(1);
+	boot_exit();
       }
 
       if ((retval = sscanf(line, " %d %d ", t, t + 1)) != 2) {
-	log("SYSERR: Format error in 'A' field, %s\n"
+	boot_log("SYSERR: Format error in 'A' field, %s\n"
 	    "...expecting 2 numeric arguments, got %d\n"
 	    "...offending line: '%s'", buf2, retval, line);
-	exit(1);
+	boot_exit();
       }
       obj_proto[i].affected[j].location = t[0];
       obj_proto[i].affected[j].modifier = t[1];
@@ -1572,22 +2485,31 @@ char *parse_object(FILE *obj_f, int nr)
     case '$':
     case '#':
       check_object(obj_proto + i);
-      top_of_objt = i++;
+      bf->parsed++;
       return (line);
     default:
-      log("SYSERR: Format error in (%c): %s", *line, buf2);
-      exit(1);
+      boot_log("SYSERR: Format error in (%c): %s", *line, buf2);
+      boot_exit();
     }
   }
 }
 
 
-#define Z	zone_table[zone]
-
 /* load the zone table and command tables */
 void load_zones(FILE *fl, char *zonename)
 {
   static zone_rnum zone = 0;
+
+  parse_zone(fl, zonename, zone_table + zone);
+  top_of_zone_table = zone++;
+}
+
+
+#define Z	(*zone)
+
+/* Read one zone file into 'zone', which doesn't have to be in the table. */
+void parse_zone(FILE *fl, char *zonename, struct zone_data *zone)
+{
   int cmd_no, num_of_cmds = 0, line_num = 0, tmp, error;
   char *ptr, buf[READ_SIZE], zname[READ_SIZE], buf2[MAX_STRING_LENGTH];
 
@@ -1608,16 +2530,16 @@ void load_zones(FILE *fl, char *zonename)
   rewind(fl);
 
   if (num_of_cmds == 0) {
-    log("SYSERR: %s is empty!", zname);
-    exit(1);
+    boot_log("SYSERR: %s is empty!", zname);
+    boot_exit();
   } else
     CREATE(Z.cmd, struct reset_com, num_of_cmds);
 
   line_num += get_line(fl, buf);
 
   if (sscanf(buf, "#%hd", &Z.number) != 1) {
-    log("SYSERR: Format error in %s, line %d", zname, line_num);
-    exit(1);
+    boot_log("SYSERR: Format error in %s, line %d", zname, line_num);
+    boot_exit();
   }
   snprintf(buf2, sizeof(buf2), "beginning of zone #%d", Z.number);
 
@@ -1628,60 +2550,59 @@ void load_zones(FILE *fl, char *zonename)
 
   line_num += get_line(fl, buf);
   if (sscanf(buf, " %hd %hd %d %d ", &Z.bot, &Z.top, &Z.lifespan, &Z.reset_mode) != 4) {
-    log("SYSERR: Format error in numeric constant line of %s", zname);
-    exit(1);
+    boot_log("SYSERR: Format error in numeric constant line of %s", zname);
+    boot_exit();
   }
   if (Z.bot > Z.top) {
-    log("SYSERR: Zone %d bottom (%d) > top (%d).", Z.number, Z.bot, Z.top);
-    exit(1);
+    boot_log("SYSERR: Zone %d bottom (%d) > top (%d).", Z.number, Z.bot, Z.top);
+    boot_exit();
   }
 
   cmd_no = 0;
 
   for (;;) {
     if ((tmp = get_line(fl, buf)) == 0) {
-      log("SYSERR: Format error in %s - premature end of file", zname);
-      exit(1);
+      boot_log("SYSERR: Format error in %s - premature end of file", zname);
+      boot_exit();
     }
     line_num += tmp;
     ptr = buf;
     skip_spaces(&ptr);
 
-    if ((ZCMD.command = *ptr) == '*')
+    if ((Z.cmd[cmd_no].command = *ptr) == '*')
       continue;
 
     ptr++;
 
-    if (ZCMD.command == 'S' || ZCMD.command == '$') {
-      ZCMD.command = 'S';
+    if (Z.cmd[cmd_no].command == 'S' || Z.cmd[cmd_no].command == '$') {
+      Z.cmd[cmd_no].command = 'S';
       break;
     }
     error = 0;
-    if (strchr("MOEPD", ZCMD.command) == NULL) {	/* a 3-arg command */
-      if (sscanf(ptr, " %d %d %d ", &tmp, &ZCMD.arg1, &ZCMD.arg2) != 3)
+    if (strchr("MOEPD", Z.cmd[cmd_no].command) == NULL) {	/* a 3-arg command */
+      if (sscanf(ptr, " %d %d %d ", &tmp, &Z.cmd[cmd_no].arg1,
+		 &Z.cmd[cmd_no].arg2) != 3)
 	error = 1;
     } else {
-      if (sscanf(ptr, " %d %d %d %d ", &tmp, &ZCMD.arg1, &ZCMD.arg2,
-		 &ZCMD.arg3) != 4)
+      if (sscanf(ptr, " %d %d %d %d ", &tmp, &Z.cmd[cmd_no].arg1,
+		 &Z.cmd[cmd_no].arg2, &Z.cmd[cmd_no].arg3) != 4)
 	error = 1;
     }
 
-    ZCMD.if_flag = tmp;
+    Z.cmd[cmd_no].if_flag = tmp;
 
     if (error) {
-      log("SYSERR: Format error in %s, line %d: '%s'", zname, line_num, buf);
-      exit(1);
+      boot_log("SYSERR: Format error in %s, line %d: '%s'", zname, line_num, buf);
+      boot_exit();
     }
-    ZCMD.line = line_num;
+    Z.cmd[cmd_no].line = line_num;
     cmd_no++;
   }
 
   if (num_of_cmds != cmd_no + 1) {
-    log("SYSERR: Zone command count mismatch for %s. Estimated: %d, Actual: %d", zname, num_of_cmds, cmd_no + 1);
-    exit(1);
+    boot_log("SYSERR: Zone command count mismatch for %s. Estimated: %d, Actual: %d", zname, num_of_cmds, cmd_no + 1);
+    boot_exit();
   }
-
-  top_of_zone_table = zone++;
 }
 
 #undef Z
@@ -1868,6 +2789,9 @@ struct char_data *read_mobile(mob_vnum nr, int type) /* and mob_rnum */
   mob->player.time.logon = time(0);
 
   mob_index[i].number++;
+  ADD_INSTANCE(mob, mob_index[i].mobs);
+
+  MOB_EVENT(mob) = event_create(mobile_activity, mob, rand_number(1, PULSE_MOBILE));
 
   return (mob);
 }
@@ -1905,82 +2829,154 @@ struct obj_data *read_object(obj_vnum nr, int type) /* and obj_rnum */
   object_list = obj;
 
   obj_index[i].number++;
+  ADD_INSTANCE(obj, obj_index[i].objs);
 
   return (obj);
 }
 
 
 
-#define ZO_DEAD  999
+/* Put 'e' at 'pos' in the reset heap, and tell its zone where it is. */
+void reset_heap_set(int pos, struct reset_entry e)
+{
+  reset_heap[pos] = e;
+  zone_table[e.zone].reset_pos = pos;
+}
+
+
+void reset_heap_up(int pos)
+{
+  struct reset_entry e = reset_heap[pos];
+  int parent;
+
+  for (; pos > 0 && reset_heap[parent = (pos - 1) / 2].due > e.due; pos = parent)
+    reset_heap_set(pos, reset_heap[parent]);
+  reset_heap_set(pos, e);
+}
+
 
-/* update zone ages, queue for reset if necessary, and dequeue when possible */
-void zone_update(void)
+void reset_heap_down(int pos)
 {
-  int i;
-  struct reset_q_element *update_u, *temp;
-  static int timer = 0;
+  struct reset_entry e = reset_heap[pos];
+  int child;
 
-  /* jelson 10/22/92 */
-  if (((++timer * PULSE_ZONE) / PASSES_PER_SEC) >= 60) {
-    /* one minute has passed */
-    /*
-     * NOT accurate unless PULSE_ZONE is a multiple of PASSES_PER_SEC or a
-     * factor of 60
-     */
+  while ((child = pos * 2 + 1) < reset_heap_size) {
+    if (child + 1 < reset_heap_size && reset_heap[child + 1].due < reset_heap[child].due)
+      child++;
+    if (reset_heap[child].due >= e.due)
+      break;
+    reset_heap_set(pos, reset_heap[child]);
+    pos = child;
+  }
+  reset_heap_set(pos, e);
+}
+
+
+/* Have 'zone' reset on pulse 'due', whether or not it was to already. */
+void zone_schedule(zone_rnum zone, unsigned long due)
+{
+  struct reset_entry e;
+  int pos = zone_table[zone].reset_pos;
 
-    timer = 0;
+  if (pos < 0) {
+    if (!reset_heap)
+      CREATE(reset_heap, struct reset_entry, top_of_zone_table + 1);
+    pos = reset_heap_size++;
+  }
+
+  e.due = due;
+  e.zone = zone;
+  reset_heap_set(pos, e);
+  reset_heap_up(pos);
+  reset_heap_down(zone_table[zone].reset_pos);
+}
 
-    /* since one minute has passed, increment zone ages */
-    for (i = 0; i <= top_of_zone_table; i++) {
-      if (zone_table[i].age < zone_table[i].lifespan &&
-	  zone_table[i].reset_mode)
-	(zone_table[i].age)++;
 
-      if (zone_table[i].age >= zone_table[i].lifespan &&
-	  zone_table[i].age < ZO_DEAD && zone_table[i].reset_mode) {
-	/* enqueue zone */
+void zone_unschedule(zone_rnum zone)
+{
+  int pos = zone_table[zone].reset_pos;
+  zone_rnum moved;
 
-	CREATE(update_u, struct reset_q_element, 1);
+  if (pos < 0)
+    return;
 
-	update_u->zone_to_reset = i;
-	update_u->next = 0;
+  zone_table[zone].reset_pos = -1;
+  if (pos == --reset_heap_size)
+    return;
 
-	if (!reset_q.head)
-	  reset_q.head = reset_q.tail = update_u;
-	else {
-	  reset_q.tail->next = update_u;
-	  reset_q.tail = update_u;
-	}
+  /* The last one takes its place, and goes up or down from there. */
+  moved = reset_heap[reset_heap_size].zone;
+  reset_heap_set(pos, reset_heap[reset_heap_size]);
+  reset_heap_up(pos);
+  reset_heap_down(zone_table[moved].reset_pos);
+}
+
+
+/* The next reset of 'zone' is a lifespan after its last, if it resets. */
+void zone_reschedule(zone_rnum zone)
+{
+  struct zone_data *z = zone_table + zone;
+
+  if (z->reset_mode)
+    zone_schedule(zone, z->reset_at + MAX(z->lifespan, 1) * 60 RL_SEC);
+  else
+    zone_unschedule(zone);
+}
+
+
+/* Minutes since 'zone' was last reset, for "show zone". */
+int zone_age(zone_rnum zone)
+{
+  if (!zone_table[zone].resident)
+    return (0);
+
+  return ((event_pulse - zone_table[zone].reset_at) / (60 RL_SEC));
+}
+
+
+/*
+ * Called every pulse: resets the zones that are due, soonest due first,
+ * in no more than RESET_BUDGET_USEC.  One with mortals in it that may
+ * only be reset empty is looked at again every PULSE_ZONE.  Once a minute
+ * it unloads the zones no player's been in for ZONE_IDLE_MINUTES.
+ */
+void zone_update(void)
+{
+  unsigned long deadline = perf_now() + RESET_BUDGET_USEC;
+  zone_rnum zone;
+
+  if (ZONE_IDLE_MINUTES > 0 && !(event_pulse % (60 RL_SEC)))
+    for (zone = 0; zone <= top_of_zone_table; zone++)
+      if (zone_table[zone].resident && !zone_table[zone].players &&
+	  ++zone_table[zone].idle >= ZONE_IDLE_MINUTES)
+	zone_unload(zone);
 
-	zone_table[i].age = ZO_DEAD;
+  for (;;) {
+    if (resetting.zone == NOWHERE) {
+      if (!reset_heap_size || reset_heap[0].due > event_pulse)
+	return;
+
+      zone = reset_heap[0].zone;
+      if (zone_table[zone].reset_mode != 2 && !is_empty(zone)) {
+	zone_schedule(zone, event_pulse + PULSE_ZONE);
+	continue;
       }
+      zone_unschedule(zone);
+      reset_start(&resetting, zone);
     }
-  }	/* end - one minute has passed */
-
-
-  /* dequeue zones (if possible) and reset */
-  /* this code is executed every 10 seconds (i.e. PULSE_ZONE) */
-  for (update_u = reset_q.head; update_u; update_u = update_u->next)
-    if (zone_table[update_u->zone_to_reset].reset_mode == 2 ||
-	is_empty(update_u->zone_to_reset)) {
-      reset_zone(update_u->zone_to_reset);
-      mudlog(CMP, LVL_GOD, FALSE, "Auto zone reset: %s", zone_table[update_u->zone_to_reset].name);
-      /* dequeue */
-      if (update_u == reset_q.head)
-	reset_q.head = reset_q.head->next;
-      else {
-	for (temp = reset_q.head; temp->next != update_u;
-	     temp = temp->next);
-
-	if (!update_u->next)
-	  reset_q.tail = temp;
-
-	temp->next = update_u->next;
-      }
 
-      free(update_u);
-      break;
-    }
+    if (!reset_zone_cmds(&resetting, deadline))
+      return;
+
+    zone = resetting.zone;
+    resetting.zone = NOWHERE;
+    zone_table[zone].reset_at = event_pulse;
+    zone_reschedule(zone);
+    mudlog(CMP, LVL_GOD, FALSE, "Auto zone reset: %s", zone_table[zone].name);
+
+    if (perf_now() >= deadline)
+      return;
+  }
 }
 
 void log_zone_error(zone_rnum zone, int cmd_no, const char *message)
@@ -1993,14 +2989,74 @@ void log_zone_error(zone_rnum zone, int cmd_no, const char *message)
 #define ZONE_ERROR(message) \
 	{ log_zone_error(zone, cmd_no, message); last_cmd = 0; }
 
-/* execute the reset command table of a given zone */
+void reset_start(struct reset_state *rs, zone_rnum zone)
+{
+  rs->zone = zone;
+  rs->cmd_no = 0;
+  rs->last_cmd = 0;
+  rs->mob = NULL;
+  rs->mob_nr = NOBODY;
+  rs->mob_gone = FALSE;
+}
+
+
+/* execute the reset command table of a given zone, all at once */
 void reset_zone(zone_rnum zone)
 {
-  int cmd_no, last_cmd = 0;
-  struct char_data *mob = NULL;
+  struct reset_state rs;
+
+  /* One under way for it is as good as done, after this. */
+  if (resetting.zone == zone)
+    resetting.zone = NOWHERE;
+
+  /* What it had when it was unloaded comes back first, to be counted. */
+  if (!zone_table[zone].resident) {
+    zone_table[zone].resident = TRUE;
+    if (ZONE_IDLE_MINUTES > 0)
+      zone_restore(zone);
+  }
+
+  reset_start(&rs, zone);
+  reset_zone_cmds(&rs, 0);
+
+  zone_table[zone].reset_at = event_pulse;
+  zone_reschedule(zone);
+}
+
+
+/*
+ * Run a zone's reset commands from where 'rs' left off, until they're
+ * done, when it returns TRUE, or perf_now() reaches 'deadline' (0 for
+ * never).  It stops only before a command that doesn't depend on the
+ * one before, and always runs at least one.
+ */
+int reset_zone_cmds(struct reset_state *rs, unsigned long deadline)
+{
+  zone_rnum zone = rs->zone;
+  int cmd_no, last_cmd = rs->last_cmd, ran = FALSE;
+  struct char_data *mob = rs->mob, *ch;
   struct obj_data *obj, *obj_to;
 
-  for (cmd_no = 0; ZCMD.command != 'S'; cmd_no++) {
+  /* The mobile last loaded may have died since the last slice. */
+  if (mob) {
+    for (ch = mob_index[rs->mob_nr].mobs; ch && ch != mob; ch = ch->next_instance);
+    if (!ch || MOB_FLAGGED(ch, MOB_NOTDEADYET)) {
+      mob = NULL;
+      rs->mob_gone = TRUE;
+    }
+  }
+
+  for (cmd_no = rs->cmd_no; ZCMD.command != 'S'; cmd_no++) {
+
+    if (deadline && ran && !ZCMD.if_flag && perf_now() >= deadline) {
+      rs->cmd_no = cmd_no;
+      rs->last_cmd = last_cmd;
+      rs->mob = mob;
+      rs->mob_nr = (mob ? GET_MOB_RNUM(mob) : NOBODY);
+      return (FALSE);
+    }
+    ran = TRUE;
+
 
     if (ZCMD.if_flag && !last_cmd)
       continue;
@@ -2054,6 +3110,10 @@ void reset_zone(zone_rnum zone)
       break;
 
     case 'G':			/* obj_to_char */
+      if (!mob && rs->mob_gone) {	/* killed since the last slice */
+	last_cmd = 0;
+	break;
+      }
       if (!mob) {
 	ZONE_ERROR("attempt to give obj to non-existant mob, command disabled");
 	ZCMD.command = '*';
@@ -2068,6 +3128,10 @@ void reset_zone(zone_rnum zone)
       break;
 
     case 'E':			/* object to equipment list */
+      if (!mob && rs->mob_gone) {
+	last_cmd = 0;
+	break;
+      }
       if (!mob) {
 	ZONE_ERROR("trying to equip non-existant mob, command disabled");
 	ZCMD.command = '*';
@@ -2128,34 +3192,259 @@ void reset_zone(zone_rnum zone)
     }
   }
 
-  zone_table[zone].age = 0;
+  return (TRUE);
 }
 
 
 
-/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's  */
+/* for use in zone_update; return TRUE if zone 'nr' is free of mortals */
 int is_empty(zone_rnum zone_nr)
 {
-  struct descriptor_data *i;
+  return (!zone_table[zone_nr].mortals);
+}
 
-  for (i = descriptor_list; i; i = i->next) {
-    if (STATE(i) != CON_PLAYING)
-      continue;
-    if (IN_ROOM(i->character) == NOWHERE)
+
+
+
+
+/* Keep count of the players in each zone, and load one they come into. */
+void zone_player_enters(struct char_data *ch, zone_rnum zone)
+{
+  zone_table[zone].players++;
+  zone_table[zone].idle = 0;
+
+  /* Going by its level now, since that can change before it leaves. */
+  if ((ch->char_specials.zone_mortal = (GET_LEVEL(ch) < LVL_IMMORT)))
+    zone_table[zone].mortals++;
+
+  if (!zone_table[zone].resident) {
+    reset_zone(zone);
+    mudlog(CMP, LVL_GOD, FALSE, "Zone loaded: %s", zone_table[zone].name);
+  }
+}
+
+
+void zone_player_leaves(struct char_data *ch, zone_rnum zone)
+{
+  zone_table[zone].players--;
+  if (ch->char_specials.zone_mortal)
+    zone_table[zone].mortals--;
+}
+
+
+/*
+ * Unload a zone no player has been in for ZONE_IDLE_MINUTES.  The objects
+ * in its rooms are saved, and then they and its mobiles, with whatever
+ * those have, are extracted; the mobiles come back with its resets when
+ * it is next come into.  Pets are left where they are, as is anything in
+ * a house, which is saved with the house.  Returns FALSE, leaving the zone
+ * as it is, if it has to stay loaded: while a mobile there has what its
+ * resets wouldn't give back, such as a shopkeeper's stock or what a
+ * scavenger picked up, the zone keeps it.
+ */
+int zone_unload(zone_rnum zone)
+{
+  struct zone_data *z = zone_table + zone;
+  struct char_data *ch, *next_ch;
+  char filename[PATH_MAX];
+  room_rnum room;
+  FILE *fl = NULL;
+  int vnum, i, ok = TRUE;
+
+  if (!z->reset_mode)
+    return (FALSE);
+
+  /* A corpse can't be saved, but won't be there long. */
+  for (vnum = z->bot; vnum <= z->top; vnum++) {
+    if ((room = real_room(vnum)) == NOWHERE || ROOM_FLAGGED(room, ROOM_HOUSE))
       continue;
-    if (GET_LEVEL(i->character) >= LVL_IMMORT)
+    if (!zone_storable(world[room].contents))
+      return (FALSE);
+    for (ch = world[room].people; ch; ch = ch->next_in_room)
+      if (zone_unloads_mob(ch) && zone_mob_keeps(zone, ch))
+	return (FALSE);
+  }
+
+  snprintf(filename, sizeof(filename), ZONE_SAVE_FILE, z->number);
+  for (vnum = z->bot; ok && vnum <= z->top; vnum++) {
+    if ((room = real_room(vnum)) == NOWHERE || ROOM_FLAGGED(room, ROOM_HOUSE) || !world[room].contents)
       continue;
-    if (world[IN_ROOM(i->character)].zone != zone_nr)
+    if (!fl && !(fl = fopen(filename, "wb"))) {
+      log("SYSERR: Can't write %s to unload zone %d: %s", filename, z->number, strerror(errno));
+      ok = FALSE;
+    } else
+      ok = zone_save_objs(world[room].contents, fl, vnum, 0);
+  }
+  if (fl && (fclose(fl) || !ok)) {
+    log("SYSERR: Error writing %s; zone %d stays loaded.", filename, z->number);
+    ok = FALSE;
+  }
+  if (!ok) {
+    remove(filename);
+    z->idle = 0;		/* try again in a while */
+    return (FALSE);
+  }
+
+  for (vnum = z->bot; vnum <= z->top; vnum++) {
+    if ((room = real_room(vnum)) == NOWHERE || ROOM_FLAGGED(room, ROOM_HOUSE))
       continue;
 
-    return (0);
+    for (ch = world[room].people; ch; ch = next_ch) {
+      next_ch = ch->next_in_room;
+      if (!zone_unloads_mob(ch))
+	continue;
+      while (ch->carrying)
+	extract_obj(ch->carrying);
+      for (i = 0; i < NUM_WEARS; i++)
+	if (GET_EQ(ch, i))
+	  extract_obj(GET_EQ(ch, i));
+      extract_char(ch);
+    }
+
+    while (world[room].contents)
+      extract_obj(world[room].contents);
   }
 
-  return (1);
+  if (resetting.zone == zone)
+    resetting.zone = NOWHERE;
+  zone_unschedule(zone);
+  z->resident = FALSE;
+  mudlog(CMP, LVL_GOD, FALSE, "Zone unloaded: %s", z->name);
+
+  return (TRUE);
+}
+
+
+/* Whether zone_unload() takes 'ch' away: not players, switched or pets. */
+int zone_unloads_mob(struct char_data *ch)
+{
+  return (IS_NPC(ch) && !ch->desc && !MOB_FLAGGED(ch, MOB_NOTDEADYET) &&
+	(!ch->master || IS_NPC(ch->master)));
+}
+
+
+/*
+ * Whether the mobile 'ch' has something the zone's resets wouldn't give
+ * it back: a shopkeeper's stock and takings, or whatever it picked up or
+ * was given.
+ */
+int zone_mob_keeps(zone_rnum zone, struct char_data *ch)
+{
+  struct obj_data *obj;
+  int i;
+
+  if (GET_MOB_SPEC(ch) == shop_keeper)
+    return (TRUE);
+
+  for (obj = ch->carrying; obj; obj = obj->next_content)
+    if (!zone_gives(zone, obj))
+      return (TRUE);
+  for (i = 0; i < NUM_WEARS; i++)
+    if (GET_EQ(ch, i) && !zone_gives(zone, GET_EQ(ch, i)))
+      return (TRUE);
+
+  return (FALSE);
+}
+
+
+/* Whether the zone's resets give 'obj', and all that's in it, to mobiles. */
+int zone_gives(zone_rnum zone, struct obj_data *obj)
+{
+  struct reset_com *c;
+
+  for (c = zone_table[zone].cmd; c->command != 'S'; c++)
+    if (strchr("GEP", c->command) && c->arg1 == GET_OBJ_RNUM(obj))
+      break;
+  if (c->command == 'S')
+    return (FALSE);
+
+  for (obj = obj->contains; obj; obj = obj->next_content)
+    if (!zone_gives(zone, obj))
+      return (FALSE);
+
+  return (TRUE);
+}
+
+
+/* Is everything in the list 'obj' one that can be saved? */
+int zone_storable(struct obj_data *obj)
+{
+  for (; obj; obj = obj->next_content)
+    if (GET_OBJ_RNUM(obj) == NOTHING || !zone_storable(obj->contains))
+      return (FALSE);
+
+  return (TRUE);
+}
+
+
+/*
+ * Save the objects in the list 'obj', last first so they're in the same
+ * order when read back, each just before what's in it.  Each is saved
+ * without the weight of its contents, which is added back as they're put
+ * into it.
+ */
+int zone_save_objs(struct obj_data *obj, FILE *fl, room_vnum room, int depth)
+{
+  struct obj_data *in;
+  int weight = 0, ok;
+
+  if (!obj)
+    return (TRUE);
+  if (!zone_save_objs(obj->next_content, fl, room, depth))
+    return (FALSE);
+
+  for (in = obj->contains; in; in = in->next_content)
+    weight += GET_OBJ_WEIGHT(in);
+
+  GET_OBJ_WEIGHT(obj) -= weight;
+  ok = (fwrite(&room, sizeof(room_vnum), 1, fl) == 1 &&
+	fwrite(&depth, sizeof(int), 1, fl) == 1 && Obj_to_store(obj, fl, 0));
+  GET_OBJ_WEIGHT(obj) += weight;
+
+  return (ok && zone_save_objs(obj->contains, fl, room, depth + 1));
 }
 
 
+/* Put back what was saved when the zone was unloaded. */
+void zone_restore(zone_rnum zone)
+{
+  struct obj_data *obj, *in[ZONE_SAVE_DEPTH + 1] = { NULL };
+  struct obj_file_elem object;
+  char filename[PATH_MAX];
+  room_vnum vnum;
+  room_rnum room;
+  FILE *fl;
+  int depth, location;
+
+  snprintf(filename, sizeof(filename), ZONE_SAVE_FILE, zone_table[zone].number);
+  if (!(fl = fopen(filename, "rb")))
+    return;
+
+  while (fread(&vnum, sizeof(room_vnum), 1, fl) == 1 && fread(&depth, sizeof(int), 1, fl) == 1 &&
+	fread(&object, sizeof(struct obj_file_elem), 1, fl) == 1) {
+    /* Anything whose prototype or room is gone is gone, too. */
+    obj = Obj_from_store(object, &location);
+    if (depth < 0 || depth >= ZONE_SAVE_DEPTH)
+      depth = 0;
+    in[depth + 1] = NULL;
+    if (!(in[depth] = obj))
+      continue;
+
+    if (depth && in[depth - 1])
+      obj_to_obj(obj, in[depth - 1]);
+    else if ((room = real_room(vnum)) != NOWHERE)
+      obj_to_room(obj, room);
+    else {
+      extract_obj(obj);
+      in[depth] = NULL;
+    }
+  }
+  if (ferror(fl))
+    log("SYSERR: Error reading %s: %s", filename, strerror(errno));
 
+  fclose(fl);
+  remove(filename);
+}
 
 
 /*************************************************************************
@@ -2165,13 +3454,7 @@ int is_empty(zone_rnum zone_nr)
 
 long get_ptable_by_name(const char *name)
 {
-  int i;
-
-  for (i = 0; i <= top_of_p_table; i++)
-    if (!str_cmp(player_table[i].name, name))
-      return (i);
-
-  return (-1);
+  return (plrindex_by_name(name));
 }
 
 
@@ -2179,11 +3462,10 @@ long get_id_by_name(const char *name)
 {
   int i;
 
-  for (i = 0; i <= top_of_p_table; i++)
-    if (!str_cmp(player_table[i].name, name))
-      return (player_table[i].id);
+  if ((i = plrindex_by_name(name)) < 0)
+    return (-1);
 
-  return (-1);
+  return (player_table[i].id);
 }
 
 
@@ -2191,11 +3473,10 @@ char *get_name_by_id(long id)
 {
   int i;
 
-  for (i = 0; i <= top_of_p_table; i++)
-    if (player_table[i].id == id)
-      return (player_table[i].name);
+  if ((i = plrindex_by_id(id)) < 0)
+    return (NULL);
 
-  return (NULL);
+  return (player_table[i].name);
 }
 
 
@@ -2205,8 +3486,8 @@ int load_char(const char *name, struct char_file_u *char_element)
   int player_i;
 
   if ((player_i = get_ptable_by_name(name)) >= 0) {
-    fseek(player_fl, player_i * sizeof(struct char_file_u), SEEK_SET);
-    if (fread(char_element, sizeof(struct char_file_u), 1, player_fl) != 1)
+    saver_wait(PLAYER_FILE);
+    if (!saver_read_at(player_fl, player_i * sizeof(struct char_file_u), char_element, sizeof(struct char_file_u)))
       return (-1);
     else
       return (player_i);
@@ -2231,13 +3512,28 @@ void save_char(struct char_data *ch)
   if (IS_NPC(ch) || !ch->desc || GET_PFILEPOS(ch) < 0)
     return;
 
-  char_to_store(ch, &st);
+  char_to_record(ch, &st);
+  journal_char_saved(ch, &st);
+  save_char_record(GET_PFILEPOS(ch), &st);
+  REMOVE_BIT(GET_DIRTY(ch), DIRTY_RECORD);
+}
+
+
+/* What save_char() writes for 'ch', who has a descriptor. */
+void char_to_record(struct char_data *ch, struct char_file_u *st)
+{
+  memset(st, 0, sizeof(struct char_file_u));	/* no stray bytes to journal */
+  char_to_store(ch, st);
+
+  strncpy(st->host, ch->desc->host, HOST_LENGTH);	/* strncpy: OK (s.host:HOST_LENGTH+1) */
+  st->host[HOST_LENGTH] = '\0';
+}
 
-  strncpy(st.host, ch->desc->host, HOST_LENGTH);	/* strncpy: OK (s.host:HOST_LENGTH+1) */
-  st.host[HOST_LENGTH] = '\0';
 
-  fseek(player_fl, GET_PFILEPOS(ch) * sizeof(struct char_file_u), SEEK_SET);
-  fwrite(&st, sizeof(struct char_file_u), 1, player_fl);
+/* Write 'st' over the player file's record 'pos', in the background. */
+void save_char_record(int pos, struct char_file_u *st)
+{
+  saver_write_at(PLAYER_FILE, player_fl, pos * sizeof(struct char_file_u), st, sizeof(struct char_file_u));
 }
 
 
@@ -2316,7 +3612,7 @@ void store_to_char(struct char_file_u *st, struct char_data *ch)
 /* copy vital data from a players char-structure to the file structure */
 void char_to_store(struct char_data *ch, struct char_file_u *st)
 {
-  int i;
+  int i, dirty = IS_NPC(ch) ? 0 : GET_DIRTY(ch);
   struct affected_type *af;
   struct obj_data *char_eq[NUM_WEARS];
 
@@ -2412,6 +3708,10 @@ void char_to_store(struct char_data *ch, struct char_file_u *st)
       equip_char(ch, char_eq[i], i);
   }
 /*   affect_total(ch); unnecessary, I think !?! */
+
+  /* Taking it all off and putting it back on changed nothing. */
+  if (!IS_NPC(ch))
+    GET_DIRTY(ch) = dirty;
 }				/* Char to store */
 
 
@@ -2432,10 +3732,14 @@ int create_entry(char *name)
 {
   int i, pos;
 
+  /* An old entry keeps its name, which is this one, and its idnum. */
+  if ((pos = get_ptable_by_name(name)) != -1)
+    return (pos);
+
   if (top_of_p_table == -1) {	/* no table */
     CREATE(player_table, struct player_index_element, 1);
     pos = top_of_p_table = 0;
-  } else if ((pos = get_ptable_by_name(name)) == -1) {	/* new name */
+  } else {			/* new name */
     i = ++top_of_p_table + 1;
 
     RECREATE(player_table, struct player_index_element, i);
@@ -2447,6 +3751,8 @@ int create_entry(char *name)
   /* copy lowercase equivalent of name to table field */
   for (i = 0; (player_table[pos].name[i] = LOWER(name[i])); i++)
 	/* Nothing */;
+  player_table[pos].id = 0;
+  plrindex_add(pos);
 
   return (pos);
 }
@@ -2469,8 +3775,8 @@ char *fread_string(FILE *fl, const char *error)
 
   do {
     if (!fgets(tmp, 512, fl)) {
-      log("SYSERR: fread_string: format error at or near %s", error);
-      exit(1);
+      boot_log("SYSERR: fread_string: format error at or near %s", error);
+      boot_exit();
     }
     /* If there is a '~', end the string; else put an "\r\n" over the '\n'. */
     if ((point = strchr(tmp, '~')) != NULL) {
@@ -2486,9 +3792,9 @@ char *fread_string(FILE *fl, const char *error)
     templength = strlen(tmp);
 
     if (length + templength >= MAX_STRING_LENGTH) {
-      log("SYSERR: fread_string: string too large (db.c)");
-      log("%s", error);
-      exit(1);
+      boot_log("SYSERR: fread_string: string too large (db.c)");
+      boot_log("%s", error);
+      boot_exit();
     } else {
       strcat(buf + length, tmp);	/* strcat: OK (size checked above) */
       length += templength;
@@ -2506,6 +3812,8 @@ void free_char(struct char_data *ch)
   int i;
   struct alias_data *a;
 
+  event_cancel(MOB_EVENT(ch));
+
   if (ch->player_specials != NULL && ch->player_specials != &dummy_mob) {
     while ((a = GET_ALIASES(ch)) != NULL) {
       GET_ALIASES(ch) = (GET_ALIASES(ch))->next;
@@ -2515,6 +3823,7 @@ void free_char(struct char_data *ch)
       free(ch->player_specials->poofin);
     if (ch->player_specials->poofout)
       free(ch->player_specials->poofout);
+    journal_free(ch);
     free(ch->player_specials);
     if (IS_NPC(ch))
       log("SYSERR: Mob %s (#%d) had player_specials allocated!", GET_NAME(ch), GET_MOB_VNUM(ch));
@@ -2522,27 +3831,27 @@ void free_char(struct char_data *ch)
   if (!IS_NPC(ch) || (IS_NPC(ch) && GET_MOB_RNUM(ch) == NOBODY)) {
     /* if this is a player, or a non-prototyped non-player, free all */
     if (GET_NAME(ch))
-      free(GET_NAME(ch));
+      str_release(GET_NAME(ch));
     if (ch->player.title)
-      free(ch->player.title);
+      str_release(ch->player.title);
     if (ch->player.short_descr)
-      free(ch->player.short_descr);
+      str_release(ch->player.short_descr);
     if (ch->player.long_descr)
-      free(ch->player.long_descr);
+      str_release(ch->player.long_descr);
     if (ch->player.description)
-      free(ch->player.description);
+      str_release(ch->player.description);
   } else if ((i = GET_MOB_RNUM(ch)) != NOBODY) {
     /* otherwise, free strings only if the string is not pointing at proto */
     if (ch->player.name && ch->player.name != mob_proto[i].player.name)
-      free(ch->player.name);
+      str_release(ch->player.name);
     if (ch->player.title && ch->player.title != mob_proto[i].player.title)
-      free(ch->player.title);
+      str_release(ch->player.title);
     if (ch->player.short_descr && ch->player.short_descr != mob_proto[i].player.short_descr)
-      free(ch->player.short_descr);
+      str_release(ch->player.short_descr);
     if (ch->player.long_descr && ch->player.long_descr != mob_proto[i].player.long_descr)
-      free(ch->player.long_descr);
+      str_release(ch->player.long_descr);
     if (ch->player.description && ch->player.description != mob_proto[i].player.description)
-      free(ch->player.description);
+      str_release(ch->player.description);
   }
   while (ch->affected)
     affect_remove(ch, ch->affected);
@@ -2563,24 +3872,24 @@ void free_obj(struct obj_data *obj)
 
   if ((nr = GET_OBJ_RNUM(obj)) == NOTHING) {
     if (obj->name)
-      free(obj->name);
+      str_release(obj->name);
     if (obj->description)
-      free(obj->description);
+      str_release(obj->description);
     if (obj->short_description)
-      free(obj->short_description);
+      str_release(obj->short_description);
     if (obj->action_description)
-      free(obj->action_description);
+      str_release(obj->action_description);
     if (obj->ex_description)
       free_extra_descriptions(obj->ex_description);
   } else {
     if (obj->name && obj->name != obj_proto[nr].name)
-      free(obj->name);
+      str_release(obj->name);
     if (obj->description && obj->description != obj_proto[nr].description)
-      free(obj->description);
+      str_release(obj->description);
     if (obj->short_description && obj->short_description != obj_proto[nr].short_description)
-      free(obj->short_description);
+      str_release(obj->short_description);
     if (obj->action_description && obj->action_description != obj_proto[nr].action_description)
-      free(obj->action_description);
+      str_release(obj->action_description);
     if (obj->ex_description && obj->ex_description != obj_proto[nr].ex_description)
       free_extra_descriptions(obj->ex_description);
   }
@@ -2797,7 +4106,7 @@ void init_char(struct char_data *ch)
   }
 
   if ((i = get_ptable_by_name(GET_NAME(ch))) != -1)
-    player_table[i].id = GET_IDNUM(ch) = ++top_idnum;
+    plrindex_set_id(i, GET_IDNUM(ch) = ++top_idnum);
   else
     log("SYSERR: init_char: Character '%s' not found in player table.", GET_NAME(ch));
 
@@ -2829,11 +4138,84 @@ void init_char(struct char_data *ch)
 
 
 
+/* Empty 'vi' and make room in it for vnums up to 'top'; -1 frees it. */
+void vnum_index_size(struct vnum_index *vi, int top)
+{
+  int i;
+
+  if (vi->rnum)
+    free(vi->rnum);
+  vi->rnum = NULL;
+  vi->top = -1;
+
+  if (top < 0)
+    return;
+
+  CREATE(vi->rnum, IDXTYPE, top + 1);
+  for (i = 0; i <= top; i++)
+    vi->rnum[i] = NOWHERE;
+  vi->top = top;
+}
+
+
+/*
+ * (Re)build the vnum index of one of the tables, once it's done.  Any
+ * code that adds a room, mobile, object or zone to its table must call
+ * this afterwards, or the new one won't be found.
+ */
+void vnum_index_build(int mode)
+{
+  int i, top = -1;
+
+  /* Nothing says the tables are in order, so each is looked over first. */
+  switch (mode) {
+  case DB_BOOT_WLD:
+    for (i = 0; i <= top_of_world; i++)
+      top = MAX(top, world[i].number);
+    vnum_index_size(&room_vnums, top);
+    for (i = 0; i <= top_of_world; i++)
+      if ((int) world[i].number >= 0)
+	room_vnums.rnum[world[i].number] = i;
+    break;
+  case DB_BOOT_MOB:
+    for (i = 0; i <= top_of_mobt; i++)
+      top = MAX(top, mob_index[i].vnum);
+    vnum_index_size(&mob_vnums, top);
+    for (i = 0; i <= top_of_mobt; i++)
+      if ((int) mob_index[i].vnum >= 0)
+	mob_vnums.rnum[mob_index[i].vnum] = i;
+    break;
+  case DB_BOOT_OBJ:
+    for (i = 0; i <= top_of_objt; i++)
+      top = MAX(top, obj_index[i].vnum);
+    vnum_index_size(&obj_vnums, top);
+    for (i = 0; i <= top_of_objt; i++)
+      if ((int) obj_index[i].vnum >= 0)
+	obj_vnums.rnum[obj_index[i].vnum] = i;
+    break;
+  case DB_BOOT_ZON:
+    for (i = 0; i <= top_of_zone_table; i++)
+      top = MAX(top, zone_table[i].number);
+    vnum_index_size(&zone_vnums, top);
+    for (i = 0; i <= top_of_zone_table; i++)
+      if ((int) zone_table[i].number >= 0)
+	zone_vnums.rnum[zone_table[i].number] = i;
+    break;
+  default:
+    log("SYSERR: Unknown table %d in vnum_index_build.", mode);
+    break;
+  }
+}
+
+
 /* returns the real number of the room with given virtual number */
 room_rnum real_room(room_vnum vnum)
 {
   room_rnum bot, top, mid;
 
+  if (room_vnums.rnum)
+    return ((int) vnum >= 0 && vnum <= room_vnums.top ? room_vnums.rnum[vnum] : NOWHERE);
+
   bot = 0;
   top = top_of_world;
 
@@ -2859,6 +4241,9 @@ mob_rnum real_mobile(mob_vnum vnum)
 {
   mob_rnum bot, top, mid;
 
+  if (mob_vnums.rnum)
+    return ((int) vnum >= 0 && vnum <= mob_vnums.top ? mob_vnums.rnum[vnum] : NOBODY);
+
   bot = 0;
   top = top_of_mobt;
 
@@ -2883,6 +4268,9 @@ obj_rnum real_object(obj_vnum vnum)
 {
   obj_rnum bot, top, mid;
 
+  if (obj_vnums.rnum)
+    return ((int) vnum >= 0 && vnum <= obj_vnums.top ? obj_vnums.rnum[vnum] : NOTHING);
+
   bot = 0;
   top = top_of_objt;
 
@@ -2907,6 +4295,9 @@ room_rnum real_zone(room_vnum vnum)
 {
   room_rnum bot, top, mid;
 
+  if (zone_vnums.rnum)
+    return ((int) vnum >= 0 && vnum <= zone_vnums.top ? zone_vnums.rnum[vnum] : NOWHERE);
+
   bot = 0;
   top = top_of_zone_table;
 
@@ -2937,11 +4328,11 @@ int check_object(struct obj_data *obj)
   int error = FALSE;
 
   if (GET_OBJ_WEIGHT(obj) < 0 && (error = TRUE))
-    log("SYSERR: Object #%d (%s) has negative weight (%d).",
+    boot_log("SYSERR: Object #%d (%s) has negative weight (%d).",
 	GET_OBJ_VNUM(obj), obj->short_description, GET_OBJ_WEIGHT(obj));
 
   if (GET_OBJ_RENT(obj) < 0 && (error = TRUE))
-    log("SYSERR: Object #%d (%s) has negative cost/day (%d).",
+    boot_log("SYSERR: Object #%d (%s) has negative cost/day (%d).",
 	GET_OBJ_VNUM(obj), obj->short_description, GET_OBJ_RENT(obj));
 
   snprintf(objname, sizeof(objname), "Object #%d (%s)", GET_OBJ_VNUM(obj), obj->short_description);
@@ -2956,13 +4347,13 @@ int check_object(struct obj_data *obj)
 
     strlcpy(onealias, space ? space + 1 : obj->name, sizeof(onealias));
     if (search_block(onealias, drinknames, TRUE) < 0 && (error = TRUE))
-      log("SYSERR: Object #%d (%s) doesn't have drink type as last alias. (%s)",
+      boot_log("SYSERR: Object #%d (%s) doesn't have drink type as last alias. (%s)",
 		GET_OBJ_VNUM(obj), obj->short_description, obj->name);
   }
   /* Fall through. */
   case ITEM_FOUNTAIN:
     if (GET_OBJ_VAL(obj, 1) > GET_OBJ_VAL(obj, 0) && (error = TRUE))
-      log("SYSERR: Object #%d (%s) contains (%d) more than maximum (%d).",
+      boot_log("SYSERR: Object #%d (%s) contains (%d) more than maximum (%d).",
 		GET_OBJ_VNUM(obj), obj->short_description,
 		GET_OBJ_VAL(obj, 1), GET_OBJ_VAL(obj, 0));
     break;
@@ -2978,7 +4369,7 @@ int check_object(struct obj_data *obj)
     error |= check_object_level(obj, 0);
     error |= check_object_spell_number(obj, 3);
     if (GET_OBJ_VAL(obj, 2) > GET_OBJ_VAL(obj, 1) && (error = TRUE))
-      log("SYSERR: Object #%d (%s) has more charges (%d) than maximum (%d).",
+      boot_log("SYSERR: Object #%d (%s) has more charges (%d) than maximum (%d).",
 		GET_OBJ_VNUM(obj), obj->short_description,
 		GET_OBJ_VAL(obj, 2), GET_OBJ_VAL(obj, 1));
     break;
@@ -3006,7 +4397,7 @@ int check_object_spell_number(struct obj_data *obj, int val)
   if (GET_OBJ_VAL(obj, val) > MAX_SPELLS && GET_OBJ_VAL(obj, val) <= MAX_SKILLS)
     error = TRUE;
   if (error)
-    log("SYSERR: Object #%d (%s) has out of range spell #%d.",
+    boot_log("SYSERR: Object #%d (%s) has out of range spell #%d.",
 	GET_OBJ_VNUM(obj), obj->short_description, GET_OBJ_VAL(obj, val));
 
   /*
@@ -3015,7 +4406,7 @@ int check_object_spell_number(struct obj_data *obj, int val)
 #if 0
   if (GET_OBJ_TYPE(obj) == ITEM_STAFF &&
 	HAS_SPELL_ROUTINE(GET_OBJ_VAL(obj, val), MAG_AREAS | MAG_MASSES))
-    log("... '%s' (#%d) uses %s spell '%s'.",
+    boot_log("... '%s' (#%d) uses %s spell '%s'.",
 	obj->short_description,	GET_OBJ_VNUM(obj),
 	HAS_SPELL_ROUTINE(GET_OBJ_VAL(obj, val), MAG_AREAS) ? "area" : "mass",
 	skill_name(GET_OBJ_VAL(obj, val)));
@@ -3028,7 +4419,7 @@ int check_object_spell_number(struct obj_data *obj, int val)
   spellname = skill_name(GET_OBJ_VAL(obj, val));
 
   if ((spellname == unused_spellname || !str_cmp("UNDEFINED", spellname)) && (error = TRUE))
-    log("SYSERR: Object #%d (%s) uses '%s' spell #%d.",
+    boot_log("SYSERR: Object #%d (%s) uses '%s' spell #%d.",
 		GET_OBJ_VNUM(obj), obj->short_description, spellname,
 		GET_OBJ_VAL(obj, val));
 
@@ -3040,7 +4431,7 @@ int check_object_level(struct obj_data *obj, int val)
   int error = FALSE;
 
   if ((GET_OBJ_VAL(obj, val) < 0 || GET_OBJ_VAL(obj, val) > LVL_IMPL) && (error = TRUE))
-    log("SYSERR: Object #%d (%s) has out of range level #%d.",
+    boot_log("SYSERR: Object #%d (%s) has out of range level #%d.",
 	GET_OBJ_VNUM(obj), obj->short_description, GET_OBJ_VAL(obj, val));
 
   return (error);
@@ -3057,7 +4448,7 @@ int check_bitvector_names(bitvector_t bits, size_t namecount, const char *whatam
 
   for (flagnum = namecount; flagnum < sizeof(bitvector_t) * 8; flagnum++)
     if ((1 << flagnum) & bits) {
-      log("SYSERR: %s has unknown %s flag, bit %d (0 through %zu known).", whatami, whatbits, flagnum, namecount - 1);
+      boot_log("SYSERR: %s has unknown %s flag, bit %d (0 through %zu known).", whatami, whatbits, flagnum, namecount - 1);
       error = TRUE;
     }
 
@@ -68,6 +68,7 @@
 #define OBJ_PREFIX	LIB_WORLD"obj"SLASH	/* object prototypes	*/
 #define ZON_PREFIX	LIB_WORLD"zon"SLASH	/* zon defs & command tables */
 #define SHP_PREFIX	LIB_WORLD"shp"SLASH	/* shop definitions	*/
+#define WORLD_IMAGE_FILE LIB_WORLD"image"	/* all of the above, compiled */
 #define HLP_PREFIX	LIB_TEXT"help"SLASH	/* for HELP <keyword>	*/
 
 #define CREDITS_FILE	LIB_TEXT"credits" /* for the 'credits' command	*/
@@ -89,19 +90,27 @@
 #define MESS_FILE	LIB_MISC"messages" /* damage messages		*/
 #define SOCMESS_FILE	LIB_MISC"socials"  /* messages for social acts	*/
 #define XNAME_FILE	LIB_MISC"xnames"   /* invalid name substrings	*/
+#define PERF_FILE	LIB_MISC"perf"	   /* 'perf dump' output		*/
 
 #define PLAYER_FILE	LIB_ETC"players"   /* the player database	*/
+#define PLAYER_INDEX_FILE LIB_ETC"players.idx" /* its names and idnums */
+#define JOURNAL_FILE	LIB_ETC"journal"   /* changes since the last saves */
 #define MAIL_FILE	LIB_ETC"plrmail"   /* for the mudmail system	*/
 #define BAN_FILE	LIB_ETC"badsites"  /* for the siteban system	*/
 #define HCONTROL_FILE	LIB_ETC"hcontrol"  /* for the house system	*/
 #define TIME_FILE	LIB_ETC"time"	   /* for calendar system	*/
+#define ZONE_SAVE_FILE	LIB_HOUSE"%d.zone" /* an unloaded zone's objects */
 
 /* public procedures in db.c */
 void	boot_db(void);
 void	destroy_db(void);
 int	create_entry(char *name);
 void	zone_update(void);
+void	zone_player_enters(struct char_data *ch, zone_rnum zone);
+void	zone_player_leaves(struct char_data *ch, zone_rnum zone);
+int	zone_age(zone_rnum zone);
 char	*fread_string(FILE *fl, const char *error);
+void	save_player_index(void);
 long	get_id_by_name(const char *name);
 char	*get_name_by_id(long id);
 void	save_mud_time(struct time_info_data *when);
@@ -114,11 +123,14 @@ zone_rnum real_zone(zone_vnum vnum);
 room_rnum real_room(room_vnum vnum);
 mob_rnum real_mobile(mob_vnum vnum);
 obj_rnum real_object(obj_vnum vnum);
+void	vnum_index_build(int mode);
 
 void	char_to_store(struct char_data *ch, struct char_file_u *st);
 void	store_to_char(struct char_file_u *st, struct char_data *ch);
 int	load_char(const char *name, struct char_file_u *char_element);
 void	save_char(struct char_data *ch);
+void	save_char_record(int pos, struct char_file_u *st);
+void	char_to_record(struct char_data *ch, struct char_file_u *st);
 void	init_char(struct char_data *ch);
 struct char_data* create_char(void);
 struct char_data *read_mobile(mob_vnum nr, int type);
@@ -164,7 +176,8 @@ struct reset_com {
 struct zone_data {
    char	*name;		    /* name of this zone                  */
    int	lifespan;           /* how long between resets (minutes)  */
-   int	age;                /* current age of this zone (minutes) */
+   unsigned long reset_at;  /* event_pulse it was last reset on   */
+   int	reset_pos;	    /* its place in the reset heap, or -1 */
    room_vnum bot;           /* starting room number for this zone */
    room_vnum top;           /* upper limit for rooms in this zone */
 
@@ -172,6 +185,11 @@ struct zone_data {
    zone_vnum number;	    /* virtual number of this zone	  */
    struct reset_com *cmd;   /* command table for reset	          */
 
+   int	players;	    /* players in the zone now		  */
+   int	mortals;	    /* ... of them below immortal	  */
+   int	resident;	    /* its mobiles and objects are loaded */
+   int	idle;		    /* minutes since a player was in it   */
+
    /*
     * Reset mode:
     *   0: Don't reset, and don't update age.
@@ -182,25 +200,11 @@ struct zone_data {
 
 
 
-/* for queueing zones for update   */
-struct reset_q_element {
-   zone_rnum zone_to_reset;            /* ref to zone_data */
-   struct reset_q_element *next;
-};
-
-
-
-/* structure for the update queue     */
-struct reset_q_type {
-   struct reset_q_element *head;
-   struct reset_q_element *tail;
-};
-
-
-
 struct player_index_element {
    char	*name;
    long id;
+   int next_name;	/* in plrindex.c's hash chains, or -1 */
+   int next_id;
 };
 
 
@@ -227,6 +231,13 @@ struct ban_list_element {
 };
 
 
+/* What's been saved, and passed over as unchanged, at autosaves. */
+#define SAVES_RECORD	0	/* player file records		*/
+#define SAVES_OBJS	1	/* rent files			*/
+#define SAVES_HOUSE	2
+#define SAVES_JOURNAL	3	/* players compared for the journal */
+#define NUM_SAVES	4
+
 /* global buffering system */
 
 #ifndef __DB_C__
@@ -248,6 +259,8 @@ extern struct index_data *obj_index;
 extern struct obj_data *object_list;
 extern struct obj_data *obj_proto;
 extern obj_rnum top_of_objt;
+
+extern unsigned long saves_done[NUM_SAVES], saves_skipped[NUM_SAVES];
 #endif
 
 #ifndef __CONFIG_C__
@@ -0,0 +1,209 @@
+/* ************************************************************************
+*   File: events.c                                      Part of CircleMUD *
+*  Usage: hierarchical timing wheel for timed events                      *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Anything that has to happen some number of pulses from now -- the
+ * periodic jobs in heartbeat(), or a single mobile's next bout of
+ * activity -- is an event on the wheel.  Putting one on or taking one
+ * off costs the same however many there are, and each pulse only looks
+ * at the events due then, plus now and again the contents of one slot of
+ * a higher level, which get spread out over the level below as their
+ * time comes closer.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "events.h"
+
+/* local globals */
+unsigned long event_pulse = 0;		/* pulses since boot */
+struct event *event_wheel[EVENT_LEVELS][EVENT_SLOTS];
+int event_count[EVENT_LEVELS];		/* events on each level */
+
+/* local functions */
+void event_insert(struct event *e);
+void event_unlink(struct event *e);
+void event_cascade(int level);
+
+
+/* Put an event in the slot its 'when' falls in. */
+void event_insert(struct event *e)
+{
+  unsigned long delta, when = e->when;
+  struct event **slot;
+  int level;
+
+  /*
+   * Never in the past: event_create() asks for at least one pulse ahead,
+   * and an event cascaded down on the pulse it's due lands in the slot
+   * event_process() is about to run.
+   */
+  delta = when - event_pulse;
+
+  for (level = 0; level < EVENT_LEVELS - 1; level++)
+    if (delta < 1UL << (EVENT_BITS * (level + 1)))
+      break;
+
+  /* Past the end of the wheel: wait in the furthest slot there is. */
+  if (delta >= 1UL << (EVENT_BITS * EVENT_LEVELS))
+    when = event_pulse + (1UL << (EVENT_BITS * EVENT_LEVELS)) - 1;
+
+  slot = &event_wheel[level][(when >> (EVENT_BITS * level)) & (EVENT_SLOTS - 1)];
+
+  if ((e->next = *slot) != NULL)
+    e->next->prev = &e->next;
+  e->prev = slot;
+  *slot = e;
+  e->level = level;
+  event_count[level]++;
+}
+
+
+void event_unlink(struct event *e)
+{
+  if ((*e->prev = e->next) != NULL)
+    e->next->prev = e->prev;
+  e->next = NULL;
+  e->prev = NULL;
+  if (e->level >= 0)
+    event_count[e->level]--;
+  e->level = -1;
+}
+
+
+/* Spread one slot of a higher level over the levels below it. */
+void event_cascade(int level)
+{
+  struct event **slot, *e;
+
+  slot = &event_wheel[level][(event_pulse >> (EVENT_BITS * level)) & (EVENT_SLOTS - 1)];
+
+  while ((e = *slot) != NULL) {
+    event_unlink(e);
+    event_insert(e);
+  }
+}
+
+
+/*
+ * Run 'func' on 'event_obj' 'when' pulses from now.  Keep the pointer
+ * returned if the event might need to be cancelled.
+ */
+struct event *event_create(EVENTFUNC(*func), void *event_obj, long when)
+{
+  struct event *e;
+
+  CREATE(e, struct event, 1);
+  e->func = func;
+  e->event_obj = event_obj;
+  e->when = event_pulse + (when > 0 ? when : 1);
+  event_insert(e);
+
+  return (e);
+}
+
+
+void event_cancel(struct event *e)
+{
+  if (!e)
+    return;
+
+  /* The event is running: event_process() will free it when it returns. */
+  if (!e->prev) {
+    e->cancelled = TRUE;
+    return;
+  }
+
+  event_unlink(e);
+  free(e);
+}
+
+
+/* Pulses until the event goes off. */
+long event_time(struct event *e)
+{
+  return (e->when > event_pulse ? (long) (e->when - event_pulse) : 0);
+}
+
+
+/*
+ * Advance the wheel one pulse and run everything due.  An event may
+ * cancel any other event, including ones due this same pulse that
+ * haven't run yet.
+ */
+void event_process(void)
+{
+  struct event *due, *e;
+  long delay;
+  int level;
+
+  event_pulse++;
+
+  for (level = 1; level < EVENT_LEVELS; level++) {
+    if (event_pulse & ((1UL << (EVENT_BITS * level)) - 1))
+      break;
+    event_cascade(level);
+  }
+
+  /* Take this pulse's slot off the wheel so it can't grow under us. */
+  due = event_wheel[0][event_pulse & (EVENT_SLOTS - 1)];
+  event_wheel[0][event_pulse & (EVENT_SLOTS - 1)] = NULL;
+  if (due)
+    due->prev = &due;
+
+  while ((e = due) != NULL) {
+    event_unlink(e);
+
+    delay = (e->func)(e->event_obj);
+
+    if (delay <= 0 || e->cancelled)
+      free(e);
+    else {
+      e->when = event_pulse + delay;
+      event_insert(e);
+    }
+  }
+}
+
+
+/* Free every event on the wheel; only for shutting down. */
+void event_free_all(void)
+{
+  struct event *e;
+  int level, slot;
+
+  for (level = 0; level < EVENT_LEVELS; level++)
+    for (slot = 0; slot < EVENT_SLOTS; slot++)
+      while ((e = event_wheel[level][slot]) != NULL) {
+	event_unlink(e);
+	free(e);
+      }
+}
+
+
+/* How many events a level holds, and the most in any one of its slots. */
+void event_level_stats(int level, int *count, int *busiest)
+{
+  struct event *e;
+  int slot, n;
+
+  *count = event_count[level];
+  *busiest = 0;
+
+  for (slot = 0; slot < EVENT_SLOTS; slot++) {
+    for (n = 0, e = event_wheel[level][slot]; e; e = e->next)
+      n++;
+    if (n > *busiest)
+      *busiest = n;
+  }
+}
@@ -0,0 +1,50 @@
+/* ************************************************************************
+*   File: events.h                                      Part of CircleMUD *
+*  Usage: header file for the timed event queue                           *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * An event function is handed the pointer it was created with and returns
+ * the number of pulses until it should run again, or 0 to be done with it.
+ * An event that is done is freed; don't keep pointers to it around.
+ */
+#define EVENTFUNC(name)	long (name)(void *event_obj)
+
+/*
+ * The wheel has EVENT_LEVELS levels of EVENT_SLOTS slots each.  Level 0
+ * has a slot for every pulse; each level above covers EVENT_SLOTS times
+ * as many pulses per slot as the one below, so 3 levels of 256 reach out
+ * about 16.7 million pulses (19 days).  Events further out than that
+ * park in the top level and are looked at again as it turns.
+ *
+ * Events move down a level as their time comes closer, a slot's worth at
+ * a time, so level 0 is made wide enough for everything that repeats
+ * every few seconds (mobiles, combat) to stay there and never be moved.
+ */
+#define EVENT_BITS	8
+#define EVENT_SLOTS	(1 << EVENT_BITS)
+#define EVENT_LEVELS	3
+
+struct event {
+  EVENTFUNC(*func);
+  void *event_obj;
+  unsigned long when;		/* pulse it's due on		*/
+  sh_int level;			/* wheel level, or -1 if running */
+  bool cancelled;		/* cancelled while running	*/
+  struct event *next;
+  struct event **prev;		/* whatever points at us	*/
+};
+
+struct event *event_create(EVENTFUNC(*func), void *event_obj, long when);
+void event_cancel(struct event *e);
+long event_time(struct event *e);
+void event_process(void);
+void event_free_all(void);
+void event_level_stats(int level, int *count, int *busiest);
+
+extern unsigned long event_pulse;
@@ -350,6 +350,7 @@ void change_alignment(struct char_data *ch, struct char_data *victim)
    * you move 1/16th of the way to having alignment -A.  Simple and fast.
    */
   GET_ALIGNMENT(ch) += (-GET_ALIGNMENT(victim) - GET_ALIGNMENT(ch)) / 16;
+  SET_DIRTY(ch, DIRTY_RECORD);
 }
 
 
@@ -744,6 +745,7 @@ int damage(struct char_data *ch, struct char_data *victim, int dam, int attackty
   /* Set the maximum damage per round and subtract the hit points */
   dam = MAX(MIN(dam, 100), 0);
   GET_HIT(victim) -= dam;
+  SET_DIRTY(victim, DIRTY_RECORD);
 
   /* Gain exp for the hit */
   if (ch != victim)
@@ -19,6 +19,7 @@
 #include "handler.h"
 #include "interpreter.h"
 #include "spells.h"
+#include "journal.h"
 
 /* local vars */
 int extractions_pending = 0;
@@ -274,6 +275,7 @@ void affect_to_char(struct char_data *ch, struct affected_type *af)
 
   affect_modify(ch, af->location, af->modifier, af->bitvector, TRUE);
   affect_total(ch);
+  SET_DIRTY(ch, DIRTY_RECORD);
 }
 
 
@@ -296,6 +298,7 @@ void affect_remove(struct char_data *ch, struct affected_type *af)
   REMOVE_FROM_LIST(af, ch->affected, next);
   free(af);
   affect_total(ch);
+  SET_DIRTY(ch, DIRTY_RECORD);
 }
 
 
@@ -380,6 +383,8 @@ void char_from_room(struct char_data *ch)
 	world[IN_ROOM(ch)].light--;
 
   REMOVE_FROM_LIST(ch, world[IN_ROOM(ch)].people, next_in_room);
+  if (!IS_NPC(ch))
+    zone_player_leaves(ch, world[IN_ROOM(ch)].zone);
   IN_ROOM(ch) = NOWHERE;
   ch->next_in_room = NULL;
 }
@@ -396,6 +401,9 @@ void char_to_room(struct char_data *ch, room_rnum room)
     world[room].people = ch;
     IN_ROOM(ch) = room;
 
+    if (!IS_NPC(ch))
+      zone_player_enters(ch, world[room].zone);
+
     if (GET_EQ(ch, WEAR_LIGHT))
       if (GET_OBJ_TYPE(GET_EQ(ch, WEAR_LIGHT)) == ITEM_LIGHT)
 	if (GET_OBJ_VAL(GET_EQ(ch, WEAR_LIGHT), 2))	/* Light ON */
@@ -421,9 +429,8 @@ void obj_to_char(struct obj_data *object, struct char_data *ch)
     IS_CARRYING_W(ch) += GET_OBJ_WEIGHT(object);
     IS_CARRYING_N(ch)++;
 
-    /* set flag for crash-save system, but not on mobs! */
-    if (!IS_NPC(ch))
-      SET_BIT(PLR_FLAGS(ch), PLR_CRASH);
+    /* mark it for the crash-save system */
+    SET_DIRTY(ch, DIRTY_OBJS);
   } else
     log("SYSERR: NULL obj (%p) or char (%p) passed to obj_to_char.", object, ch);
 }
@@ -440,9 +447,8 @@ void obj_from_char(struct obj_data *object)
   }
   REMOVE_FROM_LIST(object, object->carried_by->carrying, next_content);
 
-  /* set flag for crash-save system, but not on mobs! */
-  if (!IS_NPC(object->carried_by))
-    SET_BIT(PLR_FLAGS(object->carried_by), PLR_CRASH);
+  /* mark it for the crash-save system */
+  SET_DIRTY(object->carried_by, DIRTY_OBJS);
 
   IS_CARRYING_W(object->carried_by) -= GET_OBJ_WEIGHT(object);
   IS_CARRYING_N(object->carried_by)--;
@@ -545,6 +551,7 @@ void equip_char(struct char_data *ch, struct obj_data *obj, int pos)
 		  GET_OBJ_AFFECT(obj), TRUE);
 
   affect_total(ch);
+  SET_DIRTY(ch, DIRTY_OBJS);
 }
 
 
@@ -581,6 +588,7 @@ struct obj_data *unequip_char(struct char_data *ch, int pos)
 		  GET_OBJ_AFFECT(obj), FALSE);
 
   affect_total(ch);
+  SET_DIRTY(ch, DIRTY_OBJS);
 
   return (obj);
 }
@@ -627,13 +635,10 @@ struct obj_data *get_obj_in_list_num(int num, struct obj_data *list)
 /* search the entire world for an object number, and return a pointer  */
 struct obj_data *get_obj_num(obj_rnum nr)
 {
-  struct obj_data *i;
-
-  for (i = object_list; i; i = i->next)
-    if (GET_OBJ_RNUM(i) == nr)
-      return (i);
+  if (nr < 0 || nr > top_of_objt)
+    return (NULL);
 
-  return (NULL);
+  return (obj_index[nr].objs);
 }
 
 
@@ -665,13 +670,10 @@ struct char_data *get_char_room(char *name, int *number, room_rnum room)
 /* search all over the world for a char num, and return a pointer if found */
 struct char_data *get_char_num(mob_rnum nr)
 {
-  struct char_data *i;
-
-  for (i = character_list; i; i = i->next)
-    if (GET_MOB_RNUM(i) == nr)
-      return (i);
+  if (nr < 0 || nr > top_of_mobt)
+    return (NULL);
 
-  return (NULL);
+  return (mob_index[nr].mobs);
 }
 
 
@@ -735,6 +737,8 @@ void obj_to_obj(struct obj_data *obj, struct obj_data *obj_to)
   GET_OBJ_WEIGHT(tmp_obj) += GET_OBJ_WEIGHT(obj);
   if (tmp_obj->carried_by)
     IS_CARRYING_W(tmp_obj->carried_by) += GET_OBJ_WEIGHT(obj);
+
+  obj_dirty(obj);
 }
 
 
@@ -759,11 +763,30 @@ void obj_from_obj(struct obj_data *obj)
   if (temp->carried_by)
     IS_CARRYING_W(temp->carried_by) -= GET_OBJ_WEIGHT(obj);
 
+  obj_dirty(obj);
   obj->in_obj = NULL;
   obj->next_content = NULL;
 }
 
 
+/*
+ * Something about 'obj' that gets saved has changed: mark whoever, or
+ * whichever house, it will be saved with.
+ */
+void obj_dirty(struct obj_data *obj)
+{
+  while (obj->in_obj)
+    obj = obj->in_obj;
+
+  if (obj->carried_by)
+    SET_DIRTY(obj->carried_by, DIRTY_OBJS);
+  else if (obj->worn_by)
+    SET_DIRTY(obj->worn_by, DIRTY_OBJS);
+  else if (IN_ROOM(obj) != NOWHERE && ROOM_FLAGGED(IN_ROOM(obj), ROOM_HOUSE))
+    SET_BIT(ROOM_FLAGS(IN_ROOM(obj)), ROOM_HOUSE_CRASH);
+}
+
+
 /* Set all carried_by to point to new owner */
 void object_list_new_owner(struct obj_data *list, struct char_data *ch)
 {
@@ -796,8 +819,10 @@ void extract_obj(struct obj_data *obj)
 
   REMOVE_FROM_LIST(obj, object_list, next);
 
-  if (GET_OBJ_RNUM(obj) != NOTHING)
+  if (GET_OBJ_RNUM(obj) != NOTHING) {
     (obj_index[GET_OBJ_RNUM(obj)].number)--;
+    REMOVE_INSTANCE(obj, obj_index[GET_OBJ_RNUM(obj)].objs);
+  }
   free_obj(obj);
 }
 
@@ -805,8 +830,10 @@ void extract_obj(struct obj_data *obj)
 
 void update_object(struct obj_data *obj, int use)
 {
-  if (GET_OBJ_TIMER(obj) > 0)
+  if (GET_OBJ_TIMER(obj) > 0) {
     GET_OBJ_TIMER(obj) -= use;
+    obj_dirty(obj);
+  }
   if (obj->contains)
     update_object(obj->contains, use);
   if (obj->next_content)
@@ -822,6 +849,7 @@ void update_char_objects(struct char_data *ch)
     if (GET_OBJ_TYPE(GET_EQ(ch, WEAR_LIGHT)) == ITEM_LIGHT)
       if (GET_OBJ_VAL(GET_EQ(ch, WEAR_LIGHT), 2) > 0) {
 	i = --GET_OBJ_VAL(GET_EQ(ch, WEAR_LIGHT), 2);
+	SET_DIRTY(ch, DIRTY_OBJS);
 	if (i == 1) {
 	  send_to_char(ch, "Your light begins to flicker and fade.\r\n");
 	  act("$n's light begins to flicker and fade.", FALSE, ch, 0, 0, TO_ROOM);
@@ -931,12 +959,16 @@ void extract_char_final(struct char_data *ch)
   char_from_room(ch);
 
   if (IS_NPC(ch)) {
-    if (GET_MOB_RNUM(ch) != NOTHING)	/* prototyped */
+    if (GET_MOB_RNUM(ch) != NOTHING) {	/* prototyped */
       mob_index[GET_MOB_RNUM(ch)].number--;
+      REMOVE_INSTANCE(ch, mob_index[GET_MOB_RNUM(ch)].mobs);
+    }
     clearMemory(ch);
   } else {
     save_char(ch);
     Crash_delete_crashfile(ch);
+    Crash_flush(ch);
+    journal_free(ch);
   }
 
   /* If there's a descriptor, they're in the menu now. */
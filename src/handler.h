@@ -40,6 +40,7 @@ void	obj_from_room(struct obj_data *object);
 void	obj_to_obj(struct obj_data *obj, struct obj_data *obj_to);
 void	obj_from_obj(struct obj_data *obj);
 void	object_list_new_owner(struct obj_data *list, struct char_data *ch);
+void	obj_dirty(struct obj_data *obj);
 
 void	extract_obj(struct obj_data *obj);
 
@@ -100,6 +101,7 @@ int	Crash_load(struct char_data *ch);
 void	Crash_crashsave(struct char_data *ch);
 void	Crash_idlesave(struct char_data *ch);
 void	Crash_save_all(void);
+void	Crash_flush(struct char_data *ch);
 
 /* prototypes from fight.c */
 void	set_fighting(struct char_data *ch, struct char_data *victim);
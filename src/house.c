@@ -19,10 +19,11 @@
 #include "utils.h"
 #include "house.h"
 #include "constants.h"
+#include "saver.h"
 
 /* external functions */
 struct obj_data *Obj_from_store(struct obj_file_elem object, int *location);
-int Obj_to_store(struct obj_data *obj, FILE *fl, int location);
+void Obj_to_elem(struct obj_data *obj, struct obj_file_elem *object, int location);
 
 /* local globals */
 struct house_control_rec house_control[MAX_HOUSES];
@@ -31,7 +32,7 @@ int num_of_houses = 0;
 /* local functions */
 int House_get_filename(room_vnum vnum, char *filename, size_t maxlen);
 int House_load(room_vnum vnum);
-int House_save(struct obj_data *obj, FILE *fp);
+void House_save(struct obj_data *obj, struct save_buf *sb);
 void House_restore_weight(struct obj_data *obj);
 void House_delete_file(room_vnum vnum);
 int find_house(room_vnum vnum);
@@ -70,6 +71,7 @@ int House_load(room_vnum vnum)
     return (0);
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return (0);
+  saver_wait(filename);
   if (!(fl = fopen(filename, "r+b")))	/* no file found */
     return (0);
   while (!feof(fl)) {
@@ -96,23 +98,21 @@ int House_load(room_vnum vnum)
 
 
 /* Save all objects for a house (recursive; initial call must be followed
-   by a call to House_restore_weight)  Assumes file is open already. */
-int House_save(struct obj_data *obj, FILE *fp)
+   by a call to House_restore_weight) */
+void House_save(struct obj_data *obj, struct save_buf *sb)
 {
+  struct obj_file_elem object;
   struct obj_data *tmp;
-  int result;
 
   if (obj) {
-    House_save(obj->contains, fp);
-    House_save(obj->next_content, fp);
-    result = Obj_to_store(obj, fp, 0);
-    if (!result)
-      return (0);
+    House_save(obj->contains, sb);
+    House_save(obj->next_content, sb);
+    Obj_to_elem(obj, &object, 0);
+    save_buf_add(sb, &object, sizeof(struct obj_file_elem));
 
     for (tmp = obj->in_obj; tmp; tmp = tmp->in_obj)
       GET_OBJ_WEIGHT(tmp) -= GET_OBJ_WEIGHT(obj);
   }
-  return (1);
 }
 
 
@@ -133,22 +133,15 @@ void House_crashsave(room_vnum vnum)
 {
   int rnum;
   char buf[MAX_STRING_LENGTH];
-  FILE *fp;
+  struct save_buf sb = { NULL, 0, 0 };
 
   if ((rnum = real_room(vnum)) == NOWHERE)
     return;
   if (!House_get_filename(vnum, buf, sizeof(buf)))
     return;
-  if (!(fp = fopen(buf, "wb"))) {
-    perror("SYSERR: Error saving house file");
-    return;
-  }
-  if (!House_save(world[rnum].contents, fp)) {
-    fclose(fp);
-    return;
-  }
-  fclose(fp);
+  House_save(world[rnum].contents, &sb);
   House_restore_weight(world[rnum].contents);
+  saver_replace(buf, &sb);
   REMOVE_BIT(ROOM_FLAGS(rnum), ROOM_HOUSE_CRASH);
 }
 
@@ -157,18 +150,10 @@ void House_crashsave(room_vnum vnum)
 void House_delete_file(room_vnum vnum)
 {
   char filename[MAX_INPUT_LENGTH];
-  FILE *fl;
 
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return;
-  if (!(fl = fopen(filename, "rb"))) {
-    if (errno != ENOENT)
-      log("SYSERR: Error deleting house file #%d. (1): %s", vnum, strerror(errno));
-    return;
-  }
-  fclose(fl);
-  if (remove(filename) < 0)
-    log("SYSERR: Error deleting house file #%d. (2): %s", vnum, strerror(errno));
+  saver_remove(filename);
 }
 
 
@@ -184,6 +169,7 @@ void House_listrent(struct char_data *ch, room_vnum vnum)
 
   if (!House_get_filename(vnum, filename, sizeof(filename)))
     return;
+  saver_wait(filename);
   if (!(fl = fopen(filename, "rb"))) {
     send_to_char(ch, "No objects on file for house #%d.\r\n", vnum);
     return;
@@ -231,16 +217,11 @@ int find_house(room_vnum vnum)
 /* Save the house control information */
 void House_save_control(void)
 {
-  FILE *fl;
+  struct save_buf sb = { NULL, 0, 0 };
 
-  if (!(fl = fopen(HCONTROL_FILE, "wb"))) {
-    perror("SYSERR: Unable to open house control file.");
-    return;
-  }
   /* write all the house control recs in one fell swoop.  Pretty nifty, eh? */
-  fwrite(house_control, sizeof(struct house_control_rec), num_of_houses, fl);
-
-  fclose(fl);
+  save_buf_add(&sb, house_control, sizeof(struct house_control_rec) * num_of_houses);
+  saver_replace(HCONTROL_FILE, &sb);
 }
 
 
@@ -575,10 +556,15 @@ void House_save_all(void)
   int i;
   room_rnum real_house;
 
-  for (i = 0; i < num_of_houses; i++)
-    if ((real_house = real_room(house_control[i].vnum)) != NOWHERE)
-      if (ROOM_FLAGGED(real_house, ROOM_HOUSE_CRASH))
-	House_crashsave(house_control[i].vnum);
+  for (i = 0; i < num_of_houses; i++) {
+    if ((real_house = real_room(house_control[i].vnum)) == NOWHERE)
+      continue;
+    if (ROOM_FLAGGED(real_house, ROOM_HOUSE_CRASH)) {
+      House_crashsave(house_control[i].vnum);
+      saves_done[SAVES_HOUSE]++;
+    } else
+      saves_skipped[SAVES_HOUSE]++;
+  }
 }
 
 
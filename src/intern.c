@@ -0,0 +1,210 @@
+/* ************************************************************************
+*   File: intern.c                                      Part of CircleMUD *
+*  Usage: sharing one copy of each string of world text                   *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Room names and descriptions, keyword lists and the rest of the text in
+ * the world files repeat a great deal, from zone to zone and within one.
+ * Each different string is kept once here, with a count of the places
+ * using it, and is dropped when the last of them lets it go.  The strings
+ * are kept in an arena, which is freed only with the whole table.
+ *
+ * The world files are read on several threads at boot, so the table is
+ * locked while it's used.
+ */
+
+#define __INTERN_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "intern.h"
+#include "arena.h"
+
+#define INTERN_BASIS	2166136261U	/* FNV-1a			*/
+#define INTERN_PRIME	16777619U
+#define INTERN_MIN_SIZE	1024		/* buckets, to start with	*/
+
+struct intern_entry {
+  char *str;			/* follows the entry in the pool */
+  unsigned int hash;
+  int refs;
+  struct intern_entry *next;
+};
+
+/* local globals */
+struct intern_entry **intern_table = NULL;
+struct arena intern_pool;		/* the entries and their strings */
+unsigned int intern_size = 0;		/* buckets; a power of 2	*/
+int intern_strings = 0;			/* different strings		*/
+int intern_refs = 0;			/* places using them		*/
+size_t intern_bytes = 0;		/* held, one copy of each	*/
+size_t intern_saved = 0;		/* not held, thanks to sharing	*/
+#ifdef CIRCLE_BOOT_THREADS
+pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* local functions */
+unsigned int intern_hash(const char *str);
+void intern_grow(void);
+
+#ifdef CIRCLE_BOOT_THREADS
+#define INTERN_LOCK()	pthread_mutex_lock(&intern_lock)
+#define INTERN_UNLOCK()	pthread_mutex_unlock(&intern_lock)
+#else
+#define INTERN_LOCK()
+#define INTERN_UNLOCK()
+#endif
+
+
+unsigned int intern_hash(const char *str)
+{
+  unsigned int h = INTERN_BASIS;
+
+  for (; *str; str++)
+    h = (h ^ (unsigned char) *str) * INTERN_PRIME;
+
+  return (h);
+}
+
+
+/* Keep the chains about one long. */
+void intern_grow(void)
+{
+  struct intern_entry **old = intern_table, *e, *next;
+  unsigned int old_size = intern_size, i;
+
+  intern_size = (old_size ? old_size * 2 : INTERN_MIN_SIZE);
+  CREATE(intern_table, struct intern_entry *, intern_size);
+
+  for (i = 0; i < old_size; i++)
+    for (e = old[i]; e; e = next) {
+      next = e->next;
+      e->next = intern_table[e->hash & (intern_size - 1)];
+      intern_table[e->hash & (intern_size - 1)] = e;
+    }
+
+  if (old)
+    free(old);
+}
+
+
+/*
+ * Take 'str', which must have been malloc'd, and return the shared copy
+ * of it, new or already there.  'str' itself is freed.
+ */
+char *str_intern(char *str)
+{
+  struct intern_entry *e;
+  unsigned int hash;
+  size_t len;
+
+  if (!str)
+    return (NULL);
+
+  hash = intern_hash(str);
+  len = strlen(str) + 1;
+
+  INTERN_LOCK();
+  for (e = intern_table ? intern_table[hash & (intern_size - 1)] : NULL; e; e = e->next)
+    if (e->hash == hash && !strcmp(e->str, str)) {
+      e->refs++;
+      intern_refs++;
+      intern_saved += len;
+      INTERN_UNLOCK();
+      free(str);
+      return (e->str);
+    }
+
+  if ((unsigned int) intern_strings >= intern_size)
+    intern_grow();
+
+  e = (struct intern_entry *) arena_alloc(&intern_pool, sizeof(struct intern_entry) + len);
+  e->str = (char *) memcpy(e + 1, str, len);
+  e->hash = hash;
+  e->refs = 1;
+  e->next = intern_table[hash & (intern_size - 1)];
+  intern_table[hash & (intern_size - 1)] = e;
+
+  intern_strings++;
+  intern_refs++;
+  intern_bytes += len;
+  INTERN_UNLOCK();
+
+  free(str);
+  return (e->str);
+}
+
+
+/*
+ * Let go of a string that may be shared, or may be free()'d outright.
+ * Its space in the pool isn't used again; strings are seldom replaced.
+ */
+void str_release(char *str)
+{
+  struct intern_entry *e, **prev;
+  unsigned int hash;
+  size_t len;
+
+  if (!str)
+    return;
+
+  hash = intern_hash(str);
+  len = strlen(str) + 1;
+
+  INTERN_LOCK();
+  if (intern_table)
+    for (prev = &intern_table[hash & (intern_size - 1)]; (e = *prev); prev = &e->next) {
+      /* The same text, unshared, can be elsewhere: only this copy counts. */
+      if (e->str != str)
+	continue;
+
+      intern_refs--;
+      if (--e->refs > 0)
+	intern_saved -= len;
+      else {
+	*prev = e->next;
+	intern_strings--;
+	intern_bytes -= len;
+      }
+      INTERN_UNLOCK();
+      return;
+    }
+  INTERN_UNLOCK();
+
+  free(str);
+}
+
+
+void str_intern_stats(int *strings, int *refs, size_t *bytes, size_t *saved)
+{
+  INTERN_LOCK();
+  *strings = intern_strings;
+  *refs = intern_refs;
+  *bytes = intern_bytes;
+  *saved = intern_saved;
+  INTERN_UNLOCK();
+}
+
+
+/* Drop every shared string at once, for destroy_db(). */
+void str_intern_clear(void)
+{
+  INTERN_LOCK();
+  arena_free(&intern_pool);
+  if (intern_table)
+    free(intern_table);
+  intern_table = NULL;
+  intern_size = 0;
+  intern_strings = intern_refs = 0;
+  intern_bytes = intern_saved = 0;
+  INTERN_UNLOCK();
+}
@@ -0,0 +1,21 @@
+/* ************************************************************************
+*   File: intern.h                                      Part of CircleMUD *
+*  Usage: header file for the shared string table                         *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * A string handed to str_intern() may come back as another copy of the
+ * same text, now shared with everything else that has it.  Shared
+ * strings must never be changed in place, realloc'd or free'd; give them
+ * up with str_release(), which also frees strings that aren't shared, so
+ * it's safe on anything that might be either.
+ */
+char *str_intern(char *str);
+void str_release(char *str);
+void str_intern_clear(void);
+void str_intern_stats(int *strings, int *refs, size_t *bytes, size_t *saved);
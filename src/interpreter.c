@@ -22,6 +22,8 @@
 #include "handler.h"
 #include "mail.h"
 #include "screen.h"
+#include "perf.h"
+#include "cmdtrie.h"
 
 
 /* external variables */
@@ -124,6 +126,7 @@ ACMD(do_not_here);
 ACMD(do_olc);
 ACMD(do_order);
 ACMD(do_page);
+ACMD(do_perf);
 ACMD(do_poofset);
 ACMD(do_pour);
 ACMD(do_practice);
@@ -385,6 +388,7 @@ cpp_extern const struct command_info cmd_info[] = {
   { "page"     , POS_DEAD    , do_page     , LVL_GOD, 0 },
   { "pardon"   , POS_DEAD    , do_wizutil  , LVL_GOD, SCMD_PARDON },
   { "peer"     , POS_RESTING , do_action   , 0, 0 },
+  { "perf"     , POS_DEAD    , do_perf     , LVL_GOD, 0 },
   { "pick"     , POS_STANDING, do_gen_door , 1, SCMD_PICK },
   { "point"    , POS_RESTING , do_action   , 0, 0 },
   { "poke"     , POS_RESTING , do_action   , 0, 0 },
@@ -574,7 +578,7 @@ const char *reserved[] =
  */
 void command_interpreter(struct char_data *ch, char *argument)
 {
-  int cmd, length;
+  int cmd;
   char *line;
   char arg[MAX_INPUT_LENGTH];
 
@@ -598,12 +602,7 @@ void command_interpreter(struct char_data *ch, char *argument)
     line = any_one_arg(argument, arg);
 
   /* otherwise, find the command */
-  for (length = strlen(arg), cmd = 0; *cmd_info[cmd].command != '\n'; cmd++)
-    if (!strncmp(cmd_info[cmd].command, arg, length))
-      if (GET_LEVEL(ch) >= cmd_info[cmd].minimum_level)
-	break;
-
-  if (*cmd_info[cmd].command == '\n')
+  if ((cmd = cmdtrie_find(arg, GET_LEVEL(ch))) < 0)
     send_to_char(ch, "Huh?!?\r\n");
   else if (!IS_NPC(ch) && PLR_FLAGGED(ch, PLR_FROZEN) && GET_LEVEL(ch) < LVL_IMPL)
     send_to_char(ch, "You try, but the mind-numbing cold prevents you...\r\n");
@@ -635,8 +634,20 @@ void command_interpreter(struct char_data *ch, char *argument)
     case POS_FIGHTING:
       send_to_char(ch, "No way!  You're fighting for your life!\r\n");
       break;
-  } else if (no_specials || !special(ch, cmd, line))
-    ((*cmd_info[cmd].command_pointer) (ch, line, cmd, cmd_info[cmd].subcmd));
+  } else {
+    unsigned long start = PERF_START();
+
+    /*
+     * Most commands can touch the record somewhere (a condition, a
+     * preference, a title), so the journal compares it after any of them.
+     * What's carried is marked by whatever changes it: handler.c's moves,
+     * and obj_dirty() where an object is changed in place.
+     */
+    SET_DIRTY(ch, DIRTY_RECORD);
+    if (no_specials || !special(ch, cmd, line))
+      ((*cmd_info[cmd].command_pointer) (ch, line, cmd, cmd_info[cmd].subcmd));
+    perf_command(cmd, start);
+  }
 }
 
 /**************************************************************************
@@ -1069,14 +1080,21 @@ void half_chop(char *string, char *arg1, char *arg2)
 
 /* Used in specprocs, mostly.  (Exactly) matches "command" to cmd number */
 int find_command(const char *command)
+{
+  return (cmdtrie_exact(command));
+}
+
+
+/*
+ * Index cmd_info[] for command_interpreter() and find_command(); before
+ * anything else at boot can look a command up.
+ */
+void build_command_trie(void)
 {
   int cmd;
 
   for (cmd = 0; *cmd_info[cmd].command != '\n'; cmd++)
-    if (!strcmp(cmd_info[cmd].command, command))
-      return (cmd);
-
-  return (-1);
+    cmdtrie_add(cmd_info[cmd].command, cmd_info[cmd].minimum_level);
 }
 
 
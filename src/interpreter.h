@@ -30,6 +30,7 @@ void	nanny(struct descriptor_data *d, char *arg);
 int	is_abbrev(const char *arg1, const char *arg2);
 int	is_number(const char *str);
 int	find_command(const char *command);
+void	build_command_trie(void);
 void	skip_spaces(char **string);
 char	*delete_doubledollar(char *string);
 
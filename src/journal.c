@@ -0,0 +1,671 @@
+/* ************************************************************************
+*   File: journal.c                                     Part of CircleMUD *
+*  Usage: journaling what changes about players between saves             *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Over every JOURNAL_PERIOD seconds, journal_update() works out each
+ * player's player file record and rent file objects as they'd be saved
+ * now, and compares them with what it had last time.  Only the bytes of
+ * the record that differ are kept, and the objects, which take only a few
+ * bytes in a rent file, are kept whole if any of them changed.  What's
+ * kept for everyone goes on the end of the journal as one commit, with
+ * one write and one sync.
+ *
+ * Each record and rent file says which commit it was saved at.  A save
+ * made while a commit is being gathered is stamped with that commit's
+ * number, and the player isn't compared again until the next one, so
+ * whatever's in the journal with a higher number than a file's stamp
+ * happened after it was saved.  Booting plays those back onto the files
+ * before anything reads them, as far as the last commit that's whole.
+ *
+ * Each autosave, journal_compact() saves whoever's journaled but not yet
+ * saved in full, syncs the player file, and starts the journal afresh.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#include "db.h"
+#include "handler.h"
+#include "saver.h"
+#include "journal.h"
+#include "rentfile.h"
+
+/* external variables */
+extern struct descriptor_data *descriptor_list;
+extern struct char_data *character_list;
+extern struct player_index_element *player_table;
+extern int top_of_p_table;
+extern FILE *player_fl;
+
+/* external functions */
+void Crash_save_objs(struct char_data *ch, struct save_buf *sb);
+
+#define JR_CHAR		0	/* a player file record's bytes	*/
+#define JR_OBJS		1	/* a rent file's objects, whole		*/
+#define NUM_JR		2
+
+#define JR_BIT(type)	(1 << (type))
+
+/* Runs closer together than this are journaled as one. */
+#define JOURNAL_RUN_GAP	((int) sizeof(struct journal_run))
+
+struct journal_header {
+  char magic[8];
+  int version;
+  int char_size;		/* sizeof(struct char_file_u)		*/
+  int seq;			/* the files are saved up to this	*/
+};
+
+/* A commit is one of these, then 'len' bytes of records. */
+struct journal_commit {
+  int seq;
+  int len;
+  unsigned int check;		/* of the records, to find torn ones	*/
+};
+
+struct journal_record {
+  int type;			/* JR_xxx				*/
+  int pos;			/* the player's place in the file	*/
+  int len;			/* of what follows			*/
+};
+
+/* JR_CHAR is runs of these, each followed by 'len' new bytes. */
+struct journal_run {
+  unsigned short offset;
+  unsigned short len;
+};
+
+/* What's been journaled of a player in the game. */
+struct journal_state {
+  struct char_file_u base;	/* their record, as last journaled	*/
+  struct save_buf objs;		/* their objects, likewise		*/
+  int have;			/* JR_BIT()s: there's a base to compare	*/
+  int unsaved;			/* JR_BIT()s: journaled, not yet saved	*/
+  int stamp[NUM_JR];		/* what each was last saved at		*/
+};
+
+/* What's being replayed onto a player's files at boot. */
+struct journal_replay {
+  struct char_file_u rec;
+  struct rent_info rent;
+  struct save_buf objs;
+  int read;			/* JR_BIT()s: tried reading it		*/
+  int ok;			/* JR_BIT()s: read it			*/
+  int dirty;			/* JR_BIT()s: to be written back	*/
+};
+
+/* local globals */
+int journal_top = 0;		/* the last commit, if anything was in it */
+int journal_commits = 0;	/* since the journal was started afresh */
+int journal_slice = 0;		/* which players journal_update() is on	*/
+struct save_buf journal_pending = { NULL, 0, 0 };	/* commit journal_top + 1 */
+
+/* local functions */
+unsigned int journal_check(const char *data, size_t len);
+struct journal_state *journal_get(struct char_data *ch);
+void journal_add(int type, int pos, const void *data, size_t len);
+void journal_commit(void);
+void journal_reset(void);
+void journal_char_delta(int pos, struct char_file_u *from, struct char_file_u *to);
+void journal_set_objs(struct save_buf *sb, const char *objs, size_t len);
+void journal_gather(struct char_data *ch, int full);
+void journal_gather_slice(int slice);
+void journal_save_objs(struct char_data *ch, struct save_buf *objs, int seq);
+int journal_replay_commit(struct journal_replay **replay, int seq, const char *data, int len);
+int journal_replay_char(struct journal_replay *r, int pos, int seq, const char *data, int len);
+int journal_replay_objs(struct journal_replay *r, int pos, int seq, const char *data, int len);
+int journal_read_objs(struct journal_replay *r, int pos);
+int journal_replay_write(struct journal_replay **replay);
+
+
+/* FNV-1a. */
+unsigned int journal_check(const char *data, size_t len)
+{
+  unsigned int hash = 2166136261U;
+
+  while (len--)
+    hash = (hash ^ (unsigned char) *data++) * 16777619U;
+
+  return (hash);
+}
+
+
+/* The number of the commit being gathered, for saves made now. */
+int journal_stamp(void)
+{
+  return (journal_top + 1);
+}
+
+
+struct journal_state *journal_get(struct char_data *ch)
+{
+  if (!ch->player_specials->journal)
+    CREATE(ch->player_specials->journal, struct journal_state, 1);
+
+  return (ch->player_specials->journal);
+}
+
+
+void journal_free(struct char_data *ch)
+{
+  struct journal_state *state;
+
+  if (IS_NPC(ch) || !ch->player_specials || !(state = ch->player_specials->journal))
+    return;
+
+  if (state->objs.data)
+    free(state->objs.data);
+  free(state);
+  ch->player_specials->journal = NULL;
+}
+
+
+void journal_add(int type, int pos, const void *data, size_t len)
+{
+  struct journal_commit commit;
+  struct journal_record rec;
+
+  if (!journal_pending.len) {		/* filled in by journal_commit() */
+    memset(&commit, 0, sizeof(commit));
+    save_buf_add(&journal_pending, &commit, sizeof(commit));
+  }
+
+  rec.type = type;
+  rec.pos = pos;
+  rec.len = len;
+  save_buf_add(&journal_pending, &rec, sizeof(rec));
+  save_buf_add(&journal_pending, data, len);
+}
+
+
+/*
+ * Hand what's been gathered to the saver, to go on the journal as one.
+ * The number's used up even if there's nothing, so that whoever was
+ * saved while it was being gathered can be compared again next time.
+ */
+void journal_commit(void)
+{
+  struct journal_commit *commit;
+
+  journal_top++;
+  if (!journal_pending.len)
+    return;
+
+  commit = (struct journal_commit *) journal_pending.data;
+  commit->seq = journal_top;
+  commit->len = journal_pending.len - sizeof(struct journal_commit);
+  commit->check = journal_check(journal_pending.data + sizeof(struct journal_commit), commit->len);
+
+  saver_append(JOURNAL_FILE, &journal_pending);
+  journal_commits++;
+}
+
+
+/* Start the journal afresh, the files being saved up to journal_top. */
+void journal_reset(void)
+{
+  struct save_buf sb = { NULL, 0, 0 };
+  struct journal_header hdr;
+
+  memset(&hdr, 0, sizeof(hdr));
+  strcpy(hdr.magic, JOURNAL_MAGIC);	/* strcpy: OK (sizeof: JOURNAL_MAGIC < hdr.magic) */
+  hdr.version = JOURNAL_VERSION;
+  hdr.char_size = sizeof(struct char_file_u);
+  hdr.seq = journal_top;
+
+  save_buf_add(&sb, &hdr, sizeof(hdr));
+  saver_replace(JOURNAL_FILE, &sb);
+  journal_commits = 0;
+}
+
+
+/* Journal the bytes of 'to' that aren't as in 'from'. */
+void journal_char_delta(int pos, struct char_file_u *from, struct char_file_u *to)
+{
+  const unsigned char *a = (const unsigned char *) from, *b = (const unsigned char *) to;
+  struct save_buf sb = { NULL, 0, 0 };
+  struct journal_run run;
+  int i = 0, start, last;
+
+  while (i < (int) sizeof(struct char_file_u)) {
+    if (a[i] == b[i]) {
+      i++;
+      continue;
+    }
+    for (start = last = i; i < (int) sizeof(struct char_file_u) && i - last <= JOURNAL_RUN_GAP; i++)
+      if (a[i] != b[i])
+	last = i;
+
+    run.offset = start;
+    run.len = last - start + 1;
+    save_buf_add(&sb, &run, sizeof(run));
+    save_buf_add(&sb, b + start, run.len);
+  }
+
+  if (sb.len) {
+    journal_add(JR_CHAR, pos, sb.data, sb.len);
+    free(sb.data);
+  }
+}
+
+
+void journal_set_objs(struct save_buf *sb, const char *objs, size_t len)
+{
+  sb->len = 0;
+  save_buf_add(sb, objs, len);
+}
+
+
+/*
+ * save_char() is writing 'st'.  What's changed since it was last
+ * journaled goes in too, in case the write's lost where the journal
+ * isn't; replaying passes over it if the write was kept.
+ */
+void journal_char_saved(struct char_data *ch, struct char_file_u *st)
+{
+  struct journal_state *state;
+
+#ifdef CIRCLE_NO_JOURNAL
+  return;
+#endif
+
+  if (GET_PFILEPOS(ch) < 0)
+    return;
+  state = journal_get(ch);
+  st->player_specials_saved.journal_seq = journal_stamp();
+  if (state->have & JR_BIT(JR_CHAR))
+    journal_char_delta(GET_PFILEPOS(ch), &state->base, st);
+
+  state->base = *st;
+  state->have |= JR_BIT(JR_CHAR);
+  state->unsaved &= ~JR_BIT(JR_CHAR);
+  state->stamp[JR_CHAR] = journal_stamp();
+}
+
+
+/*
+ * Crash_crashsave() is writing 'len' bytes of 'objs', with a rent stamped
+ * journal_stamp().
+ */
+void journal_objs_saved(struct char_data *ch, const char *objs, size_t len)
+{
+  struct journal_state *state;
+
+#ifdef CIRCLE_NO_JOURNAL
+  return;
+#endif
+
+  if (GET_PFILEPOS(ch) < 0)
+    return;
+  state = journal_get(ch);
+  if ((state->have & JR_BIT(JR_OBJS)) &&
+	(len != state->objs.len || memcmp(objs, state->objs.data, len)))
+    journal_add(JR_OBJS, GET_PFILEPOS(ch), objs, len);
+
+  journal_set_objs(&state->objs, objs, len);
+  state->have |= JR_BIT(JR_OBJS);
+  state->unsaved &= ~JR_BIT(JR_OBJS);
+  state->stamp[JR_OBJS] = journal_stamp();
+}
+
+
+/*
+ * Journal what's changed about 'ch'.  The first time, they're saved in
+ * full instead, to have something to compare with.  What changes every
+ * time -- time played and when they logged on -- is left to saves.
+ *
+ * Only what GET_DIRTY() says might have changed is compared, unless it's
+ * 'full': not everything that changes a player marks them, so compaction
+ * compares everyone in full to catch what the marks missed.
+ */
+void journal_gather(struct char_data *ch, int full)
+{
+  struct journal_state *state;
+  struct char_file_u st;
+  struct save_buf sb = { NULL, 0, 0 };
+
+  if (GET_PFILEPOS(ch) < 0)
+    return;
+  state = journal_get(ch);
+
+  if (!(state->have & JR_BIT(JR_CHAR)))
+    save_char(ch);
+  else if (!full && !(GET_DIRTY(ch) & DIRTY_RECORD))
+    saves_skipped[SAVES_JOURNAL]++;
+  else if (state->stamp[JR_CHAR] != journal_stamp()) {
+    REMOVE_BIT(GET_DIRTY(ch), DIRTY_RECORD);
+    saves_done[SAVES_JOURNAL]++;
+    char_to_record(ch, &st);
+    st.played = state->base.played;
+    st.last_logon = state->base.last_logon;
+    st.player_specials_saved.journal_seq = state->base.player_specials_saved.journal_seq;
+
+    if (memcmp(&st, &state->base, sizeof(struct char_file_u))) {
+      journal_char_delta(GET_PFILEPOS(ch), &state->base, &st);
+      state->base = st;
+      state->unsaved |= JR_BIT(JR_CHAR);
+    }
+  }
+
+  if (!(state->have & JR_BIT(JR_OBJS)))
+    Crash_crashsave(ch);
+  else if (!full && !(GET_DIRTY(ch) & DIRTY_OBJS))
+    saves_skipped[SAVES_JOURNAL]++;
+  else if (state->stamp[JR_OBJS] != journal_stamp()) {
+    REMOVE_BIT(GET_DIRTY(ch), DIRTY_OBJS);
+    saves_done[SAVES_JOURNAL]++;
+    Crash_save_objs(ch, &sb);
+
+    if (sb.len != state->objs.len || memcmp(sb.data, state->objs.data, sb.len)) {
+      journal_add(JR_OBJS, GET_PFILEPOS(ch), sb.data, sb.len);
+      journal_set_objs(&state->objs, sb.data, sb.len);
+      state->unsaved |= JR_BIT(JR_OBJS);
+    }
+    free(sb.data);
+  }
+}
+
+
+/* Compare the players in 'slice' of PULSE_JOURNAL, or all of them if it's -1. */
+void journal_gather_slice(int slice)
+{
+  struct descriptor_data *d;
+
+  for (d = descriptor_list; d; d = d->next)
+    if (STATE(d) == CON_PLAYING && d->character && !IS_NPC(d->character) &&
+	(slice < 0 || GET_PFILEPOS(d->character) % PULSE_JOURNAL == slice))
+      journal_gather(d->character, slice < 0);
+}
+
+
+/*
+ * Called every pulse, to spread the comparing over the pulses of a
+ * commit rather than do it all at once.
+ */
+void journal_update(void)
+{
+#ifdef CIRCLE_NO_JOURNAL
+  return;
+#endif
+
+  journal_gather_slice(journal_slice);
+  if (++journal_slice == PULSE_JOURNAL) {
+    journal_slice = 0;
+    journal_commit();
+  }
+}
+
+
+/* A rent file of what's been journaled of 'ch', as Crash_crashsave() would. */
+void journal_save_objs(struct char_data *ch, struct save_buf *objs, int seq)
+{
+  char filename[MAX_INPUT_LENGTH], head[RENT_MAX_HEADER];
+  struct save_buf sb = { NULL, 0, 0 };
+  struct rent_info rent;
+
+  if (!get_filename(filename, sizeof(filename), CRASH_FILE, GET_NAME(ch)))
+    return;
+
+  memset(&rent, 0, sizeof(rent));
+  rent.rentcode = RENT_CRASH;
+  rent.time = time(0);
+  rent.journal_seq = seq;
+  save_buf_add(&sb, head, rent_put_header(head, &rent));
+  save_buf_add(&sb, objs->data, objs->len);
+  saver_replace(filename, &sb);
+}
+
+
+/*
+ * Save what's only in the journal, and start it afresh.  Anything
+ * journaled from now on is numbered after journal_top, which is what
+ * these are stamped with.
+ */
+void journal_compact(void)
+{
+  struct journal_state *state;
+  struct char_data *ch;
+
+#ifdef CIRCLE_NO_JOURNAL
+  return;
+#endif
+
+  journal_gather_slice(-1);
+  journal_slice = 0;
+  journal_commit();
+  if (!journal_commits)
+    return;
+
+  for (ch = character_list; ch; ch = ch->next) {
+    if (IS_NPC(ch) || !(state = ch->player_specials->journal) || !state->unsaved)
+      continue;
+
+    if (state->unsaved & JR_BIT(JR_CHAR)) {
+      state->base.player_specials_saved.journal_seq = journal_top;
+      save_char_record(GET_PFILEPOS(ch), &state->base);
+      saves_done[SAVES_RECORD]++;
+    }
+    if (state->unsaved & JR_BIT(JR_OBJS)) {
+      journal_save_objs(ch, &state->objs, journal_top);
+      saves_done[SAVES_OBJS]++;
+    }
+    state->unsaved = 0;
+  }
+
+  saver_sync(PLAYER_FILE, player_fl);
+  journal_reset();
+}
+
+
+/*
+ * Play the journal back onto the player file and rent files, and start
+ * it afresh.  Returns how many player file records were changed.
+ */
+int journal_boot(void)
+{
+  struct journal_header hdr;
+  struct journal_commit commit;
+  struct journal_replay **replay;
+  char *data;
+  long len, at;
+  int commits = 0, changes = 0, written;
+  FILE *fl;
+
+#ifdef CIRCLE_NO_JOURNAL
+  remove(JOURNAL_FILE);		/* its numbers would mean nothing later */
+  return (0);
+#endif
+
+  journal_top = time(0);
+
+  if (!(fl = fopen(JOURNAL_FILE, "rb"))) {
+    if (errno != ENOENT)
+      log("SYSERR: Couldn't open '%s': %s", JOURNAL_FILE, strerror(errno));
+    journal_reset();
+    return (0);
+  }
+
+  fseek(fl, 0L, SEEK_END);
+  len = ftell(fl);
+  rewind(fl);
+  CREATE(data, char, MAX(len, 1));
+  if (fread(data, 1, len, fl) != (size_t) len)
+    len = 0;
+  fclose(fl);
+
+  memcpy(&hdr, data, MIN(len, (long) sizeof(hdr)));
+  if (len < (long) sizeof(hdr) || strncmp(hdr.magic, JOURNAL_MAGIC, sizeof(hdr.magic)) ||
+	hdr.version != JOURNAL_VERSION || hdr.char_size != sizeof(struct char_file_u)) {
+    log("SYSERR: '%s' isn't a journal this version can read; kept as '%s.bad'.", JOURNAL_FILE, JOURNAL_FILE);
+    rename(JOURNAL_FILE, JOURNAL_FILE ".bad");
+    free(data);
+    journal_reset();
+    return (0);
+  }
+  journal_top = MAX(journal_top, hdr.seq);
+
+  CREATE(replay, struct journal_replay *, top_of_p_table + 1);
+
+  for (at = sizeof(hdr); at + (long) sizeof(commit) <= len; at += sizeof(commit) + commit.len) {
+    memcpy(&commit, data + at, sizeof(commit));
+    if (commit.len < 0 || commit.len > len - at - (long) sizeof(commit) ||
+	journal_check(data + at + sizeof(commit), commit.len) != commit.check)
+      break;
+
+    journal_top = MAX(journal_top, commit.seq);
+    changes += journal_replay_commit(replay, commit.seq, data + at + sizeof(commit), commit.len);
+    commits++;
+  }
+  if (at < len)
+    log("   Journal: the last %ld bytes weren't committed whole; ignored.", len - at);
+
+  written = journal_replay_write(replay);
+  free(replay);
+  free(data);
+
+  if (written)
+    saver_sync(PLAYER_FILE, player_fl);
+  journal_reset();
+
+  if (commits)
+    log("   Journal: %d commits, %d changes replayed.", commits, changes);
+  return (written);
+}
+
+
+int journal_replay_commit(struct journal_replay **replay, int seq, const char *data, int len)
+{
+  struct journal_record rec;
+  int at, changes = 0;
+
+  for (at = 0; at + (int) sizeof(rec) <= len; at += sizeof(rec) + rec.len) {
+    memcpy(&rec, data + at, sizeof(rec));
+    if (rec.len < 0 || rec.len > len - at - (int) sizeof(rec) || rec.pos < 0 || rec.pos > top_of_p_table) {
+      log("SYSERR: Journal commit %d has a bad record; skipping the rest of it.", seq);
+      break;
+    }
+
+    if (!replay[rec.pos])
+      CREATE(replay[rec.pos], struct journal_replay, 1);
+
+    switch (rec.type) {
+    case JR_CHAR:
+      changes += journal_replay_char(replay[rec.pos], rec.pos, seq, data + at + sizeof(rec), rec.len);
+      break;
+    case JR_OBJS:
+      changes += journal_replay_objs(replay[rec.pos], rec.pos, seq, data + at + sizeof(rec), rec.len);
+      break;
+    default:
+      log("SYSERR: Journal commit %d has a record of unknown type %d.", seq, rec.type);
+      break;
+    }
+  }
+
+  return (changes);
+}
+
+
+int journal_replay_char(struct journal_replay *r, int pos, int seq, const char *data, int len)
+{
+  struct journal_run run;
+  int at;
+
+  if (!(r->read & JR_BIT(JR_CHAR))) {
+    r->read |= JR_BIT(JR_CHAR);
+    if (saver_read_at(player_fl, pos * sizeof(struct char_file_u), &r->rec, sizeof(struct char_file_u)))
+      r->ok |= JR_BIT(JR_CHAR);
+  }
+  if (!(r->ok & JR_BIT(JR_CHAR)) || seq <= r->rec.player_specials_saved.journal_seq)
+    return (0);
+
+  for (at = 0; at + (int) sizeof(run) <= len; at += sizeof(run) + run.len) {
+    memcpy(&run, data + at, sizeof(run));
+    if (run.len > len - at - (int) sizeof(run) || run.offset + run.len > (int) sizeof(struct char_file_u))
+      break;
+    memcpy((char *) &r->rec + run.offset, data + at + sizeof(run), run.len);
+  }
+
+  r->rec.player_specials_saved.journal_seq = seq;
+  r->dirty |= JR_BIT(JR_CHAR);
+  return (1);
+}
+
+
+int journal_replay_objs(struct journal_replay *r, int pos, int seq, const char *data, int len)
+{
+  if (!(r->read & JR_BIT(JR_OBJS))) {
+    r->read |= JR_BIT(JR_OBJS);
+    if (journal_read_objs(r, pos))
+      r->ok |= JR_BIT(JR_OBJS);
+  }
+  if (!(r->ok & JR_BIT(JR_OBJS)) || seq <= r->rent.journal_seq)
+    return (0);
+
+  journal_set_objs(&r->objs, data, len);
+  r->rent.journal_seq = seq;
+  r->dirty |= JR_BIT(JR_OBJS);
+  return (1);
+}
+
+
+/*
+ * Read the header of the rent file of the player at 'pos'; there may not
+ * be one.  Its objects are replaced whole, so they aren't needed.
+ */
+int journal_read_objs(struct journal_replay *r, int pos)
+{
+  char filename[MAX_INPUT_LENGTH], head[RENT_MAX_HEADER];
+  size_t len;
+  FILE *fl;
+
+  if (!get_filename(filename, sizeof(filename), CRASH_FILE, player_table[pos].name))
+    return (FALSE);
+  if (!(fl = fopen(filename, "rb")))
+    return (FALSE);
+
+  len = fread(head, 1, sizeof(head), fl);
+  fclose(fl);
+  return (rent_get_header(head, len, &r->rent, NULL) != RENT_FORMAT_BAD);
+}
+
+
+/* Write back, and free, what journal_boot() replayed. */
+int journal_replay_write(struct journal_replay **replay)
+{
+  char filename[MAX_INPUT_LENGTH], head[RENT_MAX_HEADER];
+  struct save_buf sb = { NULL, 0, 0 };
+  struct journal_replay *r;
+  int pos, written = 0;
+
+  for (pos = 0; pos <= top_of_p_table; pos++) {
+    if (!(r = replay[pos]))
+      continue;
+
+    if (r->dirty & JR_BIT(JR_CHAR)) {
+      save_char_record(pos, &r->rec);
+      written++;
+    }
+    if ((r->dirty & JR_BIT(JR_OBJS)) &&
+	get_filename(filename, sizeof(filename), CRASH_FILE, player_table[pos].name)) {
+      save_buf_add(&sb, head, rent_put_header(head, &r->rent));
+      save_buf_add(&sb, r->objs.data, r->objs.len);
+      saver_replace(filename, &sb);
+    }
+
+    if (r->objs.data)
+      free(r->objs.data);
+    free(r);
+  }
+
+  return (written);
+}
@@ -0,0 +1,24 @@
+/* ************************************************************************
+*   File: journal.h                                     Part of CircleMUD *
+*  Usage: header file for the journal of players' changes between saves   *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Change JOURNAL_VERSION whenever what goes into the journal changes.  A
+ * change to the size of struct char_file_u is caught on its own.
+ */
+#define JOURNAL_MAGIC		"CircJnl"
+#define JOURNAL_VERSION		2
+
+int journal_boot(void);
+int journal_stamp(void);
+void journal_char_saved(struct char_data *ch, struct char_file_u *st);
+void journal_objs_saved(struct char_data *ch, const char *objs, size_t len);
+void journal_update(void);
+void journal_compact(void);
+void journal_free(struct char_data *ch);
@@ -263,6 +263,7 @@ void gain_exp(struct char_data *ch, int gain)
     GET_EXP(ch) += gain;
     return;
   }
+  SET_DIRTY(ch, DIRTY_RECORD);
   if (gain > 0) {
     gain = MIN(max_exp_gain, gain);	/* put a cap on the max gain per kill */
     GET_EXP(ch) += gain;
@@ -302,6 +303,7 @@ void gain_exp_regardless(struct char_data *ch, int gain)
   GET_EXP(ch) += gain;
   if (GET_EXP(ch) < 0)
     GET_EXP(ch) = 0;
+  SET_DIRTY(ch, DIRTY_RECORD);
 
   if (!IS_NPC(ch)) {
     while (GET_LEVEL(ch) < LVL_IMPL &&
@@ -340,6 +342,7 @@ void gain_condition(struct char_data *ch, int condition, int value)
 
   GET_COND(ch, condition) = MAX(0, GET_COND(ch, condition));
   GET_COND(ch, condition) = MIN(24, GET_COND(ch, condition));
+  SET_DIRTY(ch, DIRTY_RECORD);
 
   if (GET_COND(ch, condition) || PLR_FLAGGED(ch, PLR_WRITING))
     return;
@@ -420,6 +423,7 @@ void point_update(void)
       GET_HIT(i) = MIN(GET_HIT(i) + hit_gain(i), GET_MAX_HIT(i));
       GET_MANA(i) = MIN(GET_MANA(i) + mana_gain(i), GET_MAX_MANA(i));
       GET_MOVE(i) = MIN(GET_MOVE(i) + move_gain(i), GET_MAX_MOVE(i));
+      SET_DIRTY(i, DIRTY_RECORD);
       if (AFF_FLAGGED(i, AFF_POISON))
 	if (damage(i, i, 2, SPELL_POISON) == -1)
 	  continue;	/* Oops, they died. -gg 6/24/98 */
@@ -81,8 +81,10 @@ void affect_update(void)
   for (i = character_list; i; i = i->next)
     for (af = i->affected; af; af = next) {
       next = af->next;
-      if (af->duration >= 1)
+      if (af->duration >= 1) {
 	af->duration--;
+	SET_DIRTY(i, DIRTY_RECORD);
+      }
       else if (af->duration == -1)	/* No action */
 	af->duration = -1;	/* GODs only! unlimited */
       else {
@@ -827,6 +829,7 @@ void mag_points(int level, struct char_data *ch, struct char_data *victim,
   }
   GET_HIT(victim) = MIN(GET_MAX_HIT(victim), GET_HIT(victim) + healing);
   GET_MOVE(victim) = MIN(GET_MAX_MOVE(victim), GET_MOVE(victim) + move);
+  SET_DIRTY(victim, DIRTY_RECORD);
   update_pos(victim);
 }
 
@@ -946,8 +949,10 @@ void mag_alter_objs(int level, struct char_data *ch, struct obj_data *obj,
 
   if (to_char == NULL)
     send_to_char(ch, "%s", NOEFFECT);
-  else
+  else {
+    obj_dirty(obj);
     act(to_char, TRUE, ch, obj, 0, TO_CHAR);
+  }
 
   if (to_room != NULL)
     act(to_room, TRUE, ch, obj, 0, TO_ROOM);
@@ -20,6 +20,7 @@
 #include "handler.h"
 #include "spells.h"
 #include "constants.h"
+#include "events.h"
 
 
 /* external globals */
@@ -30,150 +31,149 @@ ACMD(do_get);
 ACMD(do_action);
 
 /* local functions */
-void mobile_activity(void);
+EVENTFUNC(mobile_activity);
 void clearMemory(struct char_data *ch);
 bool aggressive_mob_on_a_leash(struct char_data *slave, struct char_data *master, struct char_data *attack);
 
 #define MOB_AGGR_TO_ALIGN (MOB_AGGR_EVIL | MOB_AGGR_NEUTRAL | MOB_AGGR_GOOD)
 
-void mobile_activity(void)
+/*
+ * One mobile's activity.  Each mob has its own event, started at a random
+ * point in the PULSE_MOBILE cycle when it's loaded, so they don't all go
+ * about their business on the same pulse.
+ */
+EVENTFUNC(mobile_activity)
 {
-  struct char_data *ch, *next_ch, *vict;
+  struct char_data *ch = (struct char_data *) event_obj, *vict;
   struct obj_data *obj, *best_obj;
   int door, found, max;
   memory_rec *names;
 
-  for (ch = character_list; ch; ch = next_ch) {
-    next_ch = ch->next;
-
-    if (!IS_MOB(ch))
-      continue;
-
-    /* Examine call for special procedure */
-    if (MOB_FLAGGED(ch, MOB_SPEC) && !no_specials) {
-      if (mob_index[GET_MOB_RNUM(ch)].func == NULL) {
-	log("SYSERR: %s (#%d): Attempting to call non-existing mob function.",
-		GET_NAME(ch), GET_MOB_VNUM(ch));
-	REMOVE_BIT(MOB_FLAGS(ch), MOB_SPEC);
-      } else {
-        char actbuf[MAX_INPUT_LENGTH] = "";
-	if ((mob_index[GET_MOB_RNUM(ch)].func) (ch, ch, 0, actbuf))
-	  continue;		/* go to next char */
-      }
+  /* Examine call for special procedure */
+  if (MOB_FLAGGED(ch, MOB_SPEC) && !no_specials) {
+    if (mob_index[GET_MOB_RNUM(ch)].func == NULL) {
+      log("SYSERR: %s (#%d): Attempting to call non-existing mob function.",
+	      GET_NAME(ch), GET_MOB_VNUM(ch));
+      REMOVE_BIT(MOB_FLAGS(ch), MOB_SPEC);
+    } else {
+      char actbuf[MAX_INPUT_LENGTH] = "";
+      if ((mob_index[GET_MOB_RNUM(ch)].func) (ch, ch, 0, actbuf))
+	return (PULSE_MOBILE);
     }
+  }
 
-    /* If the mob has no specproc, do the default actions */
-    if (FIGHTING(ch) || !AWAKE(ch))
-      continue;
-
-    /* Scavenger (picking up objects) */
-    if (MOB_FLAGGED(ch, MOB_SCAVENGER))
-      if (world[IN_ROOM(ch)].contents && !rand_number(0, 10)) {
-	max = 1;
-	best_obj = NULL;
-	for (obj = world[IN_ROOM(ch)].contents; obj; obj = obj->next_content)
-	  if (CAN_GET_OBJ(ch, obj) && GET_OBJ_COST(obj) > max) {
-	    best_obj = obj;
-	    max = GET_OBJ_COST(obj);
-	  }
-	if (best_obj != NULL) {
-	  obj_from_room(best_obj);
-	  obj_to_char(best_obj, ch);
-	  act("$n gets $p.", FALSE, ch, best_obj, 0, TO_ROOM);
+  /* If the mob has no specproc, do the default actions */
+  if (FIGHTING(ch) || !AWAKE(ch))
+    return (PULSE_MOBILE);
+
+  /* Scavenger (picking up objects) */
+  if (MOB_FLAGGED(ch, MOB_SCAVENGER))
+    if (world[IN_ROOM(ch)].contents && !rand_number(0, 10)) {
+      max = 1;
+      best_obj = NULL;
+      for (obj = world[IN_ROOM(ch)].contents; obj; obj = obj->next_content)
+	if (CAN_GET_OBJ(ch, obj) && GET_OBJ_COST(obj) > max) {
+	  best_obj = obj;
+	  max = GET_OBJ_COST(obj);
 	}
+      if (best_obj != NULL) {
+	obj_from_room(best_obj);
+	obj_to_char(best_obj, ch);
+	act("$n gets $p.", FALSE, ch, best_obj, 0, TO_ROOM);
       }
-
-    /* Mob Movement */
-    if (!MOB_FLAGGED(ch, MOB_SENTINEL) && (GET_POS(ch) == POS_STANDING) &&
-	((door = rand_number(0, 18)) < NUM_OF_DIRS) && CAN_GO(ch, door) &&
-	!ROOM_FLAGGED(EXIT(ch, door)->to_room, ROOM_NOMOB | ROOM_DEATH) &&
-	(!MOB_FLAGGED(ch, MOB_STAY_ZONE) ||
-	 (world[EXIT(ch, door)->to_room].zone == world[IN_ROOM(ch)].zone))) {
-      perform_move(ch, door, 1);
     }
 
-    /* Aggressive Mobs */
-    if (MOB_FLAGGED(ch, MOB_AGGRESSIVE | MOB_AGGR_TO_ALIGN)) {
-      found = FALSE;
-      for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
-	if (IS_NPC(vict) || !CAN_SEE(ch, vict) || PRF_FLAGGED(vict, PRF_NOHASSLE))
-	  continue;
+  /* Mob Movement */
+  if (!MOB_FLAGGED(ch, MOB_SENTINEL) && (GET_POS(ch) == POS_STANDING) &&
+      ((door = rand_number(0, 18)) < NUM_OF_DIRS) && CAN_GO(ch, door) &&
+      !ROOM_FLAGGED(EXIT(ch, door)->to_room, ROOM_NOMOB | ROOM_DEATH) &&
+      (!MOB_FLAGGED(ch, MOB_STAY_ZONE) ||
+       (world[EXIT(ch, door)->to_room].zone == world[IN_ROOM(ch)].zone))) {
+    perform_move(ch, door, 1);
+  }
 
-	if (MOB_FLAGGED(ch, MOB_WIMPY) && AWAKE(vict))
-	  continue;
+  /* Aggressive Mobs */
+  if (MOB_FLAGGED(ch, MOB_AGGRESSIVE | MOB_AGGR_TO_ALIGN)) {
+    found = FALSE;
+    for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
+      if (IS_NPC(vict) || !CAN_SEE(ch, vict) || PRF_FLAGGED(vict, PRF_NOHASSLE))
+	continue;
 
-	if (MOB_FLAGGED(ch, MOB_AGGRESSIVE  ) ||
-	   (MOB_FLAGGED(ch, MOB_AGGR_EVIL   ) && IS_EVIL(vict)) ||
-	   (MOB_FLAGGED(ch, MOB_AGGR_NEUTRAL) && IS_NEUTRAL(vict)) ||
-	   (MOB_FLAGGED(ch, MOB_AGGR_GOOD   ) && IS_GOOD(vict))) {
+      if (MOB_FLAGGED(ch, MOB_WIMPY) && AWAKE(vict))
+	continue;
 
-          /* Can a master successfully control the charmed monster? */
-          if (aggressive_mob_on_a_leash(ch, ch->master, vict))
-            continue;
+      if (MOB_FLAGGED(ch, MOB_AGGRESSIVE  ) ||
+	 (MOB_FLAGGED(ch, MOB_AGGR_EVIL   ) && IS_EVIL(vict)) ||
+	 (MOB_FLAGGED(ch, MOB_AGGR_NEUTRAL) && IS_NEUTRAL(vict)) ||
+	 (MOB_FLAGGED(ch, MOB_AGGR_GOOD   ) && IS_GOOD(vict))) {
 
-	  hit(ch, vict, TYPE_UNDEFINED);
-	  found = TRUE;
-	}
+        /* Can a master successfully control the charmed monster? */
+        if (aggressive_mob_on_a_leash(ch, ch->master, vict))
+          continue;
+
+	hit(ch, vict, TYPE_UNDEFINED);
+	found = TRUE;
       }
     }
+  }
 
-    /* Mob Memory */
-    if (MOB_FLAGGED(ch, MOB_MEMORY) && MEMORY(ch)) {
-      found = FALSE;
-      for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
-	if (IS_NPC(vict) || !CAN_SEE(ch, vict) || PRF_FLAGGED(vict, PRF_NOHASSLE))
-	  continue;
-
-	for (names = MEMORY(ch); names && !found; names = names->next) {
-	  if (names->id != GET_IDNUM(vict))
-            continue;
-
-          /* Can a master successfully control the charmed monster? */
-          if (aggressive_mob_on_a_leash(ch, ch->master, vict))
-            continue;
-
-          found = TRUE;
-          act("'Hey!  You're the fiend that attacked me!!!', exclaims $n.", FALSE, ch, 0, 0, TO_ROOM);
-          hit(ch, vict, TYPE_UNDEFINED);
-        }
+  /* Mob Memory */
+  if (MOB_FLAGGED(ch, MOB_MEMORY) && MEMORY(ch)) {
+    found = FALSE;
+    for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
+      if (IS_NPC(vict) || !CAN_SEE(ch, vict) || PRF_FLAGGED(vict, PRF_NOHASSLE))
+	continue;
+
+      for (names = MEMORY(ch); names && !found; names = names->next) {
+	if (names->id != GET_IDNUM(vict))
+          continue;
+
+        /* Can a master successfully control the charmed monster? */
+        if (aggressive_mob_on_a_leash(ch, ch->master, vict))
+          continue;
+
+        found = TRUE;
+        act("'Hey!  You're the fiend that attacked me!!!', exclaims $n.", FALSE, ch, 0, 0, TO_ROOM);
+        hit(ch, vict, TYPE_UNDEFINED);
       }
     }
+  }
 
-    /*
-     * Charmed Mob Rebellion
-     *
-     * In order to rebel, there need to be more charmed monsters
-     * than the person can feasibly control at a time.  Then the
-     * mobiles have a chance based on the charisma of their leader.
-     *
-     * 1-4 = 0, 5-7 = 1, 8-10 = 2, 11-13 = 3, 14-16 = 4, 17-19 = 5, etc.
-     */
-    if (AFF_FLAGGED(ch, AFF_CHARM) && ch->master && num_followers_charmed(ch->master) > (GET_CHA(ch->master) - 2) / 3) {
-      if (!aggressive_mob_on_a_leash(ch, ch->master, ch->master)) {
-        if (CAN_SEE(ch, ch->master) && !PRF_FLAGGED(ch->master, PRF_NOHASSLE))
-          hit(ch, ch->master, TYPE_UNDEFINED);
-        stop_follower(ch);
-      }
+  /*
+   * Charmed Mob Rebellion
+   *
+   * In order to rebel, there need to be more charmed monsters
+   * than the person can feasibly control at a time.  Then the
+   * mobiles have a chance based on the charisma of their leader.
+   *
+   * 1-4 = 0, 5-7 = 1, 8-10 = 2, 11-13 = 3, 14-16 = 4, 17-19 = 5, etc.
+   */
+  if (AFF_FLAGGED(ch, AFF_CHARM) && ch->master && num_followers_charmed(ch->master) > (GET_CHA(ch->master) - 2) / 3) {
+    if (!aggressive_mob_on_a_leash(ch, ch->master, ch->master)) {
+      if (CAN_SEE(ch, ch->master) && !PRF_FLAGGED(ch->master, PRF_NOHASSLE))
+        hit(ch, ch->master, TYPE_UNDEFINED);
+      stop_follower(ch);
     }
+  }
 
-    /* Helper Mobs */
-    if (MOB_FLAGGED(ch, MOB_HELPER) && !AFF_FLAGGED(ch, AFF_BLIND | AFF_CHARM)) {
-      found = FALSE;
-      for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
-	if (ch == vict || !IS_NPC(vict) || !FIGHTING(vict))
-	  continue;
-	if (IS_NPC(FIGHTING(vict)) || ch == FIGHTING(vict))
-	  continue;
-
-	act("$n jumps to the aid of $N!", FALSE, ch, 0, vict, TO_ROOM);
-	hit(ch, FIGHTING(vict), TYPE_UNDEFINED);
-	found = TRUE;
-      }
+  /* Helper Mobs */
+  if (MOB_FLAGGED(ch, MOB_HELPER) && !AFF_FLAGGED(ch, AFF_BLIND | AFF_CHARM)) {
+    found = FALSE;
+    for (vict = world[IN_ROOM(ch)].people; vict && !found; vict = vict->next_in_room) {
+      if (ch == vict || !IS_NPC(vict) || !FIGHTING(vict))
+	continue;
+      if (IS_NPC(FIGHTING(vict)) || ch == FIGHTING(vict))
+	continue;
+
+      act("$n jumps to the aid of $N!", FALSE, ch, 0, vict, TO_ROOM);
+      hit(ch, FIGHTING(vict), TYPE_UNDEFINED);
+      found = TRUE;
     }
+  }
 
-    /* Add new mobile actions here */
+  /* Add new mobile actions here */
 
-  }				/* end for() */
+  return (PULSE_MOBILE);
 }
 
 
@@ -19,6 +19,9 @@
 #include "interpreter.h"
 #include "utils.h"
 #include "spells.h"
+#include "saver.h"
+#include "journal.h"
+#include "rentfile.h"
 
 /* these factors should be unique integers */
 #define RENT_FACTOR 	1
@@ -49,13 +52,14 @@ int Crash_offer_rent(struct char_data *ch, struct char_data *recep, int display,
 int Crash_report_unrentables(struct char_data *ch, struct char_data *recep, struct obj_data *obj);
 void Crash_report_rent(struct char_data *ch, struct char_data *recep, struct obj_data *obj, long *cost, long *nitems, int display, int factor);
 struct obj_data *Obj_from_store(struct obj_file_elem object, int *location);
+struct obj_data *Obj_from_rent(struct rent_obj *robj);
+void Obj_to_elem(struct obj_data *obj, struct obj_file_elem *object, int location);
 int Obj_to_store(struct obj_data *obj, FILE *fl, int location);
 void update_obj_file(void);
-int Crash_write_rentcode(struct char_data *ch, FILE *fl, struct rent_info *rent);
+void Crash_write_rentcode(struct char_data *ch, struct save_buf *sb, struct rent_info *rent);
 int gen_receptionist(struct char_data *ch, struct char_data *recep, int cmd, char *arg, int mode);
-int Crash_save(struct obj_data *obj, FILE *fp, int location);
+void Crash_save(struct obj_data *obj, struct save_buf *sb, int location);
 void Crash_rent_deadline(struct char_data *ch, struct char_data *recep, long cost);
-void Crash_restore_weight(struct obj_data *obj);
 void Crash_extract_objs(struct obj_data *obj);
 int Crash_is_unrentable(struct obj_data *obj);
 void Crash_extract_norents(struct obj_data *obj);
@@ -63,6 +67,10 @@ void Crash_extract_expensive(struct obj_data *obj);
 void Crash_calculate_rent(struct obj_data *obj, int *cost);
 void Crash_rentsave(struct char_data *ch, int cost);
 void Crash_cryosave(struct char_data *ch, int cost);
+void Crash_save_objs(struct char_data *ch, struct save_buf *sb);
+char *Crash_read_file(FILE *fl, size_t *len);
+int Crash_load_elems(struct char_data *ch, const char *data, size_t len, size_t at);
+int Crash_load_objs(struct char_data *ch, struct obj_data *cont, const char *data, size_t len, size_t *at, int *num_objs);
 
 
 struct obj_data *Obj_from_store(struct obj_file_elem object, int *location)
@@ -95,31 +103,67 @@ struct obj_data *Obj_from_store(struct obj_file_elem object, int *location)
 }
 
 
+/* Load the object 'robj' from a compact rent file, NULL if it's gone. */
+struct obj_data *Obj_from_rent(struct rent_obj *robj)
+{
+  struct obj_data *obj;
+  obj_rnum itemnum;
+  int j;
 
-int Obj_to_store(struct obj_data *obj, FILE *fl, int location)
+  if ((itemnum = real_object(robj->vnum)) == NOTHING)
+    return (NULL);
+
+  obj = read_object(itemnum, REAL);
+  for (j = 0; j < 4; j++)
+    if (IS_SET(robj->mask, RF_VALUE0 << j))
+      GET_OBJ_VAL(obj, j) = robj->elem.value[j];
+  if (IS_SET(robj->mask, RF_EXTRA))
+    GET_OBJ_EXTRA(obj) = robj->elem.extra_flags;
+  if (IS_SET(robj->mask, RF_WEIGHT))
+    GET_OBJ_WEIGHT(obj) = robj->elem.weight;
+  if (IS_SET(robj->mask, RF_TIMER))
+    GET_OBJ_TIMER(obj) = robj->elem.timer;
+  if (IS_SET(robj->mask, RF_BITVECTOR))
+    GET_OBJ_AFFECT(obj) = robj->elem.bitvector;
+  for (j = 0; j < robj->affects; j++)
+    obj->affected[j] = robj->elem.affected[j];
+
+  return (obj);
+}
+
+
+
+void Obj_to_elem(struct obj_data *obj, struct obj_file_elem *object, int location)
 {
   int j;
-  struct obj_file_elem object;
 
 #if !USE_AUTOEQ
   (void)location;
 #endif
 
-  object.item_number = GET_OBJ_VNUM(obj);
+  memset(object, 0, sizeof(struct obj_file_elem));	/* no stray bytes to journal */
+  object->item_number = GET_OBJ_VNUM(obj);
 #if USE_AUTOEQ
-  object.location = location;
+  object->location = location;
 #endif
-  object.value[0] = GET_OBJ_VAL(obj, 0);
-  object.value[1] = GET_OBJ_VAL(obj, 1);
-  object.value[2] = GET_OBJ_VAL(obj, 2);
-  object.value[3] = GET_OBJ_VAL(obj, 3);
-  object.extra_flags = GET_OBJ_EXTRA(obj);
-  object.weight = GET_OBJ_WEIGHT(obj);
-  object.timer = GET_OBJ_TIMER(obj);
-  object.bitvector = GET_OBJ_AFFECT(obj);
+  object->value[0] = GET_OBJ_VAL(obj, 0);
+  object->value[1] = GET_OBJ_VAL(obj, 1);
+  object->value[2] = GET_OBJ_VAL(obj, 2);
+  object->value[3] = GET_OBJ_VAL(obj, 3);
+  object->extra_flags = GET_OBJ_EXTRA(obj);
+  object->weight = GET_OBJ_WEIGHT(obj);
+  object->timer = GET_OBJ_TIMER(obj);
+  object->bitvector = GET_OBJ_AFFECT(obj);
   for (j = 0; j < MAX_OBJ_AFFECT; j++)
-    object.affected[j] = obj->affected[j];
+    object->affected[j] = obj->affected[j];
+}
+
+
+int Obj_to_store(struct obj_data *obj, FILE *fl, int location)
+{
+  struct obj_file_elem object;
 
+  Obj_to_elem(obj, &object, location);
   if (fwrite(&object, sizeof(struct obj_file_elem), 1, fl) < 1) {
     perror("SYSERR: error writing object in Obj_to_store");
     return (0);
@@ -229,20 +273,12 @@ void auto_equip(struct char_data *ch, struct obj_data *obj, int location)
 int Crash_delete_file(char *name)
 {
   char filename[50];
-  FILE *fl;
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return (0);
-  if (!(fl = fopen(filename, "rb"))) {
-    if (errno != ENOENT)	/* if it fails but NOT because of no file */
-      log("SYSERR: deleting crash file %s (1): %s", filename, strerror(errno));
-    return (0);
-  }
-  fclose(fl);
 
-  /* if it fails, NOT because of no file */
-  if (remove(filename) < 0 && errno != ENOENT)
-    log("SYSERR: deleting crash file %s (2): %s", filename, strerror(errno));
+  /* In turn with whatever's still to be written to it. */
+  saver_remove(filename);
 
   return (1);
 }
@@ -250,22 +286,23 @@ int Crash_delete_file(char *name)
 
 int Crash_delete_crashfile(struct char_data *ch)
 {
-  char filename[MAX_INPUT_LENGTH];
+  char filename[MAX_INPUT_LENGTH], head[RENT_MAX_HEADER];
   struct rent_info rent;
-  int numread;
+  size_t numread;
   FILE *fl;
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, GET_NAME(ch)))
     return (0);
+  saver_wait(filename);
   if (!(fl = fopen(filename, "rb"))) {
     if (errno != ENOENT)	/* if it fails, NOT because of no file */
       log("SYSERR: checking for crash file %s (3): %s", filename, strerror(errno));
     return (0);
   }
-  numread = fread(&rent, sizeof(struct rent_info), 1, fl);
+  numread = fread(head, 1, sizeof(head), fl);
   fclose(fl);
 
-  if (numread == 0)
+  if (rent_get_header(head, numread, &rent, NULL) == RENT_FORMAT_BAD)
     return (0);
 
   if (rent.rentcode == RENT_CRASH)
@@ -277,9 +314,9 @@ int Crash_delete_crashfile(struct char_data *ch)
 
 int Crash_clean_file(char *name)
 {
-  char filename[MAX_STRING_LENGTH];
+  char filename[MAX_STRING_LENGTH], head[RENT_MAX_HEADER];
   struct rent_info rent;
-  int numread;
+  size_t numread;
   FILE *fl;
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
@@ -293,10 +330,10 @@ int Crash_clean_file(char *name)
       log("SYSERR: OPENING OBJECT FILE %s (4): %s", filename, strerror(errno));
     return (0);
   }
-  numread = fread(&rent, sizeof(struct rent_info), 1, fl);
+  numread = fread(head, 1, sizeof(head), fl);
   fclose(fl);
 
-  if (numread == 0)
+  if (rent_get_header(head, numread, &rent, NULL) == RENT_FORMAT_BAD)
     return (0);
 
   if ((rent.rentcode == RENT_CRASH) ||
@@ -343,27 +380,50 @@ void update_obj_file(void)
 }
 
 
+/* Read all of 'fl' into a new buffer, and close it. */
+char *Crash_read_file(FILE *fl, size_t *len)
+{
+  char *data;
+  long size;
+
+  *len = 0;
+  if (fseek(fl, 0, SEEK_END) < 0 || (size = ftell(fl)) < 0) {
+    fclose(fl);
+    return (NULL);
+  }
+  rewind(fl);
+  CREATE(data, char, size + 1);
+  *len = fread(data, 1, size, fl);
+  fclose(fl);
+  return (data);
+}
+
+
 void Crash_listrent(struct char_data *ch, char *name)
 {
   FILE *fl;
-  char filename[MAX_INPUT_LENGTH];
+  char filename[MAX_INPUT_LENGTH], *data;
   struct obj_file_elem object;
+  struct rent_obj robj;
   struct obj_data *obj;
   struct rent_info rent;
-  int numread;
+  size_t len, at;
+  int format, depth = 0;
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return;
+  saver_wait(filename);
   if (!(fl = fopen(filename, "rb"))) {
     send_to_char(ch, "%s has no rent file.\r\n", name);
     return;
   }
-  numread = fread(&rent, sizeof(struct rent_info), 1, fl);
+  data = Crash_read_file(fl, &len);
 
   /* Oops, can't get the data, punt. */
-  if (numread == 0) {
+  if (!data || (format = rent_get_header(data, len, &rent, &at)) == RENT_FORMAT_BAD) {
     send_to_char(ch, "Error reading rent information.\r\n");
-    fclose(fl);
+    if (data)
+      free(data);
     return;
   }
 
@@ -386,18 +446,10 @@ void Crash_listrent(struct char_data *ch, char *name)
     send_to_char(ch, "Undef\r\n");
     break;
   }
-  while (!feof(fl)) {
-    if (fread(&object, sizeof(struct obj_file_elem), 1, fl) != 1) {
-      if (feof(fl))
-        break;
-      fclose(fl);
-      return;
-    }
-    if (ferror(fl)) {
-      fclose(fl);
-      return;
-    }
-    if (!feof(fl))
+
+  if (format == RENT_FORMAT_OLD) {
+    for (; at + sizeof(struct obj_file_elem) <= len; at += sizeof(struct obj_file_elem)) {
+      memcpy(&object, data + at, sizeof(struct obj_file_elem));
       if (real_object(object.item_number) != NOTHING) {
 	obj = read_object(object.item_number, VIRTUAL);
 #if USE_AUTOEQ
@@ -411,20 +463,49 @@ void Crash_listrent(struct char_data *ch, char *name)
 #endif
 	extract_obj(obj);
       }
+    }
+    free(data);
+    return;
   }
-  fclose(fl);
+
+  /* Contents are listed under their container, indented. */
+  for (;;) {
+    switch (rent_get_obj(data, len, &at, &robj)) {
+    case RENT_OBJ:
+      if ((obj = Obj_from_rent(&robj)) != NULL) {
+#if USE_AUTOEQ
+	send_to_char(ch, " %*s[%5d] (%5dau) <%2d> %-20s\r\n", depth * 2, "",
+		robj.vnum, GET_OBJ_RENT(obj), robj.location, obj->short_description);
+#else
+	send_to_char(ch, " %*s[%5d] (%5dau) %-20s\r\n", depth * 2, "",
+		robj.vnum, GET_OBJ_RENT(obj), obj->short_description);
+#endif
+	extract_obj(obj);
+      }
+      if (IS_SET(robj.mask, RF_CONTAINS))
+	depth++;
+      continue;
+    case RENT_END:
+      if (depth-- > 0)
+	continue;
+      break;
+    default:
+      send_to_char(ch, "The rest of the file is damaged.\r\n");
+      break;
+    }
+    break;
+  }
+  free(data);
 }
 
 
-int Crash_write_rentcode(struct char_data *ch, FILE *fl, struct rent_info *rent)
+void Crash_write_rentcode(struct char_data *ch, struct save_buf *sb, struct rent_info *rent)
 {
+  char buf[RENT_MAX_HEADER];
+
   (void)ch;
 
-  if (fwrite(rent, sizeof(struct rent_info), 1, fl) < 1) {
-    perror("SYSERR: writing rent code");
-    return (0);
-  }
-  return (1);
+  save_buf_add(sb, buf, rent_put_header(buf, rent));
 }
 
 
@@ -437,22 +518,16 @@ int Crash_write_rentcode(struct char_data *ch, FILE *fl, struct rent_info *rent)
 int Crash_load(struct char_data *ch)
 {
   FILE *fl;
-  char filename[MAX_STRING_LENGTH];
-  struct obj_file_elem object;
+  char filename[MAX_STRING_LENGTH], *data;
   struct rent_info rent;
-  int cost, orig_rent_code, num_objs = 0, j;
+  size_t len, at;
+  int cost, orig_rent_code, num_objs = 0, format;
   float num_of_days;
-  /* AutoEQ addition. */
-  struct obj_data *obj, *obj2, *cont_row[MAX_BAG_ROWS];
-  int location;
-
-  /* Empty all of the container lists (you never know ...) */
-  for (j = 0; j < MAX_BAG_ROWS; j++)
-    cont_row[j] = NULL;
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, GET_NAME(ch)))
     return (1);
-  if (!(fl = fopen(filename, "r+b"))) {
+  saver_wait(filename);
+  if (!(fl = fopen(filename, "rb"))) {
     if (errno != ENOENT) {	/* if it fails, NOT because of no file */
       log("SYSERR: READING OBJECT FILE %s (5): %s", filename, strerror(errno));
       send_to_char(ch,
@@ -463,13 +538,16 @@ int Crash_load(struct char_data *ch)
     mudlog(NRM, MAX(LVL_IMMORT, GET_INVIS_LEV(ch)), TRUE, "%s entering game with no equipment.", GET_NAME(ch));
     return (1);
   }
-  if (!feof(fl)) {
-    if (fread(&rent, sizeof(struct rent_info), 1, fl) != 1) {
-      fclose(fl);
-      return (1);
-    }
-  } else {
+  if (!(data = Crash_read_file(fl, &len)))
+    return (1);
+  if (!len) {
     log("SYSERR: Crash_load: %s's rent file was empty!", GET_NAME(ch));
+    free(data);
+    return (1);
+  }
+  if ((format = rent_get_header(data, len, &rent, &at)) == RENT_FORMAT_BAD) {
+    log("SYSERR: Crash_load: %s's rent file is damaged.", GET_NAME(ch));
+    free(data);
     return (1);
   }
 
@@ -477,7 +555,7 @@ int Crash_load(struct char_data *ch)
     num_of_days = (float) (time(0) - rent.time) / SECS_PER_REAL_DAY;
     cost = (int) (rent.net_cost_per_diem * num_of_days);
     if (cost > GET_GOLD(ch) + GET_BANK_GOLD(ch)) {
-      fclose(fl);
+      free(data);
       mudlog(BRF, MAX(LVL_IMMORT, GET_INVIS_LEV(ch)), TRUE, "%s entering game, rented equipment lost (no $).", GET_NAME(ch));
       Crash_crashsave(ch);
       return (2);
@@ -507,21 +585,48 @@ int Crash_load(struct char_data *ch)
     break;
   }
 
-  while (!feof(fl)) {
-    if (fread(&object, sizeof(struct obj_file_elem), 1, fl) != 1) {
-      if (feof(fl))
-        break;
-      perror("SYSERR: Reading crash file: Crash_load");
-      fclose(fl);
-      return (1);
-    }
-    if (ferror(fl)) {
-      perror("SYSERR: Reading crash file: Crash_load");
-      fclose(fl);
-      return (1);
-    }
-    if (feof(fl))
-      break;
+  if (format == RENT_FORMAT_OLD)
+    num_objs = Crash_load_elems(ch, data, len, at);
+  else if (!Crash_load_objs(ch, NULL, data, len, &at, &num_objs))
+    log("SYSERR: Crash_load: %s's rent file is damaged after %d object%s.",
+	GET_NAME(ch), num_objs, num_objs != 1 ? "s" : "");
+  free(data);
+
+  /* Little hoarding check. -gg 3/1/98 */
+  mudlog(NRM, MAX(GET_INVIS_LEV(ch), LVL_GOD), TRUE, "%s (level %d) has %d object%s (max %d).",
+	GET_NAME(ch), GET_LEVEL(ch), num_objs, num_objs != 1 ? "s" : "", max_obj_save);
+
+  /*
+   * Turn this into a crash file.  It's written anew rather than having its
+   * control block rewritten, which also brings an old file up to date.
+   */
+  Crash_crashsave(ch);
+
+  if ((orig_rent_code == RENT_RENTED) || (orig_rent_code == RENT_CRYO))
+    return (0);
+  else
+    return (1);
+}
+
+
+/*
+ * Load the obj_file_elems of an old rent file, from 'at' on, returning
+ * how many there were.
+ */
+int Crash_load_elems(struct char_data *ch, const char *data, size_t len, size_t at)
+{
+  struct obj_file_elem object;
+  int num_objs = 0, j;
+  /* AutoEQ addition. */
+  struct obj_data *obj, *obj2, *cont_row[MAX_BAG_ROWS];
+  int location;
+
+  /* Empty all of the container lists (you never know ...) */
+  for (j = 0; j < MAX_BAG_ROWS; j++)
+    cont_row[j] = NULL;
+
+  for (; at + sizeof(struct obj_file_elem) <= len; at += sizeof(struct obj_file_elem)) {
+    memcpy(&object, data + at, sizeof(struct obj_file_elem));
     ++num_objs;
     if ((obj = Obj_from_store(object, &location)) == NULL)
       continue;
@@ -623,53 +728,75 @@ int Crash_load(struct char_data *ch)
     }
   }
 
-  /* Little hoarding check. -gg 3/1/98 */
-  mudlog(NRM, MAX(GET_INVIS_LEV(ch), LVL_GOD), TRUE, "%s (level %d) has %d object%s (max %d).",
-	GET_NAME(ch), GET_LEVEL(ch), num_objs, num_objs != 1 ? "s" : "", max_obj_save);
-
-  /* turn this into a crash file by re-writing the control block */
-  rent.rentcode = RENT_CRASH;
-  rent.time = time(0);
-  rewind(fl);
-  Crash_write_rentcode(ch, fl, &rent);
-
-  fclose(fl);
-
-  if ((orig_rent_code == RENT_RENTED) || (orig_rent_code == RENT_CRYO))
-    return (0);
-  else
-    return (1);
+  return (num_objs);
 }
 
 
-
-int Crash_save(struct obj_data *obj, FILE *fp, int location)
+/*
+ * Load the list at 'at' in a compact rent file into 'cont', or onto 'ch'
+ * if it's NULL, counting what's in it in 'num_objs'.  The contents of a
+ * container that's gone, or is no longer a container, go where it would
+ * have.  FALSE if the file is damaged.
+ */
+int Crash_load_objs(struct char_data *ch, struct obj_data *cont, const char *data, size_t len, size_t *at, int *num_objs)
 {
-  struct obj_data *tmp;
+  struct rent_obj robj;
+  struct obj_data *obj;
   int result;
 
-  if (obj) {
-    Crash_save(obj->next_content, fp, location);
-    Crash_save(obj->contains, fp, MIN(0, location) - 1);
-    result = Obj_to_store(obj, fp, location);
+  while ((result = rent_get_obj(data, len, at, &robj)) == RENT_OBJ) {
+    ++*num_objs;
+    obj = Obj_from_rent(&robj);
 
-    for (tmp = obj->in_obj; tmp; tmp = tmp->in_obj)
-      GET_OBJ_WEIGHT(tmp) -= GET_OBJ_WEIGHT(obj);
+    if (IS_SET(robj.mask, RF_CONTAINS) && !Crash_load_objs(ch,
+		obj && GET_OBJ_TYPE(obj) == ITEM_CONTAINER ? obj : cont, data, len, at, num_objs))
+      result = RENT_BAD;
 
-    if (!result)
-      return (0);
+    if (obj) {
+      if (cont)
+	obj_to_obj(obj, cont);
+      else
+#if USE_AUTOEQ
+	auto_equip(ch, obj, robj.location);
+#else
+	auto_equip(ch, obj, LOC_INVENTORY);
+#endif
+    }
+    if (result == RENT_BAD)
+      break;
   }
-  return (TRUE);
+
+  return (result != RENT_BAD);
 }
 
 
-void Crash_restore_weight(struct obj_data *obj)
+
+void Crash_save(struct obj_data *obj, struct save_buf *sb, int location)
 {
+  struct obj_file_elem object, proto;
+  struct obj_data *tmp;
+  char buf[RENT_MAX_OBJ];
+  size_t len;
+
   if (obj) {
-    Crash_restore_weight(obj->contains);
-    Crash_restore_weight(obj->next_content);
-    if (obj->in_obj)
-      GET_OBJ_WEIGHT(obj->in_obj) += GET_OBJ_WEIGHT(obj);
+    Crash_save(obj->next_content, sb, location);
+
+    /* Its own weight, without what's in it: loading puts that back. */
+    Obj_to_elem(obj, &object, location);
+    for (tmp = obj->contains; tmp; tmp = tmp->next_content)
+      object.weight -= GET_OBJ_WEIGHT(tmp);
+
+    if (GET_OBJ_RNUM(obj) != NOTHING) {
+      Obj_to_elem(&obj_proto[GET_OBJ_RNUM(obj)], &proto, location);
+      len = rent_put_obj(buf, &object, &proto, location, obj->contains != NULL);
+    } else
+      len = rent_put_obj(buf, &object, NULL, location, obj->contains != NULL);
+    save_buf_add(sb, buf, len);
+
+    if (obj->contains) {
+      Crash_save(obj->contains, sb, LOC_INVENTORY);
+      save_buf_add(sb, buf, rent_put_end(buf));
+    }
   }
 }
 
@@ -752,60 +879,57 @@ void Crash_calculate_rent(struct obj_data *obj, int *cost)
 void Crash_crashsave(struct char_data *ch)
 {
   char buf[MAX_INPUT_LENGTH];
+  struct save_buf sb = { NULL, 0, 0 };
   struct rent_info rent;
-  int j;
-  FILE *fp;
+  size_t objs;
 
   if (IS_NPC(ch))
     return;
 
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
-  if (!(fp = fopen(buf, "wb")))
-    return;
 
+  memset(&rent, 0, sizeof(rent));
   rent.rentcode = RENT_CRASH;
   rent.time = time(0);
-  if (!Crash_write_rentcode(ch, fp, &rent)) {
-    fclose(fp);
-    return;
-  }
+  rent.journal_seq = journal_stamp();
+  Crash_write_rentcode(ch, &sb, &rent);
+  objs = sb.len;
+  Crash_save_objs(ch, &sb);
+
+  journal_objs_saved(ch, sb.data + objs, sb.len - objs);
+  saver_replace(buf, &sb);
+  REMOVE_BIT(GET_DIRTY(ch), DIRTY_OBJS);
+  REMOVE_BIT(PLR_FLAGS(ch), PLR_CRASH);	/* left over from before DIRTY_OBJS */
+}
 
-  for (j = 0; j < NUM_WEARS; j++)
-    if (GET_EQ(ch, j)) {
-      if (!Crash_save(GET_EQ(ch, j), fp, j + 1)) {
-	fclose(fp);
-	return;
-      }
-      Crash_restore_weight(GET_EQ(ch, j));
-    }
 
-  if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
-    return;
-  }
-  Crash_restore_weight(ch->carrying);
+/* Add what 'ch' wears and carries to 'sb', as their rent file has them. */
+void Crash_save_objs(struct char_data *ch, struct save_buf *sb)
+{
+  char buf[RENT_MAX_OBJ];
+  int j;
 
-  fclose(fp);
-  REMOVE_BIT(PLR_FLAGS(ch), PLR_CRASH);
+  for (j = 0; j < NUM_WEARS; j++)
+    Crash_save(GET_EQ(ch, j), sb, j + 1);
+  Crash_save(ch->carrying, sb, LOC_INVENTORY);
+  save_buf_add(sb, buf, rent_put_end(buf));
 }
 
 
 void Crash_idlesave(struct char_data *ch)
 {
   char buf[MAX_INPUT_LENGTH];
+  struct save_buf sb = { NULL, 0, 0 };
   struct rent_info rent;
   int j;
   int cost, cost_eq;
-  FILE *fp;
 
   if (IS_NPC(ch))
     return;
 
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
-  if (!(fp = fopen(buf, "wb")))
-    return;
 
   Crash_extract_norent_eq(ch);
   Crash_extract_norents(ch->carrying);
@@ -836,36 +960,25 @@ void Crash_idlesave(struct char_data *ch)
   if (ch->carrying == NULL) {
     for (j = 0; j < NUM_WEARS && GET_EQ(ch, j) == NULL; j++) /* Nothing */ ;
     if (j == NUM_WEARS) {	/* No equipment or inventory. */
-      fclose(fp);
       Crash_delete_file(GET_NAME(ch));
       return;
     }
   }
+  memset(&rent, 0, sizeof(rent));
   rent.net_cost_per_diem = cost;
 
   rent.rentcode = RENT_TIMEDOUT;
+  rent.journal_seq = journal_stamp();
   rent.time = time(0);
   rent.gold = GET_GOLD(ch);
   rent.account = GET_BANK_GOLD(ch);
-  if (!Crash_write_rentcode(ch, fp, &rent)) {
-    fclose(fp);
-    return;
-  }
-  for (j = 0; j < NUM_WEARS; j++) {
-    if (GET_EQ(ch, j)) {
-      if (!Crash_save(GET_EQ(ch, j), fp, j + 1)) {
-        fclose(fp);
-        return;
-      }
-      Crash_restore_weight(GET_EQ(ch, j));
-      Crash_extract_objs(GET_EQ(ch, j));
-    }
-  }
-  if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
-    return;
-  }
-  fclose(fp);
+  Crash_write_rentcode(ch, &sb, &rent);
+
+  Crash_save_objs(ch, &sb);
+  saver_replace(buf, &sb);
+
+  for (j = 0; j < NUM_WEARS; j++)
+    Crash_extract_objs(GET_EQ(ch, j));
 
   Crash_extract_objs(ch->carrying);
 }
@@ -874,44 +987,33 @@ void Crash_idlesave(struct char_data *ch)
 void Crash_rentsave(struct char_data *ch, int cost)
 {
   char buf[MAX_INPUT_LENGTH];
+  struct save_buf sb = { NULL, 0, 0 };
   struct rent_info rent;
   int j;
-  FILE *fp;
 
   if (IS_NPC(ch))
     return;
 
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
-  if (!(fp = fopen(buf, "wb")))
-    return;
 
   Crash_extract_norent_eq(ch);
   Crash_extract_norents(ch->carrying);
 
+  memset(&rent, 0, sizeof(rent));
   rent.net_cost_per_diem = cost;
   rent.rentcode = RENT_RENTED;
+  rent.journal_seq = journal_stamp();
   rent.time = time(0);
   rent.gold = GET_GOLD(ch);
   rent.account = GET_BANK_GOLD(ch);
-  if (!Crash_write_rentcode(ch, fp, &rent)) {
-    fclose(fp);
-    return;
-  }
+  Crash_write_rentcode(ch, &sb, &rent);
+
+  Crash_save_objs(ch, &sb);
+  saver_replace(buf, &sb);
+
   for (j = 0; j < NUM_WEARS; j++)
-    if (GET_EQ(ch, j)) {
-      if (!Crash_save(GET_EQ(ch,j), fp, j + 1)) {
-        fclose(fp);
-        return;
-      }
-      Crash_restore_weight(GET_EQ(ch, j));
-      Crash_extract_objs(GET_EQ(ch, j));
-    }
-  if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
-    return;
-  }
-  fclose(fp);
+    Crash_extract_objs(GET_EQ(ch, j));
 
   Crash_extract_objs(ch->carrying);
 }
@@ -920,52 +1022,52 @@ void Crash_rentsave(struct char_data *ch, int cost)
 void Crash_cryosave(struct char_data *ch, int cost)
 {
   char buf[MAX_INPUT_LENGTH];
+  struct save_buf sb = { NULL, 0, 0 };
   struct rent_info rent;
   int j;
-  FILE *fp;
 
   if (IS_NPC(ch))
     return;
 
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
-  if (!(fp = fopen(buf, "wb")))
-    return;
 
   Crash_extract_norent_eq(ch);
   Crash_extract_norents(ch->carrying);
 
   GET_GOLD(ch) = MAX(0, GET_GOLD(ch) - cost);
 
+  memset(&rent, 0, sizeof(rent));
   rent.rentcode = RENT_CRYO;
+  rent.journal_seq = journal_stamp();
   rent.time = time(0);
   rent.gold = GET_GOLD(ch);
   rent.account = GET_BANK_GOLD(ch);
   rent.net_cost_per_diem = 0;
-  if (!Crash_write_rentcode(ch, fp, &rent)) {
-    fclose(fp);
-    return;
-  }
+  Crash_write_rentcode(ch, &sb, &rent);
+
+  Crash_save_objs(ch, &sb);
+  saver_replace(buf, &sb);
+
   for (j = 0; j < NUM_WEARS; j++)
-    if (GET_EQ(ch, j)) {
-      if (!Crash_save(GET_EQ(ch, j), fp, j + 1)) {
-        fclose(fp);
-        return;
-      }
-      Crash_restore_weight(GET_EQ(ch, j));
-      Crash_extract_objs(GET_EQ(ch, j));
-    }
-  if (!Crash_save(ch->carrying, fp, 0)) {
-    fclose(fp);
-    return;
-  }
-  fclose(fp);
+    Crash_extract_objs(GET_EQ(ch, j));
 
   Crash_extract_objs(ch->carrying);
   SET_BIT(PLR_FLAGS(ch), PLR_CRYO);
 }
 
 
+/* Wait for what's been saved of 'ch' to reach the disk, as they leave. */
+void Crash_flush(struct char_data *ch)
+{
+  char buf[MAX_INPUT_LENGTH];
+
+  if (get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
+    saver_wait(buf);
+  saver_wait(PLAYER_FILE);
+}
+
+
 /* ************************************************************************
 * Routines used for the receptionist					  *
 ************************************************************************* */
@@ -1173,16 +1275,29 @@ SPECIAL(cryogenicist)
 }
 
 
+/*
+ * Save whoever's changed since they were last saved.  With the journal,
+ * that's only whatever's changed since it last compared them; the rest
+ * journal_compact() saves.
+ */
 void Crash_save_all(void)
 {
   struct descriptor_data *d;
+  int dirty;
+
   for (d = descriptor_list; d; d = d->next) {
     if ((STATE(d) == CON_PLAYING) && !IS_NPC(d->character)) {
-      if (PLR_FLAGGED(d->character, PLR_CRASH)) {
+      dirty = GET_DIRTY(d->character);
+      if (dirty & DIRTY_OBJS) {
 	Crash_crashsave(d->character);
+	saves_done[SAVES_OBJS]++;
+      } else
+	saves_skipped[SAVES_OBJS]++;
+      if (dirty & (DIRTY_RECORD | DIRTY_OBJS)) {
 	save_char(d->character);
-	REMOVE_BIT(PLR_FLAGS(d->character), PLR_CRASH);
-      }
+	saves_done[SAVES_RECORD]++;
+      } else
+	saves_skipped[SAVES_RECORD]++;
     }
   }
 }
@@ -24,6 +24,8 @@
 #include "handler.h"
 #include "db.h"
 #include "olc.h"
+#include "intern.h"
+#include "worldimg.h"
 
 /* OLC command format:
  *
@@ -280,15 +282,15 @@ void olc_string(char **string, size_t maxlen, char *arg)
 
   if (!*arg) {
     send_to_char(olc_ch, "Enter new string (max of %d characters); use '@' on a new line when done.\r\n", (int) maxlen);
-    **string = '\0';
+    WORLD_FREE_STR(*string);	/* the editor writes into its own copy */
+    *string = NULL;
     string_write(olc_ch->desc, string, maxlen, 0, NULL);
   } else {
     if (strlen(arg) > maxlen) {
       send_to_char(olc_ch, "String too long (cannot be more than %d chars).\r\n", (int) maxlen);
     } else {
-      if (*string != NULL)
-	free(*string);
-      *string = strdup(arg);
+      WORLD_FREE_STR(*string);
+      *string = str_intern(strdup(arg));
       send_to_char(olc_ch, "%s", OK);
     }
   }
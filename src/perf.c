@@ -0,0 +1,341 @@
+/* ************************************************************************
+*   File: perf.c                                        Part of CircleMUD *
+*  Usage: timing the phases of each pulse, and each command               *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * game_loop() reads the clock once as each phase of a pass ends, and
+ * command_interpreter() around each command, and the time taken goes in
+ * that phase's (or command's) histogram.  A clock read and a histogram
+ * update come to well under a microsecond, a pulse makes a couple dozen
+ * of them, and so the profiler is meant to be left on.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#include "interpreter.h"
+#include "db.h"
+#include "perf.h"
+
+/* local globals */
+int perf_on = TRUE;
+time_t perf_since;			/* when the counts were last reset */
+struct perf_hist perf_phases[NUM_PERF_PHASES];
+struct perf_hist **perf_cmds;		/* by cmd_info index, made as used */
+int perf_num_cmds;
+
+const char *perf_phase_names[NUM_PERF_PHASES] = {
+  "pulse",
+  "  network",
+  "  accept",
+  "  input",
+  "  commands",
+  "  output",
+  "  prompts",
+  "  close, wake",
+  "  heartbeat",
+  "    events",
+  "      violence",
+  "      idle pwds",
+  "      mud hour",
+  "      autosave",
+  "      usage",
+  "      time save",
+  "    zones",
+  "    journal",
+  "    extractions"
+};
+
+#define PERF_LINE_FORMAT	"%-16s %9lu %8.0f %8lu %8lu %8lu %8lu"
+
+/* local functions */
+int perf_bucket(unsigned long usec);
+unsigned long perf_bucket_top(int i);
+void perf_add(struct perf_hist *h, unsigned long usec);
+unsigned long perf_percentile(struct perf_hist *h, int pct);
+int perf_line(char *buf, size_t len, const char *name, struct perf_hist *h);
+void perf_reset(void);
+int perf_dump(const char *filename);
+void perf_dump_hist(FILE *fl, const char *name, struct perf_hist *h);
+int perf_cmd_compare(const void *a, const void *b);
+ACMD(do_perf);
+
+
+void perf_init(void)
+{
+  for (perf_num_cmds = 0; *cmd_info[perf_num_cmds].command != '\n'; perf_num_cmds++);
+
+  CREATE(perf_cmds, struct perf_hist *, perf_num_cmds);
+  perf_since = time(0);
+}
+
+
+void perf_free(void)
+{
+  int i;
+
+  for (i = 0; i < perf_num_cmds; i++)
+    if (perf_cmds[i])
+      free(perf_cmds[i]);
+  free(perf_cmds);
+}
+
+
+/*
+ * Microseconds from some fixed point; only differences mean anything.
+ * If it wraps (32-bit longs, every 71 minutes) the unsigned subtraction
+ * still gives the right difference.
+ */
+unsigned long perf_now(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((unsigned long) ts.tv_sec * 1000000UL + ts.tv_nsec / 1000);
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, (struct timezone *) 0);
+  return ((unsigned long) tv.tv_sec * 1000000UL + tv.tv_usec);
+#endif
+}
+
+
+/*
+ * Charge the time since 'start' to 'phase' and return the time now, to
+ * be the start of the next phase.  A start of 0 means the profiler was
+ * off when it was taken.
+ */
+unsigned long perf_mark(int phase, unsigned long start)
+{
+  unsigned long now;
+
+  if (!perf_on)
+    return (0);
+
+  now = perf_now();
+  if (start)
+    perf_add(&perf_phases[phase], now - start);
+  return (now);
+}
+
+
+void perf_command(int cmd, unsigned long start)
+{
+  if (!perf_on || !start || cmd < 0 || cmd >= perf_num_cmds)
+    return;
+
+  if (!perf_cmds[cmd])
+    CREATE(perf_cmds[cmd], struct perf_hist, 1);
+  perf_add(perf_cmds[cmd], perf_now() - start);
+}
+
+
+/* Below PERF_SUB each bucket is one microsecond wide. */
+int perf_bucket(unsigned long usec)
+{
+  int bits = PERF_SUB_BITS;
+
+  if (usec < PERF_SUB)
+    return ((int) usec);
+  if (usec >= 1UL << PERF_MAX_BITS)
+    usec = (1UL << PERF_MAX_BITS) - 1;
+
+  /* 'bits' is where the top bit of usec is. */
+  while (usec >> (bits + 1))
+    bits++;
+
+  return ((bits - PERF_SUB_BITS + 1) * PERF_SUB +
+	(int) ((usec >> (bits - PERF_SUB_BITS)) & (PERF_SUB - 1)));
+}
+
+
+/* The longest time that lands in bucket 'i'. */
+unsigned long perf_bucket_top(int i)
+{
+  int shift;
+
+  if (i < PERF_SUB)
+    return (i);
+
+  shift = i / PERF_SUB - 1;
+  return (((unsigned long) (PERF_SUB + i % PERF_SUB + 1) << shift) - 1);
+}
+
+
+void perf_add(struct perf_hist *h, unsigned long usec)
+{
+  h->count++;
+  h->total += usec;
+  if (usec > h->max)
+    h->max = usec;
+  h->bucket[perf_bucket(usec)]++;
+}
+
+
+/* Time that 'pct' percent of the samples took no longer than. */
+unsigned long perf_percentile(struct perf_hist *h, int pct)
+{
+  unsigned long want, seen = 0;
+  int i;
+
+  if (!h->count)
+    return (0);
+
+  want = (h->count * pct + 99) / 100;
+  for (i = 0; i < PERF_BUCKETS; i++)
+    if ((seen += h->bucket[i]) >= want)
+      return (perf_bucket_top(i) < h->max ? perf_bucket_top(i) : h->max);
+
+  return (h->max);
+}
+
+
+int perf_line(char *buf, size_t len, const char *name, struct perf_hist *h)
+{
+  return (snprintf(buf, len, PERF_LINE_FORMAT "\r\n",
+	name, h->count, h->count ? h->total / h->count : 0.0,
+	perf_percentile(h, 50), perf_percentile(h, 90),
+	perf_percentile(h, 99), h->max));
+}
+
+
+void perf_reset(void)
+{
+  int i;
+
+  memset(perf_phases, 0, sizeof(perf_phases));
+  for (i = 0; i < perf_num_cmds; i++)
+    if (perf_cmds[i])
+      memset(perf_cmds[i], 0, sizeof(struct perf_hist));
+  perf_since = time(0);
+}
+
+
+void perf_dump_hist(FILE *fl, const char *name, struct perf_hist *h)
+{
+  int i;
+
+  fprintf(fl, PERF_LINE_FORMAT "\n",
+	name, h->count, h->count ? h->total / h->count : 0.0,
+	perf_percentile(h, 50), perf_percentile(h, 90),
+	perf_percentile(h, 99), h->max);
+
+  for (i = 0; i < PERF_BUCKETS; i++)
+    if (h->bucket[i])
+      fprintf(fl, "  <= %9lu: %u\n", perf_bucket_top(i), h->bucket[i]);
+}
+
+
+/* Write every histogram in full, for comparing with another run. */
+int perf_dump(const char *filename)
+{
+  FILE *fl;
+  const char *phase;
+  char name[32];
+  int i;
+
+  if (!(fl = fopen(filename, "w"))) {
+    log("SYSERR: Unable to open perf file '%s': %s", filename, strerror(errno));
+    return (-1);
+  }
+
+  fprintf(fl, "# Pulse phases and commands since %-24.24s; times in microseconds\n", ctime(&perf_since));
+  fprintf(fl, "# %-14s %9s %8s %8s %8s %8s %8s\n", "name", "count", "avg", "p50", "p90", "p99", "max");
+
+  for (i = 0; i < NUM_PERF_PHASES; i++) {
+    for (phase = perf_phase_names[i]; *phase == ' '; phase++);
+    perf_dump_hist(fl, phase, &perf_phases[i]);
+  }
+
+  for (i = 0; i < perf_num_cmds; i++)
+    if (perf_cmds[i] && perf_cmds[i]->count) {
+      snprintf(name, sizeof(name), "cmd:%s", cmd_info[i].command);
+      perf_dump_hist(fl, name, perf_cmds[i]);
+    }
+
+  fclose(fl);
+  return (0);
+}
+
+
+int perf_cmd_compare(const void *a, const void *b)
+{
+  double ta = perf_cmds[*(const int *) a]->total;
+  double tb = perf_cmds[*(const int *) b]->total;
+
+  return (ta < tb ? 1 : ta > tb ? -1 : 0);
+}
+
+
+#define PERF_TOP_COMMANDS	25
+
+ACMD(do_perf)
+{
+  char arg[MAX_INPUT_LENGTH], buf[MAX_STRING_LENGTH];
+  size_t len;
+  int i, n, *order, nlen;
+
+  any_one_arg(argument, arg);	/* not one_argument(): "on" is a fill word */
+
+  if (!*arg || is_abbrev(arg, "commands")) {
+    len = snprintf(buf, sizeof(buf),
+	"%s since %-24.24s; times in microseconds%s\r\n"
+	"%-16s %9s %8s %8s %8s %8s %8s\r\n",
+	*arg ? "Commands" : "Pulse phases", ctime(&perf_since),
+	perf_on ? "" : " (profiler off)",
+	*arg ? "Command" : "Phase", "Count", "Avg", "p50", "p90", "p99", "Max");
+
+    if (!*arg)
+      for (i = 0; i < NUM_PERF_PHASES; i++) {
+	nlen = perf_line(buf + len, sizeof(buf) - len, perf_phase_names[i], &perf_phases[i]);
+	if (len + nlen >= sizeof(buf) || nlen < 0)
+	  break;
+	len += nlen;
+      }
+    else {
+      /* The ones that took the most time altogether. */
+      CREATE(order, int, perf_num_cmds);
+      for (n = i = 0; i < perf_num_cmds; i++)
+	if (perf_cmds[i] && perf_cmds[i]->count)
+	  order[n++] = i;
+      qsort(order, n, sizeof(int), perf_cmd_compare);
+
+      for (i = 0; i < n && i < PERF_TOP_COMMANDS; i++) {
+	nlen = perf_line(buf + len, sizeof(buf) - len, cmd_info[order[i]].command, perf_cmds[order[i]]);
+	if (len + nlen >= sizeof(buf) || nlen < 0)
+	  break;
+	len += nlen;
+      }
+      free(order);
+    }
+    page_string(ch->desc, buf, TRUE);
+  } else if (!str_cmp(arg, "reset")) {
+    perf_reset();
+    send_to_char(ch, "Profile counts reset.\r\n");
+  } else if (!str_cmp(arg, "on")) {
+    perf_on = TRUE;
+    send_to_char(ch, "Profiler on.\r\n");
+  } else if (!str_cmp(arg, "off")) {
+    perf_on = FALSE;
+    send_to_char(ch, "Profiler off.\r\n");
+  } else if (!str_cmp(arg, "dump")) {
+    if (perf_dump(PERF_FILE) < 0)
+      send_to_char(ch, "Couldn't write %s.\r\n", PERF_FILE);
+    else {
+      send_to_char(ch, "Profile written to %s.\r\n", PERF_FILE);
+      mudlog(BRF, MAX(LVL_GOD, GET_INVIS_LEV(ch)), TRUE, "(GC) %s dumped the profile to %s.", GET_NAME(ch), PERF_FILE);
+    }
+  } else
+    send_to_char(ch, "Usage: perf [ commands | reset | on | off | dump ]\r\n");
+}
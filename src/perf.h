@@ -0,0 +1,65 @@
+/* ************************************************************************
+*   File: perf.h                                        Part of CircleMUD *
+*  Usage: header file for the pulse and command profiler                  *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * What a pass through game_loop() is timed in.  The phases after
+ * PERF_HEARTBEAT happen inside it, and the periodic jobs inside
+ * PERF_EVENTS; 'perf' indents them to match.
+ */
+#define PERF_PULSE	0	/* all the work of one pass	*/
+#define PERF_NETWORK	1	/* io_service()			*/
+#define PERF_ACCEPT	2	/* new connections, hostnames	*/
+#define PERF_INPUT	3	/* process_input()		*/
+#define PERF_COMMANDS	4	/* nanny(), commands, the pager	*/
+#define PERF_OUTPUT	5	/* process_output()		*/
+#define PERF_PROMPTS	6
+#define PERF_CLOSE	7	/* closing sockets, io_wake()	*/
+#define PERF_HEARTBEAT	8
+#define PERF_EVENTS	9	/* event_process(), mobiles too	*/
+#define PERF_VIOLENCE	10
+#define PERF_IDLEPWD	11
+#define PERF_MUDHOUR	12
+#define PERF_AUTOSAVE	13
+#define PERF_USAGE	14
+#define PERF_TIMESAVE	15
+#define PERF_ZONES	16	/* zone_update()		*/
+#define PERF_JOURNAL	17	/* journal_update()		*/
+#define PERF_EXTRACT	18	/* extract_pending_chars()	*/
+#define NUM_PERF_PHASES	19
+
+/*
+ * Times are kept in log-linear histograms: each doubling of the time is
+ * split into PERF_SUB equal buckets, so any time is known to within
+ * 1/PERF_SUB of itself however short or long it is, and recording one is
+ * a few shifts and an increment.  Times run out at 2^PERF_MAX_BITS
+ * microseconds (4.5 minutes).
+ */
+#define PERF_SUB_BITS	3
+#define PERF_SUB	(1 << PERF_SUB_BITS)
+#define PERF_MAX_BITS	28
+#define PERF_BUCKETS	((PERF_MAX_BITS - PERF_SUB_BITS + 1) * PERF_SUB)
+
+struct perf_hist {
+  unsigned long count;
+  unsigned long max;		/* longest, in microseconds	*/
+  double total;			/* sum, in microseconds		*/
+  unsigned int bucket[PERF_BUCKETS];
+};
+
+extern int perf_on;
+
+/* A time to pass to perf_mark() later; 0 if we aren't counting. */
+#define PERF_START()	(perf_on ? perf_now() : 0)
+
+void perf_init(void);
+void perf_free(void);
+unsigned long perf_now(void);
+unsigned long perf_mark(int phase, unsigned long start);
+void perf_command(int cmd, unsigned long start);
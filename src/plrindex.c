@@ -0,0 +1,380 @@
+/* ************************************************************************
+*   File: plrindex.c                                    Part of CircleMUD *
+*  Usage: the player file's index of names and idnums                     *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * The player file is a row of char_file_u records, well over a kilobyte
+ * apiece, of which the game keeps only the name and idnum of each in
+ * player_table.  Those are also kept in PLAYER_INDEX_FILE, a few dozen
+ * bytes a player, so that booting reads that instead of every record.
+ * The index is only used if it was written for a player file of the size
+ * and modification time the player file has now: it's rewritten when the
+ * game shuts down, and anything that changes the player file meanwhile,
+ * the game included, makes it out of date until then.
+ *
+ * In memory, the table is hashed by name and by idnum, each a chain of
+ * positions in the table running through its entries.
+ */
+
+#define __PLRINDEX_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "plrindex.h"
+
+#define PI_BASIS	2166136261U	/* FNV-1a			*/
+#define PI_PRIME	16777619U
+#define PI_MIN_SIZE	256		/* buckets, to start with	*/
+
+struct player_index_header {
+  char magic[8];
+  int version;
+  int record_size;		/* sizeof(struct char_file_u)	*/
+  long records;
+  long players_size;		/* of the player file it's for	*/
+  long players_mtime;
+};
+
+struct player_index_record {
+  char name[MAX_NAME_LENGTH + 1];
+  long id;
+};
+
+/* local globals */
+struct player_index_element **pi_table = NULL;	/* the table hashed */
+int *pi_top;
+int *pi_names = NULL;		/* first of each chain, or -1	*/
+int *pi_ids = NULL;
+unsigned int pi_size = 0;	/* buckets in each; a power of 2 */
+
+/* local functions */
+unsigned int pi_name_hash(const char *name);
+unsigned int pi_id_hash(long id);
+int pi_name_cmp(const char *lower, const char *name);
+void pi_link(int pos);
+char *pi_lower(const char *name);
+
+#define PI_ENTRY(pos)	((*pi_table)[pos])
+
+
+/* Names hash without regard to case. */
+unsigned int pi_name_hash(const char *name)
+{
+  unsigned int h = PI_BASIS;
+
+  for (; *name; name++)
+    h = (h ^ (unsigned char) LOWER(*name)) * PI_PRIME;
+
+  return (h & (pi_size - 1));
+}
+
+
+unsigned int pi_id_hash(long id)
+{
+  return ((unsigned int) ((unsigned long) id * 2654435761UL) & (pi_size - 1));
+}
+
+
+/* The names in the table are already lower case. */
+int pi_name_cmp(const char *lower, const char *name)
+{
+  for (; *lower && *lower == LOWER(*name); lower++, name++);
+
+  return (*lower != LOWER(*name));
+}
+
+
+char *pi_lower(const char *name)
+{
+  char *lower;
+  int i;
+
+  CREATE(lower, char, strlen(name) + 1);
+  for (i = 0; (lower[i] = LOWER(name[i])); i++);
+
+  return (lower);
+}
+
+
+/* Put the entry at 'pos' at the head of its chains. */
+void pi_link(int pos)
+{
+  unsigned int h;
+
+  h = pi_name_hash(PI_ENTRY(pos).name);
+  PI_ENTRY(pos).next_name = pi_names[h];
+  pi_names[h] = pos;
+
+  h = pi_id_hash(PI_ENTRY(pos).id);
+  PI_ENTRY(pos).next_id = pi_ids[h];
+  pi_ids[h] = pos;
+}
+
+
+/*
+ * Hash the table '*table', of '*top' + 1 entries.  The table may move
+ * and grow afterwards, as long as plrindex_add() is told of each new
+ * entry.  Where two entries share a name or idnum, the lower one wins,
+ * as it did when the table was searched from the start.
+ */
+void plrindex_attach(struct player_index_element **table, int *top)
+{
+  unsigned int size;
+  int pos;
+
+  pi_table = table;
+  pi_top = top;
+
+  for (size = PI_MIN_SIZE; size < (unsigned int) (*top + 1) * 2; size *= 2);
+  if (size != pi_size) {
+    plrindex_free();
+    CREATE(pi_names, int, size);
+    CREATE(pi_ids, int, size);
+    pi_size = size;
+  }
+  memset(pi_names, -1, sizeof(int) * pi_size);
+  memset(pi_ids, -1, sizeof(int) * pi_size);
+
+  for (pos = *top; pos >= 0; pos--)
+    pi_link(pos);
+}
+
+
+/* The entry at 'pos', the new top of the table, has a name and idnum. */
+void plrindex_add(int pos)
+{
+  if ((unsigned int) (*pi_top + 1) * 2 > pi_size)
+    plrindex_attach(pi_table, pi_top);
+  else
+    pi_link(pos);
+}
+
+
+void plrindex_set_id(int pos, long id)
+{
+  int *prev;
+  unsigned int h = pi_id_hash(PI_ENTRY(pos).id);
+
+  for (prev = &pi_ids[h]; *prev >= 0; prev = &PI_ENTRY(*prev).next_id)
+    if (*prev == pos) {
+      *prev = PI_ENTRY(pos).next_id;
+      break;
+    }
+
+  PI_ENTRY(pos).id = id;
+  h = pi_id_hash(id);
+  PI_ENTRY(pos).next_id = pi_ids[h];
+  pi_ids[h] = pos;
+}
+
+
+/* Where 'name' is in the table, in any case, or -1. */
+int plrindex_by_name(const char *name)
+{
+  int pos, found = -1;
+
+  if (!pi_size)
+    return (-1);
+
+  /* Not the first found: a lower one with the name may be further on. */
+  for (pos = pi_names[pi_name_hash(name)]; pos >= 0; pos = PI_ENTRY(pos).next_name)
+    if ((found < 0 || pos < found) && !pi_name_cmp(PI_ENTRY(pos).name, name))
+      found = pos;
+
+  return (found);
+}
+
+
+int plrindex_by_id(long id)
+{
+  int pos, found = -1;
+
+  if (!pi_size)
+    return (-1);
+
+  for (pos = pi_ids[pi_id_hash(id)]; pos >= 0; pos = PI_ENTRY(pos).next_id)
+    if (PI_ENTRY(pos).id == id && (found < 0 || pos < found))
+      found = pos;
+
+  return (found);
+}
+
+
+void plrindex_free(void)
+{
+  if (pi_names)
+    free(pi_names);
+  if (pi_ids)
+    free(pi_ids);
+  pi_names = pi_ids = NULL;
+  pi_size = 0;
+}
+
+
+/*
+ * Read the index 'filename' into a new '*table', returning TRUE, if it's
+ * the index of 'players' as that is now; FALSE, with '*table' untouched,
+ * if there's no such index.
+ */
+int plrindex_load(const char *filename, FILE *players, struct player_index_element **table, int *top)
+{
+  struct player_index_header hdr;
+  struct player_index_record *recs;
+  struct stat st, ist;
+  FILE *fl;
+  long i;
+
+  if (!(fl = fopen(filename, "rb")))
+    return (FALSE);
+
+  if (fread(&hdr, sizeof(hdr), 1, fl) != 1 || fstat(fileno(fl), &ist) < 0 ||
+	fstat(fileno(players), &st) < 0 || strcmp(hdr.magic, PLAYER_INDEX_MAGIC) ||
+	hdr.version != PLAYER_INDEX_VERSION || hdr.record_size != (int) sizeof(struct char_file_u) ||
+	hdr.records < 0 || ist.st_size != (off_t) (sizeof(hdr) + hdr.records * sizeof(*recs)) ||
+	hdr.players_size != (long) st.st_size || hdr.players_mtime != (long) st.st_mtime ||
+	hdr.records != (long) (st.st_size / sizeof(struct char_file_u))) {
+    fclose(fl);
+    return (FALSE);
+  }
+
+  if (!hdr.records) {
+    fclose(fl);
+    *table = NULL;
+    *top = -1;
+    return (TRUE);
+  }
+
+  CREATE(recs, struct player_index_record, hdr.records);
+  if (fread(recs, sizeof(*recs), hdr.records, fl) != (size_t) hdr.records) {
+    free(recs);
+    fclose(fl);
+    return (FALSE);
+  }
+  fclose(fl);
+
+  CREATE(*table, struct player_index_element, hdr.records);
+  for (i = 0; i < hdr.records; i++) {
+    recs[i].name[MAX_NAME_LENGTH] = '\0';
+    (*table)[i].name = pi_lower(recs[i].name);
+    (*table)[i].id = recs[i].id;
+  }
+  *top = hdr.records - 1;
+
+  free(recs);
+  return (TRUE);
+}
+
+
+/*
+ * Build a new '*table' the slow way, from every record in 'players'.
+ * FALSE if it couldn't all be read; what could be is in '*table'.
+ */
+int plrindex_scan(FILE *players, struct player_index_element **table, int *top)
+{
+  struct char_file_u dummy;
+  long size, recs;
+  int nr = -1, ok = TRUE;
+
+  fseek(players, 0L, SEEK_END);
+  size = ftell(players);
+  rewind(players);
+
+  if (!(recs = size / sizeof(struct char_file_u))) {
+    *table = NULL;
+    *top = -1;
+    return (TRUE);
+  }
+  CREATE(*table, struct player_index_element, recs);
+
+  while (nr + 1 < recs) {
+    if (fread(&dummy, sizeof(struct char_file_u), 1, players) != 1) {
+      ok = FALSE;
+      break;
+    }
+
+    /* new record */
+    nr++;
+    (*table)[nr].name = pi_lower(dummy.name);
+    (*table)[nr].id = dummy.char_specials_saved.idnum;
+  }
+
+  *top = nr;
+  return (ok);
+}
+
+
+/* Write the index of 'players', whose table is 'table', to 'filename'. */
+int plrindex_save(const char *filename, FILE *players, struct player_index_element *table, int top)
+{
+  struct player_index_header hdr;
+  struct player_index_record *recs = NULL;
+  char tmpname[PATH_MAX];
+  struct stat st;
+  FILE *fl;
+  int i;
+
+  /* Its time is taken after the last of what's been written to it. */
+  if (fflush(players) != 0 || fstat(fileno(players), &st) < 0) {
+    log("SYSERR: Couldn't check the player file to index it: %s", strerror(errno));
+    return (FALSE);
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  strcpy(hdr.magic, PLAYER_INDEX_MAGIC);	/* strcpy: OK (sizeof: 8) */
+  hdr.version = PLAYER_INDEX_VERSION;
+  hdr.record_size = sizeof(struct char_file_u);
+  hdr.records = top + 1;
+  hdr.players_size = st.st_size;
+  hdr.players_mtime = st.st_mtime;
+
+  /* A table that doesn't match the file would only be ignored at boot. */
+  if (hdr.records != (long) (st.st_size / sizeof(struct char_file_u))) {
+    log("SYSERR: %ld players in the table but %ld in the file; not indexing it.",
+	hdr.records, (long) (st.st_size / sizeof(struct char_file_u)));
+    return (FALSE);
+  }
+
+  if (top >= 0) {
+    CREATE(recs, struct player_index_record, top + 1);
+    for (i = 0; i <= top; i++) {
+      strncpy(recs[i].name, table[i].name, MAX_NAME_LENGTH);	/* strncpy: OK (recs:MAX_NAME_LENGTH+1) */
+      recs[i].id = table[i].id;
+    }
+  }
+
+  snprintf(tmpname, sizeof(tmpname), "%s.new", filename);
+  if (!(fl = fopen(tmpname, "wb"))) {
+    log("SYSERR: Couldn't write player index '%s': %s", tmpname, strerror(errno));
+    if (recs)
+      free(recs);
+    return (FALSE);
+  }
+  if (fwrite(&hdr, sizeof(hdr), 1, fl) != 1 ||
+	(top >= 0 && fwrite(recs, sizeof(*recs), top + 1, fl) != (size_t) (top + 1)) ||
+	fclose(fl) != 0) {
+    log("SYSERR: Couldn't write player index '%s': %s", tmpname, strerror(errno));
+    remove(tmpname);
+    if (recs)
+      free(recs);
+    return (FALSE);
+  }
+  if (recs)
+    free(recs);
+
+  if (rename(tmpname, filename) < 0) {
+    log("SYSERR: Couldn't rename '%s' to '%s': %s", tmpname, filename, strerror(errno));
+    return (FALSE);
+  }
+
+  return (TRUE);
+}
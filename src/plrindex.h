@@ -0,0 +1,27 @@
+/* ************************************************************************
+*   File: plrindex.h                                    Part of CircleMUD *
+*  Usage: header file for the player file's index                         *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Change PLAYER_INDEX_VERSION whenever what goes into the index changes.
+ * A change to the size of struct char_file_u is caught on its own.
+ */
+#define PLAYER_INDEX_MAGIC	"CircPlr"
+#define PLAYER_INDEX_VERSION	1
+
+int plrindex_load(const char *filename, FILE *players, struct player_index_element **table, int *top);
+int plrindex_scan(FILE *players, struct player_index_element **table, int *top);
+int plrindex_save(const char *filename, FILE *players, struct player_index_element *table, int top);
+
+void plrindex_attach(struct player_index_element **table, int *top);
+void plrindex_add(int pos);
+void plrindex_set_id(int pos, long id);
+int plrindex_by_name(const char *name);
+int plrindex_by_id(long id);
+void plrindex_free(void);
@@ -0,0 +1,296 @@
+/* ************************************************************************
+*   File: rentfile.c                                    Part of CircleMUD *
+*  Usage: encoding and decoding rent and crash files                      *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * A rent file used to be a rent_info followed by an obj_file_elem for
+ * each object, over fifty bytes apiece however little about the object
+ * had changed since it was loaded.  Now it's RENT_MAGIC and RENT_VERSION,
+ * the rent_info's fields, and then each object as its vnum, a mask of the
+ * fields that differ from its prototype's, and only those fields, every
+ * number a varint; a long sword no one has touched takes two bytes.  An
+ * object with anything in it has RF_CONTAINS in its mask and its contents
+ * follow it as a list of their own, and every list ends with a zero.
+ *
+ * Nothing here knows about the world: the caller compares an object
+ * against its prototype and fills in what isn't in the mask from one, so
+ * the utilities can read rent files, too.  Old files, which start with a
+ * rent_info whose time can't be mistaken for RENT_MAGIC, are still read.
+ */
+
+#define __RENTFILE_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "rentfile.h"
+
+/* local functions */
+unsigned long rent_zigzag(long n);
+long rent_unzigzag(unsigned long n);
+size_t rent_put_varint(char *buf, unsigned long n);
+size_t rent_put_signed(char *buf, long n);
+int rent_get_varint(const char *data, size_t len, size_t *at, unsigned long *n);
+int rent_get_signed(const char *data, size_t len, size_t *at, long *n);
+int rent_get_int(const char *data, size_t len, size_t *at, int *n);
+
+
+/* Signs to the bottom, so small negative numbers stay small, too. */
+unsigned long rent_zigzag(long n)
+{
+  return (((unsigned long) n << 1) ^ (unsigned long) (n >> (sizeof(long) * 8 - 1)));
+}
+
+
+long rent_unzigzag(unsigned long n)
+{
+  return ((long) (n >> 1) ^ -(long) (n & 1));
+}
+
+
+/* Seven bits to a byte, the lowest first; the top bit means more follow. */
+size_t rent_put_varint(char *buf, unsigned long n)
+{
+  size_t i = 0;
+
+  while (n >= 0x80) {
+    buf[i++] = (char) (n | 0x80);
+    n >>= 7;
+  }
+  buf[i++] = (char) n;
+  return (i);
+}
+
+
+size_t rent_put_signed(char *buf, long n)
+{
+  return (rent_put_varint(buf, rent_zigzag(n)));
+}
+
+
+int rent_get_varint(const char *data, size_t len, size_t *at, unsigned long *n)
+{
+  unsigned int shift = 0;
+  unsigned char c;
+
+  *n = 0;
+  do {
+    if (*at >= len || shift >= sizeof(long) * 8)
+      return (FALSE);
+    c = (unsigned char) data[(*at)++];
+    *n |= (unsigned long) (c & 0x7f) << shift;
+    shift += 7;
+  } while (c & 0x80);
+
+  return (TRUE);
+}
+
+
+int rent_get_signed(const char *data, size_t len, size_t *at, long *n)
+{
+  unsigned long u;
+
+  if (!rent_get_varint(data, len, at, &u))
+    return (FALSE);
+  *n = rent_unzigzag(u);
+  return (TRUE);
+}
+
+
+int rent_get_int(const char *data, size_t len, size_t *at, int *n)
+{
+  long l;
+
+  if (!rent_get_signed(data, len, at, &l))
+    return (FALSE);
+  *n = (int) l;
+  return (TRUE);
+}
+
+
+size_t rent_put_header(char *buf, const struct rent_info *rent)
+{
+  size_t len = RENT_MAGIC_LEN;
+
+  memcpy(buf, RENT_MAGIC, RENT_MAGIC_LEN);
+  len += rent_put_varint(buf + len, RENT_VERSION);
+  len += rent_put_signed(buf + len, rent->time);
+  len += rent_put_signed(buf + len, rent->rentcode);
+  len += rent_put_signed(buf + len, rent->net_cost_per_diem);
+  len += rent_put_signed(buf + len, rent->gold);
+  len += rent_put_signed(buf + len, rent->account);
+  len += rent_put_signed(buf + len, rent->nitems);
+  len += rent_put_signed(buf + len, rent->journal_seq);
+  return (len);
+}
+
+
+/*
+ * Read the header at the start of 'data', in whichever format it is, and
+ * leave 'at', if it's given, where the objects start.
+ */
+int rent_get_header(const char *data, size_t len, struct rent_info *rent, size_t *at)
+{
+  unsigned long version;
+  size_t pos = RENT_MAGIC_LEN;
+
+  memset(rent, 0, sizeof(struct rent_info));
+
+  if (len < RENT_MAGIC_LEN || memcmp(data, RENT_MAGIC, RENT_MAGIC_LEN)) {
+    if (len < sizeof(struct rent_info))
+      return (RENT_FORMAT_BAD);
+    memcpy(rent, data, sizeof(struct rent_info));
+    if (at)
+      *at = sizeof(struct rent_info);
+    return (RENT_FORMAT_OLD);
+  }
+
+  if (!rent_get_varint(data, len, &pos, &version) || version != RENT_VERSION ||
+	!rent_get_int(data, len, &pos, &rent->time) ||
+	!rent_get_int(data, len, &pos, &rent->rentcode) ||
+	!rent_get_int(data, len, &pos, &rent->net_cost_per_diem) ||
+	!rent_get_int(data, len, &pos, &rent->gold) ||
+	!rent_get_int(data, len, &pos, &rent->account) ||
+	!rent_get_int(data, len, &pos, &rent->nitems) ||
+	!rent_get_int(data, len, &pos, &rent->journal_seq))
+    return (RENT_FORMAT_BAD);
+
+  if (at)
+    *at = pos;
+  return (RENT_FORMAT_COMPACT);
+}
+
+
+/*
+ * Write 'obj' as it differs from 'proto', or from nothing at all if it
+ * has no prototype.  If 'contains', its contents are to be written next,
+ * followed by rent_put_end().
+ */
+size_t rent_put_obj(char *buf, const struct obj_file_elem *obj,
+	const struct obj_file_elem *proto, int location, int contains)
+{
+  static const struct obj_file_elem none;
+  size_t len;
+  int mask = 0, j, affects = 0;
+
+  if (!proto)
+    proto = &none;
+
+  for (j = 0; j < 4; j++)
+    if (obj->value[j] != proto->value[j])
+      mask |= RF_VALUE0 << j;
+  if (obj->extra_flags != proto->extra_flags)
+    mask |= RF_EXTRA;
+  if (obj->weight != proto->weight)
+    mask |= RF_WEIGHT;
+  if (obj->timer != proto->timer)
+    mask |= RF_TIMER;
+  if (obj->bitvector != proto->bitvector)
+    mask |= RF_BITVECTOR;
+  for (j = 0; j < MAX_OBJ_AFFECT; j++)
+    if (obj->affected[j].location != proto->affected[j].location ||
+	obj->affected[j].modifier != proto->affected[j].modifier)
+      affects = j + 1;
+  if (affects)
+    mask |= RF_AFFECTS;
+  if (location)
+    mask |= RF_LOCATION;
+  if (contains)
+    mask |= RF_CONTAINS;
+
+  /* A vnum of 0 is written as 1, leaving 0 for the end of a list. */
+  len = rent_put_varint(buf, rent_zigzag(obj->item_number) + 1);
+  len += rent_put_varint(buf + len, mask);
+  if (mask & RF_LOCATION)
+    len += rent_put_signed(buf + len, location);
+  for (j = 0; j < 4; j++)
+    if (mask & (RF_VALUE0 << j))
+      len += rent_put_signed(buf + len, obj->value[j]);
+  if (mask & RF_EXTRA)
+    len += rent_put_varint(buf + len, (unsigned int) obj->extra_flags);
+  if (mask & RF_WEIGHT)
+    len += rent_put_signed(buf + len, obj->weight);
+  if (mask & RF_TIMER)
+    len += rent_put_signed(buf + len, obj->timer);
+  if (mask & RF_BITVECTOR)
+    len += rent_put_varint(buf + len, (unsigned long) obj->bitvector);
+  if (mask & RF_AFFECTS) {
+    len += rent_put_varint(buf + len, affects);
+    for (j = 0; j < affects; j++) {
+      len += rent_put_varint(buf + len, obj->affected[j].location);
+      len += rent_put_signed(buf + len, obj->affected[j].modifier);
+    }
+  }
+  return (len);
+}
+
+
+size_t rent_put_end(char *buf)
+{
+  return (rent_put_varint(buf, 0));
+}
+
+
+/*
+ * Read the object at 'at', moving 'at' past it.  RENT_END is the end of
+ * the list being read, RENT_BAD that the file is cut short or garbled;
+ * the caller goes no further with it either way.
+ */
+int rent_get_obj(const char *data, size_t len, size_t *at, struct rent_obj *obj)
+{
+  unsigned long tag, mask, n;
+  long l;
+  int j;
+
+  memset(obj, 0, sizeof(struct rent_obj));
+  if (!rent_get_varint(data, len, at, &tag))
+    return (RENT_BAD);
+  if (tag == 0)
+    return (RENT_END);
+  obj->vnum = (obj_vnum) rent_unzigzag(tag - 1);
+  obj->elem.item_number = obj->vnum;
+
+  if (!rent_get_varint(data, len, at, &mask))
+    return (RENT_BAD);
+  obj->mask = (int) mask;
+
+  if ((mask & RF_LOCATION) && !rent_get_int(data, len, at, &obj->location))
+    return (RENT_BAD);
+  for (j = 0; j < 4; j++)
+    if ((mask & (RF_VALUE0 << j)) && !rent_get_int(data, len, at, &obj->elem.value[j]))
+      return (RENT_BAD);
+  if (mask & RF_EXTRA) {
+    if (!rent_get_varint(data, len, at, &n))
+      return (RENT_BAD);
+    obj->elem.extra_flags = (int) n;
+  }
+  if ((mask & RF_WEIGHT) && !rent_get_int(data, len, at, &obj->elem.weight))
+    return (RENT_BAD);
+  if ((mask & RF_TIMER) && !rent_get_int(data, len, at, &obj->elem.timer))
+    return (RENT_BAD);
+  if (mask & RF_BITVECTOR) {
+    if (!rent_get_varint(data, len, at, &n))
+      return (RENT_BAD);
+    obj->elem.bitvector = (long) n;
+  }
+  if (mask & RF_AFFECTS) {
+    if (!rent_get_varint(data, len, at, &n) || n > MAX_OBJ_AFFECT)
+      return (RENT_BAD);
+    obj->affects = (int) n;
+    for (j = 0; j < obj->affects; j++) {
+      if (!rent_get_varint(data, len, at, &tag) || !rent_get_signed(data, len, at, &l))
+	return (RENT_BAD);
+      obj->elem.affected[j].location = (byte) tag;
+      obj->elem.affected[j].modifier = (sbyte) l;
+    }
+  }
+  return (RENT_OBJ);
+}
@@ -0,0 +1,65 @@
+/* ************************************************************************
+*   File: rentfile.h                                    Part of CircleMUD *
+*  Usage: header file for the encoding of rent and crash files            *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Read as the time in an old rent_info, RENT_MAGIC is a negative number,
+ * which no old file starts with.  Change RENT_VERSION whenever what goes
+ * into a rent file changes.
+ */
+#define RENT_MAGIC		"Rnt\377"
+#define RENT_MAGIC_LEN		4
+#define RENT_VERSION		1
+
+/* What rent_get_header() found. */
+#define RENT_FORMAT_BAD		0	/* neither, or cut short	*/
+#define RENT_FORMAT_OLD		1	/* rent_info, obj_file_elem...	*/
+#define RENT_FORMAT_COMPACT	2
+
+/* What rent_get_obj() found. */
+#define RENT_BAD		(-1)
+#define RENT_END		0	/* of a list			*/
+#define RENT_OBJ		1
+
+/* The most the rent_put_*() functions write at once. */
+#define RENT_MAX_HEADER		64
+#define RENT_MAX_OBJ		128
+
+/* Which fields of an object differ from its prototype's. */
+#define RF_VALUE0		(1 << 0)
+#define RF_VALUE1		(1 << 1)
+#define RF_VALUE2		(1 << 2)
+#define RF_VALUE3		(1 << 3)
+#define RF_EXTRA		(1 << 4)
+#define RF_WEIGHT		(1 << 5)
+#define RF_TIMER		(1 << 6)
+#define RF_BITVECTOR		(1 << 7)
+#define RF_AFFECTS		(1 << 8)
+#define RF_LOCATION		(1 << 9)
+#define RF_CONTAINS		(1 << 10)	/* its contents follow	*/
+
+/*
+ * An object read back: only the fields in 'mask' are set in 'elem', and
+ * of its affects, the first 'affects'; the rest are the prototype's.
+ */
+struct rent_obj {
+  obj_vnum vnum;
+  int location;
+  int mask;
+  int affects;
+  struct obj_file_elem elem;
+};
+
+size_t rent_put_header(char *buf, const struct rent_info *rent);
+size_t rent_put_obj(char *buf, const struct obj_file_elem *obj,
+	const struct obj_file_elem *proto, int location, int contains);
+size_t rent_put_end(char *buf);
+
+int rent_get_header(const char *data, size_t len, struct rent_info *rent, size_t *at);
+int rent_get_obj(const char *data, size_t len, size_t *at, struct rent_obj *obj);
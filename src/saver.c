@@ -0,0 +1,401 @@
+/* ************************************************************************
+*   File: saver.c                                       Part of CircleMUD *
+*  Usage: writing player, rent and house files behind the game's back     *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Saving a character, their rent file or a house used to mean opening,
+ * writing and closing the file right there, which an autosave did for
+ * everyone at once.  Now the game thread only gathers up the bytes to be
+ * written and hands them over as a save_job; with threads, one writer
+ * thread takes the jobs off save_todo in the order they came and does
+ * the file work.  Without, saver_queue() does each job on the spot.
+ *
+ * A job stays at the head of save_todo while it's being written, so
+ * anything about to read a file can saver_wait() for the jobs queued for
+ * it to be done, and saver_wait(NULL) waits for all of them.  A job that
+ * fails is passed back on save_failed for the game to log.
+ */
+
+#define __SAVER_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "saver.h"
+
+#define SAVE_REPLACE	0	/* the file becomes 'data'		*/
+#define SAVE_WRITE_AT	1	/* 'data' goes at 'offset' in 'fd'	*/
+#define SAVE_REMOVE	2
+#define SAVE_APPEND	3	/* 'data' goes on the end of the file	*/
+#define SAVE_SYNC	4	/* 'fd' is synced to disk		*/
+
+struct save_job {
+  int type;
+  char *filename;
+  int fd;
+  long offset;
+  char *data;
+  size_t len;
+  int err;			/* errno, if it failed		*/
+  struct save_job *next;
+};
+
+/* local globals */
+struct save_job *save_todo = NULL, *save_todo_tail = NULL;
+struct save_job *save_failed = NULL;	/* for the game to log	*/
+#ifdef CIRCLE_SAVE_THREAD
+pthread_mutex_t save_lock = PTHREAD_MUTEX_INITIALIZER;	/* guards the above */
+pthread_cond_t save_wake = PTHREAD_COND_INITIALIZER;	/* more to do */
+pthread_cond_t save_done = PTHREAD_COND_INITIALIZER;	/* a job's done */
+int save_thread = FALSE;		/* is there a writer yet?	*/
+#endif
+
+/* local functions */
+struct save_job *saver_job(int type, const char *filename);
+void saver_queue(struct save_job *job);
+void saver_run(struct save_job *job);
+int saver_replace_file(struct save_job *job);
+int saver_append_file(struct save_job *job);
+void saver_report(struct save_job *job);
+void saver_free(struct save_job *job);
+int saver_pending(const char *filename);
+#ifdef CIRCLE_SAVE_THREAD
+void *saver_thread_loop(void *arg);
+#endif
+
+
+void save_buf_add(struct save_buf *sb, const void *data, size_t len)
+{
+  if (!len)
+    return;
+  if (sb->len + len > sb->size) {
+    for (sb->size = MAX(sb->size, 1024); sb->len + len > sb->size; sb->size *= 2);
+    if (sb->data)
+      RECREATE(sb->data, char, sb->size);
+    else
+      CREATE(sb->data, char, sb->size);
+  }
+  memcpy(sb->data + sb->len, data, len);
+  sb->len += len;
+}
+
+
+struct save_job *saver_job(int type, const char *filename)
+{
+  struct save_job *job;
+
+  CREATE(job, struct save_job, 1);
+  job->type = type;
+  job->filename = strdup(filename);
+  job->fd = -1;
+  return (job);
+}
+
+
+void saver_free(struct save_job *job)
+{
+  if (job->data)
+    free(job->data);
+  free(job->filename);
+  free(job);
+}
+
+
+/* Replace 'filename' with what's in 'sb', which is left empty. */
+void saver_replace(const char *filename, struct save_buf *sb)
+{
+  struct save_job *job = saver_job(SAVE_REPLACE, filename);
+
+  job->data = sb->data;
+  job->len = sb->len;
+  sb->data = NULL;
+  sb->len = sb->size = 0;
+  saver_queue(job);
+}
+
+
+/* Write 'len' bytes of 'data' at 'offset' in 'fl', the open 'filename'. */
+void saver_write_at(const char *filename, FILE *fl, long offset, const void *data, size_t len)
+{
+  struct save_job *job = saver_job(SAVE_WRITE_AT, filename);
+
+  job->fd = fileno(fl);
+  job->offset = offset;
+  CREATE(job->data, char, len);
+  memcpy(job->data, data, len);
+  job->len = len;
+  saver_queue(job);
+}
+
+
+/* Add what's in 'sb', which is left empty, to the end of 'filename'. */
+void saver_append(const char *filename, struct save_buf *sb)
+{
+  struct save_job *job = saver_job(SAVE_APPEND, filename);
+
+  job->data = sb->data;
+  job->len = sb->len;
+  sb->data = NULL;
+  sb->len = sb->size = 0;
+  saver_queue(job);
+}
+
+
+/* Sync 'fl', the open 'filename', once what's ahead of this is written. */
+void saver_sync(const char *filename, FILE *fl)
+{
+  struct save_job *job = saver_job(SAVE_SYNC, filename);
+
+  job->fd = fileno(fl);
+  saver_queue(job);
+}
+
+
+/* Remove 'filename', if it's there. */
+void saver_remove(const char *filename)
+{
+  saver_queue(saver_job(SAVE_REMOVE, filename));
+}
+
+
+/*
+ * Read 'len' bytes at 'offset' in 'fl', which saver_write_at() writes
+ * to, TRUE if they were all there.  Reading through 'fl' itself could
+ * find what was in its buffer from before the writer got to the file.
+ */
+int saver_read_at(FILE *fl, long offset, void *data, size_t len)
+{
+  return (pread(fileno(fl), data, len, offset) == (ssize_t) len);
+}
+
+
+void saver_queue(struct save_job *job)
+{
+#ifdef CIRCLE_SAVE_THREAD
+  if (save_thread) {
+    pthread_mutex_lock(&save_lock);
+    if (save_todo_tail)
+      save_todo_tail->next = job;
+    else
+      save_todo = job;
+    save_todo_tail = job;
+    pthread_cond_signal(&save_wake);
+    pthread_mutex_unlock(&save_lock);
+    return;
+  }
+#endif
+
+  saver_run(job);
+  if (job->err)
+    saver_report(job);
+  saver_free(job);
+}
+
+
+/* Do a job, leaving 'job->err' set if it didn't work out. */
+void saver_run(struct save_job *job)
+{
+  switch (job->type) {
+  case SAVE_REPLACE:
+    job->err = saver_replace_file(job);
+    break;
+  case SAVE_WRITE_AT:
+    errno = 0;
+    if (pwrite(job->fd, job->data, job->len, job->offset) != (ssize_t) job->len)
+      job->err = errno ? errno : EIO;
+    break;
+  case SAVE_REMOVE:
+    if (remove(job->filename) < 0 && errno != ENOENT)
+      job->err = errno;
+    break;
+  case SAVE_APPEND:
+    job->err = saver_append_file(job);
+    break;
+  case SAVE_SYNC:
+    if (fsync(job->fd) < 0)
+      job->err = errno;
+    break;
+  }
+}
+
+
+/* Write the new file beside the old one, then put it in the old one's place. */
+int saver_replace_file(struct save_job *job)
+{
+  char tmpname[PATH_MAX];
+  FILE *fl;
+  int err;
+
+  snprintf(tmpname, sizeof(tmpname), "%s.new", job->filename);
+  if (!(fl = fopen(tmpname, "wb")))
+    return (errno);
+
+  errno = 0;
+  if (fwrite(job->data, 1, job->len, fl) != job->len || fflush(fl) != 0
+#if SAVE_FSYNC
+	|| fsync(fileno(fl)) < 0
+#endif
+	) {
+    err = errno ? errno : EIO;
+    fclose(fl);
+    remove(tmpname);
+    return (err);
+  }
+  if (fclose(fl) != 0 || rename(tmpname, job->filename) < 0) {
+    err = errno;
+    remove(tmpname);
+    return (err);
+  }
+  return (0);
+}
+
+
+/* Appends are synced whatever SAVE_FSYNC says: that's what they're for. */
+int saver_append_file(struct save_job *job)
+{
+  FILE *fl;
+  int err;
+
+  if (!(fl = fopen(job->filename, "ab")))
+    return (errno);
+
+  errno = 0;
+  if (fwrite(job->data, 1, job->len, fl) != job->len || fflush(fl) != 0 || fsync(fileno(fl)) < 0) {
+    err = errno ? errno : EIO;
+    fclose(fl);
+    return (err);
+  }
+  if (fclose(fl) != 0)
+    return (errno);
+  return (0);
+}
+
+
+void saver_report(struct save_job *job)
+{
+  log("SYSERR: Couldn't %s '%s': %s", job->type == SAVE_REMOVE ? "remove" : "save",
+	job->filename, strerror(job->err));
+}
+
+
+/* Log the jobs that have failed since last time. */
+void saver_collect(void)
+{
+  struct save_job *job, *next;
+
+#ifdef CIRCLE_SAVE_THREAD
+  pthread_mutex_lock(&save_lock);
+#endif
+  job = save_failed;
+  save_failed = NULL;
+#ifdef CIRCLE_SAVE_THREAD
+  pthread_mutex_unlock(&save_lock);
+#endif
+
+  for (; job; job = next) {
+    next = job->next;
+    saver_report(job);
+    saver_free(job);
+  }
+}
+
+
+/* Is a job for 'filename', or any job if it's NULL, still to be done? */
+int saver_pending(const char *filename)
+{
+  struct save_job *job;
+
+  for (job = save_todo; job; job = job->next)
+    if (!filename || !strcmp(job->filename, filename))
+      return (TRUE);
+
+  return (FALSE);
+}
+
+
+/*
+ * Wait until what's been handed over for 'filename' so far is written,
+ * or, if 'filename' is NULL, until everything is.
+ */
+void saver_wait(const char *filename)
+{
+#ifdef CIRCLE_SAVE_THREAD
+  if (!save_thread)
+    return;
+
+  pthread_mutex_lock(&save_lock);
+  while (saver_pending(filename))
+    pthread_cond_wait(&save_done, &save_lock);
+  pthread_mutex_unlock(&save_lock);
+
+  saver_collect();
+#else
+  (void) filename;
+#endif
+}
+
+
+#ifdef CIRCLE_SAVE_THREAD
+
+void *saver_thread_loop(void *arg __attribute__((unused)))
+{
+  struct save_job *job;
+
+  pthread_mutex_lock(&save_lock);
+  for (;;) {
+    while (!save_todo)
+      pthread_cond_wait(&save_wake, &save_lock);
+    job = save_todo;
+    pthread_mutex_unlock(&save_lock);
+
+    saver_run(job);
+
+    pthread_mutex_lock(&save_lock);
+    if (!(save_todo = job->next))
+      save_todo_tail = NULL;
+    if (job->err) {
+      job->next = save_failed;
+      save_failed = job;
+    } else
+      saver_free(job);
+    pthread_cond_broadcast(&save_done);
+  }
+
+  return (NULL);
+}
+
+#endif
+
+
+/*
+ * Start the writer, with signals blocked like the network thread.  Until
+ * it's going, which is after the world is booted, jobs are done inline.
+ * It's never stopped: shutting down waits for it to finish what it has.
+ */
+void start_save_thread(void)
+{
+#ifdef CIRCLE_SAVE_THREAD
+  pthread_t thread;
+  sigset_t all, old;
+  int err;
+
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  if ((err = pthread_create(&thread, NULL, saver_thread_loop, NULL)) != 0) {
+    log("SYSERR: pthread_create: %s", strerror(err));
+    exit(1);
+  }
+  pthread_detach(thread);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+  save_thread = TRUE;
+  log("Started the file writing thread.");
+#endif
+}
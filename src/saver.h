@@ -0,0 +1,28 @@
+/* ************************************************************************
+*   File: saver.h                                       Part of CircleMUD *
+*  Usage: header file for the writer of player, rent and house files      *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/* What's to go into a file, gathered up before it's handed to the saver. */
+struct save_buf {
+  char *data;
+  size_t len;
+  size_t size;
+};
+
+void save_buf_add(struct save_buf *sb, const void *data, size_t len);
+
+void start_save_thread(void);
+void saver_replace(const char *filename, struct save_buf *sb);
+void saver_write_at(const char *filename, FILE *fl, long offset, const void *data, size_t len);
+void saver_remove(const char *filename);
+void saver_append(const char *filename, struct save_buf *sb);
+void saver_sync(const char *filename, FILE *fl);
+void saver_wait(const char *filename);
+void saver_collect(void);
+int saver_read_at(FILE *fl, long offset, void *data, size_t len);
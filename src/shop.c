@@ -23,6 +23,7 @@
 #include "utils.h"
 #include "shop.h"
 #include "constants.h"
+#include "worldimg.h"
 
 /* External variables */
 extern struct time_info_data time_info;
@@ -1575,34 +1576,24 @@ void destroy_shops(void)
     return;
 
   for (cnt = 0; cnt <= top_shop; cnt++) {
-    if (shop_index[cnt].no_such_item1)
-      free(shop_index[cnt].no_such_item1);
-    if (shop_index[cnt].no_such_item2)
-      free(shop_index[cnt].no_such_item2);
-    if (shop_index[cnt].missing_cash1)
-      free(shop_index[cnt].missing_cash1);
-    if (shop_index[cnt].missing_cash2)
-      free(shop_index[cnt].missing_cash2);
-    if (shop_index[cnt].do_not_buy)
-      free(shop_index[cnt].do_not_buy);
-    if (shop_index[cnt].message_buy)
-      free(shop_index[cnt].message_buy);
-    if (shop_index[cnt].message_sell)
-      free(shop_index[cnt].message_sell);
-    if (shop_index[cnt].in_room)
-      free(shop_index[cnt].in_room);
-    if (shop_index[cnt].producing)
-      free(shop_index[cnt].producing);
+    WORLD_FREE(shop_index[cnt].no_such_item1);
+    WORLD_FREE(shop_index[cnt].no_such_item2);
+    WORLD_FREE(shop_index[cnt].missing_cash1);
+    WORLD_FREE(shop_index[cnt].missing_cash2);
+    WORLD_FREE(shop_index[cnt].do_not_buy);
+    WORLD_FREE(shop_index[cnt].message_buy);
+    WORLD_FREE(shop_index[cnt].message_sell);
+    WORLD_FREE(shop_index[cnt].in_room);
+    WORLD_FREE(shop_index[cnt].producing);
 
     if (shop_index[cnt].type) {
       for (itr = 0; BUY_TYPE(shop_index[cnt].type[itr]) != NOTHING; itr++)
-        if (BUY_WORD(shop_index[cnt].type[itr]))
-          free(BUY_WORD(shop_index[cnt].type[itr]));
-      free(shop_index[cnt].type);
+        WORLD_FREE(BUY_WORD(shop_index[cnt].type[itr]));
+      WORLD_FREE(shop_index[cnt].type);
     }
   }
 
-  free(shop_index);
+  WORLD_FREE(shop_index);
   shop_index = NULL;
   top_shop = -1;
 }
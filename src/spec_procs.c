@@ -349,6 +349,7 @@ void npc_steal(struct char_data *ch, struct char_data *victim)
     if (gold > 0) {
       GET_GOLD(ch) += gold;
       GET_GOLD(victim) -= gold;
+      SET_DIRTY(victim, DIRTY_RECORD);
     }
   }
 }
@@ -327,6 +327,7 @@ void mag_objectmagic(struct char_data *ch, struct obj_data *obj,
       act("Nothing seems to happen.", FALSE, ch, obj, 0, TO_ROOM);
     } else {
       GET_OBJ_VAL(obj, 2)--;
+      obj_dirty(obj);
       WAIT_STATE(ch, PULSE_VIOLENCE);
       /* Level to cast spell at. */
       k = GET_OBJ_VAL(obj, 0) ? GET_OBJ_VAL(obj, 0) : DEFAULT_STAFF_LVL;
@@ -384,6 +385,7 @@ void mag_objectmagic(struct char_data *ch, struct obj_data *obj,
       return;
     }
     GET_OBJ_VAL(obj, 2)--;
+    obj_dirty(obj);
     WAIT_STATE(ch, PULSE_VIOLENCE);
     if (GET_OBJ_VAL(obj, 0))
       call_magic(ch, tch, tobj, GET_OBJ_VAL(obj, 3),
@@ -64,6 +64,7 @@ ASPELL(spell_create_water)
 	act("$p is filled.", FALSE, ch, obj, 0, TO_CHAR);
       }
     }
+    obj_dirty(obj);
   }
 }
 
@@ -369,6 +370,8 @@ ASPELL(spell_enchant_weapon)
     act("$p glows red.", FALSE, ch, obj, 0, TO_CHAR);
   } else
     act("$p glows yellow.", FALSE, ch, obj, 0, TO_CHAR);
+
+  obj_dirty(obj);
 }
 
 
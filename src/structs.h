@@ -156,7 +156,7 @@
 #define PLR_DONTSET     (1 << 3)   /* Don't EVER set (ISNPC bit)	*/
 #define PLR_WRITING	(1 << 4)   /* Player writing (board/mail/olc)	*/
 #define PLR_MAILING	(1 << 5)   /* Player is writing mail		*/
-#define PLR_CRASH	(1 << 6)   /* Player needs to be crash-saved	*/
+#define PLR_CRASH	(1 << 6)   /* (R) Unused: see DIRTY_OBJS	*/
 #define PLR_SITEOK	(1 << 7)   /* Player has been site-cleared	*/
 #define PLR_NOSHOUT	(1 << 8)   /* Player not allowed to shout/goss	*/
 #define PLR_NOTITLE	(1 << 9)   /* Player not allowed to set title	*/
@@ -168,6 +168,10 @@
 #define PLR_CRYO	(1 << 15)  /* Player is cryo-saved (purge prog)	*/
 #define PLR_NOTDEADYET	(1 << 16)  /* (R) Player being extracted.	*/
 
+/* What's changed about a player since it was saved: player_specials->dirty */
+#define DIRTY_RECORD	(1 << 0)   /* Their player file record		*/
+#define DIRTY_OBJS	(1 << 1)   /* What they wear and carry		*/
+
 
 /* Mobile flags: used by char_data.char_specials.act */
 #define MOB_SPEC         (1 << 0)  /* Mob has a callable spec-proc	*/
@@ -483,14 +487,14 @@
 #define PULSE_SANITY	(30 RL_SEC)
 #define PULSE_USAGE	(5 * 60 RL_SEC)	/* 5 mins */
 #define PULSE_TIMESAVE	(30 * 60 RL_SEC) /* should be >= SECS_PER_MUD_HOUR */
+#define PULSE_JOURNAL	(JOURNAL_PERIOD RL_SEC)
 
 /* Variables for the output buffering system */
 #define MAX_SOCK_BUF            (12 * 1024) /* Size of kernel's sock buf   */
 #define MAX_PROMPT_LENGTH       96          /* Max length of prompt        */
-#define GARBAGE_SPACE		32          /* Space for **OVERFLOW** etc  */
-#define SMALL_BUFSIZE		1024        /* Static output buffer size   */
-/* Max amount of output that can be buffered */
-#define LARGE_BUFSIZE	   (MAX_SOCK_BUF - GARBAGE_SPACE - MAX_PROMPT_LENGTH)
+#define OUTBUF_CHUNK_SIZE	4096        /* Size of one pooled chunk    */
+/* Max amount of output that can be buffered per descriptor */
+#define MAX_OUTBUF_SIZE		(64 * 1024)
 
 #define HISTORY_SIZE		5	/* Keep last 5 commands. */
 #define MAX_STRING_LENGTH	8192
@@ -618,6 +622,8 @@ struct obj_data {
 
    struct obj_data *next_content; /* For 'contains' lists             */
    struct obj_data *next;         /* For the object list              */
+   struct obj_data *next_instance;/* For its prototype's list         */
+   struct obj_data *prev_instance;
 };
 /* ======================================================================= */
 
@@ -654,7 +660,7 @@ struct rent_info {
    int	spare4;
    int	spare5;
    int	spare6;
-   int	spare7;
+   int	journal_seq;	/* journal commit this was saved at */
 };
 /* ======================================================================= */
 
@@ -799,6 +805,7 @@ struct char_special_data {
    int	carry_weight;		/* Carried weight			*/
    byte carry_items;		/* Number of items carried		*/
    int	timer;			/* Timer for update			*/
+   byte zone_mortal;		/* Counted in its zone's mortals	*/
 
    struct char_special_data_saved saved; /* constants saved in plrfile	*/
 };
@@ -848,7 +855,7 @@ struct player_special_data_saved {
    long	spare18;
    long	spare19;
    long	spare20;
-   long	spare21;
+   long	journal_seq;		/* journal commit this was saved at	*/
 };
 
 /*
@@ -867,6 +874,8 @@ struct player_special_data {
    long last_tell;		/* idnum of last tell from		*/
    void *last_olc_targ;		/* olc control				*/
    int last_olc_mode;		/* olc control				*/
+   struct journal_state *journal;	/* what's been journaled of them	*/
+   int dirty;			/* DIRTY_x: changed since last saved	*/
 };
 
 
@@ -877,6 +886,7 @@ struct mob_special_data {
    byte default_pos;        /* Default position for NPC                */
    byte damnodice;          /* The number of damage dice's	       */
    byte damsizedice;        /* The size of the damage dice's           */
+   struct event *act_event; /* Next run of mobile_activity()           */
 };
 
 
@@ -924,6 +934,8 @@ struct char_data {
    struct char_data *next_in_room;     /* For room->people - list         */
    struct char_data *next;             /* For either monster or ppl-list  */
    struct char_data *next_fighting;    /* For fighting list               */
+   struct char_data *next_instance;    /* For its prototype's list        */
+   struct char_data *prev_instance;
 
    struct follow_type *followers;        /* List of chars followers       */
    struct char_data *master;             /* Who is char following?        */
@@ -964,8 +976,9 @@ struct char_file_u {
 /* descriptor-related structures ******************************************/
 
 
+/* One line of input.  Kept on a free list in comm.c when not in a queue. */
 struct txt_block {
-   char	*text;
+   char	text[MAX_INPUT_LENGTH];
    int aliased;
    struct txt_block *next;
 };
@@ -977,9 +990,22 @@ struct txt_q {
 };
 
 
+/*
+ * One link of a descriptor's output queue.  Chunks are all the same size
+ * and come from (and go back to) a global free list in comm.c.
+ */
+struct out_chunk {
+   struct out_chunk *next;
+   size_t head;			/* first byte not yet sent		*/
+   size_t tail;			/* end of the text in this chunk	*/
+   char	text[OUTBUF_CHUNK_SIZE];
+};
+
+
 struct descriptor_data {
    socket_t	descriptor;	/* file descriptor for socket		*/
    char	host[HOST_LENGTH+1];	/* hostname				*/
+   byte	dns_pending;		/* host is numeric until a lookup ends	*/
    byte	bad_pws;		/* number of bad pw attemps this login	*/
    byte idle_tics;		/* tics idle at password prompt		*/
    int	connected;		/* mode of 'connectedness'		*/
@@ -993,15 +1019,17 @@ struct descriptor_data {
    size_t max_str;	        /*		-			*/
    long	mail_to;		/* name for mail system			*/
    int	has_prompt;		/* is the user at a prompt?             */
-   char	inbuf[MAX_RAW_INPUT_LENGTH];  /* buffer for raw input		*/
+   struct io_link *link;	/* socket side, owned by comm.c		*/
    char	last_input[MAX_INPUT_LENGTH]; /* the last input			*/
-   char small_outbuf[SMALL_BUFSIZE];  /* standard output buffer		*/
-   char *output;		/* ptr to the current output buffer	*/
+   struct out_chunk *output;	/* first chunk of queued output		*/
+   struct out_chunk *output_tail; /* chunk new output is written into	*/
+   size_t bufptr;		/* # of bytes of output queued		*/
+   int	overflow;		/* output was dropped at MAX_OUTBUF_SIZE */
+   struct mccp_data *mccp;	/* output compressor, owned by comm.c	*/
+   unsigned long mccp_in;	/* bytes that went into the compressor	*/
+   unsigned long mccp_out;	/* ...and what came out of it		*/
    char **history;		/* History of commands, for ! mostly.	*/
    int	history_pos;		/* Circular array position.		*/
-   int  bufptr;			/* ptr to end of current output		*/
-   int	bufspace;		/* space left in the output buffer	*/
-   struct txt_block *large_outbuf; /* ptr to large buffer, if we need it */
    struct txt_q input;		/* q of unprocessed input		*/
    struct char_data *character;	/* linked to char			*/
    struct char_data *original;	/* original char if switched		*/
@@ -1094,6 +1122,8 @@ struct index_data {
    mob_vnum	vnum;	/* virtual number of this mob/obj		*/
    int		number;	/* number of existing units of this mob/obj	*/
    SPECIAL(*func);
+   struct char_data *mobs;	/* the existing units, newest first	*/
+   struct obj_data *objs;	/* ... of an object			*/
 };
 
 struct guild_info_type {
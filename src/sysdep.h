@@ -51,6 +51,160 @@
 
 /**************************************************************************/
 
+/*
+ * On systems with epoll(7) (Linux), each socket is registered with the
+ * kernel once when it connects and game_loop() only hears about the
+ * descriptors that actually became ready, instead of rebuilding select()
+ * sets over every connection each pulse.  The 'configure' script detects
+ * <sys/epoll.h>; define the constant below to force the old select() loop
+ * anyway.  Note that select() cannot handle more than FD_SETSIZE (usually
+ * 1024) descriptors, so the player limit is capped accordingly.
+ */
+
+/* #define CIRCLE_NO_EPOLL */
+
+/**************************************************************************/
+
+/*
+ * If your system has POSIX threads and a C11 <stdatomic.h>, the sockets
+ * are serviced by a separate network thread: it reads and frames input,
+ * accepts new connections and writes output while the game thread runs
+ * the world, and the two only talk through lock-free queues.  A slow or
+ * flooding client then can't eat into the pulse.  Define the constant
+ * below to do all socket work inline in game_loop() instead, which is
+ * also what happens on systems without threads.
+ */
+
+/* #define CIRCLE_NO_IO_THREAD */
+
+/**************************************************************************/
+
+/*
+ * If the 'configure' script finds zlib, clients that speak MCCP (the Mud
+ * Client Compression Protocol, version 2) are offered compressed output
+ * when they connect.  MUD output is very repetitive, so this usually
+ * saves most of the bandwidth for a little CPU.  MCCP_LEVEL trades CPU
+ * for compression (1 = fastest, 9 = smallest).  MCCP_WINDOW_BITS (9-15)
+ * and MCCP_MEMLEVEL (1-9) set how much memory each compressed connection
+ * ties up: about 2^(WINDOW_BITS + 2) + 2^(MEMLEVEL + 9) bytes, which is
+ * 256K at zlib's own defaults of 15 and 8.  Run bin/mccpbench to see the
+ * tradeoffs on a combat log or on a capture of your own output.
+ *
+ * Define CIRCLE_NO_MCCP to never offer compression.
+ */
+
+/* #define CIRCLE_NO_MCCP */
+
+#define MCCP_LEVEL		6
+#define MCCP_WINDOW_BITS	12
+#define MCCP_MEMLEVEL		5
+
+/**************************************************************************/
+
+/*
+ * With POSIX threads, looking up the hostname of a new connection is
+ * left to DNS_THREADS helper threads so a slow nameserver can't freeze
+ * the game.  The player starts out under their numeric address and it
+ * is replaced (and checked against the ban list again) when the answer
+ * comes back.  Answers are remembered for DNS_CACHE_TTL seconds, and
+ * failed lookups for DNS_FAILED_TTL.  Define CIRCLE_NO_DNS_THREADS to
+ * look names up inline the old way.
+ *
+ * For testing, define DNS_STUB_DELAY to a number of seconds: instead of
+ * asking the nameserver, every lookup then waits that long and answers
+ * with a made-up name ending in ".stub.invalid".
+ */
+
+/* #define CIRCLE_NO_DNS_THREADS */
+
+#define DNS_THREADS		2
+#define DNS_CACHE_TTL		3600
+#define DNS_FAILED_TTL		300
+
+/* #define DNS_STUB_DELAY	5 */
+
+/**************************************************************************/
+
+/*
+ * With POSIX threads, the player file, rent files and house files are
+ * written by a thread of their own.  The game thread only copies out
+ * what's to be saved, so an autosave of a full MUD doesn't stall a pulse
+ * on the disk.  Rent and house files are replaced whole: each is written
+ * under a new name and renamed over the old one, so a crash partway
+ * through leaves the old file and not half of the new one.  With
+ * SAVE_FSYNC, each is also synced to disk before it's renamed.  Define
+ * CIRCLE_NO_SAVE_THREAD to do the writing inline instead.
+ */
+
+/* #define CIRCLE_NO_SAVE_THREAD */
+
+#define SAVE_FSYNC		1
+
+/**************************************************************************/
+
+/*
+ * Between saves, what changes about each player -- points, gold and
+ * experience, and what they carry and wear -- is added to a journal every
+ * JOURNAL_PERIOD seconds, everyone's in one write and one sync.  If the
+ * MUD crashes, booting plays the journal back onto the player file and
+ * rent files, so a player loses seconds rather than everything since the
+ * last autosave.  Each autosave saves whoever's in the journal in full
+ * and starts it afresh.  Define CIRCLE_NO_JOURNAL to not keep a journal.
+ */
+
+/* #define CIRCLE_NO_JOURNAL */
+
+#define JOURNAL_PERIOD		1
+
+/**************************************************************************/
+
+/*
+ * 'bin/circle -w' writes the world, as read from the files in lib/world,
+ * into lib/world/image in a form the MUD can load just by reading it into
+ * memory.  While that image is newer than every world file, the MUD boots
+ * from it instead of parsing the world again.  On systems with mmap(2)
+ * the image is mapped rather than read, so its text is only paged in as
+ * it is used and is shared with the page cache; define CIRCLE_NO_MMAP to
+ * read it into memory instead.
+ */
+
+/* #define CIRCLE_NO_MMAP */
+
+/**************************************************************************/
+
+/*
+ * With POSIX threads, the room, mobile and object files are read on
+ * BOOT_THREADS threads at once when the world has to be booted from
+ * them.  0 means one thread for each processor.  The log and any
+ * format errors come out just as they would if the files had been read
+ * one after another.  Define CIRCLE_NO_BOOT_THREADS to read them on the
+ * one thread anyway.
+ */
+
+/* #define CIRCLE_NO_BOOT_THREADS */
+
+#define BOOT_THREADS		0
+
+/**************************************************************************/
+
+/*
+ * Set ZONE_IDLE_MINUTES to have each zone's mobiles and objects loaded
+ * only when a player first comes into it, instead of at boot.  A zone no
+ * player has been in for that many minutes is unloaded again: the objects
+ * lying in its rooms are saved to lib/house/<zone>.zone, to come back the
+ * next time it's entered, and its mobiles are removed, to be loaded anew
+ * by its resets.  Its rooms are always there.  Zones that never reset
+ * aren't unloaded once loaded, and neither is a zone with a corpse in
+ * it, or with a mobile that has what its resets wouldn't give back, such
+ * as a scavenger that's picked something up.  A shopkeeper's stock is
+ * never the zone's to give back, so any zone with a shopkeeper in it
+ * never unloads.  0 keeps every zone loaded, as always.
+ */
+
+#define ZONE_IDLE_MINUTES	0
+
+/**************************************************************************/
+
 /*
  * The Circle code prototypes library functions to avoid compiler warnings.
  * (Operating system header files *should* do this, but sometimes don't.)
@@ -300,11 +454,43 @@ struct in_addr {
 
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
+#else
+struct iovec {
+  void *iov_base;		/* for perform_socket_writev(), etc. */
+  size_t iov_len;
+};
+#endif
+
+#if defined(HAVE_SYS_EPOLL_H) && !defined(CIRCLE_NO_EPOLL)
+# include <sys/epoll.h>
+# define CIRCLE_EPOLL
+#endif
+
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_STDATOMIC_H) && !defined(CIRCLE_NO_IO_THREAD)
+# include <pthread.h>
+# include <stdatomic.h>
+# define CIRCLE_IO_THREAD
+#endif
+
+#if defined(HAVE_PTHREAD_H) && !defined(CIRCLE_NO_DNS_THREADS)
+# include <pthread.h>
+# define CIRCLE_DNS_THREADS
 #endif
 
 #endif /* __COMM_C__ && CIRCLE_UNIX */
 
 
+/* Header files that are only used in comm.c and util/mccpbench.c */
+#if defined(__COMM_C__) || defined(__MCCPBENCH_C__)
+
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ) && !defined(CIRCLE_NO_MCCP)
+# include <zlib.h>
+# define CIRCLE_MCCP
+#endif
+
+#endif /* __COMM_C__ || __MCCPBENCH_C__ */
+
+
 /* Header files that are only used in act.other.c */
 #ifdef __ACT_OTHER_C__
 
@@ -315,6 +501,73 @@ struct in_addr {
 #endif /* __ACT_OTHER_C__ */
 
 
+/* Header files that are only used in db.c */
+#ifdef __DB_C__
+
+#include <setjmp.h>
+
+#if defined(HAVE_PTHREAD_H) && !defined(CIRCLE_NO_BOOT_THREADS)
+# include <pthread.h>
+# define CIRCLE_BOOT_THREADS
+#endif
+
+#endif /* __DB_C__ */
+
+
+/* Header files that are only used in intern.c */
+#ifdef __INTERN_C__
+
+/* The world files are read on several threads; see db.c. */
+#if defined(HAVE_PTHREAD_H) && !defined(CIRCLE_NO_BOOT_THREADS)
+# include <pthread.h>
+# define CIRCLE_BOOT_THREADS
+#endif
+
+#endif /* __INTERN_C__ */
+
+
+/* Header files that are only used in plrindex.c */
+#ifdef __PLRINDEX_C__
+
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+
+#endif /* __PLRINDEX_C__ */
+
+
+/* Header files that are only used in saver.c */
+#ifdef __SAVER_C__
+
+#ifdef HAVE_SIGNAL_H
+# include <signal.h>
+#endif
+
+#if defined(HAVE_PTHREAD_H) && !defined(CIRCLE_NO_SAVE_THREAD)
+# include <pthread.h>
+# define CIRCLE_SAVE_THREAD
+#endif
+
+#endif /* __SAVER_C__ */
+
+
+/* Header files that are only used in worldimg.c */
+#ifdef __WORLDIMG_C__
+
+#include <stddef.h>		/* offsetof() */
+
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+
+#if defined(HAVE_SYS_MMAN_H) && !defined(CIRCLE_NO_MMAP)
+# include <sys/mman.h>
+# define CIRCLE_MMAP
+#endif
+
+#endif /* __WORLDIMG_C__ */
+
+
 /* Basic system dependencies *******************************************/
 
 #if CIRCLE_GNU_LIBC_MEMORY_TRACK && !defined(HAVE_MCHECK_H)
@@ -343,6 +596,15 @@ struct in_addr {
 # define isascii(c)	(((c) & ~0x7f) == 0)	/* So easy to have, but ... */
 #endif
 
+/* va_copy is C99; older compilers spell it __va_copy or not at all. */
+#if !defined(va_copy)
+# if defined(__va_copy)
+#  define va_copy(dst, src)	__va_copy(dst, src)
+# else
+#  define va_copy(dst, src)	memcpy(&(dst), &(src), sizeof(va_list))
+# endif
+#endif
+
 /* Socket/header miscellany. */
 
 #if defined(CIRCLE_WINDOWS)	/* Definitions for Win32 */
@@ -119,6 +119,7 @@ extern char *telcmds[];
 #define	TELOPT_AUTHENTICATION 37/* Authenticate */
 #define	TELOPT_ENCRYPT	38	/* Encryption option */
 #define TELOPT_NEW_ENVIRON 39	/* New - Environment variables */
+#define TELOPT_COMPRESS2 86	/* MUD Client Compression Protocol v2 */
 #define	TELOPT_EXOPL	255	/* extended-options-list */
 
 
@@ -0,0 +1,322 @@
+/* ************************************************************************
+*  file:  cmdbench.c                                  Part of CircleMUD   *
+*  Usage: measure looking commands up, by trie and by table               *
+*  All Rights Reserved                                                    *
+*  Copyright (C) 1993 The Trustees of The Johns Hopkins University        *
+************************************************************************* */
+
+/*
+ * Reads the command table out of interpreter.c, looks up the first word
+ * of each line of a sample of what players type, the way
+ * command_interpreter() does, both with cmdtrie.c and with the strncmp()
+ * down the table it replaced, and reports the time per lookup for each.
+ * Every prefix of every command, and every word of the sample, is looked
+ * up both ways at each level first, and any difference is reported:
+ * the trie has to find exactly what the table would have.
+ *
+ * With no sample file it uses a made-up one, heavy on walking, looking
+ * and fighting.  Given a file (for example, the lines a client logged
+ * its player typing), it uses that instead, one command per line.
+ */
+
+#define __CMDBENCH_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "cmdtrie.h"
+
+#define SAMPLE_REPEAT	5000	/* times through the sample, for timing */
+#define EXACT_REPEAT	2000	/* times through the table, likewise	*/
+#define MAX_CMDS	1024
+#define LINE_MAX_LEN	256
+
+struct bench_cmd {
+  char *command;
+  int level;
+};
+
+struct bench_cmd cmds[MAX_CMDS];
+int num_cmds = 0;
+
+char **words;			/* the first word of each sample line */
+int num_words = 0;
+
+/* So the lookups aren't optimized away. */
+volatile int sink;
+
+/* local functions */
+int level_value(const char *token);
+void read_commands(const char *name);
+void add_word(const char *line);
+void read_sample(const char *name);
+int table_find(const char *arg, int level);
+int table_exact(const char *command);
+int check(int level);
+double time_find(int trie, int level);
+double time_exact(int trie);
+
+
+int level_value(const char *token)
+{
+  if (isdigit(*token))
+    return (atoi(token));
+  if (!strcmp(token, "LVL_IMPL"))
+    return (LVL_IMPL);
+  if (!strcmp(token, "LVL_GRGOD"))
+    return (LVL_GRGOD);
+  if (!strcmp(token, "LVL_GOD"))
+    return (LVL_GOD);
+  if (!strcmp(token, "LVL_IMMORT"))
+    return (LVL_IMMORT);
+  if (!strcmp(token, "LVL_FREEZE"))
+    return (LVL_FREEZE);
+  return (-1);
+}
+
+
+/*
+ * Each entry of cmd_info[] is on a line of its own:
+ *   { "name", position, function, level, subcmd },
+ */
+void read_commands(const char *name)
+{
+  char line[LINE_MAX_LEN], command[LINE_MAX_LEN], level[LINE_MAX_LEN];
+  int in_table = FALSE;
+  FILE *fl;
+
+  if (!(fl = fopen(name, "r"))) {
+    perror(name);
+    exit(1);
+  }
+
+  while (fgets(line, sizeof(line), fl)) {
+    if (!in_table) {
+      in_table = (strstr(line, "cmd_info[] =") != NULL);
+      continue;
+    }
+    if (sscanf(line, " { \"%[^\"]\" , %*[^,], %*[^,], %[^, ]", command, level) != 2)
+      continue;
+    if (!strcmp(command, "\\n"))
+      break;
+    if (num_cmds == MAX_CMDS) {
+      fprintf(stderr, "%s: more than %d commands\n", name, MAX_CMDS);
+      exit(1);
+    }
+    if ((cmds[num_cmds].level = level_value(level)) < 0) {
+      fprintf(stderr, "%s: %s: unknown level %s\n", name, command, level);
+      exit(1);
+    }
+    cmds[num_cmds].command = strdup(command);
+    cmdtrie_add(command, cmds[num_cmds].level);
+    num_cmds++;
+  }
+  fclose(fl);
+
+  if (!num_cmds) {
+    fprintf(stderr, "%s: no cmd_info[] table in it\n", name);
+    exit(1);
+  }
+}
+
+
+/* The word command_interpreter() would look up from 'line'. */
+void add_word(const char *line)
+{
+  static int words_max = 0;
+  char word[LINE_MAX_LEN];
+  int len = 0;
+
+  while (isspace(*line))
+    line++;
+  if (!*line)
+    return;
+
+  if (!isalpha(*line))
+    word[len++] = *line;
+  else
+    while (*line && !isspace(*line) && len < LINE_MAX_LEN - 1)
+      word[len++] = LOWER(*line++);
+  word[len] = '\0';
+
+  if (num_words == words_max) {
+    words_max = (words_max ? words_max * 2 : 256);
+    if (!(words = (char **) realloc(words, words_max * sizeof(char *)))) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  words[num_words++] = strdup(word);
+}
+
+
+void read_sample(const char *name)
+{
+  const char *made_up[] = {
+	"n", "n", "e", "e", "s", "w", "w", "u", "d", "north", "south",
+	"look", "l", "l", "look corpse", "exa fountain", "score", "sc", "i",
+	"inv", "eq", "who", "where", "time", "weather", "exits", "consider rat",
+	"kill rat", "k rat", "k guard", "hit fido", "bash", "kick", "flee",
+	"rescue bob", "cast 'magic missile' rat", "c 'armor'", "rest", "sleep",
+	"wake", "stand", "get all corpse", "get all", "get sword", "drop sword",
+	"put all bag", "wear all", "rem sword", "wield sword", "hold torch",
+	"eat bread", "drink fountain", "fill skin fountain", "buy bread",
+	"list", "sell sword", "value sword", "practice", "prac", "say hi",
+	"'hello there", "gos anyone around?", "tell bob where are you",
+	"gt follow me", "group", "follow bob", "split 100", "save", "help",
+	"open door", "unlock door", "close door", "recall", "quaff potion",
+	"recite scroll", "use staff", "emote grins", ":waves", "smile",
+	"nod", "grin", "laugh", "ack", "xyzzy", "qwerty", "abcdefghijklmnop",
+	NULL };
+  char line[LINE_MAX_LEN];
+  FILE *fl;
+  int i;
+
+  if (!name) {
+    for (i = 0; made_up[i]; i++)
+      add_word(made_up[i]);
+    return;
+  }
+
+  if (!(fl = fopen(name, "r"))) {
+    perror(name);
+    exit(1);
+  }
+  while (fgets(line, sizeof(line), fl))
+    add_word(line);
+  fclose(fl);
+
+  if (!num_words) {
+    fprintf(stderr, "%s: nothing in it\n", name);
+    exit(1);
+  }
+}
+
+
+/* What command_interpreter() used to do. */
+int table_find(const char *arg, int level)
+{
+  int cmd;
+  size_t length = strlen(arg);
+
+  for (cmd = 0; cmd < num_cmds; cmd++)
+    if (!strncmp(cmds[cmd].command, arg, length))
+      if (level >= cmds[cmd].level)
+	return (cmd);
+
+  return (-1);
+}
+
+
+/* What find_command() used to do. */
+int table_exact(const char *command)
+{
+  int cmd;
+
+  for (cmd = 0; cmd < num_cmds; cmd++)
+    if (!strcmp(cmds[cmd].command, command))
+      return (cmd);
+
+  return (-1);
+}
+
+
+/* Returns how many lookups the trie got wrong. */
+int check(int level)
+{
+  char prefix[LINE_MAX_LEN];
+  int cmd, len, i, wrong = 0;
+
+  for (cmd = 0; cmd < num_cmds; cmd++) {
+    for (len = 0; len <= (int) strlen(cmds[cmd].command); len++) {
+      memcpy(prefix, cmds[cmd].command, len);
+      prefix[len] = '\0';
+      if (cmdtrie_find(prefix, level) != table_find(prefix, level)) {
+	printf("  level %d: '%s' finds %d, not %d\n", level, prefix,
+		cmdtrie_find(prefix, level), table_find(prefix, level));
+	wrong++;
+      }
+    }
+    if (cmdtrie_exact(cmds[cmd].command) != table_exact(cmds[cmd].command)) {
+      printf("  '%s' is exactly %d, not %d\n", cmds[cmd].command,
+		cmdtrie_exact(cmds[cmd].command), table_exact(cmds[cmd].command));
+      wrong++;
+    }
+  }
+
+  for (i = 0; i < num_words; i++)
+    if (cmdtrie_find(words[i], level) != table_find(words[i], level)) {
+      printf("  level %d: '%s' finds %d, not %d\n", level, words[i],
+		cmdtrie_find(words[i], level), table_find(words[i], level));
+      wrong++;
+    }
+
+  return (wrong);
+}
+
+
+/* Nanoseconds per lookup of the sample's words. */
+double time_find(int trie, int level)
+{
+  clock_t start = clock();
+  int r, i;
+
+  for (r = 0; r < SAMPLE_REPEAT; r++)
+    for (i = 0; i < num_words; i++)
+      sink = (trie ? cmdtrie_find(words[i], level) : table_find(words[i], level));
+
+  return ((double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double) SAMPLE_REPEAT * num_words));
+}
+
+
+/* Nanoseconds per exact lookup of every command's whole name. */
+double time_exact(int trie)
+{
+  clock_t start = clock();
+  int r, cmd;
+
+  for (r = 0; r < EXACT_REPEAT; r++)
+    for (cmd = 0; cmd < num_cmds; cmd++)
+      sink = (trie ? cmdtrie_exact(cmds[cmd].command) : table_exact(cmds[cmd].command));
+
+  return ((double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double) EXACT_REPEAT * num_cmds));
+}
+
+
+int main(int argc, char **argv)
+{
+  const int levels[] = { 1, LVL_IMMORT, LVL_IMPL, -1 };
+  double table, trie;
+  int i, wrong = 0;
+
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s interpreter.c [typed-commands]\n", argv[0]);
+    exit(1);
+  }
+  read_commands(argv[1]);
+  read_sample(argc > 2 ? argv[2] : NULL);
+
+  printf("%d commands, %d sample lines\n", num_cmds, num_words);
+  for (i = 0; levels[i] >= 0; i++)
+    wrong += check(levels[i]);
+  if (wrong) {
+    printf("%d lookups differ.\n", wrong);
+    exit(1);
+  }
+  printf("Every lookup matches.\n\n");
+
+  printf("lookup      level   table ns    trie ns\n");
+  for (i = 0; levels[i] >= 0; i++) {
+    table = time_find(FALSE, levels[i]);
+    trie = time_find(TRUE, levels[i]);
+    printf("abbreviated %5d   %8.1f   %8.1f\n", levels[i], table, trie);
+  }
+  table = time_exact(FALSE);
+  trie = time_exact(TRUE);
+  printf("exact           -   %8.1f   %8.1f\n", table, trie);
+
+  cmdtrie_free();
+  return (0);
+}
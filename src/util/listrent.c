@@ -10,6 +10,7 @@
 #include "sysdep.h"
 
 #include "structs.h"
+#include "rentfile.h"
 
 void Crash_listrent(char *fname);
 
@@ -27,18 +28,31 @@ int main(int argc, char **argv)
 void Crash_listrent(char *fname)
 {
   FILE *fl;
-  char buf[MAX_STRING_LENGTH];
+  char buf[MAX_STRING_LENGTH], *data;
   struct obj_file_elem object;
+  struct rent_obj robj;
   struct rent_info rent;
+  size_t len, at;
+  long size;
+  int format, depth = 0, result;
 
   if (!(fl = fopen(fname, "rb"))) {
     sprintf(buf, "%s has no rent file.\r\n", fname);
     printf("%s", buf);
     return;
   }
+  fseek(fl, 0, SEEK_END);
+  size = ftell(fl);
+  rewind(fl);
+  if (size < 0 || !(data = (char *) malloc(size + 1))) {
+    fclose(fl);
+    return;
+  }
+  len = fread(data, 1, size, fl);
+  fclose(fl);
+
   sprintf(buf, "%s\r\n", fname);
-  if (!feof(fl))
-    fread(&rent, sizeof(struct rent_info), 1, fl);
+  format = rent_get_header(data, len, &rent, &at);
   switch (rent.rentcode) {
   case RENT_RENTED:
     strcat(buf, "Rent\r\n");
@@ -57,15 +71,24 @@ void Crash_listrent(char *fname)
     strcat(buf, "Undef\r\n");
     break;
   }
-  while (!feof(fl)) {
-    fread(&object, sizeof(struct obj_file_elem), 1, fl);
-    if (ferror(fl)) {
-      fclose(fl);
-      return;
-    }
-    if (!feof(fl))
-      sprintf(buf, "%s[%5d] %s\n", buf, object.item_number, fname);
-  }
   printf("%s", buf);
-  fclose(fl);
+
+  if (format == RENT_FORMAT_OLD)
+    for (; at + sizeof(struct obj_file_elem) <= len; at += sizeof(struct obj_file_elem)) {
+      memcpy(&object, data + at, sizeof(struct obj_file_elem));
+      printf("[%5d] %s\n", object.item_number, fname);
+    }
+  else if (format == RENT_FORMAT_COMPACT)
+    while ((result = rent_get_obj(data, len, &at, &robj)) != RENT_BAD) {
+      if (result == RENT_END) {
+	if (depth-- == 0)
+	  break;
+	continue;
+      }
+      /* What's in a container is indented under it. */
+      printf("%*s[%5d] %s\n", depth * 2, "", robj.vnum, fname);
+      if (robj.mask & RF_CONTAINS)
+	depth++;
+    }
+  free(data);
 }
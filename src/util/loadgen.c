@@ -0,0 +1,1174 @@
+/* ************************************************************************
+*  file:  loadgen.c                                   Part of CircleMUD   *
+*  Usage: drive a running MUD with thousands of simulated players        *
+*  All Rights Reserved                                                    *
+*  Copyright (C) 1993 The Trustees of The Johns Hopkins University        *
+************************************************************************* */
+
+/*
+ * Opens telnet connections to a MUD, takes each one through the login
+ * (creating the character the first time a name is used), and then has
+ * it type commands: a weighted random mix of movement, look, say, kill,
+ * get and drop, or the lines of a script over and over.  Each command is
+ * timed from when it is sent until its prompt comes back, and at the end
+ * the round trips are reported by kind of command at the 50th, 90th,
+ * 99th and 99.9th percentiles.
+ *
+ * A player has one command outstanding at a time and, after each prompt,
+ * waits a random time averaging 1/rate seconds before the next.  A prompt
+ * brought on by someone else's doings that arrives just after a command
+ * is sent is taken for that command's, so with many players in one room
+ * the short end of the times reads a little shorter than it should.
+ *
+ * 'loadgen -W <dir>' writes a made-up world to run the MUD on: zones of
+ * rooms laid out in grids, with guards to fight and swords to pick up.
+ *
+ *   loadgen -W lib -z 20 -R 99
+ *   bin/circle 4000 &
+ *   loadgen -n 2000 -t 120
+ *
+ * With -i the players only connect, and sit at the greeting without
+ * answering it: what a crowd of idle sockets costs the MUD.  nanny()
+ * hangs up on them after 15 to 30 seconds, and they connect again.
+ * Given the MUD's process id with -S, loadgen reads the CPU time all of
+ * its threads used from /proc, and reports it per pulse, from when all
+ * the players are connected (and the warmup is over) to the end.  /proc
+ * counts in hundredths of a second, so give it a minute or more:
+ *
+ *   loadgen -i -n 10000 -c 1000 -t 120 -S `pgrep -x circle`
+ *
+ * With -r 0 players type the next command as soon as the prompt comes
+ * back, and what the MUD sends is counted in bytes a second.  Everyone
+ * starts in the same room, so a crowd that only says things keeps the
+ * MUD sending each line to all of them -- for the output path:
+ *
+ *   loadgen -n 1000 -r 0 -m move=0,look=0,kill=0,get=0,drop=0 -t 60 -w 20
+ *
+ * Anyone's prompt ends a command there, so the round trips are short.
+ *
+ * The MUD turns away players beyond max_playing (config.c) and beyond
+ * the descriptors it may open, so raise those, and 'ulimit -n', first.
+ */
+
+#define __LOADGEN_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"		/* for OPT_USEC */
+
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+
+#ifndef INVALID_SOCKET
+#define INVALID_SOCKET (-1)
+#endif
+
+#define LG_MAX_TYPES	32	/* kinds of command reported on	*/
+#define LG_TEXT		2048	/* tail of each player's output kept */
+#define LG_MAX_SCRIPT	1024	/* lines of a script		*/
+#define LG_LINE		256	/* longest command		*/
+#define LG_TICK		5	/* milliseconds between looks at the clock */
+#define LG_REPORT	10	/* seconds between progress lines */
+#define LG_GRID		10	/* rooms across each zone's grid */
+#define LG_FIRST_ZONE	30	/* so room 3001, the usual start room, exists */
+
+/* Round trips go in log-linear histograms, like perf.c's. */
+#define LG_SUB_BITS	3
+#define LG_SUB		(1 << LG_SUB_BITS)
+#define LG_MAX_BITS	28
+#define LG_BUCKETS	((LG_MAX_BITS - LG_SUB_BITS + 1) * LG_SUB)
+
+/* Where a player is. */
+#define LG_WAITING	0	/* not connected yet		*/
+#define LG_CONNECTING	1
+#define LG_LOGIN	2	/* answering nanny()		*/
+#define LG_PLAYING	3
+#define LG_CLOSED	4
+
+/* Telnet, as much as is needed to skip over it. */
+#define LG_IAC		255
+#define LG_SB		250
+#define LG_SE		240
+#define LG_WILL		251	/* WILL, WONT, DO, DONT: 251-254 */
+
+/* Replies that aren't the same for everyone. */
+#define LG_NAME		((const char *) 1)
+#define LG_PASSWORD	((const char *) 2)
+
+struct lg_hist {
+  unsigned long count;
+  unsigned long max;		/* longest, in microseconds	*/
+  double total;			/* sum, in microseconds		*/
+  unsigned int bucket[LG_BUCKETS];
+};
+
+struct lg_type {
+  char name[16];
+  struct lg_hist hist;
+  unsigned long timeouts;
+};
+
+struct lg_mix {
+  const char *type;
+  int weight;
+  const char *commands[5];	/* one picked at random; NULL-ended */
+};
+
+struct lg_client {
+  socket_t fd;
+  int state;
+  int num;			/* names the character		*/
+  char text[LG_TEXT];		/* output, less telnet codes and CRs */
+  size_t len;
+  int telnet;			/* partway through a telnet command */
+  unsigned long start;		/* connect, or command, sent at	*/
+  unsigned long next;		/* when to type the next command */
+  int type;			/* of the command out, or -1	*/
+  int line;			/* in the script		*/
+};
+
+/*
+ * What nanny() asks, by how its prompt ends, and what to tell it.  Trailing
+ * spaces don't count: the greeting loses its own when it's read in.
+ */
+struct lg_reply {
+  const char *prompt;
+  const char *reply;
+} lg_replies[] = {
+  { "be known?",	LG_NAME },
+  { "Name:",		LG_NAME },
+  { "IS it, then?",	LG_NAME },
+  { "(Y/N)?",		"y" },
+  { "Yes or No:",	"y" },
+  { "password for",	LG_PASSWORD },	/* the name follows; see lg_answer() */
+  { "Password:",	LG_PASSWORD },
+  { "retype password:",	LG_PASSWORD },
+  { "(M/F)?",		"m" },
+  { "Class:",		"w" },
+  { "PRESS RETURN:",	"" },
+  { "Make your choice:",	"1" },
+  { NULL, NULL }
+};
+
+/* Any of these and the login has gone wrong. */
+const char *lg_failures[] = {
+  "Invalid name",
+  "Wrong password",
+  "Illegal password",
+  "Passwords don't match",
+  "Sorry, ",
+  NULL
+};
+
+struct lg_mix lg_mix[] = {
+  { "move",	40, { "north", "east", "south", "west", NULL } },
+  { "look",	20, { "look", NULL } },
+  { "say",	15, { "say hello", "say anyone want to group?",
+		      "say this is only a test", NULL } },
+  { "kill",	5,  { "kill guard", NULL } },
+  { "get",	10, { "get sword", NULL } },
+  { "drop",	10, { "drop sword", NULL } },
+  { NULL, 0, { NULL } }
+};
+
+/* options */
+const char *lg_host = "127.0.0.1";
+int lg_port = 4000;
+int lg_clients = 100;
+int lg_connect_rate = 100;	/* connections a second		*/
+double lg_rate = 0.5;		/* commands a second, per player; 0, flat out */
+int lg_seconds = 60;
+int lg_warmup = 0;		/* seconds not counted		*/
+int lg_timeout = 10;		/* seconds to wait for a prompt	*/
+const char *lg_prefix = "Load";
+const char *lg_password = "loadtest";
+int lg_quiet = 0;
+int lg_idle = 0;		/* connect, and do nothing more	*/
+int lg_server = 0;		/* the MUD's pid, for its CPU time */
+
+struct lg_client *clients;
+struct lg_type types[LG_MAX_TYPES];
+int num_types;
+struct lg_hist lg_login, lg_all, lg_interval;
+
+char *script[LG_MAX_SCRIPT];
+int script_type[LG_MAX_SCRIPT];
+int script_len;
+
+unsigned long lg_began, lg_counting, lg_ended;
+unsigned long num_bytes, interval_bytes;	/* read from the MUD */
+unsigned long num_connects, num_refused, num_failed, num_dropped, num_timeouts;
+unsigned long num_idled;	/* hung up on at the greeting	*/
+
+/* The MUD's CPU time, and when it was read, at each end of the count. */
+unsigned long cpu_start, cpu_end, cpu_began, cpu_ended;
+volatile sig_atomic_t lg_stop = 0;
+
+#ifdef CIRCLE_EPOLL
+int lg_epoll;
+#endif
+
+/* local functions */
+unsigned long lg_now(void);
+unsigned long lcg(void);
+int lg_bucket(unsigned long usec);
+unsigned long lg_bucket_top(int i);
+void lg_add(struct lg_hist *h, unsigned long usec);
+unsigned long lg_percentile(struct lg_hist *h, int permille);
+void lg_print(const char *name, struct lg_hist *h, unsigned long timeouts);
+int lg_type(const char *name);
+void lg_set_mix(char *spec);
+void lg_read_script(const char *filename);
+void lg_name(int num, char *name);
+void lg_connect(struct lg_client *c, struct sockaddr_in *sa);
+void lg_close(struct lg_client *c, unsigned long *counter);
+int lg_send(struct lg_client *c, const char *txt);
+void lg_watch(struct lg_client *c, int writing);
+void lg_read(struct lg_client *c, unsigned long now);
+void lg_answer(struct lg_client *c, unsigned long now);
+int lg_ends(struct lg_client *c, size_t end, const char *txt);
+void lg_command(struct lg_client *c, unsigned long now);
+unsigned long lg_think(void);
+int lg_server_cpu(unsigned long *usec);
+void lg_run(void);
+void lg_report(void);
+RETSIGTYPE lg_interrupt(int sig);
+void lg_write(const char *dir, const char *file, const char *txt);
+void lg_write_world(const char *dir, int zones, int rooms);
+void usage(const char *prog);
+
+
+/* Microseconds from some fixed point. */
+unsigned long lg_now(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((unsigned long) ts.tv_sec * 1000000UL + ts.tv_nsec / 1000);
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, (struct timezone *) 0);
+  return ((unsigned long) tv.tv_sec * 1000000UL + tv.tv_usec);
+#endif
+}
+
+
+/* Same numbers every run, so runs can be compared. */
+unsigned long lcg(void)
+{
+  static unsigned long seed = 4243;
+
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return (seed >> 8);
+}
+
+
+/* Below LG_SUB each bucket is one microsecond wide. */
+int lg_bucket(unsigned long usec)
+{
+  int bits = LG_SUB_BITS;
+
+  if (usec < LG_SUB)
+    return ((int) usec);
+  if (usec >= 1UL << LG_MAX_BITS)
+    usec = (1UL << LG_MAX_BITS) - 1;
+
+  while (usec >> (bits + 1))
+    bits++;
+
+  return ((bits - LG_SUB_BITS + 1) * LG_SUB +
+	(int) ((usec >> (bits - LG_SUB_BITS)) & (LG_SUB - 1)));
+}
+
+
+/* The longest time that lands in bucket 'i'. */
+unsigned long lg_bucket_top(int i)
+{
+  if (i < LG_SUB)
+    return (i);
+
+  return (((unsigned long) (LG_SUB + i % LG_SUB + 1) << (i / LG_SUB - 1)) - 1);
+}
+
+
+void lg_add(struct lg_hist *h, unsigned long usec)
+{
+  h->count++;
+  h->total += usec;
+  if (usec > h->max)
+    h->max = usec;
+  h->bucket[lg_bucket(usec)]++;
+}
+
+
+/* Time that 'permille' tenths of a percent of the samples beat. */
+unsigned long lg_percentile(struct lg_hist *h, int permille)
+{
+  unsigned long want, seen = 0;
+  int i;
+
+  if (!h->count)
+    return (0);
+
+  want = (h->count * permille + 999) / 1000;
+  for (i = 0; i < LG_BUCKETS; i++)
+    if ((seen += h->bucket[i]) >= want)
+      return (lg_bucket_top(i) < h->max ? lg_bucket_top(i) : h->max);
+
+  return (h->max);
+}
+
+
+/* One line of the report, in milliseconds. */
+void lg_print(const char *name, struct lg_hist *h, unsigned long timeouts)
+{
+  printf("%-10s %9lu %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8lu\n", name,
+	h->count, h->count ? h->total / h->count / 1000 : 0.0,
+	lg_percentile(h, 500) / 1000.0, lg_percentile(h, 900) / 1000.0,
+	lg_percentile(h, 990) / 1000.0, lg_percentile(h, 999) / 1000.0,
+	h->max / 1000.0, timeouts);
+}
+
+
+/* Index of the kind of command called 'name', added if need be. */
+int lg_type(const char *name)
+{
+  int i;
+
+  for (i = 0; i < num_types; i++)
+    if (!strcmp(types[i].name, name))
+      return (i);
+
+  if (num_types == LG_MAX_TYPES)
+    return (LG_MAX_TYPES - 1);	/* lumped in with the last one */
+
+  strncpy(types[num_types].name, name, sizeof(types[num_types].name) - 1);
+  return (num_types++);
+}
+
+
+/* "move=10,kill=0": new weights for some of the mix. */
+void lg_set_mix(char *spec)
+{
+  char *item, *eq;
+  int i;
+
+  for (item = strtok(spec, ","); item; item = strtok(NULL, ",")) {
+    if (!(eq = strchr(item, '='))) {
+      fprintf(stderr, "loadgen: '%s' should be type=weight\n", item);
+      exit(1);
+    }
+    *eq++ = '\0';
+    for (i = 0; lg_mix[i].type; i++)
+      if (!strcmp(lg_mix[i].type, item))
+	break;
+    if (!lg_mix[i].type) {
+      fprintf(stderr, "loadgen: no command type '%s'\n", item);
+      exit(1);
+    }
+    lg_mix[i].weight = atoi(eq);
+  }
+}
+
+
+/* One command a line; each is reported under its first word. */
+void lg_read_script(const char *filename)
+{
+  char line[LG_LINE], verb[16], *p;
+  FILE *fl;
+
+  if (!(fl = fopen(filename, "r"))) {
+    perror(filename);
+    exit(1);
+  }
+
+  while (script_len < LG_MAX_SCRIPT && fgets(line, sizeof(line), fl)) {
+    if ((p = strpbrk(line, "\r\n")) != NULL)
+      *p = '\0';
+    for (p = line; isspace(*p); p++);
+    if (!*p || *p == '#')
+      continue;
+
+    sscanf(p, "%15s", verb);
+    script_type[script_len] = lg_type(verb);
+    if (!(script[script_len++] = strdup(p))) {
+      perror("strdup");
+      exit(1);
+    }
+  }
+  fclose(fl);
+
+  if (!script_len) {
+    fprintf(stderr, "loadgen: nothing to do in %s\n", filename);
+    exit(1);
+  }
+}
+
+
+/* The prefix and then the number in letters: Loadaa, Loadab, ... */
+void lg_name(int num, char *name)
+{
+  char letters[8];
+  int i = sizeof(letters) - 1;
+
+  letters[i] = '\0';
+  do {
+    letters[--i] = 'a' + num % 26;
+    num /= 26;
+  } while (num || i > (int) sizeof(letters) - 3);
+
+  sprintf(name, "%s%s", lg_prefix, letters + i);
+}
+
+
+void lg_connect(struct lg_client *c, struct sockaddr_in *sa)
+{
+  num_connects++;
+  c->start = lg_now();
+
+  if ((c->fd = socket(PF_INET, SOCK_STREAM, 0)) == INVALID_SOCKET) {
+    perror("loadgen: socket");
+    lg_close(c, &num_refused);
+    return;
+  }
+  fcntl(c->fd, F_SETFL, O_NONBLOCK);
+
+  if (connect(c->fd, (struct sockaddr *) sa, sizeof(*sa)) < 0 && errno != EINPROGRESS) {
+    lg_close(c, &num_refused);
+    return;
+  }
+
+  c->state = LG_CONNECTING;
+#ifdef CIRCLE_EPOLL
+  {
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.ptr = c;
+    epoll_ctl(lg_epoll, EPOLL_CTL_ADD, c->fd, &ev);
+  }
+#endif
+}
+
+
+/* Hang up, counting why. */
+void lg_close(struct lg_client *c, unsigned long *counter)
+{
+  if (c->fd != INVALID_SOCKET)
+    CLOSE_SOCKET(c->fd);	/* epoll forgets it by itself */
+  c->fd = INVALID_SOCKET;
+  c->state = LG_CLOSED;
+  (*counter)++;
+}
+
+
+/* Writing less than all of a line this short means something is wrong. */
+int lg_send(struct lg_client *c, const char *txt)
+{
+  char line[LG_LINE + 2];
+  int len;
+
+  len = snprintf(line, sizeof(line), "%s\r\n", txt);
+  if (send(c->fd, line, len, 0) != len) {
+    lg_close(c, &num_dropped);
+    return (-1);
+  }
+  return (0);
+}
+
+
+/* Connected: from now on only reading matters. */
+void lg_watch(struct lg_client *c, int writing)
+{
+  int err = 0;
+  socklen_t len = sizeof(err);
+
+  if (!writing)
+    return;
+
+  if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, (char *) &err, &len) < 0 || err) {
+    lg_close(c, &num_refused);
+    return;
+  }
+  c->state = LG_LOGIN;
+#ifdef CIRCLE_EPOLL
+  {
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = c;
+    epoll_ctl(lg_epoll, EPOLL_CTL_MOD, c->fd, &ev);
+  }
+#endif
+}
+
+
+/* Take in everything waiting, keeping only the text, and act on it. */
+void lg_read(struct lg_client *c, unsigned long now)
+{
+  unsigned char buf[4096];
+  ssize_t n, i;
+
+  for (;;) {
+    if ((n = recv(c->fd, (char *) buf, sizeof(buf), 0)) == 0) {
+      lg_close(c, lg_idle ? &num_idled : c->state == LG_LOGIN ? &num_failed : &num_dropped);
+      return;
+    } else if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+	break;
+      lg_close(c, lg_idle ? &num_idled : c->state == LG_LOGIN ? &num_failed : &num_dropped);
+      return;
+    }
+
+    interval_bytes += n;
+    if (now >= lg_counting)
+      num_bytes += n;
+
+    for (i = 0; i < n; i++) {
+      switch (c->telnet) {
+      case 0:
+	if (buf[i] == LG_IAC)
+	  c->telnet = 1;
+	else if (buf[i] != '\r' && buf[i] != '\0') {
+	  /* Only the end matters; keep the last half when it fills. */
+	  if (c->len == LG_TEXT - 1) {
+	    memmove(c->text, c->text + LG_TEXT / 2, LG_TEXT / 2 - 1);
+	    c->len = LG_TEXT / 2 - 1;
+	  }
+	  c->text[c->len++] = buf[i];
+	}
+	break;
+      case 1:			/* after IAC */
+	c->telnet = (buf[i] == LG_SB ? 3 : buf[i] >= LG_WILL && buf[i] < LG_IAC ? 2 : 0);
+	break;
+      case 2:			/* the option after WILL and so on */
+	c->telnet = 0;
+	break;
+      case 3:			/* in a subnegotiation */
+	if (buf[i] == LG_IAC)
+	  c->telnet = 4;
+	break;
+      case 4:
+	c->telnet = (buf[i] == LG_SE ? 0 : 3);
+	break;
+      }
+    }
+  }
+  c->text[c->len] = '\0';
+
+  lg_answer(c, now);
+}
+
+
+/*
+ * Output that doesn't end in a newline is waiting for something: a game
+ * prompt ends the command out, and anything else is nanny() or the pager
+ * asking a question.
+ */
+void lg_answer(struct lg_client *c, unsigned long now)
+{
+  char name[32];
+  const char *reply;
+  size_t end;
+  int i;
+
+  /* Idle players don't read what they're sent. */
+  if (lg_idle) {
+    c->len = 0;
+    return;
+  }
+
+  for (end = c->len; end && c->text[end - 1] == ' '; end--);
+  if (!end || c->text[end - 1] == '\n')
+    return;
+
+  if (c->state == LG_LOGIN)
+    for (i = 0; lg_failures[i]; i++)
+      if (strstr(c->text, lg_failures[i])) {
+	lg_close(c, &num_failed);
+	return;
+      }
+
+  if (lg_ends(c, end, ">")) {
+    if (c->state == LG_LOGIN) {
+      c->state = LG_PLAYING;
+      lg_add(&lg_login, now - c->start);
+      c->next = now + lg_think();
+    } else if (c->type >= 0) {
+      if (c->start >= lg_counting) {
+	lg_add(&types[c->type].hist, now - c->start);
+	lg_add(&lg_all, now - c->start);
+      }
+      lg_add(&lg_interval, now - c->start);
+      c->type = -1;
+      c->next = now + lg_think();
+    }
+    c->len = 0;
+    return;
+  }
+
+  /* The pager: don't want the rest. */
+  if (lg_ends(c, end, " ]")) {
+    c->len = 0;
+    lg_send(c, "q");
+    return;
+  }
+
+  for (i = 0; lg_replies[i].prompt; i++) {
+    if (lg_ends(c, end, lg_replies[i].prompt))
+      break;
+    /* "Give me a password for Loadaa: " */
+    if (lg_replies[i].reply == LG_PASSWORD && strstr(c->text, lg_replies[i].prompt) &&
+	lg_ends(c, end, ":"))
+      break;
+  }
+  if (!lg_replies[i].prompt)
+    return;			/* not all here yet */
+
+  if ((reply = lg_replies[i].reply) == LG_NAME) {
+    lg_name(c->num, name);
+    reply = name;
+  } else if (reply == LG_PASSWORD)
+    reply = lg_password;
+
+  c->len = 0;
+  lg_send(c, reply);
+}
+
+
+/* Whether the output up to 'end' ends with 'txt'. */
+int lg_ends(struct lg_client *c, size_t end, const char *txt)
+{
+  size_t len = strlen(txt);
+
+  return (end >= len && !strncmp(c->text + end - len, txt, len));
+}
+
+
+/* Type the next command, from the script or the mix. */
+void lg_command(struct lg_client *c, unsigned long now)
+{
+  const char *cmd;
+  int total = 0, pick, i, n;
+
+  if (script_len) {
+    cmd = script[c->line];
+    c->type = script_type[c->line];
+    c->line = (c->line + 1) % script_len;
+  } else {
+    for (i = 0; lg_mix[i].type; i++)
+      total += lg_mix[i].weight;
+    pick = lcg() % total;
+    for (i = 0; pick >= lg_mix[i].weight; i++)
+      pick -= lg_mix[i].weight;
+
+    for (n = 0; lg_mix[i].commands[n]; n++);
+    cmd = lg_mix[i].commands[lcg() % n];
+    c->type = lg_type(lg_mix[i].type);
+  }
+
+  c->start = now;
+  lg_send(c, cmd);
+}
+
+
+/* A random wait averaging 1/lg_rate seconds, in microseconds. */
+unsigned long lg_think(void)
+{
+  if (lg_rate == 0)
+    return (0);
+
+  return ((unsigned long) ((lcg() % 2001) * (1000.0 / lg_rate)));
+}
+
+
+/* CPU time used by all of the MUD's threads, in microseconds. */
+int lg_server_cpu(unsigned long *usec)
+{
+  char path[64], buf[1024], *p;
+  unsigned long utime, stime;
+  FILE *fl;
+  size_t n;
+
+  snprintf(path, sizeof(path), "/proc/%d/stat", lg_server);
+  if (!(fl = fopen(path, "r")))
+    return (0);
+  n = fread(buf, 1, sizeof(buf) - 1, fl);
+  fclose(fl);
+  buf[n] = '\0';
+
+  /* utime and stime are the 14th and 15th; the 2nd, the name, may have spaces. */
+  if (!(p = strrchr(buf, ')')) ||
+	sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+	&utime, &stime) != 2)
+    return (0);
+
+  *usec = (utime + stime) * (1000000UL / sysconf(_SC_CLK_TCK));
+  return (1);
+}
+
+
+RETSIGTYPE lg_interrupt(int sig __attribute__((unused)))
+{
+  lg_stop = 1;
+}
+
+
+void lg_run(void)
+{
+  struct sockaddr_in sa;
+  struct hostent *hp;
+  struct lg_client *c;
+  unsigned long now, end, report, timeout;
+  int started = 0, playing, waiting, i;
+#ifdef CIRCLE_EPOLL
+  struct epoll_event *events;
+  int n;
+#else
+  fd_set in_set, out_set;
+  struct timeval tick;
+  socket_t maxfd;
+#endif
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(lg_port);
+  if (!(hp = gethostbyname(lg_host))) {
+    fprintf(stderr, "loadgen: unknown host '%s'\n", lg_host);
+    exit(1);
+  }
+  memcpy(&sa.sin_addr, hp->h_addr, sizeof(sa.sin_addr));
+
+  if (!(clients = (struct lg_client *) calloc(lg_clients, sizeof(struct lg_client)))) {
+    perror("calloc");
+    exit(1);
+  }
+  for (i = 0; i < lg_clients; i++) {
+    clients[i].fd = INVALID_SOCKET;
+    clients[i].num = i;
+    clients[i].type = -1;
+    if (script_len)
+      clients[i].line = lcg() % script_len;
+  }
+
+#ifdef CIRCLE_EPOLL
+  if ((lg_epoll = epoll_create(lg_clients)) < 0) {
+    perror("loadgen: epoll_create");
+    exit(1);
+  }
+  if (!(events = (struct epoll_event *) calloc(lg_clients, sizeof(struct epoll_event)))) {
+    perror("calloc");
+    exit(1);
+  }
+#endif
+
+  lg_began = lg_now();
+  lg_counting = lg_began + lg_warmup * 1000000UL;
+  end = lg_began + lg_seconds * 1000000UL;
+  report = lg_began + LG_REPORT * 1000000UL;
+  timeout = lg_timeout * 1000000UL;
+
+  while (!lg_stop && (now = lg_now()) < end) {
+    /* Bring on players at lg_connect_rate a second. */
+    while (started < lg_clients &&
+	   (double) started < (now - lg_began) / 1000000.0 * lg_connect_rate + 1)
+      lg_connect(&clients[started++], &sa);
+
+#ifdef CIRCLE_EPOLL
+    n = epoll_wait(lg_epoll, events, lg_clients, LG_TICK);
+    now = lg_now();
+    for (i = 0; i < n; i++) {
+      c = (struct lg_client *) events[i].data.ptr;
+      if (c->state == LG_CONNECTING)
+	lg_watch(c, events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP));
+      if (c->state == LG_LOGIN || c->state == LG_PLAYING)
+	lg_read(c, now);
+    }
+#else
+    FD_ZERO(&in_set);
+    FD_ZERO(&out_set);
+    maxfd = 0;
+    for (i = 0; i < started; i++)
+      if (clients[i].state != LG_CLOSED) {
+	FD_SET(clients[i].fd, clients[i].state == LG_CONNECTING ? &out_set : &in_set);
+	if (clients[i].fd > maxfd)
+	  maxfd = clients[i].fd;
+      }
+    tick.tv_sec = 0;
+    tick.tv_usec = LG_TICK * 1000;
+    select(maxfd + 1, &in_set, &out_set, (fd_set *) 0, &tick);
+    now = lg_now();
+    for (i = 0; i < started; i++) {
+      c = &clients[i];
+      if (c->state == LG_CONNECTING)
+	lg_watch(c, FD_ISSET(c->fd, &out_set));
+      else if ((c->state == LG_LOGIN || c->state == LG_PLAYING) && FD_ISSET(c->fd, &in_set))
+	lg_read(c, now);
+    }
+#endif
+
+    /* Type commands that are due; give up on prompts that aren't coming. */
+    for (playing = waiting = i = 0; i < started; i++) {
+      c = &clients[i];
+      if (lg_idle) {
+	/* Hung up on, or refused: try again, but not every tick. */
+	if (c->state == LG_CLOSED && now - c->start > 1000000UL)
+	  lg_connect(c, &sa);
+	if (c->state == LG_CONNECTING)
+	  waiting++;
+	else if (c->state == LG_LOGIN)
+	  playing++;
+	continue;
+      }
+      if (c->state == LG_LOGIN && now - c->start > timeout * 3)
+	lg_close(c, &num_failed);
+      if (c->state != LG_PLAYING)
+	continue;
+      playing++;
+      if (c->type >= 0 && now - c->start > timeout) {
+	if (c->start >= lg_counting) {
+	  types[c->type].timeouts++;
+	  num_timeouts++;
+	}
+	c->type = -1;
+	c->next = now + lg_think();
+      }
+      if (c->type < 0 && now >= c->next)
+	lg_command(c, now);
+    }
+
+    /* The MUD's CPU time is counted once everyone is on. */
+    if (lg_server && !cpu_began && now >= lg_counting && started == lg_clients &&
+	!waiting && lg_server_cpu(&cpu_start))
+      cpu_began = now;
+
+    if (!lg_quiet && now >= report && lg_idle) {
+      printf("%4lus: %d idle, %d connecting, %lu hung up on\n",
+	    (now - lg_began) / 1000000, playing, waiting, num_idled);
+      fflush(stdout);
+      report += LG_REPORT * 1000000UL;
+    } else if (!lg_quiet && now >= report) {
+      printf("%4lus: %d playing, %lu closed, %.0f commands/s, p50 %.1f ms, p99 %.1f ms, %.2f MB/s\n",
+	    (now - lg_began) / 1000000, playing,
+	    num_refused + num_failed + num_dropped,
+	    lg_interval.count / (double) LG_REPORT,
+	    lg_percentile(&lg_interval, 500) / 1000.0,
+	    lg_percentile(&lg_interval, 990) / 1000.0,
+	    interval_bytes / (double) LG_REPORT / 1000000.0);
+      fflush(stdout);
+      memset(&lg_interval, 0, sizeof(lg_interval));
+      interval_bytes = 0;
+      report += LG_REPORT * 1000000UL;
+    }
+  }
+
+  lg_ended = lg_now();
+  if (cpu_began && lg_server_cpu(&cpu_end))
+    cpu_ended = lg_ended;
+
+  for (i = 0; i < lg_clients; i++)
+    if (clients[i].fd != INVALID_SOCKET)
+      CLOSE_SOCKET(clients[i].fd);
+#ifdef CIRCLE_EPOLL
+  close(lg_epoll);
+  free(events);
+#endif
+  free(clients);
+}
+
+
+void lg_report(void)
+{
+  double pulses, counted;
+  char rate[32];
+  int i;
+
+  if (lg_server && !cpu_ended)
+    printf("\nCouldn't read the MUD's CPU time from /proc/%d/stat%s.\n", lg_server,
+	cpu_began ? "" : ", or not everyone got on");
+  else if (lg_server) {
+    pulses = (cpu_ended - cpu_began) / (double) OPT_USEC;
+    printf("\nThe MUD used %.2f CPU seconds in %.1f: %.0f us a pulse, %.1f%% of a CPU.\n",
+	(cpu_end - cpu_start) / 1000000.0, (cpu_ended - cpu_began) / 1000000.0,
+	(cpu_end - cpu_start) / pulses,
+	(cpu_end - cpu_start) * 100.0 / (cpu_ended - cpu_began));
+  }
+
+  if (lg_idle) {
+    printf("\n%d idle players for %lu seconds.\n"
+	"%lu connections: %lu refused, %lu hung up on at the greeting.\n",
+	lg_clients, (lg_ended - lg_began) / 1000000, num_connects, num_refused, num_idled);
+    return;
+  }
+
+  if (lg_rate == 0)
+    strcpy(rate, "as many commands as they could");
+  else
+    snprintf(rate, sizeof(rate), "%.2f commands a second each", lg_rate);
+  printf("\n%d players, %s, for %lu seconds%s; "
+	"round trips in milliseconds\n",
+	lg_clients, rate, (lg_ended - lg_began) / 1000000,
+	lg_warmup ? " (less warmup)" : "");
+  printf("%-10s %9s %8s %8s %8s %8s %8s %8s %8s\n", "Command", "Count",
+	"Avg", "p50", "p90", "p99", "p99.9", "Max", "Timeouts");
+
+  for (i = 0; i < num_types; i++)
+    if (types[i].hist.count || types[i].timeouts)
+      lg_print(types[i].name, &types[i].hist, types[i].timeouts);
+  lg_print("all", &lg_all, num_timeouts);
+  lg_print("login", &lg_login, num_failed);
+
+  counted = (lg_ended - (lg_counting > lg_began ? lg_counting : lg_began)) / 1000000.0;
+  if (counted > 0)
+    printf("\nRead %.1f MB in %.1f seconds: %.2f MB/s, %.1f K/s a player.\n",
+	num_bytes / 1000000.0, counted, num_bytes / counted / 1000000.0,
+	num_bytes / counted / 1000.0 / lg_clients);
+
+  printf("\n%lu connections: %lu refused, %lu failed to log in, %lu dropped.\n",
+	num_connects, num_refused, num_failed, num_dropped);
+}
+
+
+void lg_write(const char *dir, const char *file, const char *txt)
+{
+  char path[1024];
+  FILE *fl;
+
+  snprintf(path, sizeof(path), "%s/%s", dir, file);
+  if (!(fl = fopen(path, "w"))) {
+    perror(path);
+    exit(1);
+  }
+  fputs(txt, fl);
+  fclose(fl);
+}
+
+
+/*
+ * Enough of a lib/ directory for the MUD to boot: each zone is a grid of
+ * rooms LG_GRID across, joined to the zones either side by an up and a
+ * down exit in its first room, with a guard carrying a sword and another
+ * sword on the floor in every fifth room.
+ */
+void lg_write_world(const char *dir, int zones, int rooms)
+{
+  const char *dirs[] = { "", "world", "world/wld", "world/mob", "world/obj",
+	"world/zon", "world/shp", "text", "text/help", "misc", "etc", "house",
+	"plrobjs", "plrobjs/A-E", "plrobjs/F-J", "plrobjs/K-O", "plrobjs/P-T",
+	"plrobjs/U-Z", "plrobjs/ZZZ", "plralias", "plralias/A-E", "plralias/F-J",
+	"plralias/K-O", "plralias/P-T", "plralias/U-Z", "plralias/ZZZ", NULL };
+  const char *texts[] = { "news", "credits", "motd", "imotd", "info", "wizlist",
+	"immlist", "policies", "handbook", "background", NULL };
+  const char *kinds[] = { "wld", "mob", "obj", "zon" };
+  char path[1024], buf[256];
+  FILE *fl[4], *index[4];
+  int i, k, z, r, v;
+
+  for (i = 0; dirs[i]; i++) {
+    snprintf(path, sizeof(path), "%s/%s", dir, dirs[i]);
+    if (mkdir(path, 0755) < 0 && errno != EEXIST) {
+      perror(path);
+      exit(1);
+    }
+  }
+
+  for (i = 0; texts[i]; i++) {
+    snprintf(path, sizeof(path), "text/%s", texts[i]);
+    snprintf(buf, sizeof(buf), "This is the %s.\n", texts[i]);
+    lg_write(dir, path, buf);
+  }
+  lg_write(dir, "text/greetings", "\nA made-up world, for load testing.\n\n"
+	"By what name do you wish to be known? ");
+  lg_write(dir, "text/help/screen", "Help.\n");
+  lg_write(dir, "text/help/index", "help.hlp\n$\n");
+  lg_write(dir, "text/help/help.hlp", "HELP\nThere is no help.\n#\n$\n");
+  lg_write(dir, "misc/messages", "* messages\nM\n 399\n$\n$\n$\n$\n$\n$\n$\n$\n$\n$\n$\n$\n$\n");
+  lg_write(dir, "misc/socials", "smile 0 0\nYou smile.\n$n smiles.\n#\n\n$\n");
+  lg_write(dir, "misc/xnames", "");
+  lg_write(dir, "misc/ideas", "");
+  lg_write(dir, "misc/typos", "");
+  lg_write(dir, "misc/bugs", "");
+  lg_write(dir, "etc/badsites", "");
+  lg_write(dir, "etc/hcontrol", "");
+  lg_write(dir, "world/shp/index", "$\n");
+  lg_write(dir, "world/shp/index.mini", "$\n");
+
+  for (k = 0; k < 4; k++) {
+    snprintf(path, sizeof(path), "%s/world/%s/index", dir, kinds[k]);
+    if (!(index[k] = fopen(path, "w"))) {
+      perror(path);
+      exit(1);
+    }
+  }
+
+  for (z = LG_FIRST_ZONE; z < LG_FIRST_ZONE + zones; z++) {
+    for (k = 0; k < 4; k++) {
+      snprintf(path, sizeof(path), "%s/world/%s/%d.%s", dir, kinds[k], z, kinds[k]);
+      if (!(fl[k] = fopen(path, "w"))) {
+	perror(path);
+	exit(1);
+      }
+      fprintf(index[k], "%d.%s\n", z, kinds[k]);
+    }
+
+    for (r = 0; r < rooms; r++) {
+      v = z * 100 + r + 1;
+      fprintf(fl[0], "#%d\nRoom %d~\n   You are standing in one of the many rooms of zone %d.\n"
+		"~\n%d 0 1\n", v, v, z, z);
+      if (r >= LG_GRID)
+	fprintf(fl[0], "D0\n~\n~\n0 -1 %d\n", v - LG_GRID);
+      if (r % LG_GRID < LG_GRID - 1 && r + 1 < rooms)
+	fprintf(fl[0], "D1\n~\n~\n0 -1 %d\n", v + 1);
+      if (r + LG_GRID < rooms)
+	fprintf(fl[0], "D2\n~\n~\n0 -1 %d\n", v + LG_GRID);
+      if (r % LG_GRID)
+	fprintf(fl[0], "D3\n~\n~\n0 -1 %d\n", v - 1);
+      if (!r && z + 1 < LG_FIRST_ZONE + zones)
+	fprintf(fl[0], "D4\n~\n~\n0 -1 %d\n", (z + 1) * 100 + 1);
+      if (!r && z > LG_FIRST_ZONE)
+	fprintf(fl[0], "D5\n~\n~\n0 -1 %d\n", (z - 1) * 100 + 1);
+      fprintf(fl[0], "E\nsign~\nThe sign says this is room %d.\n~\nS\n", v);
+    }
+    fprintf(fl[0], "$~\n");
+
+    fprintf(fl[1], "#%d\nguard~\nthe guard~\nA guard stands here.\n~\n"
+		"A guard, there to be killed.\n~\nb 0 0 S\n"
+		"2 19 8 2d8+10 1d4+0\n20 100\n8 8 1\n$\n", z * 100 + 1);
+    fprintf(fl[2], "#%d\nsword~\na sword~\nA sword lies here.~\n~\n"
+		"5 0 an\n0 1 6 3\n5 10 1\n$\n", z * 100 + 1);
+
+    fprintf(fl[3], "#%d\nZone %d~\n%d %d 5 2\n", z, z, z * 100, z * 100 + 99);
+    for (r = 0; r < rooms; r += 5) {
+      fprintf(fl[3], "M 0 %d %d %d\nG 1 %d 1000\nO 0 %d %d %d\n",
+		z * 100 + 1, rooms / 5 + 1, z * 100 + r + 1,
+		z * 100 + 1, z * 100 + 1, rooms / 5 * 2 + 2, z * 100 + r + 1);
+    }
+    fprintf(fl[3], "S\n$\n");
+
+    for (k = 0; k < 4; k++)
+      fclose(fl[k]);
+  }
+
+  for (k = 0; k < 4; k++) {
+    fprintf(index[k], "$\n");
+    fclose(index[k]);
+    snprintf(path, sizeof(path), "world/%s/index.mini", kinds[k]);
+    snprintf(buf, sizeof(buf), "%d.%s\n$\n", LG_FIRST_ZONE, kinds[k]);
+    lg_write(dir, path, buf);
+  }
+
+  printf("Wrote %d zones of %d rooms to %s.\n", zones, rooms, dir);
+}
+
+
+void usage(const char *prog)
+{
+  fprintf(stderr,
+	"Usage: %s [-h host] [-p port] [-n players] [-c connects/sec]\n"
+	"          [-r commands/sec] [-t seconds] [-w warmup] [-T timeout]\n"
+	"          [-s script | -m type=weight,...] [-N prefix] [-P password] [-q]\n"
+	"          [-i] [-S mud-pid]\n"
+	"       %s -W dir [-z zones] [-R rooms]\n", prog, prog);
+  exit(1);
+}
+
+
+int main(int argc, char **argv)
+{
+  const char *world = NULL, *scriptfile = NULL;
+  int zones = 10, rooms = 50, pos;
+#if defined(HAVE_SYS_RESOURCE_H) && defined(RLIMIT_NOFILE)
+  struct rlimit limit;
+#endif
+
+  for (pos = 1; pos < argc; pos++) {
+    if (argv[pos][0] != '-' || !argv[pos][1] || argv[pos][2])
+      usage(argv[0]);
+    if (argv[pos][1] == 'q') {
+      lg_quiet = 1;
+      continue;
+    }
+    if (argv[pos][1] == 'i') {
+      lg_idle = 1;
+      continue;
+    }
+    if (pos + 1 == argc)
+      usage(argv[0]);
+
+    switch (argv[pos][1]) {
+    case 'h': lg_host = argv[++pos]; break;
+    case 'p': lg_port = atoi(argv[++pos]); break;
+    case 'n': lg_clients = atoi(argv[++pos]); break;
+    case 'c': lg_connect_rate = atoi(argv[++pos]); break;
+    case 'r': lg_rate = atof(argv[++pos]); break;
+    case 't': lg_seconds = atoi(argv[++pos]); break;
+    case 'w': lg_warmup = atoi(argv[++pos]); break;
+    case 'T': lg_timeout = atoi(argv[++pos]); break;
+    case 's': scriptfile = argv[++pos]; break;
+    case 'm': lg_set_mix(argv[++pos]); break;
+    case 'N': lg_prefix = argv[++pos]; break;
+    case 'P': lg_password = argv[++pos]; break;
+    case 'W': world = argv[++pos]; break;
+    case 'z': zones = atoi(argv[++pos]); break;
+    case 'R': rooms = atoi(argv[++pos]); break;
+    case 'S': lg_server = atoi(argv[++pos]); break;
+    default: usage(argv[0]);
+    }
+  }
+
+  if (world) {
+    if (zones < 1 || zones > 600 || rooms < 1 || rooms > 99) {
+      fprintf(stderr, "loadgen: 1 to 600 zones of 1 to 99 rooms.\n");
+      exit(1);
+    }
+    lg_write_world(world, zones, rooms);
+    return (0);
+  }
+
+  if (lg_clients < 1 || lg_connect_rate < 1 || lg_rate < 0 || lg_seconds < 1 || lg_timeout < 1) {
+    fprintf(stderr, "loadgen: players, rates (but -r), and times must be more than 0.\n");
+    exit(1);
+  }
+  if (strlen(lg_prefix) > 12 || strlen(lg_password) < 3) {
+    fprintf(stderr, "loadgen: the prefix can have 12 letters at most, the password needs 3.\n");
+    exit(1);
+  }
+
+  if (scriptfile)
+    lg_read_script(scriptfile);
+  else {
+    for (pos = 0; lg_mix[pos].type; pos++)
+      if (lg_mix[pos].weight > 0)
+	lg_type(lg_mix[pos].type);
+    if (!num_types) {
+      fprintf(stderr, "loadgen: every weight in the mix is 0.\n");
+      exit(1);
+    }
+  }
+
+#if defined(HAVE_SYS_RESOURCE_H) && defined(RLIMIT_NOFILE)
+  /* As many descriptors as we're allowed. */
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+#endif
+#ifndef CIRCLE_EPOLL
+  if (lg_clients > FD_SETSIZE - 8) {
+    lg_clients = FD_SETSIZE - 8;
+    fprintf(stderr, "loadgen: select() can only watch %d players.\n", lg_clients);
+  }
+#endif
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, lg_interrupt);
+
+  lg_run();
+  lg_report();
+
+  return (0);
+}
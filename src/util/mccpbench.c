@@ -0,0 +1,252 @@
+/* ************************************************************************
+*  file:  mccpbench.c                                 Part of CircleMUD   *
+*  Usage: measure what MCCP compression costs and saves                  *
+*  All Rights Reserved                                                    *
+*  Copyright (C) 1993 The Trustees of The Johns Hopkins University        *
+************************************************************************* */
+
+/*
+ * Runs a stream of MUD output through zlib the way comm.c does -- one
+ * long deflate stream, sync-flushed after every write -- for a range of
+ * compression levels, window sizes and memory levels, and reports for
+ * each the compression ratio, the CPU time per K of input, and how much
+ * memory zlib held for the stream.  Use it to pick MCCP_LEVEL,
+ * MCCP_WINDOW_BITS and MCCP_MEMLEVEL in sysdep.h.
+ *
+ * With no arguments it makes up a few hundred K of combat spam, room
+ * descriptions, and prompts.  Given a file (a capture of real output, for
+ * example a client log), it uses that instead, one write per line.
+ */
+
+#define __MCCPBENCH_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#ifndef CIRCLE_MCCP
+
+int main(void)
+{
+  printf("mccpbench: CircleMUD was configured without zlib; MCCP is off.\n");
+  return (0);
+}
+
+#else
+
+#define SAMPLE_PULSES	4000	/* pulses of made-up output */
+#define SAMPLE_REPEAT	5	/* times through the sample, for timing */
+#define WRITE_MAX	8192	/* largest single write */
+
+char *sample;			/* the output, back to back */
+size_t sample_len;
+size_t *writes;			/* length of each write in 'sample' */
+int num_writes;
+
+size_t mem_now, mem_peak;	/* what zlib has allocated */
+
+/* local functions */
+voidpf count_alloc(voidpf opaque, uInt items, uInt size);
+void count_free(voidpf opaque, voidpf address);
+void add_write(const char *txt, size_t len);
+unsigned long lcg(void);
+void make_sample(void);
+void read_sample(const char *name);
+void bench(int level, int wbits, int mlevel);
+
+
+/* zlib allocator that keeps track of the total; the size rides in front. */
+voidpf count_alloc(voidpf opaque __attribute__((unused)), uInt items, uInt size)
+{
+  size_t bytes = (size_t) items * size, *p;
+
+  if (!(p = (size_t *) malloc(sizeof(double) + bytes)))
+    return (Z_NULL);
+  *p = bytes;
+  if ((mem_now += bytes) > mem_peak)
+    mem_peak = mem_now;
+  return ((voidpf) ((double *) p + 1));
+}
+
+
+void count_free(voidpf opaque __attribute__((unused)), voidpf address)
+{
+  size_t *p = (size_t *) ((double *) address - 1);
+
+  mem_now -= *p;
+  free(p);
+}
+
+
+void add_write(const char *txt, size_t len)
+{
+  static size_t sample_max = 0;
+  static int writes_max = 0;
+
+  while (sample_len + len > sample_max) {
+    sample_max = (sample_max ? sample_max * 2 : 65536);
+    if (!(sample = (char *) realloc(sample, sample_max))) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  if (num_writes == writes_max) {
+    writes_max = (writes_max ? writes_max * 2 : 1024);
+    if (!(writes = (size_t *) realloc(writes, writes_max * sizeof(size_t)))) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  memcpy(sample + sample_len, txt, len);
+  sample_len += len;
+  writes[num_writes++] = len;
+}
+
+
+/* Same numbers every run, so results can be compared. */
+unsigned long lcg(void)
+{
+  static unsigned long seed = 4243;
+
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return (seed >> 8);
+}
+
+
+void make_sample(void)
+{
+  const char *mobs[] = { "the cityguard", "a giant rat", "the Grand Mistress",
+	"an orc warrior", "the beastly fido", "a wandering minstrel" };
+  const char *hits[] = { "misses", "barely scratches", "hits", "hits very hard",
+	"massacres", "OBLITERATES" };
+  const char *room =
+	"The Temple Square\r\n"
+	"   You are standing on the temple square.  Huge marble steps lead up to\r\n"
+	"the temple gate.  The entrance to the Clerics' Guild is to the west, and\r\n"
+	"the old Grunting Boar Inn, is to the east.  Just south of here you see\r\n"
+	"the market square, the center of Midgaard.\r\n"
+	"[ Exits: n e s w ]\r\n"
+	"A large fountain stands in the middle of the square.\r\n";
+  char buf[WRITE_MAX];
+  int pulse, len, m;
+
+  for (pulse = 0; pulse < SAMPLE_PULSES; pulse++) {
+    m = lcg() % 6;
+    switch (lcg() % 8) {
+    case 0:			/* walked somewhere */
+      len = snprintf(buf, sizeof(buf), "%s%s is standing here.\r\n",
+		room, mobs[m]);
+      break;
+    case 1:			/* someone said something */
+      len = snprintf(buf, sizeof(buf), "%c%s says, 'Have you seen %lu gold coins lying about?'\r\n",
+		toupper(*mobs[m]), mobs[m] + 1, lcg() % 1000);
+      break;
+    default:			/* a round of combat */
+      len = snprintf(buf, sizeof(buf),
+		"You %s %s.\r\n%c%s %s you.\r\n%c%s is %s.\r\n",
+		hits[lcg() % 6], mobs[m], toupper(*mobs[m]), mobs[m] + 1,
+		hits[lcg() % 6], toupper(*mobs[m]), mobs[m] + 1,
+		lcg() % 2 ? "bleeding freely" : "slightly hurt");
+      break;
+    }
+    len += snprintf(buf + len, sizeof(buf) - len, "\r\n< %luH %luM %luV > ",
+		lcg() % 500, lcg() % 200, lcg() % 150);
+    add_write(buf, len);
+  }
+}
+
+
+void read_sample(const char *name)
+{
+  char buf[WRITE_MAX];
+  FILE *fl;
+
+  if (!(fl = fopen(name, "rb"))) {
+    perror(name);
+    exit(1);
+  }
+  while (fgets(buf, sizeof(buf), fl))
+    add_write(buf, strlen(buf));
+  fclose(fl);
+
+  if (!sample_len) {
+    fprintf(stderr, "%s: nothing in it\n", name);
+    exit(1);
+  }
+}
+
+
+void bench(int level, int wbits, int mlevel)
+{
+  static Bytef out[WRITE_MAX * 2];
+  z_stream s;
+  unsigned long total_out = 0;
+  size_t off;
+  clock_t start;
+  double secs;
+  int i, r;
+
+  memset(&s, 0, sizeof(s));
+  s.zalloc = count_alloc;
+  s.zfree = count_free;
+  mem_now = mem_peak = 0;
+
+  if (deflateInit2(&s, level, Z_DEFLATED, wbits, mlevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+    printf("%5d %5d %5d   deflateInit2 failed\n", level, wbits, mlevel);
+    return;
+  }
+
+  start = clock();
+  for (r = 0; r < SAMPLE_REPEAT; r++) {
+    for (off = 0, i = 0; i < num_writes; off += writes[i++]) {
+      s.next_in = (Bytef *) sample + off;
+      s.avail_in = writes[i];
+      do {
+	s.next_out = out;
+	s.avail_out = sizeof(out);
+	deflate(&s, Z_SYNC_FLUSH);
+	if (r == 0)
+	  total_out += sizeof(out) - s.avail_out;
+      } while (s.avail_out == 0);
+    }
+  }
+  secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%5d %5d %5d  %6.1f%%  %8.2f  %6luK\n", level, wbits, mlevel,
+	100.0 * total_out / sample_len,
+	secs * 1000000.0 / (SAMPLE_REPEAT * (sample_len / 1024.0)),
+	(unsigned long) mem_peak / 1024);
+
+  deflateEnd(&s);
+}
+
+
+int main(int argc, char **argv)
+{
+  int levels[] = { 1, 3, 6, 9 }, wbits[] = { 10, 12, 15 }, mlevels[] = { 3, 5, 8 };
+  int l, w, m;
+
+  if (argc > 2) {
+    fprintf(stderr, "Usage: %s [output-capture]\n", argv[0]);
+    exit(1);
+  } else if (argc == 2)
+    read_sample(argv[1]);
+  else
+    make_sample();
+
+  printf("%d writes, %lu bytes, %lu bytes/write; zlib %s\n"
+	"currently: level %d, window bits %d, memlevel %d\n\n",
+	num_writes, (unsigned long) sample_len,
+	(unsigned long) sample_len / num_writes, zlibVersion(),
+	MCCP_LEVEL, MCCP_WINDOW_BITS, MCCP_MEMLEVEL);
+  printf("level wbits mlevl    size   us/K-in   memory\n");
+
+  for (l = 0; l < (int) (sizeof(levels) / sizeof(int)); l++)
+    for (w = 0; w < (int) (sizeof(wbits) / sizeof(int)); w++)
+      for (m = 0; m < (int) (sizeof(mlevels) / sizeof(int)); m++)
+	bench(levels[l], wbits[w], mlevels[m]);
+
+  return (0);
+}
+
+#endif /* CIRCLE_MCCP */
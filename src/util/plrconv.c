@@ -0,0 +1,149 @@
+/* ************************************************************************
+*  file:  plrconv.c                                   Part of CircleMUD   *
+*  Usage: index an existing player file, and check the index against it   *
+*  All Rights Reserved                                                    *
+*  Copyright (C) 1993 The Trustees of The Johns Hopkins University        *
+************************************************************************* */
+
+/*
+ * Reads every record of a player file and writes the index the game
+ * boots from (see plrindex.c), then reads the index back and checks it
+ * against the player file: each record's name and idnum must be in the
+ * index at its place, and looking either up must find it, or an earlier
+ * record with the same, as the game would.
+ *
+ *   plrconv lib/etc/players			writes lib/etc/players.idx
+ *   plrconv -c lib/etc/players		only checks an index already there
+ *
+ * Run it with the game down: the game rewrites the index as it shuts
+ * down, and ignores one made for a player file that's since changed.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "plrindex.h"
+
+/* local functions */
+int check_index(FILE *players, struct player_index_element *table, int top);
+int names_match(const char *a, const char *b);
+
+
+void basic_mud_log(const char *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+
+int names_match(const char *a, const char *b)
+{
+  for (; *a && LOWER(*a) == LOWER(*b); a++, b++);
+
+  return (LOWER(*a) == LOWER(*b));
+}
+
+
+/* Returns the number of problems found. */
+int check_index(FILE *players, struct player_index_element *table, int top)
+{
+  struct char_file_u rec;
+  int i, pos, bad = 0;
+
+  plrindex_attach(&table, &top);
+  rewind(players);
+
+  for (i = 0; i <= top; i++) {
+    if (fread(&rec, sizeof(rec), 1, players) != 1) {
+      printf("Record %d: can't be read.\n", i);
+      return (bad + 1);
+    }
+    rec.name[MAX_NAME_LENGTH] = '\0';
+
+    if (!names_match(table[i].name, rec.name) || table[i].id != rec.char_specials_saved.idnum) {
+      printf("Record %d: %s (%ld) in the file, %s (%ld) in the index.\n", i, rec.name,
+		rec.char_specials_saved.idnum, table[i].name, table[i].id);
+      bad++;
+      continue;
+    }
+
+    pos = plrindex_by_name(rec.name);
+    if (pos < 0 || pos > i || !names_match(table[pos].name, rec.name)) {
+      printf("Record %d: looking up the name %s finds %d.\n", i, rec.name, pos);
+      bad++;
+    }
+
+    pos = plrindex_by_id(rec.char_specials_saved.idnum);
+    if (pos < 0 || pos > i || table[pos].id != rec.char_specials_saved.idnum) {
+      printf("Record %d: looking up the idnum %ld finds %d.\n", i, rec.char_specials_saved.idnum, pos);
+      bad++;
+    }
+  }
+
+  plrindex_free();
+  return (bad);
+}
+
+
+int main(int argc, char **argv)
+{
+  struct player_index_element *table = NULL, *loaded = NULL;
+  int top = -1, loaded_top = -1, check_only = FALSE, bad;
+  char index[PATH_MAX];
+  FILE *players;
+
+  if (argc > 1 && !strcmp(argv[1], "-c")) {
+    check_only = TRUE;
+    argc--;
+    argv++;
+  }
+  if (argc != 2 && argc != 3) {
+    printf("Usage: %s [-c] playerfile-name [indexfile-name]\n", argv[0]);
+    exit(1);
+  }
+
+  if (argc == 3)
+    snprintf(index, sizeof(index), "%s", argv[2]);
+  else
+    snprintf(index, sizeof(index), "%s.idx", argv[1]);
+
+  if (!(players = fopen(argv[1], "rb"))) {
+    perror(argv[1]);
+    exit(1);
+  }
+
+  if (!check_only) {
+    if (!plrindex_scan(players, &table, &top)) {
+      printf("%s can't all be read; no index written.\n", argv[1]);
+      exit(1);
+    }
+    if (!plrindex_save(index, players, table, top))
+      exit(1);
+    printf("%d players indexed in %s.\n", top + 1, index);
+  }
+
+  if (!plrindex_load(index, players, &loaded, &loaded_top)) {
+    printf("%s isn't an up to date index of %s.\n", index, argv[1]);
+    exit(1);
+  }
+  if (!check_only && loaded_top != top) {
+    printf("%d players indexed, but %d read back.\n", top + 1, loaded_top + 1);
+    exit(1);
+  }
+
+  if ((bad = check_index(players, loaded, loaded_top)) != 0) {
+    printf("%d problems found.\n", bad);
+    exit(1);
+  }
+  printf("%d players checked: the index matches the player file.\n", loaded_top + 1);
+
+  fclose(players);
+  return (0);
+}
@@ -0,0 +1,382 @@
+/* ************************************************************************
+*  file:  vnumbench.c                                 Part of CircleMUD   *
+*  Usage: measure looking rooms, mobiles, objects and zones up by vnum    *
+*  All Rights Reserved                                                    *
+*  Copyright (C) 1993 The Trustees of The Johns Hopkins University        *
+************************************************************************* */
+
+/*
+ * Makes up a world of zones with a few rooms, mobiles and objects
+ * scattered through each one's hundred vnums, the way builders leave
+ * them, and looks vnums up in it both with the index real_room() and
+ * friends use now and with the binary search down the tables they used
+ * before.  Half the vnums looked up are in the world and half are random
+ * ones below the highest, which mostly aren't.  Every vnum is looked up
+ * both ways first, and any difference is reported.
+ *
+ * The look-ups below are the same as in db.c's vnum_index_build() and
+ * real_*(); keep them that way.
+ *
+ *   vnumbench [zones [records-per-zone [vnums-per-zone]]]
+ *
+ * The defaults, 250 zones of 10 records in 100 vnums each, are a sparse
+ * world; 250 99 100 is a dense one.
+ */
+
+#define __VNUMBENCH_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+
+#define LOOKUPS		2000000	/* per table, for timing */
+
+/*
+ * The tables, as db.c has them: the binary search steps through the
+ * structures themselves, so its cache misses are the real ones.
+ */
+struct room_data *world;
+struct index_data *mob_index, *obj_index;
+struct zone_data *zone_table;
+room_rnum top_of_world;
+mob_rnum top_of_mobt;
+obj_rnum top_of_objt;
+zone_rnum top_of_zone_table;
+
+struct vnum_index {
+  IDXTYPE *rnum;
+  int top;			/* highest vnum it has room for	*/
+};
+
+struct vnum_index room_vnums, mob_vnums, obj_vnums, zone_vnums;
+
+IDXTYPE *vnums;		/* what's looked up, in order */
+IDXTYPE *zone_nums;		/* the same for the zone table */
+int max_vnum;
+
+/* So the lookups aren't optimized away. */
+volatile int sink;
+
+/* local functions */
+unsigned long lcg(void);
+void make_world(int zones, int per_zone, int span);
+void vnum_index_size(struct vnum_index *vi, int top);
+void make_indexes(void);
+room_rnum index_room(room_vnum vnum);
+mob_rnum index_mobile(mob_vnum vnum);
+obj_rnum index_object(obj_vnum vnum);
+zone_rnum index_zone(zone_vnum vnum);
+room_rnum search_room(room_vnum vnum);
+mob_rnum search_mobile(mob_vnum vnum);
+obj_rnum search_object(obj_vnum vnum);
+zone_rnum search_zone(zone_vnum vnum);
+void make_lookups(int zones, int per_zone);
+int check(IDXTYPE (*by_index)(IDXTYPE), IDXTYPE (*by_search)(IDXTYPE), const char *what);
+double time_lookups(IDXTYPE (*lookup)(IDXTYPE), IDXTYPE *list);
+
+
+void basic_mud_log(const char *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+
+unsigned long lcg(void)
+{
+  static unsigned long seed = 4243;
+
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return (seed >> 8);
+}
+
+
+/*
+ * Zone z covers vnums z * span to z * span + span - 1; each of its
+ * records gets a random vnum in there, none twice, and the tables are
+ * in vnum order, as the boot leaves them.
+ */
+void make_world(int zones, int per_zone, int span)
+{
+  char *used;
+  int z, i, n = 0, v;
+
+  CREATE(world, struct room_data, zones * per_zone);
+  CREATE(mob_index, struct index_data, zones * per_zone);
+  CREATE(obj_index, struct index_data, zones * per_zone);
+  CREATE(zone_table, struct zone_data, zones);
+  CREATE(used, char, span);
+
+  for (z = 0; z < zones; z++) {
+    zone_table[z].number = z;
+    zone_table[z].bot = z * span;
+    zone_table[z].top = z * span + span - 1;
+
+    memset(used, 0, span);
+    for (i = 0; i < per_zone; i++) {
+      do {
+	v = lcg() % span;
+      } while (used[v]);
+      used[v] = 1;
+    }
+    for (v = 0; v < span; v++)
+      if (used[v]) {
+	world[n].number = z * span + v;
+	mob_index[n].vnum = z * span + v;
+	obj_index[n].vnum = z * span + v;
+	n++;
+      }
+  }
+  free(used);
+
+  top_of_world = top_of_mobt = top_of_objt = n - 1;
+  top_of_zone_table = zones - 1;
+  max_vnum = zones * span - 1;
+}
+
+
+void vnum_index_size(struct vnum_index *vi, int top)
+{
+  int i;
+
+  if (vi->rnum)
+    free(vi->rnum);
+  vi->rnum = NULL;
+  vi->top = -1;
+
+  if (top < 0)
+    return;
+
+  CREATE(vi->rnum, IDXTYPE, top + 1);
+  for (i = 0; i <= top; i++)
+    vi->rnum[i] = NOWHERE;
+  vi->top = top;
+}
+
+
+void make_indexes(void)
+{
+  int i;
+
+  vnum_index_size(&room_vnums, world[top_of_world].number);
+  for (i = 0; i <= top_of_world; i++)
+    room_vnums.rnum[world[i].number] = i;
+
+  vnum_index_size(&mob_vnums, mob_index[top_of_mobt].vnum);
+  for (i = 0; i <= top_of_mobt; i++)
+    mob_vnums.rnum[mob_index[i].vnum] = i;
+
+  vnum_index_size(&obj_vnums, obj_index[top_of_objt].vnum);
+  for (i = 0; i <= top_of_objt; i++)
+    obj_vnums.rnum[obj_index[i].vnum] = i;
+
+  vnum_index_size(&zone_vnums, zone_table[top_of_zone_table].number);
+  for (i = 0; i <= top_of_zone_table; i++)
+    zone_vnums.rnum[zone_table[i].number] = i;
+}
+
+
+room_rnum index_room(room_vnum vnum)
+{
+  return ((int) vnum >= 0 && vnum <= room_vnums.top ? room_vnums.rnum[vnum] : NOWHERE);
+}
+
+
+mob_rnum index_mobile(mob_vnum vnum)
+{
+  return ((int) vnum >= 0 && vnum <= mob_vnums.top ? mob_vnums.rnum[vnum] : NOBODY);
+}
+
+
+obj_rnum index_object(obj_vnum vnum)
+{
+  return ((int) vnum >= 0 && vnum <= obj_vnums.top ? obj_vnums.rnum[vnum] : NOTHING);
+}
+
+
+zone_rnum index_zone(zone_vnum vnum)
+{
+  return ((int) vnum >= 0 && vnum <= zone_vnums.top ? zone_vnums.rnum[vnum] : NOWHERE);
+}
+
+
+/* What real_room() used to do. */
+room_rnum search_room(room_vnum vnum)
+{
+  room_rnum bot = 0, top = top_of_world, mid;
+
+  for (;;) {
+    mid = (bot + top) / 2;
+
+    if ((world + mid)->number == vnum)
+      return (mid);
+    if (bot >= top)
+      return (NOWHERE);
+    if ((world + mid)->number > vnum)
+      top = mid - 1;
+    else
+      bot = mid + 1;
+  }
+}
+
+
+/* What real_mobile() used to do. */
+mob_rnum search_mobile(mob_vnum vnum)
+{
+  mob_rnum bot = 0, top = top_of_mobt, mid;
+
+  for (;;) {
+    mid = (bot + top) / 2;
+
+    if ((mob_index + mid)->vnum == vnum)
+      return (mid);
+    if (bot >= top)
+      return (NOBODY);
+    if ((mob_index + mid)->vnum > vnum)
+      top = mid - 1;
+    else
+      bot = mid + 1;
+  }
+}
+
+
+/* What real_object() used to do. */
+obj_rnum search_object(obj_vnum vnum)
+{
+  obj_rnum bot = 0, top = top_of_objt, mid;
+
+  for (;;) {
+    mid = (bot + top) / 2;
+
+    if ((obj_index + mid)->vnum == vnum)
+      return (mid);
+    if (bot >= top)
+      return (NOTHING);
+    if ((obj_index + mid)->vnum > vnum)
+      top = mid - 1;
+    else
+      bot = mid + 1;
+  }
+}
+
+
+/* What real_zone() used to do. */
+zone_rnum search_zone(zone_vnum vnum)
+{
+  zone_rnum bot = 0, top = top_of_zone_table, mid;
+
+  for (;;) {
+    mid = (bot + top) / 2;
+
+    if ((zone_table + mid)->number == vnum)
+      return (mid);
+    if (bot >= top)
+      return (NOWHERE);
+    if ((zone_table + mid)->number > vnum)
+      top = mid - 1;
+    else
+      bot = mid + 1;
+  }
+}
+
+
+/* Every other one is in the world; the rest are anything. */
+void make_lookups(int zones, int per_zone)
+{
+  int i;
+
+  CREATE(vnums, IDXTYPE, LOOKUPS);
+  CREATE(zone_nums, IDXTYPE, LOOKUPS);
+  for (i = 0; i < LOOKUPS; i++)
+    if (i % 2) {
+      vnums[i] = lcg() % (max_vnum + 1);
+      zone_nums[i] = lcg() % (max_vnum + 1);
+    } else {
+      vnums[i] = world[lcg() % (zones * per_zone)].number;
+      zone_nums[i] = lcg() % zones;
+    }
+}
+
+
+/* Returns how many vnums the index got wrong. */
+int check(IDXTYPE (*by_index)(IDXTYPE), IDXTYPE (*by_search)(IDXTYPE), const char *what)
+{
+  int vnum, wrong = 0;
+
+  for (vnum = 0; vnum <= max_vnum + 100; vnum++)
+    if (by_index(vnum) != by_search(vnum)) {
+      if (wrong++ < 10)
+	printf("  %s %d is %d, not %d\n", what, vnum, by_index(vnum), by_search(vnum));
+    }
+
+  return (wrong);
+}
+
+
+/* Nanoseconds per lookup. */
+double time_lookups(IDXTYPE (*lookup)(IDXTYPE), IDXTYPE *list)
+{
+  clock_t start = clock();
+  int i;
+
+  for (i = 0; i < LOOKUPS; i++)
+    sink = lookup(list[i]);
+
+  return ((double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / LOOKUPS);
+}
+
+
+int main(int argc, char **argv)
+{
+  int zones = 250, per_zone = 10, span = 100, wrong = 0;
+
+  if (argc > 4) {
+    fprintf(stderr, "Usage: %s [zones [records-per-zone [vnums-per-zone]]]\n", argv[0]);
+    exit(1);
+  }
+  if (argc > 1)
+    zones = atoi(argv[1]);
+  if (argc > 2)
+    per_zone = atoi(argv[2]);
+  if (argc > 3)
+    span = atoi(argv[3]);
+  if (zones < 1 || per_zone < 1 || per_zone > span || (long) zones * span > 32000) {
+    fprintf(stderr, "%s: need 1 to %d records a zone, and no more than 32000 vnums in all.\n",
+	argv[0], span);
+    exit(1);
+  }
+
+  make_world(zones, per_zone, span);
+  make_indexes();
+  make_lookups(zones, per_zone);
+
+  printf("%d zones, %d records in each of their %d vnums\n", zones, per_zone, span);
+  wrong += check(index_room, search_room, "room");
+  wrong += check(index_mobile, search_mobile, "mobile");
+  wrong += check(index_object, search_object, "object");
+  wrong += check(index_zone, search_zone, "zone");
+  if (wrong) {
+    printf("%d lookups differ.\n", wrong);
+    exit(1);
+  }
+  printf("Every lookup matches.\n\n");
+
+  printf("table      index ns   search ns\n");
+  printf("room       %8.1f    %8.1f\n", time_lookups(index_room, vnums),
+	time_lookups(search_room, vnums));
+  printf("mobile     %8.1f    %8.1f\n", time_lookups(index_mobile, vnums),
+	time_lookups(search_mobile, vnums));
+  printf("object     %8.1f    %8.1f\n", time_lookups(index_object, vnums),
+	time_lookups(search_object, vnums));
+  printf("zone       %8.1f    %8.1f\n", time_lookups(index_zone, zone_nums),
+	time_lookups(search_zone, zone_nums));
+
+  return (0);
+}
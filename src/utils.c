@@ -197,11 +197,16 @@ void log_death_trap(struct char_data *ch)
 /*
  * New variable argument log() function.  Works the same as the old for
  * previously written code but is very nice for new code.
+ *
+ * Other threads log as well as the game, so the time is worked out in a
+ * buffer of our own and each message is written to the log under the
+ * stream's lock, in one piece.
  */
 void basic_mud_vlog(const char *format, va_list args)
 {
   time_t ct = time(0);
-  char *time_s = asctime(localtime(&ct));
+  char time_s[32];
+  struct tm tm;
 
   if (logfile == NULL) {
     puts("SYSERR: Using log() before stream was initialized!");
@@ -211,12 +216,23 @@ void basic_mud_vlog(const char *format, va_list args)
   if (format == NULL)
     format = "SYSERR: log() received a NULL format.";
 
-  time_s[strlen(time_s) - 1] = '\0';
+#ifdef CIRCLE_UNIX
+  localtime_r(&ct, &tm);
+#else
+  tm = *localtime(&ct);
+#endif
+  strftime(time_s, sizeof(time_s), "%b %e %H:%M:%S", &tm);
 
-  fprintf(logfile, "%-15.15s :: ", time_s + 4);
+#ifdef CIRCLE_UNIX
+  flockfile(logfile);
+#endif
+  fprintf(logfile, "%-15.15s :: ", time_s);
   vfprintf(logfile, format, args);
   fputc('\n', logfile);
   fflush(logfile);
+#ifdef CIRCLE_UNIX
+  funlockfile(logfile);
+#endif
 }
 
 
@@ -178,6 +178,28 @@ void	update_pos(struct char_data *victim);
    }					\
 
 
+/*
+ * The mobiles and objects made from each prototype are kept in a list of
+ * their own, which they can be taken out of without searching it.
+ */
+#define ADD_INSTANCE(item, head)	do {		\
+   (item)->prev_instance = NULL;			\
+   if (((item)->next_instance = (head)) != NULL)	\
+      (head)->prev_instance = (item);			\
+   (head) = (item);					\
+} while (0)
+
+#define REMOVE_INSTANCE(item, head)	do {		\
+   if ((item)->prev_instance)				\
+      (item)->prev_instance->next_instance = (item)->next_instance; \
+   else							\
+      (head) = (item)->next_instance;			\
+   if ((item)->next_instance)				\
+      (item)->next_instance->prev_instance = (item)->prev_instance; \
+   (item)->next_instance = (item)->prev_instance = NULL; \
+} while (0)
+
+
 /* basic bitvector utils *************************************************/
 
 
@@ -203,6 +225,7 @@ void	update_pos(struct char_data *victim);
 
 #define MOB_FLAGS(ch)	((ch)->char_specials.saved.act)
 #define PLR_FLAGS(ch)	((ch)->char_specials.saved.act)
+#define GET_DIRTY(ch)	CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->dirty))
 #define PRF_FLAGS(ch) CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->saved.pref))
 #define AFF_FLAGS(ch)	((ch)->char_specials.saved.affected_by)
 #define ROOM_FLAGS(loc)	(world[(loc)].room_flags)
@@ -228,6 +251,9 @@ void	update_pos(struct char_data *victim);
 #define OBJ_FLAGGED(obj, flag) (IS_SET(GET_OBJ_EXTRA(obj), (flag)))
 #define HAS_SPELL_ROUTINE(spl, flag) (IS_SET(SPELL_ROUTINES(spl), (flag)))
 
+/* Something saved about 'ch' has changed: DIRTY_x.  Mobs aren't saved. */
+#define SET_DIRTY(ch, what)	do { if (!IS_NPC(ch)) GET_DIRTY(ch) |= (what); } while (0)
+
 /* IS_AFFECTED for backwards compatibility */
 #define IS_AFFECTED(ch, skill) (AFF_FLAGGED((ch), (skill)))
 
@@ -337,6 +363,7 @@ void	update_pos(struct char_data *victim);
 
 #define GET_DEFAULT_POS(ch)	((ch)->mob_specials.default_pos)
 #define MEMORY(ch)		((ch)->mob_specials.memory)
+#define MOB_EVENT(ch)		((ch)->mob_specials.act_event)
 
 #define STRENGTH_APPLY_INDEX(ch) \
         ( ((GET_ADD(ch)==0) || (GET_STR(ch) != 18)) ? GET_STR(ch) :\
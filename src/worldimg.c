@@ -0,0 +1,730 @@
+/* ************************************************************************
+*   File: worldimg.c                                    Part of CircleMUD *
+*  Usage: writing the world out as one binary image, and booting from it  *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * 'circle -w' boots the world from the text files as usual and then
+ * writes the rooms and exits, mobile and object prototypes, zone command
+ * tables and shops into WORLD_IMAGE_FILE just as they sit in memory,
+ * except that each pointer is written as an offset.  The strings go in a
+ * pool after the tables, each different string only once.
+ *
+ * At boot the image is mapped into memory and the offsets in the tables
+ * are turned back into pointers: nothing is parsed, and nothing is
+ * malloc'd string by string.  The string pool is only read, so its pages
+ * stay shared with the page cache instead of becoming our own memory.
+ *
+ * The image is only used if it was made by a server with the same
+ * structures, from world files with the same names, sizes and times as
+ * the ones there now; otherwise the text files are read as before.
+ */
+
+#define __WORLDIMG_C__
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "shop.h"
+#include "worldimg.h"
+
+#define WI_ALIGN	8		/* where each table may start	*/
+#define WI_BASIS	2166136261UL	/* FNV-1a			*/
+#define WI_PRIME	16777619UL
+
+struct world_image_header {
+  char magic[8];
+  int version;
+  unsigned long layout;		/* sizes and offsets of the structures */
+  unsigned long sources;	/* names, sizes and times of the files */
+  unsigned long checksum;	/* of everything after the header */
+  unsigned long length;		/* of the whole file		*/
+
+  int top_of_world, top_of_mobt, top_of_objt, top_of_zone_table, top_shop;
+
+  /* Where each table starts, and the strings. */
+  unsigned long world, mob_index, mob_proto, obj_index, obj_proto;
+  unsigned long zone_table, shop_index, strings;
+};
+
+/* local globals */
+char *image_base = NULL;	/* the image, while the world is in it */
+char *image_strings;
+size_t image_length;
+#ifdef CIRCLE_MMAP
+int image_mapped;		/* rather than read into a buffer */
+#endif
+
+char *wi_buf;			/* the header and tables, being written */
+size_t wi_len, wi_max;
+char *wi_pool;			/* the strings, being written	*/
+size_t wi_pool_len, wi_pool_max;
+unsigned long *wi_strtab;	/* offsets in the pool, hashed	*/
+size_t wi_strtab_size, wi_strtab_used;
+
+/* local functions */
+unsigned long wi_hash(unsigned long h, const void *data, size_t len);
+unsigned long wi_layout(void);
+unsigned long wi_sources(void);
+unsigned long wi_alloc(size_t len);
+unsigned long wi_string(const char *str);
+void wi_strtab_grow(void);
+unsigned long wi_extra(struct extra_descr_data *ed);
+void wi_write_rooms(void);
+void wi_write_mobs(void);
+void wi_write_objs(void);
+void wi_write_zones(void);
+void wi_write_shops(void);
+void wi_free(void);
+void wi_fix_extra(struct extra_descr_data *ed);
+void wi_fix(struct world_image_header *hdr);
+char *wi_map(FILE *fl, size_t len);
+
+/* external variables */
+extern struct shop_data *shop_index;
+extern int top_shop;
+extern int no_specials;
+
+/*
+ * While writing, pointers become offsets: into the file for the tables,
+ * and into the pool for strings.  The buffer moves as it grows, so hold
+ * on to offsets, not pointers, across anything that adds to it.
+ */
+#define WI_OFFSET(off)		((void *) (size_t) (off))
+#define WI_AT(type, off)	((type *) (wi_buf + (off)))
+#define WI_HDR			WI_AT(struct world_image_header, 0)
+
+/* And back again when it's loaded.  Offset 0 is NULL for both. */
+#define WI_PTR(p)	((p) = (void *) ((p) ? image_base + (size_t) (p) : NULL))
+#define WI_STR(p)	((p) = (void *) ((p) ? image_strings + (size_t) (p) : NULL))
+
+
+/* FNV-1a, a word at a time while there are whole words. */
+unsigned long wi_hash(unsigned long h, const void *data, size_t len)
+{
+  const unsigned char *p = (const unsigned char *) data;
+  unsigned long w;
+
+  for (; len >= sizeof(w); p += sizeof(w), len -= sizeof(w)) {
+    memcpy(&w, p, sizeof(w));
+    h = (h ^ w) * WI_PRIME;
+  }
+  for (; len; p++, len--)
+    h = (h ^ *p) * WI_PRIME;
+
+  return (h);
+}
+
+
+/*
+ * The image holds the structures as this server lays them out, so
+ * anything that resizes one or moves a pointer in it makes old images
+ * unusable.
+ */
+unsigned long wi_layout(void)
+{
+  size_t layout[] = {
+    sizeof(void *), sizeof(long), sizeof(struct world_image_header),
+    sizeof(struct room_data), offsetof(struct room_data, name),
+    offsetof(struct room_data, description),
+    offsetof(struct room_data, ex_description),
+    offsetof(struct room_data, dir_option),
+    sizeof(struct room_direction_data),
+    offsetof(struct room_direction_data, general_description),
+    offsetof(struct room_direction_data, keyword),
+    sizeof(struct extra_descr_data), offsetof(struct extra_descr_data, keyword),
+    offsetof(struct extra_descr_data, description),
+    offsetof(struct extra_descr_data, next),
+    sizeof(struct char_data), offsetof(struct char_data, player),
+    offsetof(struct char_data, player_specials),
+    sizeof(struct char_player_data), offsetof(struct char_player_data, name),
+    offsetof(struct char_player_data, short_descr),
+    offsetof(struct char_player_data, long_descr),
+    offsetof(struct char_player_data, description),
+    offsetof(struct char_player_data, title),
+    sizeof(struct obj_data), offsetof(struct obj_data, name),
+    offsetof(struct obj_data, description),
+    offsetof(struct obj_data, short_description),
+    offsetof(struct obj_data, action_description),
+    offsetof(struct obj_data, ex_description),
+    sizeof(struct index_data), sizeof(struct reset_com),
+    sizeof(struct zone_data), offsetof(struct zone_data, name),
+    offsetof(struct zone_data, cmd),
+    sizeof(struct shop_data), offsetof(struct shop_data, producing),
+    offsetof(struct shop_data, type), offsetof(struct shop_data, no_such_item1),
+    offsetof(struct shop_data, message_sell), offsetof(struct shop_data, in_room),
+    sizeof(struct shop_buy_data), offsetof(struct shop_buy_data, keywords)
+  };
+
+  return (wi_hash(WI_BASIS, layout, sizeof(layout)));
+}
+
+
+/*
+ * The name, size and time of every world file and index, or 0 if an
+ * index is missing.
+ */
+unsigned long wi_sources(void)
+{
+  const char *prefixes[] = { WLD_PREFIX, MOB_PREFIX, OBJ_PREFIX, ZON_PREFIX, SHP_PREFIX, NULL };
+  char name[128], path[PATH_MAX];
+  unsigned long h = WI_BASIS, stamp[2];
+  struct stat st;
+  FILE *index;
+  int i;
+
+  for (i = 0; prefixes[i]; i++) {
+    snprintf(path, sizeof(path), "%s%s", prefixes[i], INDEX_FILE);
+    if (!(index = fopen(path, "r")))
+      return (0);
+
+    snprintf(name, sizeof(name), "%s", INDEX_FILE);
+    do {
+      snprintf(path, sizeof(path), "%s%s", prefixes[i], name);
+      if (stat(path, &st) < 0)
+	stamp[0] = stamp[1] = 0;
+      else {
+	stamp[0] = (unsigned long) st.st_size;
+	stamp[1] = (unsigned long) st.st_mtime;
+      }
+      h = wi_hash(h, path, strlen(path));
+      h = wi_hash(h, stamp, sizeof(stamp));
+    } while (fscanf(index, "%127s\n", name) == 1 && *name != '$');
+
+    fclose(index);
+  }
+
+  return (h);
+}
+
+
+/* Zeroed room for 'len' bytes of table; returns where it is. */
+unsigned long wi_alloc(size_t len)
+{
+  size_t off = (wi_len + WI_ALIGN - 1) & ~((size_t) WI_ALIGN - 1);
+
+  while (off + len > wi_max) {
+    wi_max = (wi_max ? wi_max * 2 : 65536);
+    RECREATE(wi_buf, char, wi_max);
+  }
+  memset(wi_buf + wi_len, 0, off + len - wi_len);
+  wi_len = off + len;
+
+  return (off);
+}
+
+
+void wi_strtab_grow(void)
+{
+  unsigned long *old = wi_strtab, slot;
+  size_t old_size = wi_strtab_size, i;
+
+  wi_strtab_size = (old_size ? old_size * 2 : 4096);
+  CREATE(wi_strtab, unsigned long, wi_strtab_size);
+
+  for (i = 0; i < old_size; i++) {
+    if (!old[i])
+      continue;
+    slot = wi_hash(WI_BASIS, wi_pool + old[i], strlen(wi_pool + old[i])) % wi_strtab_size;
+    while (wi_strtab[slot])
+      slot = (slot + 1) % wi_strtab_size;
+    wi_strtab[slot] = old[i];
+  }
+
+  if (old)
+    free(old);
+}
+
+
+/* Where 'str' is in the pool, adding it if it isn't there yet. */
+unsigned long wi_string(const char *str)
+{
+  unsigned long slot, off;
+  size_t len;
+
+  if (!str)
+    return (0);
+
+  if (wi_strtab_used * 2 >= wi_strtab_size)
+    wi_strtab_grow();
+
+  len = strlen(str);
+  for (slot = wi_hash(WI_BASIS, str, len) % wi_strtab_size; wi_strtab[slot];
+	slot = (slot + 1) % wi_strtab_size)
+    if (!strcmp(wi_pool + wi_strtab[slot], str))
+      return (wi_strtab[slot]);
+
+  while (wi_pool_len + len + 1 > wi_pool_max) {
+    wi_pool_max *= 2;
+    RECREATE(wi_pool, char, wi_pool_max);
+  }
+  off = wi_pool_len;
+  memcpy(wi_pool + off, str, len + 1);
+  wi_pool_len += len + 1;
+
+  wi_strtab[slot] = off;
+  wi_strtab_used++;
+  return (off);
+}
+
+
+/* Copy a list of extra descriptions; returns where the first one is. */
+unsigned long wi_extra(struct extra_descr_data *ed)
+{
+  unsigned long first = 0, prev = 0, off;
+  struct extra_descr_data *copy;
+
+  for (; ed; ed = ed->next) {
+    off = wi_alloc(sizeof(struct extra_descr_data));
+    copy = WI_AT(struct extra_descr_data, off);
+    copy->keyword = WI_OFFSET(wi_string(ed->keyword));
+    copy->description = WI_OFFSET(wi_string(ed->description));
+
+    if (prev)
+      WI_AT(struct extra_descr_data, prev)->next = WI_OFFSET(off);
+    else
+      first = off;
+    prev = off;
+  }
+
+  return (first);
+}
+
+
+void wi_write_rooms(void)
+{
+  struct room_direction_data *dir;
+  struct room_data *room;
+  unsigned long rooms, off;
+  room_rnum i;
+  int d;
+
+  rooms = wi_alloc(sizeof(struct room_data) * (top_of_world + 1));
+  WI_HDR->world = rooms;
+  WI_HDR->top_of_world = top_of_world;
+
+  for (i = 0; i <= top_of_world; i++) {
+    room = WI_AT(struct room_data, rooms) + i;
+    *room = world[i];
+    room->name = WI_OFFSET(wi_string(world[i].name));
+    room->description = WI_OFFSET(wi_string(world[i].description));
+    room->func = NULL;
+    room->contents = NULL;
+    room->people = NULL;
+    room->light = 0;
+
+    off = wi_extra(world[i].ex_description);
+    (WI_AT(struct room_data, rooms) + i)->ex_description = WI_OFFSET(off);
+
+    for (d = 0; d < NUM_OF_DIRS; d++) {
+      if (!world[i].dir_option[d])
+	continue;
+      off = wi_alloc(sizeof(struct room_direction_data));
+      dir = WI_AT(struct room_direction_data, off);
+      *dir = *world[i].dir_option[d];
+      dir->general_description = WI_OFFSET(wi_string(world[i].dir_option[d]->general_description));
+      dir->keyword = WI_OFFSET(wi_string(world[i].dir_option[d]->keyword));
+      (WI_AT(struct room_data, rooms) + i)->dir_option[d] = WI_OFFSET(off);
+    }
+  }
+}
+
+
+/*
+ * Nothing has been loaded from the prototypes yet, so apart from their
+ * strings and the shared player_specials their pointers are all NULL.
+ */
+void wi_write_mobs(void)
+{
+  struct char_data *mob;
+  unsigned long index, protos;
+  mob_rnum i;
+
+  index = wi_alloc(sizeof(struct index_data) * (top_of_mobt + 1));
+  memcpy(wi_buf + index, mob_index, sizeof(struct index_data) * (top_of_mobt + 1));
+  protos = wi_alloc(sizeof(struct char_data) * (top_of_mobt + 1));
+  WI_HDR->mob_index = index;
+  WI_HDR->mob_proto = protos;
+  WI_HDR->top_of_mobt = top_of_mobt;
+
+  for (i = 0; i <= top_of_mobt; i++) {
+    mob = WI_AT(struct char_data, protos) + i;
+    *mob = mob_proto[i];
+    mob->player.name = WI_OFFSET(wi_string(mob_proto[i].player.name));
+    mob->player.short_descr = WI_OFFSET(wi_string(mob_proto[i].player.short_descr));
+    mob->player.long_descr = WI_OFFSET(wi_string(mob_proto[i].player.long_descr));
+    mob->player.description = WI_OFFSET(wi_string(mob_proto[i].player.description));
+    mob->player.title = WI_OFFSET(wi_string(mob_proto[i].player.title));
+    mob->player_specials = NULL;
+  }
+}
+
+
+void wi_write_objs(void)
+{
+  struct obj_data *obj;
+  unsigned long index, protos, off;
+  obj_rnum i;
+
+  index = wi_alloc(sizeof(struct index_data) * (top_of_objt + 1));
+  memcpy(wi_buf + index, obj_index, sizeof(struct index_data) * (top_of_objt + 1));
+  protos = wi_alloc(sizeof(struct obj_data) * (top_of_objt + 1));
+  WI_HDR->obj_index = index;
+  WI_HDR->obj_proto = protos;
+  WI_HDR->top_of_objt = top_of_objt;
+
+  for (i = 0; i <= top_of_objt; i++) {
+    obj = WI_AT(struct obj_data, protos) + i;
+    *obj = obj_proto[i];
+    obj->name = WI_OFFSET(wi_string(obj_proto[i].name));
+    obj->description = WI_OFFSET(wi_string(obj_proto[i].description));
+    obj->short_description = WI_OFFSET(wi_string(obj_proto[i].short_description));
+    obj->action_description = WI_OFFSET(wi_string(obj_proto[i].action_description));
+
+    off = wi_extra(obj_proto[i].ex_description);
+    (WI_AT(struct obj_data, protos) + i)->ex_description = WI_OFFSET(off);
+  }
+}
+
+
+void wi_write_zones(void)
+{
+  unsigned long zones, cmds;
+  zone_rnum i;
+  int n;
+
+  zones = wi_alloc(sizeof(struct zone_data) * (top_of_zone_table + 1));
+  WI_HDR->zone_table = zones;
+  WI_HDR->top_of_zone_table = top_of_zone_table;
+
+  for (i = 0; i <= top_of_zone_table; i++) {
+    for (n = 0; zone_table[i].cmd[n].command != 'S'; n++);
+    cmds = wi_alloc(sizeof(struct reset_com) * (n + 1));
+    memcpy(wi_buf + cmds, zone_table[i].cmd, sizeof(struct reset_com) * (n + 1));
+
+    *(WI_AT(struct zone_data, zones) + i) = zone_table[i];
+    (WI_AT(struct zone_data, zones) + i)->name = WI_OFFSET(wi_string(zone_table[i].name));
+    (WI_AT(struct zone_data, zones) + i)->cmd = WI_OFFSET(cmds);
+  }
+}
+
+
+/* The lists in a shop each end with a NOTHING. */
+void wi_write_shops(void)
+{
+  struct shop_data *from, *shop;
+  unsigned long shops, producing, type, in_room;
+  int i, n;
+
+  WI_HDR->top_shop = top_shop;
+  if (top_shop < 0)
+    return;
+
+  shops = wi_alloc(sizeof(struct shop_data) * (top_shop + 1));
+  WI_HDR->shop_index = shops;
+
+  for (i = 0; i <= top_shop; i++) {
+    from = shop_index + i;
+
+    for (n = 0; from->producing[n] != NOTHING; n++);
+    producing = wi_alloc(sizeof(obj_vnum) * (n + 1));
+    memcpy(wi_buf + producing, from->producing, sizeof(obj_vnum) * (n + 1));
+
+    for (n = 0; BUY_TYPE(from->type[n]) != NOTHING; n++);
+    type = wi_alloc(sizeof(struct shop_buy_data) * (n + 1));
+    for (; n >= 0; n--) {
+      BUY_TYPE(WI_AT(struct shop_buy_data, type)[n]) = BUY_TYPE(from->type[n]);
+      BUY_WORD(WI_AT(struct shop_buy_data, type)[n]) = WI_OFFSET(wi_string(BUY_WORD(from->type[n])));
+    }
+
+    for (n = 0; from->in_room[n] != NOWHERE; n++);
+    in_room = wi_alloc(sizeof(room_vnum) * (n + 1));
+    memcpy(wi_buf + in_room, from->in_room, sizeof(room_vnum) * (n + 1));
+
+    shop = WI_AT(struct shop_data, shops) + i;
+    *shop = *from;
+    shop->producing = WI_OFFSET(producing);
+    shop->type = WI_OFFSET(type);
+    shop->in_room = WI_OFFSET(in_room);
+    shop->func = NULL;
+    shop->no_such_item1 = WI_OFFSET(wi_string(from->no_such_item1));
+    shop->no_such_item2 = WI_OFFSET(wi_string(from->no_such_item2));
+    shop->missing_cash1 = WI_OFFSET(wi_string(from->missing_cash1));
+    shop->missing_cash2 = WI_OFFSET(wi_string(from->missing_cash2));
+    shop->do_not_buy = WI_OFFSET(wi_string(from->do_not_buy));
+    shop->message_buy = WI_OFFSET(wi_string(from->message_buy));
+    shop->message_sell = WI_OFFSET(wi_string(from->message_sell));
+  }
+}
+
+
+void wi_free(void)
+{
+  free(wi_buf);
+  free(wi_pool);
+  free(wi_strtab);
+  wi_buf = wi_pool = NULL;
+  wi_strtab = NULL;
+  wi_len = wi_max = wi_pool_len = wi_pool_max = wi_strtab_size = wi_strtab_used = 0;
+}
+
+
+/*
+ * Write the world as booted from the text files to 'filename'.  It goes
+ * to a new file that replaces the old one only once it's complete, so a
+ * MUD booting meanwhile never sees half an image.
+ */
+int world_image_write(const char *filename)
+{
+  char tmpname[PATH_MAX];
+  unsigned long strings;
+  FILE *fl;
+
+  log("Writing the world image.");
+
+  wi_alloc(sizeof(struct world_image_header));
+  wi_pool_max = 65536;
+  CREATE(wi_pool, char, wi_pool_max);
+  wi_pool_len = 1;		/* so no string is at offset 0 */
+
+  wi_write_rooms();
+  wi_write_mobs();
+  wi_write_objs();
+  wi_write_zones();
+  wi_write_shops();
+
+  strings = wi_alloc(wi_pool_len);
+  memcpy(wi_buf + strings, wi_pool, wi_pool_len);
+
+  memcpy(WI_HDR->magic, WORLD_IMAGE_MAGIC, sizeof(WI_HDR->magic));
+  WI_HDR->version = WORLD_IMAGE_VERSION;
+  WI_HDR->layout = wi_layout();
+  WI_HDR->sources = wi_sources();
+  WI_HDR->length = wi_len;
+  WI_HDR->strings = strings;
+  WI_HDR->checksum = wi_hash(WI_BASIS, wi_buf + sizeof(struct world_image_header),
+	wi_len - sizeof(struct world_image_header));
+
+  snprintf(tmpname, sizeof(tmpname), "%s.new", filename);
+  if (!(fl = fopen(tmpname, "wb"))) {
+    log("SYSERR: Couldn't write world image '%s': %s", tmpname, strerror(errno));
+    wi_free();
+    return (-1);
+  }
+  if (fwrite(wi_buf, 1, wi_len, fl) != wi_len || fclose(fl) != 0) {
+    log("SYSERR: Couldn't write world image '%s': %s", tmpname, strerror(errno));
+    remove(tmpname);
+    wi_free();
+    return (-1);
+  }
+  if (rename(tmpname, filename) < 0) {
+    log("SYSERR: Couldn't rename '%s' to '%s': %s", tmpname, filename, strerror(errno));
+    wi_free();
+    return (-1);
+  }
+
+  log("   %lu bytes: %lu of tables, %lu of strings (%lu different).",
+	(unsigned long) wi_len, (unsigned long) strings,
+	(unsigned long) wi_pool_len, (unsigned long) wi_strtab_used);
+  wi_free();
+  return (0);
+}
+
+
+void wi_fix_extra(struct extra_descr_data *ed)
+{
+  for (; ed; ed = ed->next) {
+    WI_STR(ed->keyword);
+    WI_STR(ed->description);
+    WI_PTR(ed->next);
+  }
+}
+
+
+/* Turn every offset in the tables into a pointer. */
+void wi_fix(struct world_image_header *hdr)
+{
+  struct shop_buy_data *buy;
+  int i, d;
+
+  world = (struct room_data *) (image_base + hdr->world);
+  for (i = 0; i <= hdr->top_of_world; i++) {
+    WI_STR(world[i].name);
+    WI_STR(world[i].description);
+    WI_PTR(world[i].ex_description);
+    wi_fix_extra(world[i].ex_description);
+    for (d = 0; d < NUM_OF_DIRS; d++)
+      if (WI_PTR(world[i].dir_option[d])) {
+	WI_STR(world[i].dir_option[d]->general_description);
+	WI_STR(world[i].dir_option[d]->keyword);
+      }
+  }
+  top_of_world = hdr->top_of_world;
+
+  mob_index = (struct index_data *) (image_base + hdr->mob_index);
+  mob_proto = (struct char_data *) (image_base + hdr->mob_proto);
+  for (i = 0; i <= hdr->top_of_mobt; i++) {
+    WI_STR(mob_proto[i].player.name);
+    WI_STR(mob_proto[i].player.short_descr);
+    WI_STR(mob_proto[i].player.long_descr);
+    WI_STR(mob_proto[i].player.description);
+    WI_STR(mob_proto[i].player.title);
+    mob_proto[i].player_specials = &dummy_mob;
+  }
+  top_of_mobt = hdr->top_of_mobt;
+
+  obj_index = (struct index_data *) (image_base + hdr->obj_index);
+  obj_proto = (struct obj_data *) (image_base + hdr->obj_proto);
+  for (i = 0; i <= hdr->top_of_objt; i++) {
+    WI_STR(obj_proto[i].name);
+    WI_STR(obj_proto[i].description);
+    WI_STR(obj_proto[i].short_description);
+    WI_STR(obj_proto[i].action_description);
+    WI_PTR(obj_proto[i].ex_description);
+    wi_fix_extra(obj_proto[i].ex_description);
+  }
+  top_of_objt = hdr->top_of_objt;
+
+  zone_table = (struct zone_data *) (image_base + hdr->zone_table);
+  for (i = 0; i <= hdr->top_of_zone_table; i++) {
+    WI_STR(zone_table[i].name);
+    WI_PTR(zone_table[i].cmd);
+  }
+  top_of_zone_table = hdr->top_of_zone_table;
+
+  /* Shops are left out like the text files would have left them. */
+  if (no_specials || hdr->top_shop < 0)
+    return;
+
+  shop_index = (struct shop_data *) (image_base + hdr->shop_index);
+  for (i = 0; i <= hdr->top_shop; i++) {
+    WI_PTR(shop_index[i].producing);
+    WI_PTR(shop_index[i].type);
+    for (buy = shop_index[i].type; BUY_TYPE(*buy) != NOTHING; buy++)
+      WI_STR(BUY_WORD(*buy));
+    WI_STR(BUY_WORD(*buy));
+    WI_PTR(shop_index[i].in_room);
+    WI_STR(shop_index[i].no_such_item1);
+    WI_STR(shop_index[i].no_such_item2);
+    WI_STR(shop_index[i].missing_cash1);
+    WI_STR(shop_index[i].missing_cash2);
+    WI_STR(shop_index[i].do_not_buy);
+    WI_STR(shop_index[i].message_buy);
+    WI_STR(shop_index[i].message_sell);
+  }
+  top_shop = hdr->top_shop;
+}
+
+
+/* The whole file in memory, mapped if we can. */
+char *wi_map(FILE *fl, size_t len)
+{
+  char *buf;
+
+#ifdef CIRCLE_MMAP
+  /* Private, so fixing up the tables doesn't write to the file. */
+  buf = (char *) mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fl), 0);
+  if (buf != (char *) MAP_FAILED) {
+    image_mapped = TRUE;
+    return (buf);
+  }
+  log("SYSERR: Couldn't map the world image: %s", strerror(errno));
+  image_mapped = FALSE;
+#endif
+
+  CREATE(buf, char, len);
+  rewind(fl);
+  if (fread(buf, 1, len, fl) != len) {
+    free(buf);
+    return (NULL);
+  }
+  return (buf);
+}
+
+
+/*
+ * Boot the world from the image in 'filename'.  Returns FALSE, having
+ * changed nothing, if there's no image or it can't be used; the world
+ * files must be read instead.
+ */
+int world_image_load(const char *filename)
+{
+  struct world_image_header hdr, *image;
+  struct stat st;
+  FILE *fl;
+  char *buf;
+
+  if (!(fl = fopen(filename, "rb")))
+    return (FALSE);
+
+  if (fread(&hdr, sizeof(hdr), 1, fl) != 1 || fstat(fileno(fl), &st) < 0 ||
+	memcmp(hdr.magic, WORLD_IMAGE_MAGIC, sizeof(hdr.magic)) || hdr.version != WORLD_IMAGE_VERSION ||
+	hdr.layout != wi_layout() || hdr.length != (unsigned long) st.st_size) {
+    log("World image '%s' is from another version of the server; ignoring it.", filename);
+    fclose(fl);
+    return (FALSE);
+  }
+
+  if (hdr.sources != wi_sources()) {
+    log("World image '%s' is older than the world files; ignoring it.", filename);
+    fclose(fl);
+    return (FALSE);
+  }
+
+  if (!(buf = wi_map(fl, hdr.length))) {
+    log("SYSERR: Couldn't read world image '%s'.", filename);
+    fclose(fl);
+    return (FALSE);
+  }
+  fclose(fl);
+
+  image_base = buf;
+  image_length = hdr.length;
+
+  if (wi_hash(WI_BASIS, buf + sizeof(hdr), hdr.length - sizeof(hdr)) != hdr.checksum) {
+    log("SYSERR: World image '%s' is corrupt; ignoring it.", filename);
+    world_image_unload();
+    return (FALSE);
+  }
+
+  image = (struct world_image_header *) buf;
+  image_strings = buf + image->strings;
+  wi_fix(image);
+
+  log("   %d rooms, %d mobs, %d objs, %d zones, %d shops; %lu bytes.",
+	top_of_world + 1, top_of_mobt + 1, top_of_objt + 1,
+	top_of_zone_table + 1, top_shop + 1, hdr.length);
+  return (TRUE);
+}
+
+
+/* Let go of the image; only once nothing points into it. */
+void world_image_unload(void)
+{
+  if (!image_base)
+    return;
+
+#ifdef CIRCLE_MMAP
+  if (image_mapped)
+    munmap(image_base, image_length);
+  else
+#endif
+    free(image_base);
+
+  image_base = NULL;
+}
+
+
+int world_image_owns(const void *ptr)
+{
+  return (image_base && (const char *) ptr >= image_base &&
+	(const char *) ptr < image_base + image_length);
+}
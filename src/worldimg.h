@@ -0,0 +1,27 @@
+/* ************************************************************************
+*   File: worldimg.h                                    Part of CircleMUD *
+*  Usage: header file for the compiled world image                        *
+*                                                                         *
+*  All rights reserved.  See license.doc for complete information.        *
+*                                                                         *
+*  Copyright (C) 1993, 94 by the Trustees of the Johns Hopkins University *
+*  CircleMUD is based on DikuMUD, Copyright (C) 1990, 1991.               *
+************************************************************************ */
+
+/*
+ * Change WORLD_IMAGE_VERSION whenever what goes into the image changes.
+ * Changes to the structures themselves are caught on their own.
+ */
+#define WORLD_IMAGE_MAGIC	"CircWld"
+#define WORLD_IMAGE_VERSION	1
+
+int world_image_load(const char *filename);
+int world_image_write(const char *filename);
+void world_image_unload(void);
+int world_image_owns(const void *ptr);
+
+/* free() for world data, which might be part of the image instead. */
+#define WORLD_FREE(ptr)	do { if ((ptr) && !world_image_owns(ptr)) free(ptr); } while (0)
+
+/* The same for world text, which is shared through str_intern() instead. */
+#define WORLD_FREE_STR(ptr)	do { if ((ptr) && !world_image_owns(ptr)) str_release(ptr); } while (0)